@@ -0,0 +1,106 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#include <stdlib.h>
+#include "os/mynewt.h"
+#include "console/console.h"
+#include "os_bench.h"
+
+/*
+ * Measures the cost of re-arming a callout and of computing the next
+ * wakeup for tickless idle, with 10, 100 and 1000 callouts armed.  All
+ * callouts expire well after the benchmark completes, and are stopped
+ * before it returns.
+ */
+
+#define CALLOUT_BENCH_MAX       (1000)
+#define CALLOUT_BENCH_ITERS     (1000)
+#define CALLOUT_BENCH_MIN_TICKS (OS_TICKS_PER_SEC * 60)
+#define CALLOUT_BENCH_MAX_TICKS (OS_TICKS_PER_SEC * 600)
+
+static struct os_callout callout_bench_callouts[CALLOUT_BENCH_MAX];
+
+static void
+callout_bench_cb(struct os_event *ev)
+{
+}
+
+static os_time_t
+callout_bench_ticks(void)
+{
+    return CALLOUT_BENCH_MIN_TICKS +
+           rand() % (CALLOUT_BENCH_MAX_TICKS - CALLOUT_BENCH_MIN_TICKS);
+}
+
+static void
+callout_bench_one(int num)
+{
+    uint64_t reset_ns;
+    uint64_t wakeup_ns;
+    uint64_t start;
+    os_time_t ticks;
+    os_sr_t sr;
+    int i;
+
+    for (i = 0; i < num; i++) {
+        os_callout_reset(&callout_bench_callouts[i], callout_bench_ticks());
+    }
+
+    reset_ns = 0;
+    for (i = 0; i < CALLOUT_BENCH_ITERS; i++) {
+        ticks = callout_bench_ticks();
+        start = os_bench_time_ns();
+        os_callout_reset(&callout_bench_callouts[rand() % num], ticks);
+        reset_ns += os_bench_time_ns() - start;
+    }
+
+    OS_ENTER_CRITICAL(sr);
+    start = os_bench_time_ns();
+    for (i = 0; i < CALLOUT_BENCH_ITERS; i++) {
+        os_callout_wakeup_ticks(os_time_get());
+    }
+    wakeup_ns = os_bench_time_ns() - start;
+    OS_EXIT_CRITICAL(sr);
+
+    for (i = 0; i < num; i++) {
+        os_callout_stop(&callout_bench_callouts[i]);
+    }
+
+    console_printf("  %4d armed: reset %6lu ns, wakeup_ticks %6lu ns\n", num,
+                   (unsigned long)(reset_ns / CALLOUT_BENCH_ITERS),
+                   (unsigned long)(wakeup_ns / CALLOUT_BENCH_ITERS));
+}
+
+void
+callout_bench_run(void)
+{
+    int i;
+
+    for (i = 0; i < CALLOUT_BENCH_MAX; i++) {
+        os_callout_init(&callout_bench_callouts[i], os_eventq_dflt_get(),
+                        callout_bench_cb, NULL);
+    }
+
+    console_printf("callout: %s\n", MYNEWT_VAL(OS_CALLOUT_WHEEL) ?
+                   "timer wheel" : "sorted list");
+    for (i = 10; i <= CALLOUT_BENCH_MAX; i *= 10) {
+        callout_bench_one(i);
+    }
+}
@@ -0,0 +1,195 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include "os/mynewt.h"
+#include "console/console.h"
+#include "tinycbor/cbor.h"
+#include "tinycbor/cbor_buf_writer.h"
+#include "tinycbor/cbor_mbuf_reader.h"
+#include "os_bench.h"
+
+/*
+ * Measures how long it takes to decode a CBOR map, similar to an SMP
+ * request, from an mbuf chain split into 1, 8 and 64 fragments.
+ */
+
+#define CBOR_BENCH_NUM_KEYS     (40)
+#define CBOR_BENCH_DATA_LEN     (256)
+#define CBOR_BENCH_BUF_SZ       (640)
+#define CBOR_BENCH_MAX_FRAGS    (64)
+#define CBOR_BENCH_ITERS        (200)
+
+#define CBOR_BENCH_MBUF_BLOCK_SZ                                    \
+    (CBOR_BENCH_BUF_SZ + sizeof(struct os_mbuf) +                   \
+     sizeof(struct os_mbuf_pkthdr))
+#define CBOR_BENCH_MBUF_COUNT   (CBOR_BENCH_MAX_FRAGS + 2)
+
+static os_membuf_t cbor_bench_mbuf_buf[
+    OS_MEMPOOL_SIZE(CBOR_BENCH_MBUF_COUNT, CBOR_BENCH_MBUF_BLOCK_SZ)];
+static struct os_mempool cbor_bench_mempool;
+static struct os_mbuf_pool cbor_bench_mbuf_pool;
+
+static uint8_t cbor_bench_buf[CBOR_BENCH_BUF_SZ];
+static uint8_t cbor_bench_data[CBOR_BENCH_DATA_LEN];
+
+static int
+cbor_bench_encode(void)
+{
+    struct cbor_buf_writer writer;
+    CborEncoder encoder;
+    CborEncoder map;
+    char key[8];
+    int rc;
+    int i;
+
+    cbor_buf_writer_init(&writer, cbor_bench_buf, sizeof(cbor_bench_buf));
+    cbor_encoder_init(&encoder, &writer.enc, 0);
+
+    rc = cbor_encoder_create_map(&encoder, &map, CborIndefiniteLength);
+    for (i = 0; i < CBOR_BENCH_NUM_KEYS; i++) {
+        snprintf(key, sizeof(key), "k%02d", i);
+        rc |= cbor_encode_text_stringz(&map, key);
+        rc |= cbor_encode_uint(&map, i * 1000);
+    }
+    memset(cbor_bench_data, 0xa5, sizeof(cbor_bench_data));
+    rc |= cbor_encode_text_stringz(&map, "data");
+    rc |= cbor_encode_byte_string(&map, cbor_bench_data,
+                                  sizeof(cbor_bench_data));
+    rc |= cbor_encoder_close_container(&encoder, &map);
+    assert(rc == 0);
+
+    return cbor_buf_writer_buffer_size(&writer, cbor_bench_buf);
+}
+
+static struct os_mbuf *
+cbor_bench_chain(int len, int num_frags)
+{
+    struct os_mbuf *head;
+    struct os_mbuf *om;
+    int frag_len;
+    int off;
+    int rc;
+
+    head = os_mbuf_get_pkthdr(&cbor_bench_mbuf_pool, 0);
+    assert(head != NULL);
+
+    for (off = 0; off < len; off += frag_len) {
+        frag_len = (len + num_frags - 1) / num_frags;
+        if (frag_len > len - off) {
+            frag_len = len - off;
+        }
+
+        if (off == 0) {
+            om = head;
+        } else {
+            om = os_mbuf_get(&cbor_bench_mbuf_pool, 0);
+            assert(om != NULL);
+            os_mbuf_concat(head, om);
+        }
+        rc = os_mbuf_append(om, cbor_bench_buf + off, frag_len);
+        assert(rc == 0);
+        if (om != head) {
+            OS_MBUF_PKTHDR(head)->omp_len += frag_len;
+        }
+    }
+
+    return head;
+}
+
+static int
+cbor_bench_decode(struct os_mbuf *om)
+{
+    static uint8_t data[CBOR_BENCH_DATA_LEN];
+    struct cbor_mbuf_reader reader;
+    bool is_data;
+    CborParser parser;
+    CborValue value;
+    CborValue map;
+    size_t len;
+    int sum;
+    int val;
+    int rc;
+
+    cbor_mbuf_reader_init(&reader, om, 0);
+    rc = cbor_parser_init(&reader.r, 0, &parser, &value);
+    rc |= cbor_value_enter_container(&value, &map);
+
+    sum = 0;
+    while (rc == 0 && !cbor_value_at_end(&map)) {
+        rc |= cbor_value_text_string_equals(&map, "data", &is_data);
+        if (is_data) {
+            rc |= cbor_value_advance(&map);
+            len = sizeof(data);
+            rc |= cbor_value_copy_byte_string(&map, data, &len, NULL);
+        } else {
+            rc |= cbor_value_advance(&map);
+            rc |= cbor_value_get_int(&map, &val);
+            sum += val;
+        }
+        rc |= cbor_value_advance(&map);
+    }
+    assert(rc == 0);
+
+    return sum;
+}
+
+void
+cbor_bench_run(void)
+{
+    static const int frags[] = { 1, 8, 64 };
+    struct os_mbuf *om;
+    uint64_t start;
+    uint64_t dur;
+    int len;
+    int sum;
+    int rc;
+    int i;
+    int j;
+
+    rc = os_mempool_init(&cbor_bench_mempool, CBOR_BENCH_MBUF_COUNT,
+                         CBOR_BENCH_MBUF_BLOCK_SZ, cbor_bench_mbuf_buf,
+                         "cbor_bench");
+    assert(rc == 0);
+    rc = os_mbuf_pool_init(&cbor_bench_mbuf_pool, &cbor_bench_mempool,
+                           CBOR_BENCH_MBUF_BLOCK_SZ, CBOR_BENCH_MBUF_COUNT);
+    assert(rc == 0);
+
+    len = cbor_bench_encode();
+    console_printf("cbor: decode %d byte map from mbuf chain\n", len);
+
+    for (i = 0; i < sizeof(frags) / sizeof(frags[0]); i++) {
+        om = cbor_bench_chain(len, frags[i]);
+
+        start = os_bench_time_ns();
+        for (j = 0; j < CBOR_BENCH_ITERS; j++) {
+            sum = cbor_bench_decode(om);
+            assert(sum == 1000 * CBOR_BENCH_NUM_KEYS *
+                          (CBOR_BENCH_NUM_KEYS - 1) / 2);
+        }
+        dur = os_bench_time_ns() - start;
+
+        console_printf("  %2d fragments: avg %6lu ns\n", frags[i],
+                       (unsigned long)(dur / CBOR_BENCH_ITERS));
+        os_mbuf_free_chain(om);
+    }
+}
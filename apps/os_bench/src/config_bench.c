@@ -0,0 +1,135 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(OS_BENCH_CONFIG)
+
+#include "console/console.h"
+#include "flash_map/flash_map.h"
+#include "config/config.h"
+#include "config/config_fcb.h"
+#include "os_bench.h"
+
+/*
+ * Measures boot time config loading, duplicate checking saves and single
+ * value lookups with a config FCB holding a few hundred settings, each
+ * stored several times.  The FCB is placed in the first 64kB of the
+ * simulated flash.
+ */
+
+#define CONFIG_BENCH_NUM_SETTINGS   (400)
+#define CONFIG_BENCH_GENERATIONS    (3)
+#define CONFIG_BENCH_NUM_AREAS      (4)
+
+static struct flash_area config_bench_areas[CONFIG_BENCH_NUM_AREAS];
+static struct conf_fcb config_bench_fcb;
+
+static void
+config_bench_name(char *name, int len, int i)
+{
+    snprintf(name, len, "bench/setting%03d", i);
+}
+
+static void
+config_bench_mount(void)
+{
+    int rc;
+
+    config_bench_fcb.cf_fcb.f_magic = MYNEWT_VAL(CONFIG_FCB_MAGIC);
+    config_bench_fcb.cf_fcb.f_sectors = config_bench_areas;
+    config_bench_fcb.cf_fcb.f_sector_cnt = CONFIG_BENCH_NUM_AREAS;
+
+    rc = conf_fcb_src(&config_bench_fcb);
+    assert(rc == 0);
+    rc = conf_fcb_dst(&config_bench_fcb);
+    assert(rc == 0);
+}
+
+void
+config_bench_run(void)
+{
+    char name[32];
+    char val[16];
+    uint64_t start;
+    uint64_t dur;
+    int rc;
+    int g;
+    int i;
+
+    for (i = 0; i < CONFIG_BENCH_NUM_AREAS; i++) {
+        config_bench_areas[i].fa_device_id = 0;
+        config_bench_areas[i].fa_off = i * 16 * 1024;
+        config_bench_areas[i].fa_size = 16 * 1024;
+        rc = flash_area_erase(&config_bench_areas[i], 0, 16 * 1024);
+        assert(rc == 0);
+    }
+    config_bench_mount();
+
+    for (g = 0; g < CONFIG_BENCH_GENERATIONS; g++) {
+        for (i = 0; i < CONFIG_BENCH_NUM_SETTINGS; i++) {
+            config_bench_name(name, sizeof(name), i);
+            snprintf(val, sizeof(val), "%d", g * 1000 + i);
+            rc = conf_save_one(name, val);
+            assert(rc == 0);
+        }
+    }
+
+    console_printf("config: %d settings x %d generations, index %s\n",
+                   CONFIG_BENCH_NUM_SETTINGS, CONFIG_BENCH_GENERATIONS,
+                   MYNEWT_VAL(CONFIG_FCB_INDEX) ? "on" : "off");
+
+    /* Forget the registered sources, as a reboot would. */
+    conf_store_init();
+
+    start = os_bench_time_ns();
+    config_bench_mount();
+    rc = conf_load();
+    dur = os_bench_time_ns() - start;
+    assert(rc == 0);
+    console_printf("  boot load        : %8lu us\n",
+                   (unsigned long)(dur / 1000));
+
+    start = os_bench_time_ns();
+    for (i = 0; i < CONFIG_BENCH_NUM_SETTINGS; i++) {
+        config_bench_name(name, sizeof(name), i);
+        snprintf(val, sizeof(val), "%d",
+                 (CONFIG_BENCH_GENERATIONS - 1) * 1000 + i);
+        rc = conf_save_one(name, val);
+        assert(rc == 0);
+    }
+    dur = os_bench_time_ns() - start;
+    console_printf("  save (duplicate) : %8lu ns avg\n",
+                   (unsigned long)(dur / CONFIG_BENCH_NUM_SETTINGS));
+
+    start = os_bench_time_ns();
+    for (i = 0; i < CONFIG_BENCH_NUM_SETTINGS; i++) {
+        config_bench_name(name, sizeof(name), i);
+        rc = conf_get_stored_value(name, val, sizeof(val));
+        assert(rc == 0);
+        assert(atoi(val) == (CONFIG_BENCH_GENERATIONS - 1) * 1000 + i);
+    }
+    dur = os_bench_time_ns() - start;
+    console_printf("  stored lookup    : %8lu ns avg\n",
+                   (unsigned long)(dur / CONFIG_BENCH_NUM_SETTINGS));
+}
+
+#endif
@@ -0,0 +1,108 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#include <stdlib.h>
+#include "os/mynewt.h"
+#include "console/console.h"
+#include "crc/crc8.h"
+#include "crc/crc16.h"
+#include "crc/crc32.h"
+#include "crc/adler32.h"
+#include "os_bench.h"
+
+/*
+ * Measures the throughput of the checksums in util/crc over a RAM buffer.
+ */
+
+#define CRC_BENCH_BUF_SZ    (4096)
+#define CRC_BENCH_ITERS     (256)
+
+#if MYNEWT_VAL_CHOICE(UTIL_CRC_CRC32_METHOD, slice8)
+#define CRC_BENCH_CRC32_METHOD  "slice8"
+#elif MYNEWT_VAL_CHOICE(UTIL_CRC_CRC32_METHOD, slice4)
+#define CRC_BENCH_CRC32_METHOD  "slice4"
+#elif MYNEWT_VAL_CHOICE(UTIL_CRC_CRC32_METHOD, table)
+#define CRC_BENCH_CRC32_METHOD  "table"
+#else
+#define CRC_BENCH_CRC32_METHOD  "bitwise"
+#endif
+
+static uint8_t crc_bench_buf[CRC_BENCH_BUF_SZ];
+
+/* Keeps the compiler from discarding the results. */
+static volatile uint32_t crc_bench_sink;
+
+static void
+crc_bench_report(const char *name, uint64_t dur)
+{
+    uint64_t tenths;
+
+    /* 10 * bytes per microsecond is MB/s with one decimal. */
+    tenths = (uint64_t)CRC_BENCH_BUF_SZ * CRC_BENCH_ITERS * 10000 / dur;
+    console_printf("  %-8s: %4lu.%lu MB/s\n", name,
+                   (unsigned long)(tenths / 10), (unsigned long)(tenths % 10));
+}
+
+void
+crc_bench_run(void)
+{
+    uint64_t start;
+    uint32_t val;
+    int i;
+
+    for (i = 0; i < CRC_BENCH_BUF_SZ; i++) {
+        crc_bench_buf[i] = rand();
+    }
+
+    console_printf("crc: %d byte buffer, crc32 method %s\n",
+                   CRC_BENCH_BUF_SZ, CRC_BENCH_CRC32_METHOD);
+
+    start = os_bench_time_ns();
+    val = crc8_init();
+    for (i = 0; i < CRC_BENCH_ITERS; i++) {
+        val = crc8_calc(val, crc_bench_buf, CRC_BENCH_BUF_SZ);
+    }
+    crc_bench_sink = val;
+    crc_bench_report("crc8", os_bench_time_ns() - start);
+
+    start = os_bench_time_ns();
+    val = CRC16_INITIAL_CRC;
+    for (i = 0; i < CRC_BENCH_ITERS; i++) {
+        val = crc16_ccitt(val, crc_bench_buf, CRC_BENCH_BUF_SZ);
+    }
+    crc_bench_sink = val;
+    crc_bench_report("crc16", os_bench_time_ns() - start);
+
+    start = os_bench_time_ns();
+    val = crc32_init();
+    for (i = 0; i < CRC_BENCH_ITERS; i++) {
+        val = crc32_calc(val, crc_bench_buf, CRC_BENCH_BUF_SZ);
+    }
+    crc_bench_sink = val;
+    crc_bench_report("crc32", os_bench_time_ns() - start);
+
+    start = os_bench_time_ns();
+    val = adler32_init();
+    for (i = 0; i < CRC_BENCH_ITERS; i++) {
+        val = adler32_calc(val, crc_bench_buf, CRC_BENCH_BUF_SZ);
+    }
+    crc_bench_sink = val;
+    crc_bench_report("adler32", os_bench_time_ns() - start);
+}
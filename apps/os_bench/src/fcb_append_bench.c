@@ -0,0 +1,139 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <assert.h>
+#include <string.h>
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(OS_BENCH_FCB_APPEND)
+
+#include "console/console.h"
+#include "flash_map/flash_map.h"
+#include "fcb/fcb.h"
+#include "os_bench.h"
+
+/*
+ * Measures appending small entries to an FCB with and without a page
+ * sized write buffer.  Uses the first 64kB of the simulated flash.
+ */
+
+#define FCB_APPEND_BENCH_AREA_SZ    (64 * 1024)
+#define FCB_APPEND_BENCH_ROUNDS     (10)
+
+static struct flash_area fcb_append_bench_area = {
+    .fa_device_id = 0,
+    .fa_off = 0,
+    .fa_size = FCB_APPEND_BENCH_AREA_SZ,
+};
+static struct fcb fcb_append_bench_fcb;
+static uint8_t fcb_append_bench_wbuf[256];
+static uint8_t fcb_append_bench_data[128];
+
+/*
+ * Fills the sector with entries of the given size and returns the time
+ * per entry, including the final flush.
+ */
+static uint64_t
+fcb_append_bench_fill(int entry_len, bool buffered)
+{
+    struct fcb_entry loc;
+    struct fcb *fcb;
+    uint64_t start;
+    uint64_t dur;
+    int cnt;
+    int rc;
+
+    rc = flash_area_erase(&fcb_append_bench_area, 0,
+                          FCB_APPEND_BENCH_AREA_SZ);
+    assert(rc == 0);
+
+    fcb = &fcb_append_bench_fcb;
+    memset(fcb, 0, sizeof(*fcb));
+    fcb->f_magic = 0x42454e43;
+    fcb->f_sectors = &fcb_append_bench_area;
+    fcb->f_sector_cnt = 1;
+    if (buffered) {
+        fcb->f_wbuf = fcb_append_bench_wbuf;
+        fcb->f_wbuf_size = sizeof(fcb_append_bench_wbuf);
+    }
+    rc = fcb_init(fcb);
+    assert(rc == 0);
+
+    start = os_bench_time_ns();
+    for (cnt = 0; ; cnt++) {
+        rc = fcb_append(fcb, entry_len, &loc);
+        if (rc == FCB_ERR_NOSPACE) {
+            break;
+        }
+        assert(rc == 0);
+        rc = fcb_write(fcb, &loc, fcb_append_bench_data, entry_len);
+        assert(rc == 0);
+        rc = fcb_append_finish(fcb, &loc);
+        assert(rc == 0);
+    }
+    rc = fcb_flush(fcb);
+    assert(rc == 0);
+    dur = os_bench_time_ns() - start;
+
+    return dur / cnt;
+}
+
+static uint64_t
+fcb_append_bench_measure(int entry_len, bool buffered)
+{
+    uint64_t best;
+    uint64_t dur;
+    int round;
+
+    best = UINT64_MAX;
+    for (round = 0; round < FCB_APPEND_BENCH_ROUNDS; round++) {
+        dur = fcb_append_bench_fill(entry_len, buffered);
+        if (dur < best) {
+            best = dur;
+        }
+    }
+
+    return best;
+}
+
+void
+fcb_append_bench_run(void)
+{
+    static const int lens[] = { 8, 32, 128 };
+    uint64_t direct;
+    uint64_t buffered;
+    int i;
+
+    for (i = 0; i < sizeof(fcb_append_bench_data); i++) {
+        fcb_append_bench_data[i] = i;
+    }
+
+    console_printf("fcb_append: %d byte write buffer\n",
+                   (int)sizeof(fcb_append_bench_wbuf));
+
+    for (i = 0; i < sizeof(lens) / sizeof(lens[0]); i++) {
+        direct = fcb_append_bench_measure(lens[i], false);
+        buffered = fcb_append_bench_measure(lens[i], true);
+
+        console_printf("  %3d byte entries: direct %6lu ns, "
+                       "buffered %6lu ns\n", lens[i],
+                       (unsigned long)direct, (unsigned long)buffered);
+    }
+}
+
+#endif
@@ -0,0 +1,135 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <assert.h>
+#include <string.h>
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(OS_BENCH_FCB_MOUNT)
+
+#include "console/console.h"
+#include "flash_map/flash_map.h"
+#include "fcb/fcb.h"
+#include "os_bench.h"
+
+/*
+ * Measures fcb_init() on a single 64kB sector, as used by log FCBs,
+ * filled with entries of various sizes.  Uses the first 64kB of the
+ * simulated flash.
+ */
+
+#define FCB_MOUNT_BENCH_AREA_SZ     (64 * 1024)
+#define FCB_MOUNT_BENCH_ROUNDS      (20)
+
+static struct flash_area fcb_mount_bench_area = {
+    .fa_device_id = 0,
+    .fa_off = 0,
+    .fa_size = FCB_MOUNT_BENCH_AREA_SZ,
+};
+static struct fcb fcb_mount_bench_fcb;
+static uint8_t fcb_mount_bench_data[256];
+
+static void
+fcb_mount_bench_init(void)
+{
+    struct fcb *fcb;
+    int rc;
+
+    fcb = &fcb_mount_bench_fcb;
+    memset(fcb, 0, sizeof(*fcb));
+    fcb->f_magic = 0x42454e43;
+    fcb->f_sectors = &fcb_mount_bench_area;
+    fcb->f_sector_cnt = 1;
+
+    rc = fcb_init(fcb);
+    assert(rc == 0);
+}
+
+/*
+ * Fills the sector with entries of the given size and returns the number
+ * of entries written.
+ */
+static int
+fcb_mount_bench_fill(int entry_len)
+{
+    struct fcb_entry loc;
+    int cnt;
+    int rc;
+
+    rc = flash_area_erase(&fcb_mount_bench_area, 0, FCB_MOUNT_BENCH_AREA_SZ);
+    assert(rc == 0);
+    fcb_mount_bench_init();
+
+    for (cnt = 0; ; cnt++) {
+        rc = fcb_append(&fcb_mount_bench_fcb, entry_len, &loc);
+        if (rc == FCB_ERR_NOSPACE) {
+            break;
+        }
+        assert(rc == 0);
+        rc = flash_area_write(loc.fe_area, loc.fe_data_off,
+                              fcb_mount_bench_data, entry_len);
+        assert(rc == 0);
+        rc = fcb_append_finish(&fcb_mount_bench_fcb, &loc);
+        assert(rc == 0);
+    }
+
+    return cnt;
+}
+
+void
+fcb_mount_bench_run(void)
+{
+    static const int lens[] = { 8, 32, 128 };
+    struct fcb_entry active;
+    uint64_t start;
+    uint64_t best;
+    uint64_t dur;
+    int round;
+    int cnt;
+    int i;
+
+    for (i = 0; i < sizeof(fcb_mount_bench_data); i++) {
+        fcb_mount_bench_data[i] = i;
+    }
+
+    console_printf("fcb_mount: %d kB sector, fast mount %s\n",
+                   FCB_MOUNT_BENCH_AREA_SZ / 1024,
+                   MYNEWT_VAL(FCB_FAST_MOUNT) ? "on" : "off");
+
+    for (i = 0; i < sizeof(lens) / sizeof(lens[0]); i++) {
+        cnt = fcb_mount_bench_fill(lens[i]);
+        active = fcb_mount_bench_fcb.f_active;
+
+        best = UINT64_MAX;
+        for (round = 0; round < FCB_MOUNT_BENCH_ROUNDS; round++) {
+            start = os_bench_time_ns();
+            fcb_mount_bench_init();
+            dur = os_bench_time_ns() - start;
+            if (dur < best) {
+                best = dur;
+            }
+        }
+        assert(fcb_mount_bench_fcb.f_active.fe_elem_off == active.fe_elem_off);
+        assert(fcb_mount_bench_fcb.f_active_sector_entry_count == cnt);
+
+        console_printf("  %3d byte entries (%5d): %8lu us\n",
+                       lens[i], cnt, (unsigned long)(best / 1000));
+    }
+}
+
+#endif
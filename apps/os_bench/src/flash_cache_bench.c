@@ -0,0 +1,201 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <assert.h>
+#include <string.h>
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(OS_BENCH_FLASH_CACHE)
+
+#include "console/console.h"
+#include "flash_map/flash_map.h"
+#include "hal/hal_flash.h"
+#include "mcu/mcu_sim.h"
+#include "fcb/fcb.h"
+#include "os_bench.h"
+
+/*
+ * Measures mounting and walking an FCB with and without the hal_flash read
+ * cache, with every flash read delayed as on an external SPI flash.  Uses
+ * the first 64kB of the simulated flash.
+ */
+
+#define FLASH_CACHE_BENCH_AREA_SZ   (64 * 1024)
+#define FLASH_CACHE_BENCH_ROUNDS    (5)
+#define FLASH_CACHE_BENCH_ENTRY_SZ  (32)
+#define FLASH_CACHE_BENCH_LATENCY   (10)
+
+static struct flash_area flash_cache_bench_area = {
+    .fa_device_id = 0,
+    .fa_off = 0,
+    .fa_size = FLASH_CACHE_BENCH_AREA_SZ,
+};
+static struct fcb flash_cache_bench_fcb;
+static uint8_t flash_cache_bench_data[FLASH_CACHE_BENCH_ENTRY_SZ];
+
+static void
+flash_cache_bench_init(void)
+{
+    struct fcb *fcb;
+    int rc;
+
+    fcb = &flash_cache_bench_fcb;
+    memset(fcb, 0, sizeof(*fcb));
+    fcb->f_magic = 0x42454e43;
+    fcb->f_sectors = &flash_cache_bench_area;
+    fcb->f_sector_cnt = 1;
+
+    rc = fcb_init(fcb);
+    assert(rc == 0);
+}
+
+static int
+flash_cache_bench_fill(void)
+{
+    struct fcb_entry loc;
+    int cnt;
+    int rc;
+
+    rc = flash_area_erase(&flash_cache_bench_area, 0,
+                          FLASH_CACHE_BENCH_AREA_SZ);
+    assert(rc == 0);
+    flash_cache_bench_init();
+
+    for (cnt = 0; ; cnt++) {
+        rc = fcb_append(&flash_cache_bench_fcb, FLASH_CACHE_BENCH_ENTRY_SZ,
+                        &loc);
+        if (rc == FCB_ERR_NOSPACE) {
+            break;
+        }
+        assert(rc == 0);
+        rc = flash_area_write(loc.fe_area, loc.fe_data_off,
+                              flash_cache_bench_data,
+                              FLASH_CACHE_BENCH_ENTRY_SZ);
+        assert(rc == 0);
+        rc = fcb_append_finish(&flash_cache_bench_fcb, &loc);
+        assert(rc == 0);
+    }
+
+    return cnt;
+}
+
+/*
+ * Reads every entry back, as a log reader would.
+ */
+static int
+flash_cache_bench_walk_cb(struct fcb_entry *loc, void *arg)
+{
+    uint8_t buf[FLASH_CACHE_BENCH_ENTRY_SZ];
+    int *cnt;
+    int rc;
+
+    rc = flash_area_read(loc->fe_area, loc->fe_data_off, buf,
+                         loc->fe_data_len);
+    assert(rc == 0);
+
+    cnt = arg;
+    (*cnt)++;
+    return 0;
+}
+
+static void
+flash_cache_bench_one(int cached, int entry_cnt)
+{
+    struct hal_flash_cache_stats stats;
+    uint64_t mount_best;
+    uint64_t walk_best;
+    uint64_t start;
+    uint64_t dur;
+    int round;
+    int cnt;
+    int rc;
+
+    hal_flash_cache_enable(flash_cache_bench_area.fa_device_id, cached);
+    hal_flash_cache_stats_clear();
+
+    mount_best = UINT64_MAX;
+    walk_best = UINT64_MAX;
+    for (round = 0; round < FLASH_CACHE_BENCH_ROUNDS; round++) {
+        hal_flash_cache_invalidate(flash_cache_bench_area.fa_device_id);
+
+        start = os_bench_time_ns();
+        flash_cache_bench_init();
+        dur = os_bench_time_ns() - start;
+        if (dur < mount_best) {
+            mount_best = dur;
+        }
+
+        cnt = 0;
+        start = os_bench_time_ns();
+        rc = fcb_walk(&flash_cache_bench_fcb, NULL,
+                      flash_cache_bench_walk_cb, &cnt);
+        dur = os_bench_time_ns() - start;
+        assert(rc == 0);
+        assert(cnt == entry_cnt);
+        if (dur < walk_best) {
+            walk_best = dur;
+        }
+    }
+    hal_flash_cache_stats_get(&stats);
+
+    console_printf("  cache %-3s: mount %8lu us, walk %8lu us\n",
+                   cached ? "on" : "off",
+                   (unsigned long)(mount_best / 1000),
+                   (unsigned long)(walk_best / 1000));
+    if (cached) {
+        console_printf("             hits %lu misses %lu prefetches %lu "
+                       "bypasses %lu\n",
+                       (unsigned long)stats.hfcs_hits,
+                       (unsigned long)stats.hfcs_misses,
+                       (unsigned long)stats.hfcs_prefetches,
+                       (unsigned long)stats.hfcs_bypasses);
+    }
+}
+
+void
+flash_cache_bench_run(void)
+{
+    uint32_t latency;
+    int cnt;
+    int i;
+
+    for (i = 0; i < sizeof(flash_cache_bench_data); i++) {
+        flash_cache_bench_data[i] = i;
+    }
+
+    cnt = flash_cache_bench_fill();
+
+    latency = native_flash_read_latency_us;
+    native_flash_read_latency_us = FLASH_CACHE_BENCH_LATENCY;
+
+    console_printf("flash_cache: %d byte entries (%d), %d us per read, "
+                   "%d x %d byte lines\n",
+                   FLASH_CACHE_BENCH_ENTRY_SZ, cnt, FLASH_CACHE_BENCH_LATENCY,
+                   MYNEWT_VAL(HAL_FLASH_READ_CACHE_LINES),
+                   MYNEWT_VAL(HAL_FLASH_READ_CACHE_LINE_SIZE));
+
+    flash_cache_bench_one(0, cnt);
+    flash_cache_bench_one(1, cnt);
+
+    native_flash_read_latency_us = latency;
+    hal_flash_cache_enable(flash_cache_bench_area.fa_device_id,
+        !!(MYNEWT_VAL(HAL_FLASH_READ_CACHE_DEVICES) &
+           (1UL << flash_cache_bench_area.fa_device_id)));
+}
+
+#endif
@@ -0,0 +1,105 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#include "os/mynewt.h"
+#include "console/console.h"
+#include "os_bench.h"
+
+#if MYNEWT_VAL(BSP_SIMULATED)
+#include <time.h>
+#endif
+
+uint64_t
+os_bench_time_ns(void)
+{
+#if MYNEWT_VAL(BSP_SIMULATED)
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#else
+    return (uint64_t)os_cputime_ticks_to_usecs(os_cputime_get32()) * 1000;
+#endif
+}
+
+int
+mynewt_main(int argc, char **argv)
+{
+    sysinit();
+
+    console_printf("os_bench running on %s\n", MYNEWT_VAL(BSP_NAME));
+
+#if MYNEWT_VAL(OS_BENCH_SCHED)
+    sched_bench_run();
+#endif
+#if MYNEWT_VAL(OS_BENCH_CALLOUT)
+    callout_bench_run();
+#endif
+#if MYNEWT_VAL(OS_BENCH_SLEEP)
+    sleep_bench_run();
+#endif
+#if MYNEWT_VAL(OS_BENCH_MEMPOOL)
+    mempool_bench_run();
+#endif
+#if MYNEWT_VAL(OS_BENCH_CRC)
+    crc_bench_run();
+#endif
+#if MYNEWT_VAL(OS_BENCH_CBOR)
+    cbor_bench_run();
+#endif
+#if MYNEWT_VAL(OS_BENCH_CONFIG)
+    config_bench_run();
+#endif
+#if MYNEWT_VAL(OS_BENCH_MBUF_IO)
+    mbuf_io_bench_run();
+#endif
+#if MYNEWT_VAL(OS_BENCH_MBUF_FREE)
+    mbuf_free_bench_run();
+#endif
+#if MYNEWT_VAL(OS_BENCH_FCB_MOUNT)
+    fcb_mount_bench_run();
+#endif
+#if MYNEWT_VAL(OS_BENCH_FCB_APPEND)
+    fcb_append_bench_run();
+#endif
+#if MYNEWT_VAL(OS_BENCH_FLASH_CACHE)
+    flash_cache_bench_run();
+#endif
+#if MYNEWT_VAL(OS_BENCH_NFFS)
+    nffs_bench_run();
+#endif
+#if MYNEWT_VAL(OS_BENCH_NET_ECHO)
+    net_echo_bench_run();
+#endif
+#if MYNEWT_VAL(OS_BENCH_OIC)
+    oic_bench_run();
+#endif
+#if MYNEWT_VAL(OS_BENCH_SENSOR)
+    sensor_bench_run();
+#endif
+
+    console_printf("os_bench done\n");
+
+    while (1) {
+        os_eventq_run(os_eventq_dflt_get());
+    }
+
+    return 0;
+}
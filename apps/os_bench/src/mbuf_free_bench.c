@@ -0,0 +1,126 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <assert.h>
+#include "os/mynewt.h"
+#include "console/console.h"
+#include "os_bench.h"
+
+/*
+ * Measures the cost of freeing mbuf chains of 1, 8 and 32 segments, as
+ * received BLE or IP packets are, one segment at a time with os_mbuf_free()
+ * versus with os_mbuf_free_chain(), which returns each run of segments to
+ * the pool in one critical section.  The fastest of many runs is reported,
+ * to filter out host scheduling noise.
+ */
+
+#define MBUF_FREE_BENCH_MAX_SEGS    (32)
+#define MBUF_FREE_BENCH_ITERS       (2000)
+#define MBUF_FREE_BENCH_BLOCK_SZ    (64 + sizeof(struct os_mbuf))
+
+static os_membuf_t mbuf_free_bench_buf[
+    OS_MEMPOOL_SIZE(MBUF_FREE_BENCH_MAX_SEGS, MBUF_FREE_BENCH_BLOCK_SZ)];
+static struct os_mempool mbuf_free_bench_mempool;
+static struct os_mbuf_pool mbuf_free_bench_mbuf_pool;
+
+static struct os_mbuf *
+mbuf_free_bench_chain(int num_segs)
+{
+    struct os_mbuf *head;
+    struct os_mbuf *om;
+    int i;
+
+    head = os_mbuf_get(&mbuf_free_bench_mbuf_pool, 0);
+    assert(head != NULL);
+    for (i = 1; i < num_segs; i++) {
+        om = os_mbuf_get(&mbuf_free_bench_mbuf_pool, 0);
+        assert(om != NULL);
+        os_mbuf_concat(head, om);
+    }
+
+    return head;
+}
+
+static void
+mbuf_free_bench_segs(struct os_mbuf *om)
+{
+    struct os_mbuf *next;
+
+    while (om != NULL) {
+        next = SLIST_NEXT(om, om_next);
+        os_mbuf_free(om);
+        om = next;
+    }
+}
+
+static uint64_t
+mbuf_free_bench_measure(int num_segs, int use_chain)
+{
+    struct os_mbuf *om;
+    uint64_t start;
+    uint64_t best;
+    uint64_t dur;
+    int i;
+
+    best = UINT64_MAX;
+    for (i = 0; i < MBUF_FREE_BENCH_ITERS; i++) {
+        om = mbuf_free_bench_chain(num_segs);
+
+        start = os_bench_time_ns();
+        if (use_chain) {
+            os_mbuf_free_chain(om);
+        } else {
+            mbuf_free_bench_segs(om);
+        }
+        dur = os_bench_time_ns() - start;
+        if (dur < best) {
+            best = dur;
+        }
+    }
+    assert(mbuf_free_bench_mempool.mp_num_free == MBUF_FREE_BENCH_MAX_SEGS);
+
+    return best;
+}
+
+void
+mbuf_free_bench_run(void)
+{
+    static const int segs[] = { 1, 8, 32 };
+    uint64_t single;
+    uint64_t chain;
+    int rc;
+    int i;
+
+    rc = os_mempool_init(&mbuf_free_bench_mempool, MBUF_FREE_BENCH_MAX_SEGS,
+                         MBUF_FREE_BENCH_BLOCK_SZ, mbuf_free_bench_buf,
+                         "mbuf_free_bench");
+    assert(rc == 0);
+    rc = os_mbuf_pool_init(&mbuf_free_bench_mbuf_pool,
+                           &mbuf_free_bench_mempool, MBUF_FREE_BENCH_BLOCK_SZ,
+                           MBUF_FREE_BENCH_MAX_SEGS);
+    assert(rc == 0);
+
+    console_printf("mbuf_free: free an mbuf chain\n");
+    for (i = 0; i < sizeof(segs) / sizeof(segs[0]); i++) {
+        single = mbuf_free_bench_measure(segs[i], 0);
+        chain = mbuf_free_bench_measure(segs[i], 1);
+        console_printf("  %2d segments: per segment %6lu ns, "
+                       "free_chain %6lu ns\n", segs[i],
+                       (unsigned long)single, (unsigned long)chain);
+    }
+}
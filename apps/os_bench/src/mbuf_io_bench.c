@@ -0,0 +1,204 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <assert.h>
+#include <string.h>
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(OS_BENCH_MBUF_IO)
+
+#include "console/console.h"
+#include "flash_map/flash_map.h"
+#include "os_bench.h"
+
+/*
+ * Measures how fast a fragmented mbuf chain, such as a log entry or an SMP
+ * response, can be written to flash: flattened into a scratch buffer first,
+ * versus handed over segment by segment with flash_area_writev().  Uses the
+ * first 64kB of the simulated flash.
+ */
+
+#define MBUF_IO_BENCH_MSG_LEN       (1024)
+#define MBUF_IO_BENCH_MAX_FRAGS     (16)
+#define MBUF_IO_BENCH_ROUNDS        (50)
+#define MBUF_IO_BENCH_AREA_SZ       (64 * 1024)
+
+#define MBUF_IO_BENCH_MBUF_BLOCK_SZ                                 \
+    (MBUF_IO_BENCH_MSG_LEN + sizeof(struct os_mbuf) +               \
+     sizeof(struct os_mbuf_pkthdr))
+#define MBUF_IO_BENCH_MBUF_COUNT    (MBUF_IO_BENCH_MAX_FRAGS + 1)
+
+static os_membuf_t mbuf_io_bench_mbuf_buf[
+    OS_MEMPOOL_SIZE(MBUF_IO_BENCH_MBUF_COUNT, MBUF_IO_BENCH_MBUF_BLOCK_SZ)];
+static struct os_mempool mbuf_io_bench_mempool;
+static struct os_mbuf_pool mbuf_io_bench_mbuf_pool;
+
+static const struct flash_area mbuf_io_bench_area = {
+    .fa_device_id = 0,
+    .fa_off = 0,
+    .fa_size = MBUF_IO_BENCH_AREA_SZ,
+};
+
+static uint8_t mbuf_io_bench_data[MBUF_IO_BENCH_MSG_LEN];
+static uint8_t mbuf_io_bench_scratch[MBUF_IO_BENCH_MSG_LEN];
+
+static struct os_mbuf *
+mbuf_io_bench_chain(int num_frags)
+{
+    struct os_mbuf *head;
+    struct os_mbuf *om;
+    int frag_len;
+    int off;
+    int rc;
+
+    head = os_mbuf_get_pkthdr(&mbuf_io_bench_mbuf_pool, 0);
+    assert(head != NULL);
+
+    frag_len = MBUF_IO_BENCH_MSG_LEN / num_frags;
+    for (off = 0; off < MBUF_IO_BENCH_MSG_LEN; off += frag_len) {
+        if (off == 0) {
+            om = head;
+        } else {
+            om = os_mbuf_get(&mbuf_io_bench_mbuf_pool, 0);
+            assert(om != NULL);
+            os_mbuf_concat(head, om);
+        }
+        rc = os_mbuf_append(om, mbuf_io_bench_data + off, frag_len);
+        assert(rc == 0);
+        if (om != head) {
+            OS_MBUF_PKTHDR(head)->omp_len += frag_len;
+        }
+    }
+
+    return head;
+}
+
+static int
+mbuf_io_bench_write_flat(uint32_t off, const struct os_mbuf *om)
+{
+    int rc;
+
+    rc = os_mbuf_copydata(om, 0, MBUF_IO_BENCH_MSG_LEN,
+                          mbuf_io_bench_scratch);
+    assert(rc == 0);
+
+    return flash_area_write(&mbuf_io_bench_area, off, mbuf_io_bench_scratch,
+                            MBUF_IO_BENCH_MSG_LEN);
+}
+
+static int
+mbuf_io_bench_write_iov(uint32_t off, const struct os_mbuf *om)
+{
+    struct os_iovec iov[MBUF_IO_BENCH_MAX_FRAGS];
+    struct os_mbuf_iov_iter it;
+    int iov_cnt;
+    int rc;
+
+    rc = os_mbuf_iov_init(&it, om, 0, MBUF_IO_BENCH_MSG_LEN);
+    assert(rc == 0);
+    iov_cnt = os_mbuf_iov_fill(&it, iov, MBUF_IO_BENCH_MAX_FRAGS);
+    assert(os_mbuf_iov_done(&it));
+
+    return flash_area_writev(&mbuf_io_bench_area, off, iov, iov_cnt);
+}
+
+/*
+ * Fills the area with copies of the chain, once per round, and returns the
+ * time per message of the fastest round.  The erases between rounds are not
+ * timed, and taking the minimum filters out host scheduling noise.
+ */
+static uint64_t
+mbuf_io_bench_measure(const struct os_mbuf *om,
+                      int (*write_fn)(uint32_t, const struct os_mbuf *))
+{
+    uint64_t start;
+    uint64_t best;
+    uint64_t dur;
+    uint32_t off;
+    int round;
+    int rc;
+
+    best = UINT64_MAX;
+    for (round = 0; round < MBUF_IO_BENCH_ROUNDS; round++) {
+        rc = flash_area_erase(&mbuf_io_bench_area, 0, MBUF_IO_BENCH_AREA_SZ);
+        assert(rc == 0);
+
+        start = os_bench_time_ns();
+        for (off = 0; off < MBUF_IO_BENCH_AREA_SZ;
+             off += MBUF_IO_BENCH_MSG_LEN) {
+
+            rc = write_fn(off, om);
+            assert(rc == 0);
+        }
+        dur = os_bench_time_ns() - start;
+        if (dur < best) {
+            best = dur;
+        }
+    }
+
+    rc = flash_area_read(&mbuf_io_bench_area,
+                         MBUF_IO_BENCH_AREA_SZ - MBUF_IO_BENCH_MSG_LEN,
+                         mbuf_io_bench_scratch, MBUF_IO_BENCH_MSG_LEN);
+    assert(rc == 0);
+    assert(memcmp(mbuf_io_bench_scratch, mbuf_io_bench_data,
+                  MBUF_IO_BENCH_MSG_LEN) == 0);
+
+    return best / (MBUF_IO_BENCH_AREA_SZ / MBUF_IO_BENCH_MSG_LEN);
+}
+
+void
+mbuf_io_bench_run(void)
+{
+    static const int frags[] = { 1, 4, 16 };
+    struct os_mbuf *om;
+    uint64_t flat;
+    uint64_t iov;
+    int rc;
+    int i;
+
+    rc = os_mempool_init(&mbuf_io_bench_mempool, MBUF_IO_BENCH_MBUF_COUNT,
+                         MBUF_IO_BENCH_MBUF_BLOCK_SZ, mbuf_io_bench_mbuf_buf,
+                         "mbuf_io_bench");
+    assert(rc == 0);
+    rc = os_mbuf_pool_init(&mbuf_io_bench_mbuf_pool, &mbuf_io_bench_mempool,
+                           MBUF_IO_BENCH_MBUF_BLOCK_SZ,
+                           MBUF_IO_BENCH_MBUF_COUNT);
+    assert(rc == 0);
+
+    for (i = 0; i < MBUF_IO_BENCH_MSG_LEN; i++) {
+        mbuf_io_bench_data[i] = i;
+    }
+
+    console_printf("mbuf_io: write %d byte mbuf chain to flash (align %d)\n",
+                   MBUF_IO_BENCH_MSG_LEN,
+                   (int)flash_area_align(&mbuf_io_bench_area));
+
+    for (i = 0; i < sizeof(frags) / sizeof(frags[0]); i++) {
+        om = mbuf_io_bench_chain(frags[i]);
+
+        flat = mbuf_io_bench_measure(om, mbuf_io_bench_write_flat);
+        iov = mbuf_io_bench_measure(om, mbuf_io_bench_write_iov);
+
+        console_printf("  %2d fragments: flatten %6lu ns, writev %6lu ns\n",
+                       frags[i], (unsigned long)flat, (unsigned long)iov);
+        os_mbuf_free_chain(om);
+    }
+}
+
+#endif
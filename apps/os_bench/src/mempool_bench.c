@@ -0,0 +1,158 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#include <assert.h>
+#include "os/mynewt.h"
+#include "console/console.h"
+#include "os_bench.h"
+
+/*
+ * Several tasks allocate and free bursts of blocks from one shared memory
+ * pool, as the BLE host, the network stack and logging do with msys.  The
+ * benchmark reports the average cost of a get + put pair with and without
+ * per-task caches.  The simulator has a single CPU and the workers have
+ * different priorities, so they run one after another; what is measured is
+ * the critical section and cache lookup overhead as tasks share the pool.
+ */
+
+#define MEMPOOL_BENCH_MAX_TASKS     (4)
+#define MEMPOOL_BENCH_BLOCKS        (64)
+#define MEMPOOL_BENCH_BLOCK_SIZE    (64)
+#define MEMPOOL_BENCH_BURST         (8)
+#define MEMPOOL_BENCH_ITERS         (2000)
+#define MEMPOOL_BENCH_CACHE_SIZE    (16)
+#define MEMPOOL_BENCH_STACK_SIZE    (OS_STACK_ALIGN(512))
+
+struct mempool_bench_worker {
+    struct os_task task;
+    struct os_sem start;
+#if MYNEWT_VAL(OS_MEMPOOL_CACHE)
+    struct os_mempool_cache cache;
+#endif
+    os_stack_t stack[MEMPOOL_BENCH_STACK_SIZE];
+};
+
+static os_membuf_t mempool_bench_buf[
+    OS_MEMPOOL_SIZE(MEMPOOL_BENCH_BLOCKS, MEMPOOL_BENCH_BLOCK_SIZE)];
+static struct os_mempool mempool_bench_pool;
+static struct mempool_bench_worker
+    mempool_bench_workers[MEMPOOL_BENCH_MAX_TASKS];
+static struct os_sem mempool_bench_done;
+static int mempool_bench_use_cache;
+
+static void
+mempool_bench_worker_task(void *arg)
+{
+    struct mempool_bench_worker *w;
+    void *blocks[MEMPOOL_BENCH_BURST];
+    int i;
+    int j;
+
+    w = arg;
+
+    while (1) {
+        os_sem_pend(&w->start, OS_TIMEOUT_NEVER);
+
+#if MYNEWT_VAL(OS_MEMPOOL_CACHE)
+        if (mempool_bench_use_cache) {
+            os_mempool_cache_init(&w->cache, &mempool_bench_pool, &w->task,
+                                  MEMPOOL_BENCH_CACHE_SIZE);
+        }
+#endif
+
+        for (i = 0; i < MEMPOOL_BENCH_ITERS; i++) {
+            for (j = 0; j < MEMPOOL_BENCH_BURST; j++) {
+                blocks[j] = os_memblock_get(&mempool_bench_pool);
+                assert(blocks[j] != NULL);
+            }
+            for (j = 0; j < MEMPOOL_BENCH_BURST; j++) {
+                os_memblock_put(&mempool_bench_pool, blocks[j]);
+            }
+        }
+
+#if MYNEWT_VAL(OS_MEMPOOL_CACHE)
+        if (mempool_bench_use_cache) {
+            os_mempool_cache_remove(&w->cache);
+        }
+#endif
+
+        os_sem_release(&mempool_bench_done);
+    }
+}
+
+static void
+mempool_bench_one(int num_tasks, int use_cache)
+{
+    uint64_t start;
+    uint64_t dur;
+    int i;
+
+    mempool_bench_use_cache = use_cache;
+    mempool_bench_pool.mp_min_free = mempool_bench_pool.mp_num_free;
+
+    start = os_bench_time_ns();
+    for (i = 0; i < num_tasks; i++) {
+        os_sem_release(&mempool_bench_workers[i].start);
+    }
+    for (i = 0; i < num_tasks; i++) {
+        os_sem_pend(&mempool_bench_done, OS_TIMEOUT_NEVER);
+    }
+    dur = os_bench_time_ns() - start;
+
+    console_printf("  %d tasks, %-8s: avg %5lu ns per get + put, "
+                   "min free %d\n", num_tasks, use_cache ? "cache" : "no cache",
+                   (unsigned long)(dur / ((uint64_t)num_tasks *
+                                          MEMPOOL_BENCH_ITERS *
+                                          MEMPOOL_BENCH_BURST)),
+                   mempool_bench_pool.mp_min_free);
+}
+
+void
+mempool_bench_run(void)
+{
+    struct mempool_bench_worker *w;
+    int rc;
+    int i;
+
+    rc = os_mempool_init(&mempool_bench_pool, MEMPOOL_BENCH_BLOCKS,
+                         MEMPOOL_BENCH_BLOCK_SIZE, mempool_bench_buf,
+                         "mempool_bench");
+    assert(rc == 0);
+    os_sem_init(&mempool_bench_done, 0);
+
+    for (i = 0; i < MEMPOOL_BENCH_MAX_TASKS; i++) {
+        w = &mempool_bench_workers[i];
+        os_sem_init(&w->start, 0);
+        rc = os_task_init(&w->task, "mempool_bench",
+                          mempool_bench_worker_task, w,
+                          MYNEWT_VAL(OS_MAIN_TASK_PRIO) + 1 + i, OS_WAIT_FOREVER,
+                          w->stack, MEMPOOL_BENCH_STACK_SIZE);
+        assert(rc == 0);
+    }
+
+    console_printf("mempool: %d blocks in bursts of %d\n", MEMPOOL_BENCH_BLOCKS,
+                   MEMPOOL_BENCH_BURST);
+    for (i = 1; i <= MEMPOOL_BENCH_MAX_TASKS; i *= 2) {
+        mempool_bench_one(i, 0);
+#if MYNEWT_VAL(OS_MEMPOOL_CACHE)
+        mempool_bench_one(i, 1);
+#endif
+    }
+}
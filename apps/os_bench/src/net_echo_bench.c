@@ -0,0 +1,314 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <assert.h>
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(OS_BENCH_NET_ECHO)
+
+#include "console/console.h"
+#include "mn_socket/mn_socket.h"
+#include "os_bench.h"
+
+/*
+ * Measures UDP and TCP echo over the host loopback interface.  Both the
+ * client and the echo server are mn_sockets, so every round trip passes
+ * through the socket backend twice.  Reports the average and worst round
+ * trip time of small messages, and the throughput of larger messages with a
+ * fixed number of bytes in flight.
+ */
+
+#define NET_ECHO_BENCH_PORT         (9780)
+#define NET_ECHO_BENCH_ITERS        (1000)
+#define NET_ECHO_BENCH_MSG_SZ       (64)
+#define NET_ECHO_BENCH_BULK_SZ      (1024)
+#define NET_ECHO_BENCH_BULK_CNT     (1024)
+#define NET_ECHO_BENCH_WINDOW       (8 * NET_ECHO_BENCH_BULK_SZ)
+#define NET_ECHO_BENCH_TMO          (OS_TICKS_PER_SEC * 2)
+
+static struct mn_socket *net_echo_bench_client;
+static struct mn_socket *net_echo_bench_server;
+static struct mn_socket *net_echo_bench_listener;
+
+/* Released for every chunk of data the client receives. */
+static struct os_sem net_echo_bench_rx_sem;
+/* Released when a TCP connection has been connected and accepted. */
+static struct os_sem net_echo_bench_conn_sem;
+static uint32_t net_echo_bench_rx_bytes;
+static int net_echo_bench_connecting;
+static int net_echo_bench_stream;
+
+static void
+net_echo_bench_addr(struct mn_sockaddr_in *sin, uint16_t port)
+{
+    memset(sin, 0, sizeof(*sin));
+    sin->msin_len = sizeof(*sin);
+    sin->msin_family = MN_AF_INET;
+    sin->msin_port = htons(port);
+    sin->msin_addr.s_addr = htonl(0x7f000001);
+}
+
+static void
+net_echo_bench_server_readable(void *arg, int err)
+{
+    struct mn_sockaddr_in from;
+    struct os_mbuf *om;
+    int rc;
+
+    while (mn_recvfrom(net_echo_bench_server, &om,
+                       (struct mn_sockaddr *)&from) == 0) {
+        rc = mn_sendto(net_echo_bench_server, om,
+                       (struct mn_sockaddr *)&from);
+        /* Stream sockets consume the data on any error but MN_EAGAIN. */
+        if (rc != 0 && (rc == MN_EAGAIN || !net_echo_bench_stream)) {
+            os_mbuf_free_chain(om);
+        }
+    }
+}
+
+static void
+net_echo_bench_client_readable(void *arg, int err)
+{
+    struct os_mbuf *om;
+
+    while (mn_recvfrom(net_echo_bench_client, &om, NULL) == 0) {
+        net_echo_bench_rx_bytes += OS_MBUF_PKTLEN(om);
+        os_mbuf_free_chain(om);
+        os_sem_release(&net_echo_bench_rx_sem);
+    }
+}
+
+static void
+net_echo_bench_writable(void *arg, int err)
+{
+    if (net_echo_bench_connecting) {
+        assert(err == 0);
+        os_sem_release(&net_echo_bench_conn_sem);
+    }
+}
+
+static const union mn_socket_cb net_echo_bench_server_cbs = {
+    .socket.readable = net_echo_bench_server_readable,
+    .socket.writable = net_echo_bench_writable,
+};
+
+static const union mn_socket_cb net_echo_bench_client_cbs = {
+    .socket.readable = net_echo_bench_client_readable,
+    .socket.writable = net_echo_bench_writable,
+};
+
+static int
+net_echo_bench_newconn(void *arg, struct mn_socket *new)
+{
+    mn_socket_set_cbs(new, NULL, &net_echo_bench_server_cbs);
+    net_echo_bench_server = new;
+    os_sem_release(&net_echo_bench_conn_sem);
+    return 0;
+}
+
+static const union mn_socket_cb net_echo_bench_listen_cbs = {
+    .listen.newconn = net_echo_bench_newconn,
+};
+
+static int
+net_echo_bench_send(int len)
+{
+    struct mn_sockaddr_in to;
+    struct os_mbuf *om;
+    int rc;
+
+    om = os_msys_get_pkthdr(len, 0);
+    assert(om != NULL);
+    while (OS_MBUF_PKTLEN(om) < len) {
+        rc = os_mbuf_append(om, "echo echo echo echo echo echo ",
+                            min(32, len - OS_MBUF_PKTLEN(om)));
+        assert(rc == 0);
+    }
+
+    net_echo_bench_addr(&to, NET_ECHO_BENCH_PORT);
+    while (1) {
+        rc = mn_sendto(net_echo_bench_client, om, (struct mn_sockaddr *)&to);
+        if (rc != MN_EAGAIN) {
+            break;
+        }
+        /* Previous stream data still queued. */
+        os_time_delay(1);
+    }
+    return rc;
+}
+
+/*
+ * Waits until the client has received 'bytes' in total.
+ */
+static int
+net_echo_bench_wait(uint32_t bytes)
+{
+    while ((int32_t)(net_echo_bench_rx_bytes - bytes) < 0) {
+        if (os_sem_pend(&net_echo_bench_rx_sem, NET_ECHO_BENCH_TMO) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void
+net_echo_bench_one(const char *name)
+{
+    uint32_t tx_bytes;
+    uint64_t start;
+    uint64_t total;
+    uint64_t max;
+    uint64_t dur;
+    int rc;
+    int i;
+
+    console_printf("  %s:\n", name);
+
+    net_echo_bench_rx_bytes = 0;
+    tx_bytes = 0;
+    total = 0;
+    max = 0;
+    for (i = 0; i < NET_ECHO_BENCH_ITERS; i++) {
+        start = os_bench_time_ns();
+        rc = net_echo_bench_send(NET_ECHO_BENCH_MSG_SZ);
+        assert(rc == 0);
+        tx_bytes += NET_ECHO_BENCH_MSG_SZ;
+        if (net_echo_bench_wait(tx_bytes) != 0) {
+            console_printf("    timeout after %d round trips\n", i);
+            return;
+        }
+        dur = os_bench_time_ns() - start;
+
+        total += dur;
+        if (dur > max) {
+            max = dur;
+        }
+    }
+    console_printf("    %d byte round trip: avg %8lu ns, max %8lu ns\n",
+                   NET_ECHO_BENCH_MSG_SZ,
+                   (unsigned long)(total / NET_ECHO_BENCH_ITERS),
+                   (unsigned long)max);
+
+    net_echo_bench_rx_bytes = 0;
+    tx_bytes = 0;
+    start = os_bench_time_ns();
+    for (i = 0; i < NET_ECHO_BENCH_BULK_CNT; i++) {
+        if (net_echo_bench_wait(tx_bytes + NET_ECHO_BENCH_BULK_SZ -
+                                NET_ECHO_BENCH_WINDOW) != 0) {
+            break;
+        }
+        rc = net_echo_bench_send(NET_ECHO_BENCH_BULK_SZ);
+        assert(rc == 0);
+        tx_bytes += NET_ECHO_BENCH_BULK_SZ;
+    }
+    if (i < NET_ECHO_BENCH_BULK_CNT || net_echo_bench_wait(tx_bytes) != 0) {
+        console_printf("    timeout, %lu of %lu bytes echoed\n",
+                       (unsigned long)net_echo_bench_rx_bytes,
+                       (unsigned long)tx_bytes);
+        return;
+    }
+    dur = os_bench_time_ns() - start;
+    console_printf("    %d byte echo: %8lu kB/s\n", NET_ECHO_BENCH_BULK_SZ,
+                   (unsigned long)((uint64_t)tx_bytes * 1000000 / dur));
+}
+
+static void
+net_echo_bench_udp(void)
+{
+    struct mn_sockaddr_in sin;
+    int rc;
+
+    rc = mn_socket(&net_echo_bench_server, MN_PF_INET, MN_SOCK_DGRAM, 0);
+    assert(rc == 0);
+    mn_socket_set_cbs(net_echo_bench_server, NULL,
+                      &net_echo_bench_server_cbs);
+    net_echo_bench_addr(&sin, NET_ECHO_BENCH_PORT);
+    rc = mn_bind(net_echo_bench_server, (struct mn_sockaddr *)&sin);
+    assert(rc == 0);
+
+    /* Bound, so that the replies are polled for. */
+    rc = mn_socket(&net_echo_bench_client, MN_PF_INET, MN_SOCK_DGRAM, 0);
+    assert(rc == 0);
+    mn_socket_set_cbs(net_echo_bench_client, NULL,
+                      &net_echo_bench_client_cbs);
+    net_echo_bench_addr(&sin, 0);
+    rc = mn_bind(net_echo_bench_client, (struct mn_sockaddr *)&sin);
+    assert(rc == 0);
+
+    net_echo_bench_one("UDP");
+
+    mn_close(net_echo_bench_client);
+    mn_close(net_echo_bench_server);
+}
+
+static void
+net_echo_bench_tcp(void)
+{
+    struct mn_sockaddr_in sin;
+    int rc;
+
+    rc = mn_socket(&net_echo_bench_listener, MN_PF_INET, MN_SOCK_STREAM, 0);
+    assert(rc == 0);
+    mn_socket_set_cbs(net_echo_bench_listener, NULL,
+                      &net_echo_bench_listen_cbs);
+    net_echo_bench_addr(&sin, NET_ECHO_BENCH_PORT);
+    rc = mn_bind(net_echo_bench_listener, (struct mn_sockaddr *)&sin);
+    assert(rc == 0);
+    rc = mn_listen(net_echo_bench_listener, 1);
+    assert(rc == 0);
+
+    rc = mn_socket(&net_echo_bench_client, MN_PF_INET, MN_SOCK_STREAM, 0);
+    assert(rc == 0);
+    mn_socket_set_cbs(net_echo_bench_client, NULL,
+                      &net_echo_bench_client_cbs);
+
+    net_echo_bench_stream = 1;
+    net_echo_bench_connecting = 1;
+    rc = mn_connect(net_echo_bench_client, (struct mn_sockaddr *)&sin);
+    assert(rc == 0);
+    rc = os_sem_pend(&net_echo_bench_conn_sem, NET_ECHO_BENCH_TMO);
+    if (rc == 0) {
+        rc = os_sem_pend(&net_echo_bench_conn_sem, NET_ECHO_BENCH_TMO);
+    }
+    net_echo_bench_connecting = 0;
+
+    if (rc != 0) {
+        console_printf("  TCP:\n    connect timeout\n");
+    } else {
+        net_echo_bench_one("TCP");
+        mn_close(net_echo_bench_server);
+    }
+
+    mn_close(net_echo_bench_client);
+    mn_close(net_echo_bench_listener);
+    net_echo_bench_stream = 0;
+}
+
+void
+net_echo_bench_run(void)
+{
+    os_sem_init(&net_echo_bench_rx_sem, 0);
+    os_sem_init(&net_echo_bench_conn_sem, 0);
+
+    console_printf("net_echo: echo over loopback\n");
+    net_echo_bench_udp();
+    net_echo_bench_tcp();
+}
+
+#endif
@@ -0,0 +1,269 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(OS_BENCH_NFFS)
+
+#include "console/console.h"
+#include "fs/fs.h"
+#include "nffs/nffs.h"
+#include "os_bench.h"
+
+/*
+ * Measures restoring an NFFS file system holding many small files, and
+ * reading those files back in order and at random.  Uses the four 128kB
+ * sectors of the simulated flash starting at 128kB.  With NFFS_CHECKPOINT,
+ * restore is also measured from a checkpoint kept in the last 128kB sector,
+ * with and without objects written after the checkpoint.
+ */
+
+#define NFFS_BENCH_DIRS         (24)
+#define NFFS_BENCH_FILES_PER    (32)
+#define NFFS_BENCH_FILES        (NFFS_BENCH_DIRS * NFFS_BENCH_FILES_PER)
+#define NFFS_BENCH_FILE_SZ      (128)
+#define NFFS_BENCH_READ_SZ      (16)
+#define NFFS_BENCH_RAND_READS   (2000)
+#define NFFS_BENCH_ROUNDS       (3)
+#define NFFS_BENCH_NEW_FILES    (64)
+
+static const struct nffs_area_desc nffs_bench_areas[] = {
+    { 0x00020000, 128 * 1024, 0 },
+    { 0x00040000, 128 * 1024, 0 },
+    { 0x00060000, 128 * 1024, 0 },
+    { 0x00080000, 128 * 1024, 0 },
+    { 0, 0, 0 },
+};
+
+#if MYNEWT_VAL(NFFS_CHECKPOINT)
+static const struct nffs_area_desc nffs_bench_checkpoint_desc = {
+    0x000e0000, 128 * 1024, 0
+};
+#endif
+
+static uint8_t nffs_bench_data[NFFS_BENCH_FILE_SZ];
+
+static void
+nffs_bench_path(char *buf, int idx)
+{
+    sprintf(buf, "/d%d/f%d", idx / NFFS_BENCH_FILES_PER,
+            idx % NFFS_BENCH_FILES_PER);
+}
+
+static void
+nffs_bench_write(const char *path)
+{
+    struct fs_file *file;
+    int rc;
+
+    rc = fs_open(path, FS_ACCESS_WRITE | FS_ACCESS_TRUNCATE, &file);
+    assert(rc == 0);
+    rc = fs_write(file, nffs_bench_data, sizeof(nffs_bench_data));
+    assert(rc == 0);
+    rc = fs_close(file);
+    assert(rc == 0);
+}
+
+static void
+nffs_bench_fill(void)
+{
+    char path[16];
+    int rc;
+    int i;
+
+    rc = nffs_format(nffs_bench_areas);
+    assert(rc == 0);
+
+    for (i = 0; i < NFFS_BENCH_DIRS; i++) {
+        sprintf(path, "/d%d", i);
+        rc = fs_mkdir(path);
+        assert(rc == 0);
+    }
+    for (i = 0; i < NFFS_BENCH_FILES; i++) {
+        nffs_bench_path(path, i);
+        nffs_bench_write(path);
+    }
+}
+
+#if MYNEWT_VAL(NFFS_CHECKPOINT)
+static uint64_t
+nffs_bench_restore(void)
+{
+    uint64_t best;
+    uint64_t start;
+    uint64_t dur;
+    int round;
+    int rc;
+
+    best = UINT64_MAX;
+    for (round = 0; round < NFFS_BENCH_ROUNDS; round++) {
+        start = os_bench_time_ns();
+        rc = nffs_detect(nffs_bench_areas);
+        dur = os_bench_time_ns() - start;
+        assert(rc == 0);
+        if (dur < best) {
+            best = dur;
+        }
+    }
+
+    return best;
+}
+
+static void
+nffs_bench_checkpoint(void)
+{
+    uint64_t replay_best;
+    uint64_t cp_best;
+    char path[16];
+    int rc;
+    int i;
+
+    rc = nffs_checkpoint_area_set(&nffs_bench_checkpoint_desc);
+    assert(rc == 0);
+    rc = nffs_checkpoint();
+    assert(rc == 0);
+
+    cp_best = nffs_bench_restore();
+
+    /* These are read on top of the checkpoint at each restore. */
+    for (i = 0; i < NFFS_BENCH_NEW_FILES; i++) {
+        sprintf(path, "/d%d/n%d", i % NFFS_BENCH_DIRS, i);
+        nffs_bench_write(path);
+    }
+    replay_best = nffs_bench_restore();
+
+    rc = nffs_checkpoint_area_set(NULL);
+    assert(rc == 0);
+
+    console_printf("  restore from checkpoint %8lu us\n",
+                   (unsigned long)(cp_best / 1000));
+    console_printf("  restore from checkpoint, %d new files: %8lu us\n",
+                   NFFS_BENCH_NEW_FILES, (unsigned long)(replay_best / 1000));
+}
+#endif
+
+static void
+nffs_bench_read(int idx, uint32_t off, uint32_t len)
+{
+    uint8_t buf[NFFS_BENCH_FILE_SZ];
+    struct fs_file *file;
+    uint32_t out_len;
+    char path[16];
+    int rc;
+
+    nffs_bench_path(path, idx);
+    rc = fs_open(path, FS_ACCESS_READ, &file);
+    assert(rc == 0);
+    rc = fs_seek(file, off);
+    assert(rc == 0);
+    rc = fs_read(file, len, buf, &out_len);
+    assert(rc == 0 && out_len == len);
+    assert(memcmp(buf, nffs_bench_data + off, len) == 0);
+    rc = fs_close(file);
+    assert(rc == 0);
+}
+
+void
+nffs_bench_run(void)
+{
+    uint64_t restore_best;
+    uint64_t seq_best;
+    uint64_t rand_best;
+    uint64_t start;
+    uint64_t dur;
+    int round;
+    int rc;
+    int i;
+
+    for (i = 0; i < sizeof(nffs_bench_data); i++) {
+        nffs_bench_data[i] = i;
+    }
+
+    nffs_config.nc_num_inodes = NFFS_BENCH_FILES + NFFS_BENCH_NEW_FILES +
+                                NFFS_BENCH_DIRS + 8;
+    nffs_config.nc_num_blocks = NFFS_BENCH_FILES + NFFS_BENCH_NEW_FILES + 8;
+    rc = nffs_init();
+    assert(rc == 0);
+#if MYNEWT_VAL(NFFS_CHECKPOINT)
+    /* The first restores measure a full scan. */
+    rc = nffs_checkpoint_area_set(NULL);
+    assert(rc == 0);
+#endif
+
+    nffs_bench_fill();
+
+    console_printf("nffs: %d files of %d bytes, hash %d-%d buckets, "
+                   "cache %d inodes %d blocks\n",
+                   NFFS_BENCH_FILES, NFFS_BENCH_FILE_SZ,
+                   MYNEWT_VAL(NFFS_HASH_SIZE), MYNEWT_VAL(NFFS_HASH_SIZE_MAX),
+                   (int)nffs_config.nc_num_cache_inodes,
+                   (int)nffs_config.nc_num_cache_blocks);
+
+    restore_best = UINT64_MAX;
+    seq_best = UINT64_MAX;
+    rand_best = UINT64_MAX;
+    for (round = 0; round < NFFS_BENCH_ROUNDS; round++) {
+        start = os_bench_time_ns();
+        rc = nffs_detect(nffs_bench_areas);
+        dur = os_bench_time_ns() - start;
+        assert(rc == 0);
+        if (dur < restore_best) {
+            restore_best = dur;
+        }
+
+        start = os_bench_time_ns();
+        for (i = 0; i < NFFS_BENCH_FILES; i++) {
+            nffs_bench_read(i, 0, NFFS_BENCH_FILE_SZ);
+        }
+        dur = os_bench_time_ns() - start;
+        if (dur < seq_best) {
+            seq_best = dur;
+        }
+
+        srand(round);
+        start = os_bench_time_ns();
+        for (i = 0; i < NFFS_BENCH_RAND_READS; i++) {
+            nffs_bench_read(rand() % NFFS_BENCH_FILES,
+                            rand() % (NFFS_BENCH_FILE_SZ -
+                                      NFFS_BENCH_READ_SZ + 1),
+                            NFFS_BENCH_READ_SZ);
+        }
+        dur = os_bench_time_ns() - start;
+        if (dur < rand_best) {
+            rand_best = dur;
+        }
+    }
+
+    console_printf("  restore, full scan %8lu us\n",
+                   (unsigned long)(restore_best / 1000));
+    console_printf("  sequential read, %d files: %8lu us\n",
+                   NFFS_BENCH_FILES, (unsigned long)(seq_best / 1000));
+    console_printf("  random read, %d x %d bytes: %8lu us\n",
+                   NFFS_BENCH_RAND_READS, NFFS_BENCH_READ_SZ,
+                   (unsigned long)(rand_best / 1000));
+
+#if MYNEWT_VAL(NFFS_CHECKPOINT)
+    nffs_bench_checkpoint();
+#endif
+}
+
+#endif
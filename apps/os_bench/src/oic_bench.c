@@ -0,0 +1,191 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <assert.h>
+#include <string.h>
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(OS_BENCH_OIC)
+
+#include "console/console.h"
+#include "oic/oc_api.h"
+#include "oic/messaging/coap/coap.h"
+#include "oic/port/mynewt/ip.h"
+#include "os_bench.h"
+
+/*
+ * Measures CoAP GET requests over IPv4 loopback.  The OIC client and the
+ * server resource live in the same image, so every request and response goes
+ * through the IP transport and the socket backend.  OIC runs off the default
+ * event queue, which the benchmark drives itself while waiting for responses.
+ */
+
+#define OIC_BENCH_URI               "/bench"
+#define OIC_BENCH_PORT              (5683)
+#define OIC_BENCH_ITERS             (1000)
+#define OIC_BENCH_TMO               (OS_TICKS_PER_SEC * 2)
+
+static const int oic_bench_sizes[] = { 16, 256, 768 };
+
+static uint8_t oic_bench_data[768];
+/* Size of the byte string the server puts in its responses. */
+static int oic_bench_len;
+/* Payload size of the last response, -1 while one is outstanding. */
+static int oic_bench_rsp_len;
+static oc_server_handle_t oic_bench_server;
+
+static void
+oic_bench_get_handler(oc_request_t *request, oc_interface_mask_t interface)
+{
+    oc_rep_start_root_object();
+    oc_rep_set_byte_string(root, d, oic_bench_data, oic_bench_len);
+    oc_rep_end_root_object();
+    oc_send_response(request, OC_STATUS_OK);
+}
+
+static void
+oic_bench_rsp(oc_client_response_t *rsp)
+{
+    struct os_mbuf *m;
+    uint16_t off;
+
+    if (rsp->code != OC_STATUS_OK) {
+        oic_bench_rsp_len = 0;
+        return;
+    }
+    oic_bench_rsp_len = coap_get_payload(rsp->packet, &m, &off);
+}
+
+static void
+oic_bench_init(void)
+{
+    oc_init_platform("Mynewt", NULL, NULL);
+    oc_add_device("/oic/d", "oic.d.bench", "os_bench", "1.0", "1.0", NULL,
+                  NULL);
+}
+
+static void
+oic_bench_register_resources(void)
+{
+    oc_resource_t *res;
+
+    res = oc_new_resource(OIC_BENCH_URI, 1, 0);
+    oc_resource_bind_resource_type(res, "x.mynewt.bench");
+    oc_resource_bind_resource_interface(res, OC_IF_R);
+    oc_resource_set_default_interface(res, OC_IF_R);
+    oc_resource_set_request_handler(res, OC_GET, oic_bench_get_handler);
+    oc_add_resource(res);
+}
+
+static oc_handler_t oic_bench_handler = {
+    .init = oic_bench_init,
+    .register_resources = oic_bench_register_resources,
+};
+
+/*
+ * Issues a GET and processes OIC events until the response arrives.  Returns
+ * the payload size of the response, or -1 if there was none.
+ */
+static int
+oic_bench_get(void)
+{
+    struct os_eventq *evq;
+    struct os_event *ev;
+
+    oic_bench_rsp_len = -1;
+    if (!oc_do_get(OIC_BENCH_URI, &oic_bench_server, NULL, oic_bench_rsp,
+                   LOW_QOS)) {
+        return -1;
+    }
+
+    evq = os_eventq_dflt_get();
+    while (oic_bench_rsp_len < 0) {
+        ev = os_eventq_poll(&evq, 1, OIC_BENCH_TMO);
+        if (ev == NULL) {
+            return -1;
+        }
+        ev->ev_cb(ev);
+    }
+    return oic_bench_rsp_len;
+}
+
+static void
+oic_bench_one(int len)
+{
+    uint64_t start;
+    uint64_t total;
+    uint64_t max;
+    uint64_t dur;
+    int rsp_len;
+    int i;
+
+    oic_bench_len = len;
+    total = 0;
+    max = 0;
+    rsp_len = 0;
+    for (i = 0; i < OIC_BENCH_ITERS; i++) {
+        start = os_bench_time_ns();
+        rsp_len = oic_bench_get();
+        if (rsp_len <= len) {
+            console_printf("    %d byte GET failed after %d requests\n",
+                           len, i);
+            return;
+        }
+        dur = os_bench_time_ns() - start;
+
+        total += dur;
+        if (dur > max) {
+            max = dur;
+        }
+    }
+    console_printf("    %d byte GET: avg %8lu ns, max %8lu ns, %6lu kB/s\n",
+                   len, (unsigned long)(total / OIC_BENCH_ITERS),
+                   (unsigned long)max,
+                   (unsigned long)((uint64_t)rsp_len * OIC_BENCH_ITERS *
+                                   1000000 / total));
+}
+
+void
+oic_bench_run(void)
+{
+    oc_make_ip4_endpoint(ep, 0, OIC_BENCH_PORT, 127, 0, 0, 1);
+    int rc;
+    int i;
+
+    for (i = 0; i < sizeof(oic_bench_data); i++) {
+        oic_bench_data[i] = i;
+    }
+    memcpy(&oic_bench_server.endpoint, &ep, sizeof(ep));
+
+    console_printf("oic: CoAP GET over IPv4 loopback\n");
+
+    rc = oc_main_init(&oic_bench_handler);
+    if (rc != 0) {
+        console_printf("    init failed: %d\n", rc);
+        return;
+    }
+
+    for (i = 0; i < ARRAY_SIZE(oic_bench_sizes); i++) {
+        oic_bench_one(oic_bench_sizes[i]);
+    }
+
+    oc_main_shutdown();
+}
+
+#endif
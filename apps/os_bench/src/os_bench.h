@@ -0,0 +1,58 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#ifndef H_OS_BENCH_
+#define H_OS_BENCH_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Returns a free running timestamp in nanoseconds.  On the simulator this
+ * reads the host monotonic clock, as the simulated hal_timer only advances
+ * once per OS tick.
+ */
+uint64_t os_bench_time_ns(void);
+
+void sched_bench_run(void);
+void callout_bench_run(void);
+void sleep_bench_run(void);
+void mempool_bench_run(void);
+void crc_bench_run(void);
+void cbor_bench_run(void);
+void config_bench_run(void);
+void mbuf_io_bench_run(void);
+void mbuf_free_bench_run(void);
+void fcb_mount_bench_run(void);
+void fcb_append_bench_run(void);
+void flash_cache_bench_run(void);
+void nffs_bench_run(void);
+void net_echo_bench_run(void);
+void oic_bench_run(void);
+void sensor_bench_run(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
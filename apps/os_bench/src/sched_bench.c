@@ -0,0 +1,116 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#include <assert.h>
+#include "os/mynewt.h"
+#include "console/console.h"
+#include "os_bench.h"
+
+/*
+ * Measures how long interrupts stay disabled while a task is woken up and
+ * put back to sleep, as a function of the number of ready tasks.  The
+ * ready tasks are bare task structures that are never run: they all have a
+ * lower priority than the benchmark (main) task and are only kept on the
+ * run list while interrupts are disabled.  The woken task has the lowest
+ * priority, i.e. it is inserted at the end of the run list.
+ */
+
+#define SCHED_BENCH_MAX_TASKS   (64)
+#define SCHED_BENCH_ITERS       (1000)
+#define SCHED_BENCH_VICTIM_PRIO (OS_TASK_PRI_LOWEST - 1)
+
+static struct os_task sched_bench_tasks[SCHED_BENCH_MAX_TASKS];
+static struct os_task sched_bench_victim;
+
+static void
+sched_bench_task_init(struct os_task *t, uint8_t prio)
+{
+    os_sr_t sr;
+
+    t->t_name = "sched_bench";
+    t->t_prio = prio;
+    t->t_state = OS_TASK_READY;
+    os_sched_insert(t);
+
+    OS_ENTER_CRITICAL(sr);
+    os_sched_sleep(t, OS_TIMEOUT_NEVER);
+    OS_EXIT_CRITICAL(sr);
+}
+
+static void
+sched_bench_one(int num_tasks)
+{
+    uint64_t start;
+    uint64_t total;
+    uint64_t max;
+    uint64_t dur;
+    os_sr_t sr;
+    int i;
+    int j;
+
+    total = 0;
+    max = 0;
+    for (i = 0; i < SCHED_BENCH_ITERS; i++) {
+        OS_ENTER_CRITICAL(sr);
+        for (j = 0; j < num_tasks; j++) {
+            os_sched_wakeup(&sched_bench_tasks[j]);
+        }
+
+        start = os_bench_time_ns();
+        os_sched_wakeup(&sched_bench_victim);
+        os_sched_sleep(&sched_bench_victim, OS_TIMEOUT_NEVER);
+        dur = os_bench_time_ns() - start;
+
+        for (j = 0; j < num_tasks; j++) {
+            os_sched_sleep(&sched_bench_tasks[j], OS_TIMEOUT_NEVER);
+        }
+        OS_EXIT_CRITICAL(sr);
+
+        total += dur;
+        if (dur > max) {
+            max = dur;
+        }
+    }
+
+    console_printf("  %3d tasks: avg %6lu ns, max %6lu ns\n", num_tasks,
+                   (unsigned long)(total / SCHED_BENCH_ITERS),
+                   (unsigned long)max);
+}
+
+void
+sched_bench_run(void)
+{
+    int i;
+
+    assert(MYNEWT_VAL(OS_MAIN_TASK_PRIO) + SCHED_BENCH_MAX_TASKS <
+           SCHED_BENCH_VICTIM_PRIO);
+
+    for (i = 0; i < SCHED_BENCH_MAX_TASKS; i++) {
+        sched_bench_task_init(&sched_bench_tasks[i],
+                              MYNEWT_VAL(OS_MAIN_TASK_PRIO) + 1 + i);
+    }
+    sched_bench_task_init(&sched_bench_victim, SCHED_BENCH_VICTIM_PRIO);
+
+    console_printf("sched: wakeup + sleep, %s run list\n",
+                   MYNEWT_VAL(OS_SCHED_PRIO_BITMAP) ? "bitmap" : "sorted");
+    for (i = 1; i <= SCHED_BENCH_MAX_TASKS; i *= 2) {
+        sched_bench_one(i);
+    }
+}
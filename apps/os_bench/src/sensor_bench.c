@@ -0,0 +1,159 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <assert.h>
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(OS_BENCH_SENSOR)
+
+#include "console/console.h"
+#include "sensor/sensor.h"
+#include "sensor/accel.h"
+#include "sim/sim_accel.h"
+#include "os_bench.h"
+
+/*
+ * Measures reading a simulated accelerometer that always has a full FIFO,
+ * one sample per callback with sensor_read(), and one block of samples per
+ * callback with sensor_read_fifo().  Reports the samples read per second and
+ * the average time per callback.  A listener is registered for part of the
+ * runs, to include the cost of passing the samples to it.
+ */
+
+#define SENSOR_BENCH_FIFO_SZ        (255)
+#define SENSOR_BENCH_ITERS          (200)
+
+static struct sim_accel sensor_bench_accel;
+static uint32_t sensor_bench_samples;
+static uint32_t sensor_bench_callbacks;
+static float sensor_bench_sum;
+
+static int
+sensor_bench_data_func(struct sensor *sensor, void *arg, void *data,
+                       sensor_type_t type)
+{
+    struct sensor_accel_data *sad;
+
+    sad = data;
+    sensor_bench_sum += sad->sad_x;
+    sensor_bench_samples++;
+    sensor_bench_callbacks++;
+
+    return 0;
+}
+
+static int
+sensor_bench_fifo_func(struct sensor *sensor, void *arg,
+                       struct sensor_fifo_data *sfd)
+{
+    struct sensor_accel_data *sad;
+    int i;
+
+    for (i = 0; i < sfd->sfd_count; i++) {
+        sad = sensor_fifo_sample(sfd, i);
+        sensor_bench_sum += sad->sad_x;
+    }
+    sensor_bench_samples += sfd->sfd_count;
+    sensor_bench_callbacks++;
+
+    return 0;
+}
+
+static int
+sensor_bench_listener_func(struct sensor *sensor, void *arg, void *data,
+                           sensor_type_t type)
+{
+    return 0;
+}
+
+static struct sensor_listener sensor_bench_listener = {
+    .sl_sensor_type = SENSOR_TYPE_ACCELEROMETER,
+    .sl_func = sensor_bench_listener_func,
+};
+
+static void
+sensor_bench_one(const char *name, int fifo)
+{
+    struct sensor *sensor;
+    uint64_t start;
+    uint64_t dur;
+    int rc;
+    int i;
+
+    sensor = &sensor_bench_accel.sa_sensor;
+
+    sensor_bench_samples = 0;
+    sensor_bench_callbacks = 0;
+    start = os_bench_time_ns();
+    for (i = 0; i < SENSOR_BENCH_ITERS; i++) {
+        if (fifo) {
+            rc = sensor_read_fifo(sensor, SENSOR_TYPE_ACCELEROMETER,
+                                  sensor_bench_fifo_func, NULL, 0,
+                                  OS_TIMEOUT_NEVER);
+        } else {
+            rc = sensor_read(sensor, SENSOR_TYPE_ACCELEROMETER,
+                             sensor_bench_data_func, NULL, OS_TIMEOUT_NEVER);
+        }
+        assert(rc == 0);
+    }
+    dur = os_bench_time_ns() - start;
+
+    console_printf("    %-20s %9lu samples/s, %6lu ns per callback\n", name,
+                   (unsigned long)((uint64_t)sensor_bench_samples *
+                                   1000000000 / dur),
+                   (unsigned long)(dur / sensor_bench_callbacks));
+}
+
+void
+sensor_bench_run(void)
+{
+    struct sim_accel_cfg cfg = {
+        .sac_nr_samples = SENSOR_BENCH_FIFO_SZ,
+        .sac_nr_axises = 3,
+        .sac_sample_itvl = 0,
+        .sac_mask = SENSOR_TYPE_ACCELEROMETER,
+    };
+    struct sensor *sensor;
+    int rc;
+
+    console_printf("sensor: sim accelerometer, %d sample FIFO\n",
+                   SENSOR_BENCH_FIFO_SZ);
+
+    rc = os_dev_create(&sensor_bench_accel.sa_dev, "bench_accel",
+                       OS_DEV_INIT_PRIMARY, 0, sim_accel_init, NULL);
+    assert(rc == 0);
+    rc = sim_accel_config(&sensor_bench_accel, &cfg);
+    assert(rc == 0);
+
+    sensor = &sensor_bench_accel.sa_sensor;
+    rc = sensor_set_type_mask(sensor, cfg.sac_mask);
+    assert(rc == 0);
+
+    sensor_bench_one("read", 0);
+    sensor_bench_one("read_fifo", 1);
+
+    rc = sensor_register_listener(sensor, &sensor_bench_listener);
+    assert(rc == 0);
+    sensor_bench_one("read, listener", 0);
+    sensor_bench_one("read_fifo, listener", 1);
+    rc = sensor_unregister_listener(sensor, &sensor_bench_listener);
+    assert(rc == 0);
+}
+
+#endif
@@ -0,0 +1,127 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#include <assert.h>
+#include <stdlib.h>
+#include "os/mynewt.h"
+#include "console/console.h"
+#include "os_bench.h"
+
+/*
+ * Measures how long interrupts stay disabled while a task is put to sleep
+ * with a timeout, the next wakeup time is queried (as done by the idle task
+ * before entering tickless sleep) and the task is woken up again, as a
+ * function of the number of tasks already sleeping with a timeout.  The
+ * sleeping tasks are bare task structures that are never run; their
+ * timeouts are far enough in the future that they never expire.
+ */
+
+#define SLEEP_BENCH_MAX_TASKS   (32)
+#define SLEEP_BENCH_ITERS       (1000)
+#define SLEEP_BENCH_MIN_TICKS   (OS_TICKS_PER_SEC * 60)
+#define SLEEP_BENCH_PRIO        (OS_TASK_PRI_LOWEST - 1)
+
+static struct os_task sleep_bench_tasks[SLEEP_BENCH_MAX_TASKS];
+static struct os_task sleep_bench_victim;
+
+static os_time_t
+sleep_bench_ticks(void)
+{
+    return SLEEP_BENCH_MIN_TICKS + rand() % (OS_TICKS_PER_SEC * 60);
+}
+
+static void
+sleep_bench_task_init(struct os_task *t)
+{
+    os_sr_t sr;
+
+    t->t_name = "sleep_bench";
+    t->t_prio = SLEEP_BENCH_PRIO;
+    t->t_state = OS_TASK_READY;
+    os_sched_insert(t);
+
+    OS_ENTER_CRITICAL(sr);
+    os_sched_sleep(t, OS_TIMEOUT_NEVER);
+    OS_EXIT_CRITICAL(sr);
+}
+
+static void
+sleep_bench_one(int num_tasks)
+{
+    uint64_t start;
+    uint64_t total;
+    uint64_t max;
+    uint64_t dur;
+    os_time_t ticks;
+    os_sr_t sr;
+    int i;
+    int j;
+
+    total = 0;
+    max = 0;
+    for (i = 0; i < SLEEP_BENCH_ITERS; i++) {
+        OS_ENTER_CRITICAL(sr);
+        for (j = 0; j < num_tasks; j++) {
+            os_sched_wakeup(&sleep_bench_tasks[j]);
+            os_sched_sleep(&sleep_bench_tasks[j], sleep_bench_ticks());
+        }
+        os_sched_wakeup(&sleep_bench_victim);
+        ticks = sleep_bench_ticks();
+
+        start = os_bench_time_ns();
+        os_sched_sleep(&sleep_bench_victim, ticks);
+        os_sched_wakeup_ticks(os_time_get());
+        os_sched_wakeup(&sleep_bench_victim);
+        dur = os_bench_time_ns() - start;
+
+        os_sched_sleep(&sleep_bench_victim, OS_TIMEOUT_NEVER);
+        for (j = 0; j < num_tasks; j++) {
+            os_sched_wakeup(&sleep_bench_tasks[j]);
+            os_sched_sleep(&sleep_bench_tasks[j], OS_TIMEOUT_NEVER);
+        }
+        OS_EXIT_CRITICAL(sr);
+
+        total += dur;
+        if (dur > max) {
+            max = dur;
+        }
+    }
+
+    console_printf("  %3d tasks: avg %6lu ns, max %6lu ns\n", num_tasks,
+                   (unsigned long)(total / SLEEP_BENCH_ITERS),
+                   (unsigned long)max);
+}
+
+void
+sleep_bench_run(void)
+{
+    int i;
+
+    for (i = 0; i < SLEEP_BENCH_MAX_TASKS; i++) {
+        sleep_bench_task_init(&sleep_bench_tasks[i]);
+    }
+    sleep_bench_task_init(&sleep_bench_victim);
+
+    console_printf("sleep: sleep + next wakeup + wakeup, %s sleep list\n",
+                   MYNEWT_VAL(OS_SCHED_SLEEP_HEAP) ? "heap" : "sorted");
+    for (i = 1; i <= SLEEP_BENCH_MAX_TASKS; i *= 2) {
+        sleep_bench_one(i);
+    }
+}
@@ -17,17 +17,99 @@
  * under the License.
  */
 
+#include <string.h>
 #include "os/mynewt.h"
 #include <tinycbor/cbor_mbuf_reader.h>
 #include <tinycbor/compilersupport_p.h>
 
+/*
+ * The parser reads the data mostly front to back.  Rather than walking the
+ * chain from its head on every access, the reader remembers the mbuf of the
+ * last access and moves forward from there; it only rewinds to the head
+ * when the parser seeks backwards.
+ */
+
+/**
+ * Returns the mbuf holding the byte at the specified absolute chain offset
+ * and sets *om_off to the offset within that mbuf, or returns NULL if the
+ * offset is past the end of the chain.
+ */
+static struct os_mbuf *
+cbor_mbuf_reader_seek(struct cbor_mbuf_reader *cb, int off, int *om_off)
+{
+    struct os_mbuf *om;
+    int om_start;
+
+    if (off < cb->cur_off) {
+        cb->cur_m = cb->m;
+        cb->cur_off = 0;
+    }
+
+    om = cb->cur_m;
+    om_start = cb->cur_off;
+    while (om != NULL && off >= om_start + om->om_len) {
+        om_start += om->om_len;
+        om = SLIST_NEXT(om, om_next);
+    }
+    if (om == NULL) {
+        return NULL;
+    }
+
+    cb->cur_m = om;
+    cb->cur_off = om_start;
+    *om_off = off - om_start;
+    return om;
+}
+
+/**
+ * Copies len bytes starting at the specified offset from the start of the
+ * data.
+ *
+ * @return                      0 on success; -1 if the chain is too short.
+ */
+static int
+cbor_mbuf_reader_copy(struct cbor_mbuf_reader *cb, int offset, void *dst,
+                      size_t len)
+{
+    struct os_mbuf *om;
+    uint8_t *udst;
+    size_t chunk;
+    int om_off;
+
+    om = cbor_mbuf_reader_seek(cb, offset + cb->init_off, &om_off);
+    if (om == NULL) {
+        return len == 0 ? 0 : -1;
+    }
+
+    /* Fast path: the whole range is in one mbuf. */
+    if (om_off + len <= om->om_len) {
+        memcpy(dst, om->om_data + om_off, len);
+        return 0;
+    }
+
+    udst = dst;
+    while (len > 0) {
+        if (om == NULL) {
+            return -1;
+        }
+        chunk = min(om->om_len - om_off, len);
+        memcpy(udst, om->om_data + om_off, chunk);
+        udst += chunk;
+        len -= chunk;
+        om = SLIST_NEXT(om, om_next);
+        om_off = 0;
+    }
+
+    return 0;
+}
+
 static uint8_t
 cbor_mbuf_reader_get8(struct cbor_decoder_reader *d, int offset)
 {
     uint8_t val;
     struct cbor_mbuf_reader *cb = (struct cbor_mbuf_reader *) d;
 
-    os_mbuf_copydata(cb->m, offset + cb->init_off, sizeof(val), &val);
+    cbor_mbuf_reader_copy(cb, offset, &val, sizeof(val));
     return val;
 }
 
@@ -37,7 +119,7 @@ cbor_mbuf_reader_get16(struct cbor_decoder_reader *d, int offset)
     uint16_t val;
     struct cbor_mbuf_reader *cb = (struct cbor_mbuf_reader *) d;
 
-    os_mbuf_copydata(cb->m, offset + cb->init_off, sizeof(val), &val);
+    cbor_mbuf_reader_copy(cb, offset, &val, sizeof(val));
     return cbor_ntohs(val);
 }
 
@@ -47,7 +129,7 @@ cbor_mbuf_reader_get32(struct cbor_decoder_reader *d, int offset)
     uint32_t val;
     struct cbor_mbuf_reader *cb = (struct cbor_mbuf_reader *) d;
 
-    os_mbuf_copydata(cb->m, offset + cb->init_off, sizeof(val), &val);
+    cbor_mbuf_reader_copy(cb, offset, &val, sizeof(val));
     return cbor_ntohl(val);
 }
 
@@ -57,7 +139,7 @@ cbor_mbuf_reader_get64(struct cbor_decoder_reader *d, int offset)
     uint64_t val;
     struct cbor_mbuf_reader *cb = (struct cbor_mbuf_reader *) d;
 
-    os_mbuf_copydata(cb->m, offset + cb->init_off, sizeof(val), &val);
+    cbor_mbuf_reader_copy(cb, offset, &val, sizeof(val));
     return cbor_ntohll(val);
 }
 
@@ -66,21 +148,35 @@ cbor_mbuf_reader_cmp(struct cbor_decoder_reader *d, char *buf, int offset,
                      size_t len)
 {
     struct cbor_mbuf_reader *cb = (struct cbor_mbuf_reader *) d;
-    return os_mbuf_cmpf(cb->m, offset + cb->init_off, buf, len) == 0;
+    struct os_mbuf *om;
+    size_t chunk;
+    int om_off;
+
+    om = cbor_mbuf_reader_seek(cb, offset + cb->init_off, &om_off);
+    while (len > 0) {
+        if (om == NULL) {
+            return false;
+        }
+        chunk = min(om->om_len - om_off, len);
+        if (memcmp(om->om_data + om_off, buf, chunk) != 0) {
+            return false;
+        }
+        buf += chunk;
+        len -= chunk;
+        om = SLIST_NEXT(om, om_next);
+        om_off = 0;
+    }
+
+    return true;
 }
 
 static uintptr_t
 cbor_mbuf_reader_cpy(struct cbor_decoder_reader *d, char *dst, int offset,
                      size_t len)
 {
-    int rc;
     struct cbor_mbuf_reader *cb = (struct cbor_mbuf_reader *) d;
 
-    rc = os_mbuf_copydata(cb->m, offset + cb->init_off, len, dst);
-    if (rc == 0) {
-        return true;
-    }
-    return false;
+    return cbor_mbuf_reader_copy(cb, offset, dst, len) == 0;
 }
 
 void
@@ -99,6 +195,8 @@ cbor_mbuf_reader_init(struct cbor_mbuf_reader *cb, struct os_mbuf *m,
     assert(OS_MBUF_IS_PKTHDR(m));
     hdr = OS_MBUF_PKTHDR(m);
     cb->m = m;
+    cb->cur_m = m;
+    cb->cur_off = 0;
     cb->init_off = initial_offset;
     cb->r.message_size = hdr->omp_len - initial_offset;
 }
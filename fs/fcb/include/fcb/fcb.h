@@ -34,7 +34,11 @@ extern "C" {
 
 #include <syscfg/syscfg.h>
 #include <os/os_mutex.h>
+#include <os/queue.h>
 #include <flash_map/flash_map.h>
+#if MYNEWT_VAL(FCB_PRE_ERASE)
+#include <hal/hal_flash_async.h>
+#endif
 
 #define FCB_MAX_LEN	(CHAR_MAX | CHAR_MAX << 7) /* Max length of element */
 
@@ -63,6 +67,28 @@ struct fcb_entry {
     bool fe_step_back; /* walk backwards */
 };
 
+#if MYNEWT_VAL(FCB_PRE_ERASE)
+/**
+ * Background erase counters of an FCB with f_pre_erase set.
+ */
+struct fcb_pre_erase_stats {
+    /** The number of sectors erased by the flash worker task. */
+    uint32_t fpes_erased;
+    /**
+     * The number of times a sector was needed while the worker was still
+     * erasing it, and the caller waited.
+     */
+    uint32_t fpes_waits;
+    /**
+     * The number of sectors erased by the caller, because they were needed
+     * before the worker got to them or after it failed.
+     */
+    uint32_t fpes_inline;
+    /** The number of background erases that failed. */
+    uint32_t fpes_errs;
+};
+#endif
+
 struct fcb {
     /* Caller of fcb_init fills this in */
     uint32_t f_magic;		/* As placed on the disk */
@@ -72,6 +98,18 @@ struct fcb {
     /** Number of element in active sector (f_active) */
     uint16_t f_active_sector_entry_count;
     struct flash_area *f_sectors; /* Array of sectors, must be contiguous */
+#if MYNEWT_VAL(FCB_WRITE_BUF)
+    /**
+     * Optional write buffer, usually one flash page.  Its size must be
+     * a multiple of the flash alignment.  NULL to write straight through.
+     */
+    uint8_t *f_wbuf;
+    uint16_t f_wbuf_size;
+#endif
+#if MYNEWT_VAL(FCB_PRE_ERASE)
+    /** Erase rotated sectors in the background; see fcb_rotate(). */
+    bool f_pre_erase;
+#endif
 
     /* Flash circular buffer internal state */
     struct os_mutex f_mtx;	/* Locking for accessing the FCB data */
@@ -79,6 +117,18 @@ struct fcb {
     struct fcb_entry f_active;
     uint16_t f_active_id;
     uint8_t f_align;		/* writes to flash have to aligned to this */
+#if MYNEWT_VAL(FCB_WRITE_BUF)
+    uint16_t f_wbuf_len;	/* bytes held in f_wbuf */
+    uint32_t f_wbuf_off;	/* offset of f_wbuf[0] in f_wbuf_area */
+    struct flash_area *f_wbuf_area;
+    SLIST_ENTRY(fcb) f_wbuf_next;
+#endif
+#if MYNEWT_VAL(FCB_PRE_ERASE)
+    uint16_t f_dirty_cnt;	/* rotated sectors before f_oldest to erase */
+    bool f_erase_busy;		/* f_erase_op submitted, result not seen */
+    struct hal_flash_op f_erase_op;
+    struct fcb_pre_erase_stats f_pre_erase_stats;
+#endif
 };
 
 /**
@@ -156,6 +206,43 @@ int fcb_append_finish(struct fcb *, struct fcb_entry *append_loc);
  */
 int fcb_write(struct fcb *fcb, struct fcb_entry *loc, const uint8_t *buf, size_t len);
 
+struct os_iovec;
+
+/**
+ * Write a gather list of user data.
+ *
+ * Like fcb_write(), but takes the data as an array of segments which are
+ * written back to back.
+ *
+ * @param fcb - fcb to write entry to
+ * @param loc - location of the entry
+ * @param iov - segments to write
+ * @param iov_cnt - number of segments
+ * @return 0 on success, non-zero on failure
+ */
+int fcb_writev(struct fcb *fcb, struct fcb_entry *loc,
+               const struct os_iovec *iov, int iov_cnt);
+
+/**
+ * Write out data held in the FCB write buffer, and finish background
+ * erases.
+ *
+ * With FCB_WRITE_BUF, entries appended to an FCB that has f_wbuf set are
+ * collected in RAM and programmed a buffer at a time.  Entry data must
+ * then be written with fcb_write() or fcb_writev() rather than
+ * flash_area_write().  The buffer is written out when it fills, before
+ * entries are read, when the active sector changes, on fcb_rotate() and
+ * at sysdown.  Call this to make appended entries durable at other times.
+ *
+ * With FCB_PRE_ERASE, this also erases the sectors dropped by fcb_rotate()
+ * that the flash worker has not erased yet.  An FCB with f_pre_erase set
+ * must be flushed before it is initialized again.
+ *
+ * @param fcb - fcb to flush
+ * @return 0 on success, non-zero on failure
+ */
+int fcb_flush(struct fcb *fcb);
+
 /**
  * Walk over all entries in FCB.
  * cb gets called for every entry. If cb wants to stop the walk, it should
@@ -206,6 +293,15 @@ int fcb_walk_back(struct fcb *fcb, fcb_walk_cb cb, void *cb_arg);
 
 /**
  * Erases the data from oldest sector.
+ *
+ * With FCB_PRE_ERASE and f_pre_erase set, the sector is only dropped here
+ * and erased later by the flash worker task (HAL_FLASH_ASYNC), so rotation
+ * does not block the caller for the erase time.  The sector is not reused
+ * until it has been erased.  Keep f_scratch_cnt at 1 or more so that the
+ * worker has a full sector of appends to finish before the sector is next
+ * needed; f_pre_erase_stats tells how often appends still had to wait.
+ * If the device resets before the erase, the dropped sector is found again
+ * as the oldest at the next fcb_init().
  */
 int fcb_rotate(struct fcb *);
 
@@ -16,7 +16,7 @@
  * specific language governing permissions and limitations
  * under the License.
  */
-#include "fcb_test.h"
+#include "fcb_test/fcb_test.h"
 
 TEST_CASE_SELF(fcb_test_area_info)
 {
@@ -0,0 +1,100 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "fcb_test/fcb_test.h"
+
+static void
+fcb_test_mount_remount(struct fcb *fcb, const struct fcb_entry *exp)
+{
+    int rc;
+
+    memset(fcb, 0, sizeof(*fcb));
+    fcb->f_sector_cnt = 2;
+    fcb->f_sectors = test_fcb_area;
+
+    rc = fcb_init(fcb);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(fcb->f_active.fe_area == exp->fe_area);
+    TEST_ASSERT(fcb->f_active.fe_elem_off == exp->fe_elem_off);
+    TEST_ASSERT(fcb->f_active.fe_data_off == exp->fe_data_off);
+    TEST_ASSERT(fcb->f_active.fe_data_len == exp->fe_data_len);
+}
+
+/*
+ * Entries full of erased-looking bytes, an unfinished entry and an entry
+ * without CRC must not confuse the search for the write position.
+ */
+TEST_CASE_SELF(fcb_test_mount)
+{
+    struct fcb *fcb;
+    struct fcb_entry loc = {};
+    struct fcb_entry exp;
+    uint8_t test_data[128];
+    uint16_t cnt;
+    int rc;
+    int i;
+
+    fcb_tc_pretest(2);
+
+    fcb = &test_fcb;
+
+    /* Empty active sector. */
+    exp = fcb->f_active;
+    fcb_test_mount_remount(fcb, &exp);
+    TEST_ASSERT(fcb->f_active_sector_entry_count == 0);
+
+    memset(test_data, 0xff, sizeof(test_data));
+    for (i = 0; i < 40; i++) {
+        rc = fcb_append(fcb, i % 2 ? sizeof(test_data) : 3, &loc);
+        TEST_ASSERT_FATAL(rc == 0);
+        rc = flash_area_write(loc.fe_area, loc.fe_data_off, test_data,
+                              loc.fe_data_len);
+        TEST_ASSERT(rc == 0);
+        rc = fcb_append_finish(fcb, &loc);
+        TEST_ASSERT(rc == 0);
+    }
+    cnt = fcb->f_active_sector_entry_count;
+    exp = fcb->f_active;
+    fcb_test_mount_remount(fcb, &exp);
+    TEST_ASSERT(fcb->f_active_sector_entry_count == cnt);
+
+    /* Length written, data and CRC not. */
+    rc = fcb_append(fcb, sizeof(test_data), &loc);
+    TEST_ASSERT_FATAL(rc == 0);
+    exp = fcb->f_active;
+    fcb_test_mount_remount(fcb, &exp);
+    TEST_ASSERT(fcb->f_active_sector_entry_count == cnt + 1);
+
+    /* Data written, CRC not. */
+    for (i = 0; i < sizeof(test_data); i++) {
+        test_data[i] = fcb_test_append_data(sizeof(test_data), i);
+    }
+    rc = fcb_append(fcb, sizeof(test_data), &loc);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = flash_area_write(loc.fe_area, loc.fe_data_off, test_data,
+                          sizeof(test_data));
+    TEST_ASSERT(rc == 0);
+    exp = fcb->f_active;
+    fcb_test_mount_remount(fcb, &exp);
+    TEST_ASSERT(fcb->f_active_sector_entry_count == cnt + 2);
+
+    /* Appends after remount go behind the broken entries. */
+    rc = fcb_append(fcb, 1, &loc);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(loc.fe_elem_off == exp.fe_elem_off);
+}
@@ -0,0 +1,146 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "fcb_test/fcb_test.h"
+
+#if MYNEWT_VAL(FCB_PRE_ERASE)
+
+static void
+fcb_test_pre_erase_mount(struct fcb *fcb)
+{
+    int rc;
+
+    memset(fcb, 0, sizeof(*fcb));
+    fcb->f_sector_cnt = 4;
+    fcb->f_scratch_cnt = 1;
+    fcb->f_sectors = test_fcb_area;
+    fcb->f_pre_erase = true;
+
+    rc = fcb_init(fcb);
+    TEST_ASSERT_FATAL(rc == 0);
+}
+
+static int
+fcb_test_pre_erase_fill(struct fcb *fcb)
+{
+    struct fcb_entry loc;
+    uint8_t test_data[128];
+    int cnt;
+    int rc;
+
+    memset(test_data, 0xa5, sizeof(test_data));
+    for (cnt = 0; ; cnt++) {
+        rc = fcb_append(fcb, sizeof(test_data), &loc);
+        if (rc == FCB_ERR_NOSPACE) {
+            break;
+        }
+        TEST_ASSERT_FATAL(rc == 0);
+        rc = fcb_write(fcb, &loc, test_data, sizeof(test_data));
+        TEST_ASSERT(rc == 0);
+        rc = fcb_append_finish(fcb, &loc);
+        TEST_ASSERT(rc == 0);
+    }
+    return cnt;
+}
+
+#endif
+
+TEST_CASE_TASK(fcb_test_pre_erase)
+{
+#if MYNEWT_VAL(FCB_PRE_ERASE)
+    struct fcb *fcb;
+    struct fcb_pre_erase_stats *stats;
+    int cnts[4];
+    struct append_arg aa_arg = {
+        .elem_cnts = cnts
+    };
+    bool empty;
+    int per_sector;
+    int rc;
+
+    fcb_test_wipe();
+    fcb = &test_fcb;
+    fcb_test_pre_erase_mount(fcb);
+    stats = &fcb->f_pre_erase_stats;
+
+    /* Sectors 0-2 get filled, sector 3 is the scratch. */
+    per_sector = fcb_test_pre_erase_fill(fcb) / 3;
+    TEST_ASSERT_FATAL(per_sector > 0);
+
+    /* Sector 0 is dropped at once, and erased by the flash worker. */
+    rc = fcb_rotate(fcb);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(fcb->f_oldest == &test_fcb_area[1]);
+    TEST_ASSERT(fcb->f_dirty_cnt == 1);
+
+    memset(cnts, 0, sizeof(cnts));
+    rc = fcb_walk(fcb, NULL, fcb_test_cnt_elems_cb, &aa_arg);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(cnts[0] == 0 && cnts[1] == per_sector);
+
+    /* The completion event is handled by the main task, which has priority. */
+    rc = hal_flash_op_wait(&fcb->f_erase_op, OS_TIMEOUT_NEVER);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(fcb->f_dirty_cnt == 0);
+    TEST_ASSERT(stats->fpes_erased == 1);
+    rc = flash_area_is_empty(&test_fcb_area[0], &empty);
+    TEST_ASSERT(rc == 0 && empty);
+
+    /* Sector 1 is dropped, but the worker does not get to run. */
+    rc = fcb_rotate(fcb);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(fcb->f_oldest == &test_fcb_area[2]);
+    TEST_ASSERT(fcb->f_dirty_cnt == 1);
+
+    /* Sectors 3 and 0 can be filled; 1 is left as scratch. */
+    rc = fcb_test_pre_erase_fill(fcb);
+    TEST_ASSERT(rc == 2 * per_sector);
+    TEST_ASSERT(fcb->f_dirty_cnt == 1);
+
+    /* Taking the scratch into use erases it inline. */
+    rc = fcb_append_to_scratch(fcb);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(fcb->f_active.fe_area == &test_fcb_area[1]);
+    TEST_ASSERT(fcb->f_dirty_cnt == 0);
+    TEST_ASSERT(stats->fpes_inline == 1);
+    TEST_ASSERT(stats->fpes_errs == 0);
+
+    rc = fcb_test_pre_erase_fill(fcb);
+    TEST_ASSERT(rc == per_sector);
+
+    /* A rotate with nothing to spare erases in place. */
+    rc = fcb_rotate(fcb);
+    TEST_ASSERT(rc == 0);
+    rc = fcb_rotate(fcb);
+    TEST_ASSERT(rc == 0);
+    rc = fcb_rotate(fcb);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(fcb->f_oldest == fcb->f_active.fe_area);
+    rc = fcb_flush(fcb);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(fcb->f_dirty_cnt == 0);
+
+    /* Everything dropped is gone after a remount. */
+    fcb_test_pre_erase_mount(fcb);
+    memset(cnts, 0, sizeof(cnts));
+    rc = fcb_walk(fcb, NULL, fcb_test_cnt_elems_cb, &aa_arg);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(cnts[0] == 0 && cnts[1] == per_sector &&
+                cnts[2] == 0 && cnts[3] == 0);
+#endif
+}
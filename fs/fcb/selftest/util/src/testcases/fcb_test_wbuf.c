@@ -0,0 +1,146 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "fcb_test/fcb_test.h"
+
+#if MYNEWT_VAL(FCB_WRITE_BUF)
+
+static uint8_t fcb_test_wbuf_mem[256];
+
+static void
+fcb_test_wbuf_mount(struct fcb *fcb)
+{
+    int rc;
+
+    memset(fcb, 0, sizeof(*fcb));
+    fcb->f_sector_cnt = 2;
+    fcb->f_sectors = test_fcb_area;
+    fcb->f_wbuf = fcb_test_wbuf_mem;
+    fcb->f_wbuf_size = sizeof(fcb_test_wbuf_mem);
+
+    rc = fcb_init(fcb);
+    TEST_ASSERT_FATAL(rc == 0);
+}
+
+static void
+fcb_test_wbuf_append(struct fcb *fcb, int len)
+{
+    struct fcb_entry loc;
+    uint8_t test_data[128];
+    int rc;
+    int i;
+
+    for (i = 0; i < len; i++) {
+        test_data[i] = fcb_test_append_data(len, i);
+    }
+    rc = fcb_append(fcb, len, &loc);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = fcb_write(fcb, &loc, test_data, len);
+    TEST_ASSERT(rc == 0);
+    rc = fcb_append_finish(fcb, &loc);
+    TEST_ASSERT(rc == 0);
+}
+
+#endif
+
+TEST_CASE_SELF(fcb_test_wbuf)
+{
+#if MYNEWT_VAL(FCB_WRITE_BUF)
+    struct fcb *fcb;
+    static uint8_t big_data[1000];
+    struct fcb_entry loc = {};
+    uint32_t data_off;
+    int var_cnt;
+    int elems;
+    int rc;
+    int i;
+
+    fcb_tc_pretest(2);
+
+    fcb = &test_fcb;
+    fcb_test_wbuf_mount(fcb);
+
+    /* Fills a bit over one buffer; the tail stays in RAM. */
+    for (i = 0; i < 20; i++) {
+        fcb_test_wbuf_append(fcb, 16);
+    }
+    rc = fcb_area_info(fcb, NULL, &elems, NULL);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(elems == 20);
+
+    /* Reading flushed the buffer, so a remount finds every entry. */
+    fcb_test_wbuf_mount(fcb);
+    rc = fcb_area_info(fcb, NULL, &elems, NULL);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(elems == 20);
+
+    /* Entries still in the buffer are lost without a flush. */
+    for (i = 0; i < 3; i++) {
+        fcb_test_wbuf_append(fcb, 16);
+    }
+    fcb_test_wbuf_mount(fcb);
+    rc = fcb_area_info(fcb, NULL, &elems, NULL);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(elems == 20);
+
+    for (i = 0; i < 3; i++) {
+        fcb_test_wbuf_append(fcb, 16);
+    }
+    rc = fcb_flush(fcb);
+    TEST_ASSERT(rc == 0);
+    fcb_test_wbuf_mount(fcb);
+    rc = fcb_area_info(fcb, NULL, &elems, NULL);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(elems == 23);
+
+    /* Entries of every size, straddling the ends of the buffer. */
+    fcb_tc_pretest(2);
+    fcb_test_wbuf_mount(fcb);
+    for (i = 0; i < 128; i++) {
+        fcb_test_wbuf_append(fcb, i);
+    }
+    var_cnt = 0;
+    rc = fcb_walk(fcb, NULL, fcb_test_data_walk_cb, &var_cnt);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(var_cnt == 128);
+
+    /* Entries larger than the buffer. */
+    for (i = 0; i < sizeof(big_data); i++) {
+        big_data[i] = i;
+    }
+    rc = fcb_append(fcb, sizeof(big_data), &loc);
+    TEST_ASSERT_FATAL(rc == 0);
+    data_off = loc.fe_data_off;
+    rc = fcb_write(fcb, &loc, big_data, sizeof(big_data));
+    TEST_ASSERT(rc == 0);
+    rc = fcb_append_finish(fcb, &loc);
+    TEST_ASSERT(rc == 0);
+    rc = fcb_flush(fcb);
+    TEST_ASSERT(rc == 0);
+
+    memset(big_data, 0, sizeof(big_data));
+    rc = flash_area_read(loc.fe_area, data_off, big_data, sizeof(big_data));
+    TEST_ASSERT(rc == 0);
+    for (i = 0; i < sizeof(big_data); i++) {
+        TEST_ASSERT(big_data[i] == (uint8_t)i);
+    }
+    rc = fcb_area_info(fcb, NULL, &elems, NULL);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(elems == 129);
+#endif
+}
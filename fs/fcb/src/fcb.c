@@ -29,6 +29,133 @@ fcb_start_offset(struct fcb *fcb)
     return fcb_len_in_flash(fcb, sizeof(struct fcb_disk_area));
 }
 
+#if MYNEWT_VAL(FCB_FAST_MOUNT)
+/* Bytes checked by each probe of the erased tail search. */
+#define FCB_PROBE_SZ    8
+
+/**
+ * Binary searches a sector for the start of its erased tail.  Entries are
+ * written back to back, so everything past the last one is erased.  A run
+ * of erased-looking bytes inside entry data can stop the search early;
+ * the result is only used to size reads, not to place the write pointer.
+ */
+static int
+fcb_find_erased_tail(struct fcb *fcb, struct flash_area *fap, uint32_t *offp)
+{
+    uint8_t buf[FCB_PROBE_SZ];
+    uint32_t lo;
+    uint32_t hi;
+    uint32_t mid;
+    uint32_t len;
+    int rc;
+
+    lo = fcb_start_offset(fcb) / fcb->f_align;
+    hi = fap->fa_size / fcb->f_align;
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        len = fap->fa_size - mid * fcb->f_align;
+        if (len > sizeof(buf)) {
+            len = sizeof(buf);
+        }
+        rc = flash_area_read_is_empty(fap, mid * fcb->f_align, buf, len);
+        if (rc < 0) {
+            return FCB_ERR_FLASH;
+        }
+        if (rc == 1) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    *offp = lo * fcb->f_align;
+
+    return 0;
+}
+
+/**
+ * Finds the write position and entry count of the active sector without
+ * reading entry data.  Entry headers are parsed out of reads of up to
+ * FCB_FAST_MOUNT_BUF_SIZE bytes, so a sector of small entries costs a few
+ * reads instead of several per entry.  Only the last entry is checked
+ * against its CRC.  The result is the same as walking the sector with
+ * fcb_getnext_in_area(): entries failing the CRC are counted and skipped
+ * there as well.
+ */
+static int
+fcb_mount_active(struct fcb *fcb)
+{
+    uint8_t buf[MYNEWT_VAL(FCB_FAST_MOUNT_BUF_SIZE)];
+    struct fcb_entry *active;
+    struct fcb_entry tail;
+    struct flash_area *fap;
+    uint32_t buf_off;
+    uint32_t buf_len;
+    uint32_t end;
+    uint32_t off;
+    uint32_t len;
+    uint16_t data_len;
+    uint8_t erased_val;
+    uint8_t *p;
+    int rc;
+
+    active = &fcb->f_active;
+    fap = active->fe_area;
+
+    rc = fcb_find_erased_tail(fcb, fap, &end);
+    if (rc) {
+        return rc;
+    }
+
+    erased_val = flash_area_erased_val(fap);
+    tail = *active;
+    buf_off = 0;
+    buf_len = 0;
+    off = active->fe_elem_off;
+    while (off + 2 <= fap->fa_size) {
+        if (off < buf_off || off + 2 > buf_off + buf_len) {
+            /* Past the erased tail only the length bytes are needed. */
+            if (end > off + 2) {
+                len = end - off;
+            } else {
+                len = 2;
+            }
+            if (len > sizeof(buf)) {
+                len = sizeof(buf);
+            }
+            if (len > fap->fa_size - off) {
+                len = fap->fa_size - off;
+            }
+            rc = flash_area_read(fap, off, buf, len);
+            if (rc) {
+                return FCB_ERR_FLASH;
+            }
+            buf_off = off;
+            buf_len = len;
+        }
+        p = &buf[off - buf_off];
+        if (p[0] == erased_val && p[1] == erased_val) {
+            break;
+        }
+        fcb_get_len(p, &data_len);
+        tail.fe_elem_off = off;
+        off += fcb_entry_total_len(fcb, data_len);
+        active->fe_elem_ix++;
+    }
+
+    if (active->fe_elem_ix) {
+        rc = fcb_elem_info(fcb, &tail);
+        if (rc && rc != FCB_ERR_CRC) {
+            return rc;
+        }
+        active->fe_data_off = tail.fe_data_off;
+        active->fe_data_len = tail.fe_data_len;
+    }
+    active->fe_elem_off = off;
+
+    return 0;
+}
+#endif
+
 int
 fcb_init(struct fcb *fcb)
 {
@@ -95,6 +222,18 @@ fcb_init(struct fcb *fcb)
      */
     assert((fcb->f_align & (fcb->f_align - 1)) == 0);
 
+    rc = fcb_wbuf_init(fcb);
+    if (rc) {
+        return rc;
+    }
+
+#if MYNEWT_VAL(FCB_PRE_ERASE)
+    fcb_pre_erase_init(fcb);
+#endif
+
+#if MYNEWT_VAL(FCB_FAST_MOUNT)
+    rc = fcb_mount_active(fcb);
+#else
     while (1) {
         rc = fcb_getnext_in_area(fcb, NULL, &fcb->f_active);
         if (rc == FCB_ERR_NOVAR) {
@@ -105,12 +244,33 @@ fcb_init(struct fcb *fcb)
             break;
         }
     }
+#endif
     fcb->f_active_sector_entry_count = fcb->f_active.fe_elem_ix;
 
     os_mutex_init(&fcb->f_mtx);
     return rc;
 }
 
+int
+fcb_flush(struct fcb *fcb)
+{
+    int rc;
+
+    rc = os_mutex_pend(&fcb->f_mtx, OS_WAIT_FOREVER);
+    if (rc && rc != OS_NOT_STARTED) {
+        return FCB_ERR_ARGS;
+    }
+
+    rc = fcb_wbuf_flush(fcb);
+    if (rc == 0) {
+        rc = fcb_pre_erase_sync(fcb);
+    }
+
+    os_mutex_release(&fcb->f_mtx);
+
+    return rc;
+}
+
 int
 fcb_free_sector_cnt(struct fcb *fcb)
 {
@@ -18,6 +18,7 @@
  */
 #include <stddef.h>
 
+#include "os/mynewt.h"
 #include "fcb/fcb.h"
 #include "fcb_priv.h"
 
@@ -56,6 +57,14 @@ fcb_append_to_scratch(struct fcb *fcb)
     if (!fa) {
         return FCB_ERR_NOSPACE;
     }
+    rc = fcb_wbuf_flush(fcb);
+    if (rc) {
+        return rc;
+    }
+    rc = fcb_pre_erase_take(fcb, fa);
+    if (rc) {
+        return rc;
+    }
     rc = fcb_sector_hdr_init(fcb, fa, fcb->f_active_id + 1);
     if (rc) {
         return rc;
@@ -71,7 +80,52 @@ fcb_write(struct fcb *fcb, struct fcb_entry *loc, const uint8_t *buf, size_t len
 {
     int rc;
 
-    rc = flash_area_write(loc->fe_area, loc->fe_data_off, buf, len);
+#if MYNEWT_VAL(FCB_WRITE_BUF)
+    /* Writes land in the shared write buffer. */
+    rc = os_mutex_pend(&fcb->f_mtx, OS_WAIT_FOREVER);
+    if (rc && rc != OS_NOT_STARTED) {
+        return FCB_ERR_ARGS;
+    }
+#endif
+
+    rc = fcb_flash_write(fcb, loc->fe_area, loc->fe_data_off, buf, len);
+    if (rc == 0) {
+        loc->fe_data_off += len;
+    }
+
+#if MYNEWT_VAL(FCB_WRITE_BUF)
+    os_mutex_release(&fcb->f_mtx);
+#endif
+
+    return rc;
+}
+
+int
+fcb_writev(struct fcb *fcb, struct fcb_entry *loc,
+           const struct os_iovec *iov, int iov_cnt)
+{
+    uint32_t len;
+    int rc;
+    int i;
+
+#if MYNEWT_VAL(FCB_WRITE_BUF)
+    if (fcb->f_wbuf) {
+        for (i = 0; i < iov_cnt; i++) {
+            rc = fcb_write(fcb, loc, iov[i].iov_base, iov[i].iov_len);
+            if (rc) {
+                return rc;
+            }
+        }
+        return 0;
+    }
+#endif
+
+    len = 0;
+    for (i = 0; i < iov_cnt; i++) {
+        len += iov[i].iov_len;
+    }
+
+    rc = flash_area_writev(loc->fe_area, loc->fe_data_off, iov, iov_cnt);
     if (rc == 0) {
         loc->fe_data_off += len;
     }
@@ -109,6 +163,14 @@ fcb_append(struct fcb *fcb, uint16_t len, struct fcb_entry *append_loc)
             rc = FCB_ERR_NOSPACE;
             goto err;
         }
+        rc = fcb_wbuf_flush(fcb);
+        if (rc) {
+            goto err;
+        }
+        rc = fcb_pre_erase_take(fcb, fa);
+        if (rc) {
+            goto err;
+        }
         rc = fcb_sector_hdr_init(fcb, fa, fcb->f_active_id + 1);
         if (rc) {
             goto err;
@@ -119,7 +181,8 @@ fcb_append(struct fcb *fcb, uint16_t len, struct fcb_entry *append_loc)
         fcb->f_active_sector_entry_count = 0;
     }
 
-    rc = flash_area_write(active->fe_area, active->fe_elem_off, tmp_str, cnt);
+    rc = fcb_flash_write(fcb, active->fe_area, active->fe_elem_off, tmp_str,
+                         cnt);
     if (rc) {
         rc = FCB_ERR_FLASH;
         goto err;
@@ -148,16 +211,27 @@ fcb_append_finish(struct fcb *fcb, struct fcb_entry *loc)
     uint8_t crc8;
     uint32_t off;
 
+#if MYNEWT_VAL(FCB_WRITE_BUF)
+    rc = os_mutex_pend(&fcb->f_mtx, OS_WAIT_FOREVER);
+    if (rc && rc != OS_NOT_STARTED) {
+        return FCB_ERR_ARGS;
+    }
+#endif
+
     fcb->f_active_sector_entry_count++;
     rc = fcb_elem_crc8(fcb, loc, &crc8);
     if (rc) {
-        return rc;
+        goto out;
     }
     off = loc->fe_data_off + fcb_len_in_flash(fcb, loc->fe_data_len);
 
-    rc = flash_area_write(loc->fe_area, off, &crc8, sizeof(crc8));
+    rc = fcb_flash_write(fcb, loc->fe_area, off, &crc8, sizeof(crc8));
     if (rc) {
-        return FCB_ERR_FLASH;
+        rc = FCB_ERR_FLASH;
     }
-    return 0;
+out:
+#if MYNEWT_VAL(FCB_WRITE_BUF)
+    os_mutex_release(&fcb->f_mtx);
+#endif
+    return rc;
 }
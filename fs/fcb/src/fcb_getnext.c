@@ -457,6 +457,12 @@ fcb_getnext_nolock(struct fcb *fcb, struct fcb_entry *loc)
 {
     int rc = 0;
 
+    /* Entries handed out are read with flash_area_read(). */
+    rc = fcb_wbuf_flush(fcb);
+    if (rc) {
+        return rc;
+    }
+
     do {
         rc = fcb_step(fcb, loc, rc);
         if (rc) {
@@ -0,0 +1,212 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <string.h>
+
+#include "os/mynewt.h"
+#include "fcb/fcb.h"
+#include "fcb_priv.h"
+
+#if MYNEWT_VAL(FCB_PRE_ERASE)
+
+/*
+ * With f_pre_erase set, fcb_rotate() only drops the oldest sector and the
+ * erase is left to the flash worker task.  Dropped sectors that have not
+ * been erased yet are the f_dirty_cnt sectors right before f_oldest; they
+ * are erased in order, one operation at a time.  Free sectors are taken
+ * into use right after f_active, so with f_scratch_cnt > 0 there is a full
+ * sector of appends to finish an erase before the sector is needed.  If it
+ * is needed earlier, the appending task waits for the erase, or does it
+ * itself.
+ *
+ * All state is protected by f_mtx.  Completion events are handled on the
+ * default event queue.
+ */
+
+static void fcb_pre_erase_done(struct os_event *ev);
+
+/*
+ * Returns the sector erased next: the first one dropped.
+ */
+static struct flash_area *
+fcb_pre_erase_first(struct fcb *fcb)
+{
+    int idx;
+
+    idx = fcb->f_oldest - fcb->f_sectors;
+    idx = (idx + fcb->f_sector_cnt - fcb->f_dirty_cnt) % fcb->f_sector_cnt;
+
+    return &fcb->f_sectors[idx];
+}
+
+/*
+ * Collects the result of a finished erase.
+ */
+static void
+fcb_pre_erase_reap(struct fcb *fcb)
+{
+    if (!fcb->f_erase_busy || hal_flash_op_busy(&fcb->f_erase_op)) {
+        return;
+    }
+    fcb->f_erase_busy = false;
+    if (fcb->f_erase_op.hfo_rc == 0) {
+        fcb->f_dirty_cnt--;
+        fcb->f_pre_erase_stats.fpes_erased++;
+    } else {
+        /* Not retried in the background; see fcb_pre_erase_take(). */
+        fcb->f_pre_erase_stats.fpes_errs++;
+    }
+}
+
+/*
+ * Starts erasing the next dropped sector, if there is one and the worker
+ * is not busy with this FCB.
+ */
+static void
+fcb_pre_erase_kick(struct fcb *fcb)
+{
+    struct flash_area *fap;
+    int rc;
+
+    if (fcb->f_erase_busy || fcb->f_dirty_cnt == 0) {
+        return;
+    }
+
+    fap = fcb_pre_erase_first(fcb);
+    rc = flash_area_erase_async(fap, 0, fap->fa_size, &fcb->f_erase_op);
+    if (rc == 0) {
+        fcb->f_erase_busy = true;
+    }
+}
+
+static void
+fcb_pre_erase_done(struct os_event *ev)
+{
+    struct fcb *fcb;
+    int rc;
+
+    fcb = ev->ev_arg;
+
+    rc = os_mutex_pend(&fcb->f_mtx, OS_WAIT_FOREVER);
+    if (rc && rc != OS_NOT_STARTED) {
+        return;
+    }
+
+    fcb_pre_erase_reap(fcb);
+    if (fcb->f_erase_op.hfo_rc == 0) {
+        fcb_pre_erase_kick(fcb);
+    }
+
+    os_mutex_release(&fcb->f_mtx);
+}
+
+void
+fcb_pre_erase_init(struct fcb *fcb)
+{
+    fcb->f_dirty_cnt = 0;
+    fcb->f_erase_busy = false;
+    memset(&fcb->f_pre_erase_stats, 0, sizeof(fcb->f_pre_erase_stats));
+    hal_flash_op_init(&fcb->f_erase_op, os_eventq_dflt_get(),
+                      fcb_pre_erase_done, fcb);
+}
+
+void
+fcb_pre_erase_queue(struct fcb *fcb)
+{
+    fcb->f_dirty_cnt++;
+    fcb_pre_erase_kick(fcb);
+}
+
+/*
+ * Erases the first dropped sector in the caller's context.  An erase the
+ * worker has not started yet is withdrawn rather than waited for, so the
+ * caller does not depend on the low priority worker getting to run.
+ */
+static int
+fcb_pre_erase_one(struct fcb *fcb)
+{
+    struct flash_area *fap;
+    int rc;
+
+    if (fcb->f_erase_busy) {
+        hal_flash_op_cancel(&fcb->f_erase_op);
+        if (fcb->f_erase_op.hfo_state == HAL_FLASH_OP_IDLE) {
+            fcb->f_erase_busy = false;
+        } else {
+            if (hal_flash_op_busy(&fcb->f_erase_op)) {
+                fcb->f_pre_erase_stats.fpes_waits++;
+                hal_flash_op_wait(&fcb->f_erase_op, OS_TIMEOUT_NEVER);
+            }
+            fcb_pre_erase_reap(fcb);
+            if (fcb->f_erase_op.hfo_rc == 0) {
+                return 0;
+            }
+        }
+    }
+
+    fap = fcb_pre_erase_first(fcb);
+    rc = flash_area_erase(fap, 0, fap->fa_size);
+    if (rc) {
+        return FCB_ERR_FLASH;
+    }
+    fcb->f_dirty_cnt--;
+    fcb->f_pre_erase_stats.fpes_inline++;
+
+    return 0;
+}
+
+int
+fcb_pre_erase_take(struct fcb *fcb, struct flash_area *fap)
+{
+    int rc;
+
+    if (fcb->f_dirty_cnt == 0) {
+        return 0;
+    }
+
+    fcb_pre_erase_reap(fcb);
+    if (fcb->f_dirty_cnt > 0 && fap == fcb_pre_erase_first(fcb)) {
+        rc = fcb_pre_erase_one(fcb);
+        if (rc) {
+            return rc;
+        }
+    }
+    fcb_pre_erase_kick(fcb);
+
+    return 0;
+}
+
+int
+fcb_pre_erase_sync(struct fcb *fcb)
+{
+    int rc;
+
+    while (fcb->f_dirty_cnt > 0) {
+        rc = fcb_pre_erase_one(fcb);
+        if (rc) {
+            return rc;
+        }
+    }
+
+    /* Nothing left to report; the FCB may be re-initialized after this. */
+    os_eventq_remove(os_eventq_dflt_get(), &fcb->f_erase_op.hfo_ev);
+
+    return 0;
+}
+
+#endif
@@ -70,6 +70,80 @@ int fcb_sector_hdr_read(struct fcb *, struct flash_area *fap,
  */
 int fcb_entry_total_len(struct fcb *fcb, int len);
 
+#if MYNEWT_VAL(FCB_WRITE_BUF)
+/*
+ * Flash access for entries of the active sector.  Writes go through the
+ * write buffer, and reads see data still held in it.  Return values are
+ * those of flash_area_write(), flash_area_read() and
+ * flash_area_read_is_empty().
+ */
+int fcb_flash_write(struct fcb *fcb, struct flash_area *fap, uint32_t off,
+                    const void *src, uint32_t len);
+int fcb_flash_read(struct fcb *fcb, struct flash_area *fap, uint32_t off,
+                   void *dst, uint32_t len);
+int fcb_flash_read_is_empty(struct fcb *fcb, struct flash_area *fap,
+                            uint32_t off, void *dst, uint32_t len);
+
+int fcb_wbuf_init(struct fcb *fcb);
+int fcb_wbuf_flush(struct fcb *fcb);
+int fcb_wbuf_sysdown(int reason);
+#else
+static inline int
+fcb_flash_write(struct fcb *fcb, struct flash_area *fap, uint32_t off,
+                const void *src, uint32_t len)
+{
+    return flash_area_write(fap, off, src, len);
+}
+
+static inline int
+fcb_flash_read(struct fcb *fcb, struct flash_area *fap, uint32_t off,
+               void *dst, uint32_t len)
+{
+    return flash_area_read(fap, off, dst, len);
+}
+
+static inline int
+fcb_flash_read_is_empty(struct fcb *fcb, struct flash_area *fap,
+                        uint32_t off, void *dst, uint32_t len)
+{
+    return flash_area_read_is_empty(fap, off, dst, len);
+}
+
+static inline int
+fcb_wbuf_init(struct fcb *fcb)
+{
+    return 0;
+}
+
+static inline int
+fcb_wbuf_flush(struct fcb *fcb)
+{
+    return 0;
+}
+#endif
+
+#if MYNEWT_VAL(FCB_PRE_ERASE)
+void fcb_pre_erase_init(struct fcb *fcb);
+void fcb_pre_erase_queue(struct fcb *fcb);
+/*
+ * Makes sure a free sector about to become the active one is erased.
+ */
+int fcb_pre_erase_take(struct fcb *fcb, struct flash_area *fap);
+int fcb_pre_erase_sync(struct fcb *fcb);
+#else
+static inline int
+fcb_pre_erase_take(struct fcb *fcb, struct flash_area *fap)
+{
+    return 0;
+}
+
+static inline int
+fcb_pre_erase_sync(struct fcb *fcb)
+{
+    return 0;
+}
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -31,6 +31,26 @@ fcb_rotate(struct fcb *fcb)
         return FCB_ERR_ARGS;
     }
 
+    rc = fcb_wbuf_flush(fcb);
+    if (rc) {
+        goto out;
+    }
+
+#if MYNEWT_VAL(FCB_PRE_ERASE)
+    if (fcb->f_pre_erase && fcb->f_oldest != fcb->f_active.fe_area) {
+        /* Leave the erase to the flash worker task. */
+        fcb->f_oldest = fcb_getnext_area(fcb, fcb->f_oldest);
+        fcb_pre_erase_queue(fcb);
+        goto out;
+    }
+#endif
+
+    /* Dropped sectors must be erased before the active one moves on. */
+    rc = fcb_pre_erase_sync(fcb);
+    if (rc) {
+        goto out;
+    }
+
     rc = flash_area_erase(fcb->f_oldest, 0, fcb->f_oldest->fa_size);
     if (rc) {
         rc = FCB_ERR_FLASH;
@@ -0,0 +1,237 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <string.h>
+
+#include "os/mynewt.h"
+#include "sysdown/sysdown.h"
+#include "fcb/fcb.h"
+#include "fcb_priv.h"
+
+#if MYNEWT_VAL(FCB_WRITE_BUF)
+
+/* FCBs with a write buffer, flushed at sysdown. */
+static SLIST_HEAD(, fcb) fcb_wbuf_list = SLIST_HEAD_INITIALIZER(fcb_wbuf_list);
+
+int
+fcb_wbuf_init(struct fcb *fcb)
+{
+    struct fcb *cur;
+
+    fcb->f_wbuf_len = 0;
+    fcb->f_wbuf_area = NULL;
+    if (!fcb->f_wbuf) {
+        return 0;
+    }
+    if (fcb->f_wbuf_size < fcb->f_align ||
+        fcb->f_wbuf_size % fcb->f_align) {
+        return FCB_ERR_ARGS;
+    }
+
+    SLIST_FOREACH(cur, &fcb_wbuf_list, f_wbuf_next) {
+        if (cur == fcb) {
+            return 0;
+        }
+    }
+    SLIST_INSERT_HEAD(&fcb_wbuf_list, fcb, f_wbuf_next);
+
+    return 0;
+}
+
+/*
+ * Area offset where the buffer has to be written out: the next multiple of
+ * f_wbuf_size in flash, so that full buffers program whole pages.
+ */
+static uint32_t
+fcb_wbuf_end(const struct fcb *fcb)
+{
+    uint32_t addr;
+
+    addr = fcb->f_wbuf_area->fa_off + fcb->f_wbuf_off;
+    return fcb->f_wbuf_off + fcb->f_wbuf_size - addr % fcb->f_wbuf_size;
+}
+
+static bool
+fcb_wbuf_overlaps(const struct fcb *fcb, const struct flash_area *fap,
+                  uint32_t off, uint32_t len)
+{
+    return fcb->f_wbuf_len && fap == fcb->f_wbuf_area &&
+           off < fcb->f_wbuf_off + fcb->f_wbuf_len &&
+           off + len > fcb->f_wbuf_off;
+}
+
+int
+fcb_wbuf_flush(struct fcb *fcb)
+{
+    int rc;
+
+    if (!fcb->f_wbuf_len) {
+        return 0;
+    }
+
+    rc = flash_area_write(fcb->f_wbuf_area, fcb->f_wbuf_off, fcb->f_wbuf,
+                          fcb->f_wbuf_len);
+    fcb->f_wbuf_len = 0;
+    if (rc) {
+        return FCB_ERR_FLASH;
+    }
+
+    return 0;
+}
+
+int
+fcb_flash_write(struct fcb *fcb, struct flash_area *fap, uint32_t off,
+                const void *src, uint32_t len)
+{
+    const uint8_t *u8p;
+    uint32_t addr;
+    uint32_t end;
+    uint32_t n;
+    int rc;
+
+    if (!fcb->f_wbuf || off + len > fap->fa_size) {
+        rc = fcb_wbuf_flush(fcb);
+        if (rc) {
+            return rc;
+        }
+        return flash_area_write(fap, off, src, len);
+    }
+
+    u8p = src;
+    while (len > 0) {
+        if (fcb->f_wbuf_len) {
+            /*
+             * Keep filling the buffer if this write follows it.  Entry
+             * fields start aligned, so the only gap allowed is the padding
+             * at the end of an alignment unit, which the flash driver would
+             * fill with the erased value anyway.
+             */
+            end = fcb->f_wbuf_off + fcb->f_wbuf_len;
+            if (fap != fcb->f_wbuf_area || off < end ||
+                off - end >= fcb->f_align || off >= fcb_wbuf_end(fcb)) {
+                rc = fcb_wbuf_flush(fcb);
+                if (rc) {
+                    return rc;
+                }
+            } else {
+                memset(fcb->f_wbuf + fcb->f_wbuf_len,
+                       flash_area_erased_val(fap), off - end);
+                fcb->f_wbuf_len += off - end;
+            }
+        }
+
+        if (!fcb->f_wbuf_len) {
+            /* Whole pages need not be copied. */
+            addr = fap->fa_off + off;
+            if (addr % fcb->f_wbuf_size == 0 && len >= fcb->f_wbuf_size) {
+                n = len - len % fcb->f_wbuf_size;
+                rc = flash_area_write(fap, off, u8p, n);
+                if (rc) {
+                    return rc;
+                }
+                off += n;
+                u8p += n;
+                len -= n;
+                continue;
+            }
+            fcb->f_wbuf_area = fap;
+            fcb->f_wbuf_off = off;
+        }
+
+        n = min(len, fcb_wbuf_end(fcb) - off);
+        memcpy(fcb->f_wbuf + fcb->f_wbuf_len, u8p, n);
+        fcb->f_wbuf_len += n;
+        off += n;
+        u8p += n;
+        len -= n;
+
+        if (off == fcb_wbuf_end(fcb)) {
+            rc = fcb_wbuf_flush(fcb);
+            if (rc) {
+                return rc;
+            }
+        }
+    }
+
+    return 0;
+}
+
+int
+fcb_flash_read(struct fcb *fcb, struct flash_area *fap, uint32_t off,
+               void *dst, uint32_t len)
+{
+    uint32_t start;
+    uint32_t end;
+    int rc;
+
+    rc = flash_area_read(fap, off, dst, len);
+    if (rc || !fcb_wbuf_overlaps(fcb, fap, off, len)) {
+        return rc;
+    }
+
+    /* Flash is still erased where the buffer goes; copy over it. */
+    start = max(off, fcb->f_wbuf_off);
+    end = min(off + len, fcb->f_wbuf_off + fcb->f_wbuf_len);
+    memcpy((uint8_t *)dst + (start - off),
+           fcb->f_wbuf + (start - fcb->f_wbuf_off), end - start);
+
+    return 0;
+}
+
+int
+fcb_flash_read_is_empty(struct fcb *fcb, struct flash_area *fap,
+                        uint32_t off, void *dst, uint32_t len)
+{
+    const uint8_t *u8p;
+    uint8_t erased_val;
+    uint32_t i;
+    int rc;
+
+    if (!fcb_wbuf_overlaps(fcb, fap, off, len)) {
+        return flash_area_read_is_empty(fap, off, dst, len);
+    }
+
+    rc = fcb_flash_read(fcb, fap, off, dst, len);
+    if (rc) {
+        return -1;
+    }
+
+    u8p = dst;
+    erased_val = flash_area_erased_val(fap);
+    for (i = 0; i < len; i++) {
+        if (u8p[i] != erased_val) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+int
+fcb_wbuf_sysdown(int reason)
+{
+    struct fcb *fcb;
+
+    SLIST_FOREACH(fcb, &fcb_wbuf_list, f_wbuf_next) {
+        fcb_flush(fcb);
+    }
+
+    return SYSDOWN_COMPLETE;
+}
+
+#endif
@@ -35,6 +35,9 @@ extern "C" {
 #include <syscfg/syscfg.h>
 #include <os/os_mutex.h>
 #include <flash_map/flash_map.h>
+#if MYNEWT_VAL(FCB2_PRE_ERASE)
+#include <hal/hal_flash_async.h>
+#endif
 
 #define FCB2_MAX_LEN	(CHAR_MAX | CHAR_MAX << 7) /* Max length of element */
 
@@ -57,6 +60,28 @@ struct fcb2_entry {
 #define FCB2_ENTRY_SIZE          6
 #define FCB2_CRC_LEN             2
 
+#if MYNEWT_VAL(FCB2_PRE_ERASE)
+/**
+ * Background erase counters of an FCB with f_pre_erase set.
+ */
+struct fcb2_pre_erase_stats {
+    /** The number of sectors erased by the flash worker task. */
+    uint32_t fpes_erased;
+    /**
+     * The number of times a sector was needed while the worker was still
+     * erasing it, and the caller waited.
+     */
+    uint32_t fpes_waits;
+    /**
+     * The number of sectors erased by the caller, because they were needed
+     * before the worker got to them or after it failed.
+     */
+    uint32_t fpes_inline;
+    /** The number of background erases that failed. */
+    uint32_t fpes_errs;
+};
+#endif
+
 /**
  * State structure for flash circular buffer version2.
  */
@@ -69,11 +94,21 @@ struct fcb2 {
     uint16_t f_sector_cnt;  /* Number of sectors used by fcb */
     uint16_t f_oldest_sec;  /* Index of oldest sector */
     struct flash_sector_range *f_ranges;
+#if MYNEWT_VAL(FCB2_PRE_ERASE)
+    /** Erase rotated sectors in the background; see fcb2_rotate(). */
+    bool f_pre_erase;
+#endif
 
     /* Flash circular buffer internal state */
     struct os_mutex f_mtx;	/* Locking for accessing the FCB data */
     struct fcb2_entry f_active;
     uint16_t f_active_id;
+#if MYNEWT_VAL(FCB2_PRE_ERASE)
+    uint16_t f_dirty_cnt;   /* rotated sectors before f_oldest_sec to erase */
+    bool f_erase_busy;      /* f_erase_op submitted, result not seen */
+    struct hal_flash_op f_erase_op;
+    struct fcb2_pre_erase_stats f_pre_erase_stats;
+#endif
 };
 
 /**
@@ -224,12 +259,34 @@ int fcb2_read(struct fcb2_entry *loc, uint16_t off, void *buf, uint16_t len);
 /**
  * Erases the data from oldest sector.
  *
+ * With FCB2_PRE_ERASE and f_pre_erase set, the sector is only dropped here
+ * and erased later by the flash worker task (HAL_FLASH_ASYNC), so rotation
+ * does not block the caller for the erase time.  The sector is not reused
+ * until it has been erased.  Keep f_scratch_cnt at 1 or more so that the
+ * worker has a full sector of appends to finish before the sector is next
+ * needed; f_pre_erase_stats tells how often appends still had to wait.
+ * If the device resets before the erase, the dropped sector is found again
+ * as the oldest at the next fcb2_init().
+ *
  * @param fcb            FCB where to erase the sector
  *
  * @return 0 on success. Otherwise one of FCB2_XXX error codes.
  */
 int fcb2_rotate(struct fcb2 *fcb);
 
+/**
+ * Finish background erases.
+ *
+ * With FCB2_PRE_ERASE, this erases the sectors dropped by fcb2_rotate()
+ * that the flash worker has not erased yet.  An FCB with f_pre_erase set
+ * must be flushed before it is initialized again.
+ *
+ * @param fcb            FCB to flush
+ *
+ * @return 0 on success. Otherwise one of FCB2_XXX error codes.
+ */
+int fcb2_flush(struct fcb2 *fcb);
+
 /**
  * Start using the scratch block.
  *
@@ -16,8 +16,8 @@
  * specific language governing permissions and limitations
  * under the License.
  */
-#ifndef _FCB_TEST_H
-#define _FCB_TEST_H
+#ifndef _FCB2_TEST_H
+#define _FCB2_TEST_H
 
 #include <stdio.h>
 #include <string.h>
@@ -26,7 +26,7 @@
 #include "testutil/testutil.h"
 
 #include "fcb/fcb2.h"
-#include "fcb_priv.h"
+#include "fcb/../../src/fcb_priv.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -49,7 +49,9 @@ void fcb_tc_pretest(uint8_t sector_count);
 /* Inits fcb without wiping flash */
 int fcb_tc_init_fcb(uint8_t sector_count);
 
+TEST_SUITE_DECL(fcb_test_all);
+
 #ifdef __cplusplus
 }
 #endif
-#endif /* _FCB_TEST_H */
+#endif /* _FCB2_TEST_H */
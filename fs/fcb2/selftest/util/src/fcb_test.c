@@ -23,10 +23,7 @@
 #include "os/mynewt.h"
 #include "testutil/testutil.h"
 
-#include "fcb/fcb2.h"
-#include "fcb_priv.h"
-
-#include "fcb_test.h"
+#include "fcb2_test/fcb2_test.h"
 
 #include "flash_map/flash_map.h"
 
@@ -150,6 +147,7 @@ TEST_CASE_DECL(fcb_test_multiple_scratch)
 TEST_CASE_DECL(fcb_test_last_of_n)
 TEST_CASE_DECL(fcb_test_area_info)
 TEST_CASE_DECL(fcb_test_getprev)
+TEST_CASE_DECL(fcb_test_pre_erase)
 
 TEST_SUITE(fcb_test_all)
 {
@@ -165,11 +163,5 @@ TEST_SUITE(fcb_test_all)
     fcb_test_last_of_n();
     fcb_test_area_info();
     fcb_test_getprev();
-}
-
-int
-main(int argc, char **argv)
-{
-    fcb_test_all();
-    return tu_any_failed;
+    fcb_test_pre_erase();
 }
@@ -0,0 +1,149 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "fcb2_test/fcb2_test.h"
+
+#if MYNEWT_VAL(FCB2_PRE_ERASE)
+
+static void
+fcb_test_pre_erase_mount(struct fcb2 *fcb)
+{
+    int rc;
+
+    memset(fcb, 0, sizeof(*fcb));
+    fcb->f_sector_cnt = 4;
+    fcb->f_scratch_cnt = 1;
+    fcb->f_ranges = test_fcb_ranges;
+    fcb->f_range_cnt = 1;
+    fcb->f_pre_erase = true;
+    test_fcb_ranges[0].fsr_sector_count = 4;
+    test_fcb_ranges[0].fsr_flash_area.fa_size =
+        test_fcb_ranges[0].fsr_sector_size * 4;
+
+    rc = fcb2_init(fcb);
+    TEST_ASSERT_FATAL(rc == 0);
+}
+
+static int
+fcb_test_pre_erase_fill(struct fcb2 *fcb)
+{
+    struct fcb2_entry loc;
+    uint8_t test_data[128];
+    int cnt;
+    int rc;
+
+    memset(test_data, 0xa5, sizeof(test_data));
+    for (cnt = 0; ; cnt++) {
+        rc = fcb2_append(fcb, sizeof(test_data), &loc);
+        if (rc == FCB2_ERR_NOSPACE) {
+            break;
+        }
+        TEST_ASSERT_FATAL(rc == 0);
+        rc = fcb2_write(&loc, 0, test_data, sizeof(test_data));
+        TEST_ASSERT(rc == 0);
+        rc = fcb2_append_finish(&loc);
+        TEST_ASSERT(rc == 0);
+    }
+    return cnt;
+}
+
+#endif
+
+TEST_CASE_TASK(fcb_test_pre_erase)
+{
+#if MYNEWT_VAL(FCB2_PRE_ERASE)
+    struct fcb2 *fcb;
+    struct fcb2_pre_erase_stats *stats;
+    int cnts[4];
+    struct append_arg aa_arg = {
+        .elem_cnts = cnts
+    };
+    int per_sector;
+    int rc;
+
+    fcb_test_wipe();
+    fcb = &test_fcb;
+    fcb_test_pre_erase_mount(fcb);
+    stats = &fcb->f_pre_erase_stats;
+
+    /* Sectors 0-2 get filled, sector 3 is the scratch. */
+    per_sector = fcb_test_pre_erase_fill(fcb) / 3;
+    TEST_ASSERT_FATAL(per_sector > 0);
+
+    /* Sector 0 is dropped at once, and erased by the flash worker. */
+    rc = fcb2_rotate(fcb);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(fcb->f_oldest_sec == 1);
+    TEST_ASSERT(fcb->f_dirty_cnt == 1);
+
+    memset(cnts, 0, sizeof(cnts));
+    rc = fcb2_walk(fcb, FCB2_SECTOR_OLDEST, fcb_test_cnt_elems_cb, &aa_arg);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(cnts[0] == 0 && cnts[1] == per_sector);
+
+    /* The completion event is handled by the main task, which has priority. */
+    rc = hal_flash_op_wait(&fcb->f_erase_op, OS_TIMEOUT_NEVER);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(fcb->f_dirty_cnt == 0);
+    TEST_ASSERT(stats->fpes_erased == 1);
+    rc = fcb2_sector_hdr_read(fcb, test_fcb_ranges, 0, NULL);
+    TEST_ASSERT(rc == 0);
+
+    /* Sector 1 is dropped, but the worker does not get to run. */
+    rc = fcb2_rotate(fcb);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(fcb->f_oldest_sec == 2);
+    TEST_ASSERT(fcb->f_dirty_cnt == 1);
+
+    /* Sectors 3 and 0 can be filled; 1 is left as scratch. */
+    rc = fcb_test_pre_erase_fill(fcb);
+    TEST_ASSERT(rc == 2 * per_sector);
+    TEST_ASSERT(fcb->f_dirty_cnt == 1);
+
+    /* Taking the scratch into use erases it inline. */
+    rc = fcb2_append_to_scratch(fcb);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(fcb->f_active.fe_sector == 1);
+    TEST_ASSERT(fcb->f_dirty_cnt == 0);
+    TEST_ASSERT(stats->fpes_inline == 1);
+    TEST_ASSERT(stats->fpes_errs == 0);
+
+    rc = fcb_test_pre_erase_fill(fcb);
+    TEST_ASSERT(rc == per_sector);
+
+    /* A rotate with nothing to spare erases in place. */
+    rc = fcb2_rotate(fcb);
+    TEST_ASSERT(rc == 0);
+    rc = fcb2_rotate(fcb);
+    TEST_ASSERT(rc == 0);
+    rc = fcb2_rotate(fcb);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(fcb->f_oldest_sec == fcb->f_active.fe_sector);
+    rc = fcb2_flush(fcb);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(fcb->f_dirty_cnt == 0);
+
+    /* Everything dropped is gone after a remount. */
+    fcb_test_pre_erase_mount(fcb);
+    memset(cnts, 0, sizeof(cnts));
+    rc = fcb2_walk(fcb, FCB2_SECTOR_OLDEST, fcb_test_cnt_elems_cb, &aa_arg);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(cnts[0] == 0 && cnts[1] == per_sector &&
+                cnts[2] == 0 && cnts[3] == 0);
+#endif
+}
@@ -86,6 +86,9 @@ fcb2_init(struct fcb2 *fcb)
         fcb2_len_in_flash(newest_srp, sizeof(struct fcb2_disk_area));
     fcb->f_active.fe_entry_num = 0;
     fcb->f_active_id = newest;
+#if MYNEWT_VAL(FCB2_PRE_ERASE)
+    fcb2_pre_erase_init(fcb);
+#endif
 
     while (1) {
         rc = fcb2_getnext_in_area(fcb, &fcb->f_active);
@@ -101,6 +104,23 @@ fcb2_init(struct fcb2 *fcb)
     return rc;
 }
 
+int
+fcb2_flush(struct fcb2 *fcb)
+{
+    int rc;
+
+    rc = os_mutex_pend(&fcb->f_mtx, OS_WAIT_FOREVER);
+    if (rc && rc != OS_NOT_STARTED) {
+        return FCB2_ERR_ARGS;
+    }
+
+    rc = fcb2_pre_erase_sync(fcb);
+
+    os_mutex_release(&fcb->f_mtx);
+
+    return rc;
+}
+
 int
 fcb2_free_sector_cnt(struct fcb2 *fcb)
 {
@@ -57,6 +57,10 @@ fcb2_append_to_scratch(struct fcb2 *fcb)
     if (sector < 0) {
         return FCB2_ERR_NOSPACE;
     }
+    rc = fcb2_pre_erase_take(fcb, sector);
+    if (rc) {
+        return rc;
+    }
     rc = fcb2_sector_hdr_init(fcb, sector, fcb->f_active_id + 1);
     if (rc) {
         return rc;
@@ -190,6 +194,10 @@ fcb2_append(struct fcb2 *fcb, uint16_t len, struct fcb2_entry *append_loc)
             rc = FCB2_ERR_NOSPACE;
             goto err;
         }
+        rc = fcb2_pre_erase_take(fcb, sector);
+        if (rc) {
+            goto err;
+        }
         rc = fcb2_sector_hdr_init(fcb, sector, fcb->f_active_id + 1);
         if (rc) {
             goto err;
@@ -0,0 +1,213 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <string.h>
+
+#include "os/mynewt.h"
+#include "fcb/fcb2.h"
+#include "fcb_priv.h"
+
+#if MYNEWT_VAL(FCB2_PRE_ERASE)
+
+/*
+ * With f_pre_erase set, fcb2_rotate() only drops the oldest sector and the
+ * erase is left to the flash worker task.  Dropped sectors that have not
+ * been erased yet are the f_dirty_cnt sectors right before f_oldest_sec;
+ * they are erased in order, one operation at a time.  Free sectors are
+ * taken into use right after the active one, so with f_scratch_cnt > 0
+ * there is a full sector of appends to finish an erase before the sector
+ * is needed.  If it is needed earlier, the appending task waits for the
+ * erase, or does it itself.
+ *
+ * All state is protected by f_mtx.  Completion events are handled on the
+ * default event queue.
+ */
+
+static void fcb2_pre_erase_done(struct os_event *ev);
+
+/*
+ * Returns the sector erased next: the first one dropped.
+ */
+static int
+fcb2_pre_erase_first(struct fcb2 *fcb)
+{
+    return (fcb->f_oldest_sec + fcb->f_sector_cnt - fcb->f_dirty_cnt) %
+           fcb->f_sector_cnt;
+}
+
+/*
+ * Collects the result of a finished erase.
+ */
+static void
+fcb2_pre_erase_reap(struct fcb2 *fcb)
+{
+    if (!fcb->f_erase_busy || hal_flash_op_busy(&fcb->f_erase_op)) {
+        return;
+    }
+    fcb->f_erase_busy = false;
+    if (fcb->f_erase_op.hfo_rc == 0) {
+        fcb->f_dirty_cnt--;
+        fcb->f_pre_erase_stats.fpes_erased++;
+    } else {
+        /* Not retried in the background; see fcb2_pre_erase_take(). */
+        fcb->f_pre_erase_stats.fpes_errs++;
+    }
+}
+
+/*
+ * Starts erasing the next dropped sector, if there is one and the worker
+ * is not busy with this FCB.
+ */
+static void
+fcb2_pre_erase_kick(struct fcb2 *fcb)
+{
+    struct fcb2_sector_info info;
+    struct flash_sector_range *range;
+    int rc;
+
+    if (fcb->f_erase_busy || fcb->f_dirty_cnt == 0) {
+        return;
+    }
+
+    rc = fcb2_get_sector_info(fcb, fcb2_pre_erase_first(fcb), &info);
+    if (rc) {
+        return;
+    }
+    range = info.si_range;
+    rc = flash_area_erase_async(&range->fsr_flash_area,
+        info.si_sector_in_range * range->fsr_sector_size,
+        range->fsr_sector_size, &fcb->f_erase_op);
+    if (rc == 0) {
+        fcb->f_erase_busy = true;
+    }
+}
+
+static void
+fcb2_pre_erase_done(struct os_event *ev)
+{
+    struct fcb2 *fcb;
+    int rc;
+
+    fcb = ev->ev_arg;
+
+    rc = os_mutex_pend(&fcb->f_mtx, OS_WAIT_FOREVER);
+    if (rc && rc != OS_NOT_STARTED) {
+        return;
+    }
+
+    fcb2_pre_erase_reap(fcb);
+    if (fcb->f_erase_op.hfo_rc == 0) {
+        fcb2_pre_erase_kick(fcb);
+    }
+
+    os_mutex_release(&fcb->f_mtx);
+}
+
+void
+fcb2_pre_erase_init(struct fcb2 *fcb)
+{
+    fcb->f_dirty_cnt = 0;
+    fcb->f_erase_busy = false;
+    memset(&fcb->f_pre_erase_stats, 0, sizeof(fcb->f_pre_erase_stats));
+    hal_flash_op_init(&fcb->f_erase_op, os_eventq_dflt_get(),
+                      fcb2_pre_erase_done, fcb);
+}
+
+void
+fcb2_pre_erase_queue(struct fcb2 *fcb)
+{
+    fcb->f_dirty_cnt++;
+    fcb2_pre_erase_kick(fcb);
+}
+
+/*
+ * Erases the first dropped sector in the caller's context.  An erase the
+ * worker has not started yet is withdrawn rather than waited for, so the
+ * caller does not depend on the low priority worker getting to run.
+ */
+static int
+fcb2_pre_erase_one(struct fcb2 *fcb)
+{
+    int rc;
+
+    if (fcb->f_erase_busy) {
+        hal_flash_op_cancel(&fcb->f_erase_op);
+        if (fcb->f_erase_op.hfo_state == HAL_FLASH_OP_IDLE) {
+            fcb->f_erase_busy = false;
+        } else {
+            if (hal_flash_op_busy(&fcb->f_erase_op)) {
+                fcb->f_pre_erase_stats.fpes_waits++;
+                hal_flash_op_wait(&fcb->f_erase_op, OS_TIMEOUT_NEVER);
+            }
+            fcb2_pre_erase_reap(fcb);
+            if (fcb->f_erase_op.hfo_rc == 0) {
+                return 0;
+            }
+        }
+    }
+
+    rc = fcb2_sector_erase(fcb, fcb2_pre_erase_first(fcb));
+    if (rc) {
+        return FCB2_ERR_FLASH;
+    }
+    fcb->f_dirty_cnt--;
+    fcb->f_pre_erase_stats.fpes_inline++;
+
+    return 0;
+}
+
+int
+fcb2_pre_erase_take(struct fcb2 *fcb, int sector)
+{
+    int rc;
+
+    if (fcb->f_dirty_cnt == 0) {
+        return 0;
+    }
+
+    fcb2_pre_erase_reap(fcb);
+    if (fcb->f_dirty_cnt > 0 && sector == fcb2_pre_erase_first(fcb)) {
+        rc = fcb2_pre_erase_one(fcb);
+        if (rc) {
+            return rc;
+        }
+    }
+    fcb2_pre_erase_kick(fcb);
+
+    return 0;
+}
+
+int
+fcb2_pre_erase_sync(struct fcb2 *fcb)
+{
+    int rc;
+
+    while (fcb->f_dirty_cnt > 0) {
+        rc = fcb2_pre_erase_one(fcb);
+        if (rc) {
+            return rc;
+        }
+    }
+
+    /* Nothing left to report; the FCB may be re-initialized after this. */
+    os_eventq_remove(os_eventq_dflt_get(), &fcb->f_erase_op.hfo_ev);
+
+    return 0;
+}
+
+#endif
@@ -118,6 +118,28 @@ int fcb2_write_to_sector(struct fcb2_entry *loc, int off,
  */
 int fcb2_read_from_sector(struct fcb2_entry *loc, int off, void *buf, int len);
 
+#if MYNEWT_VAL(FCB2_PRE_ERASE)
+void fcb2_pre_erase_init(struct fcb2 *fcb);
+void fcb2_pre_erase_queue(struct fcb2 *fcb);
+/*
+ * Makes sure a free sector about to become the active one is erased.
+ */
+int fcb2_pre_erase_take(struct fcb2 *fcb, int sector);
+int fcb2_pre_erase_sync(struct fcb2 *fcb);
+#else
+static inline int
+fcb2_pre_erase_take(struct fcb2 *fcb, int sector)
+{
+    return 0;
+}
+
+static inline int
+fcb2_pre_erase_sync(struct fcb2 *fcb)
+{
+    return 0;
+}
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -32,6 +32,21 @@ fcb2_rotate(struct fcb2 *fcb)
         return FCB2_ERR_ARGS;
     }
 
+#if MYNEWT_VAL(FCB2_PRE_ERASE)
+    if (fcb->f_pre_erase && fcb->f_oldest_sec != fcb->f_active.fe_sector) {
+        /* Leave the erase to the flash worker task. */
+        fcb->f_oldest_sec = fcb2_getnext_sector(fcb, fcb->f_oldest_sec);
+        fcb2_pre_erase_queue(fcb);
+        goto out;
+    }
+#endif
+
+    /* Dropped sectors must be erased before the active one moves on. */
+    rc = fcb2_pre_erase_sync(fcb);
+    if (rc) {
+        goto out;
+    }
+
     rc = fcb2_sector_erase(fcb, fcb->f_oldest_sec);
     if (rc) {
         rc = FCB2_ERR_FLASH;
@@ -44,10 +44,10 @@ struct nffs_config {
     /** Maximum number of open directories; default=4. */
     uint32_t nc_num_dirs;
 
-    /** Inode cache size; default=4. */
+    /** Inode cache size; default=NFFS_NUM_CACHE_INODES. */
     uint32_t nc_num_cache_inodes;
 
-    /** Data block cache size; default=64. */
+    /** Data block cache size; default=NFFS_NUM_CACHE_BLOCKS. */
     uint32_t nc_num_cache_blocks;
 };
 
@@ -62,6 +62,8 @@ struct nffs_area_desc {
 int nffs_init(void);
 int nffs_detect(const struct nffs_area_desc *area_descs);
 int nffs_format(const struct nffs_area_desc *area_descs);
+int nffs_checkpoint_area_set(const struct nffs_area_desc *desc);
+int nffs_checkpoint(void);
 
 int nffs_misc_desc_from_flash_area(int idx, int *cnt, struct nffs_area_desc *nad);
 
@@ -72,6 +72,9 @@ nffs_testcase_pre(void* arg)
 {
     save_area_descs = nffs_current_area_descs;
     nffs_current_area_descs = nffs_selftest_area_descs;
+
+    /* The test cases use all of flash, checkpoint region included. */
+    nffs_checkpoint_area_set(NULL);
 }
 
 TEST_CASE_DECL(nffs_test_unlink)
@@ -100,6 +103,9 @@ TEST_CASE_DECL(nffs_test_readdir)
 TEST_CASE_DECL(nffs_test_split_file)
 TEST_CASE_DECL(nffs_test_gc_on_oom)
 TEST_CASE_DECL(nffs_test_cache_large_file)
+TEST_CASE_DECL(nffs_test_hash_grow)
+TEST_CASE_DECL(nffs_test_checkpoint)
+TEST_CASE_DECL(nffs_test_cache_lru)
 
 static void
 nffs_test_basic_cases(void)
@@ -129,6 +135,8 @@ nffs_test_basic_cases(void)
     nffs_test_readdir();
     nffs_test_split_file();
     nffs_test_gc_on_oom();
+    nffs_test_hash_grow();
+    nffs_test_checkpoint();
 }
 
 TEST_SUITE(nffs_test_suite_1_1)
@@ -165,6 +173,7 @@ TEST_SUITE(nffs_suite_cache)
     tu_suite_set_pre_test_cb(nffs_testcase_pre, NULL);
 
     nffs_test_cache_large_file();
+    nffs_test_cache_lru();
 }
 
 int
@@ -0,0 +1,51 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "nffs_test_utils.h"
+
+TEST_CASE_SELF(nffs_test_cache_lru)
+{
+    char filename[16];
+    int rc;
+    int i;
+
+    /*** Setup. */
+    rc = nffs_format(nffs_current_area_descs);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT_FATAL(nffs_config.nc_num_cache_inodes == 4);
+
+    for (i = 0; i < 5; i++) {
+        sprintf(filename, "/f%d", i);
+        nffs_test_util_create_file(filename, "abcdefgh", 8);
+    }
+    nffs_cache_clear();
+
+    /* Fill the inode cache, each file with its one block cached. */
+    for (i = 0; i < 4; i++) {
+        sprintf(filename, "/f%d", i);
+        nffs_test_util_assert_contents(filename, "abcdefgh", 8);
+    }
+
+    /* Reading f0 again makes f1 the least recently used. */
+    nffs_test_util_assert_contents("/f0", "abcdefgh", 8);
+    nffs_test_util_assert_contents("/f4", "abcdefgh", 8);
+
+    /* f0 kept its cached block; f1 was evicted. */
+    nffs_test_util_assert_cache_range("/f0", 0, 8);
+    nffs_test_util_assert_cache_range("/f1", 0, 0);
+}
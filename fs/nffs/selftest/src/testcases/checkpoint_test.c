@@ -0,0 +1,199 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "nffs_test_utils.h"
+
+static const struct nffs_area_desc nffs_test_checkpoint_areas[] = {
+    { 0x00020000, 128 * 1024 },
+    { 0x00040000, 128 * 1024 },
+    { 0x00060000, 128 * 1024 },
+    { 0, 0 },
+};
+
+/* Outside of the file system areas. */
+static const struct nffs_area_desc nffs_test_checkpoint_desc = {
+    0x000e0000, 128 * 1024
+};
+
+static void
+nffs_test_checkpoint_detect(int from_checkpoint)
+{
+    int rc;
+
+    rc = nffs_detect(nffs_test_checkpoint_areas);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(nffs_restore_from_checkpoint == from_checkpoint);
+}
+
+TEST_CASE_SELF(nffs_test_checkpoint)
+{
+    struct fs_file *file;
+    uint8_t byte;
+    int rc;
+
+    struct nffs_test_file_desc *expected_before =
+        (struct nffs_test_file_desc[]) { {
+            .filename = "",
+            .is_dir = 1,
+            .children = (struct nffs_test_file_desc[]) { {
+                .filename = "dir",
+                .is_dir = 1,
+                .children = (struct nffs_test_file_desc[]) { {
+                    .filename = "a",
+                    .contents = "aaaa",
+                    .contents_len = 4,
+                }, {
+                    .filename = "b",
+                    .contents = "bbb",
+                    .contents_len = 3,
+                }, {
+                    .filename = "c",
+                    .contents = "c",
+                    .contents_len = 1,
+                }, {
+                    .filename = NULL,
+                } },
+            }, {
+                .filename = "top",
+                .contents = "top",
+                .contents_len = 3,
+            }, {
+                .filename = NULL,
+            } },
+    } };
+
+    struct nffs_test_file_desc *expected_after =
+        (struct nffs_test_file_desc[]) { {
+            .filename = "",
+            .is_dir = 1,
+            .children = (struct nffs_test_file_desc[]) { {
+                .filename = "dir",
+                .is_dir = 1,
+                .children = (struct nffs_test_file_desc[]) { {
+                    .filename = "a",
+                    .contents = "aaaa-more",
+                    .contents_len = 9,
+                }, {
+                    .filename = "b",
+                    .contents = "bbb",
+                    .contents_len = 3,
+                }, {
+                    .filename = "top2",
+                    .contents = "top",
+                    .contents_len = 3,
+                }, {
+                    .filename = NULL,
+                } },
+            }, {
+                .filename = "new",
+                .contents = "new",
+                .contents_len = 3,
+            }, {
+                .filename = NULL,
+            } },
+    } };
+
+    /*** Setup. */
+    rc = nffs_checkpoint_area_set(&nffs_test_checkpoint_desc);
+    TEST_ASSERT(rc == 0);
+    rc = nffs_format(nffs_test_checkpoint_areas);
+    TEST_ASSERT(rc == 0);
+
+    rc = fs_mkdir("/dir");
+    TEST_ASSERT(rc == 0);
+    nffs_test_util_create_file("/dir/b", "bbb", 3);
+    nffs_test_util_create_file("/dir/c", "c", 1);
+    nffs_test_util_create_file("/dir/a", "aaaa", 4);
+    nffs_test_util_create_file("/top", "top", 3);
+
+    /* No checkpoint after a format; the full scan writes one. */
+    nffs_test_checkpoint_detect(0);
+    nffs_test_assert_system_once(expected_before);
+
+    nffs_test_checkpoint_detect(1);
+    nffs_test_assert_system_once(expected_before);
+
+    /*** Objects written after the checkpoint get read on top of it. */
+    nffs_test_util_append_file("/dir/a", "-more", 5);
+    rc = fs_rename("/top", "/dir/top2");
+    TEST_ASSERT(rc == 0);
+    rc = fs_unlink("/dir/c");
+    TEST_ASSERT(rc == 0);
+    nffs_test_util_create_file("/new", "new", 3);
+
+    nffs_test_checkpoint_detect(1);
+    nffs_test_assert_system_once(expected_after);
+
+    rc = nffs_checkpoint();
+    TEST_ASSERT(rc == 0);
+    nffs_test_checkpoint_detect(1);
+    nffs_test_assert_system_once(expected_after);
+
+    /*** Garbage collection is followed by a new checkpoint. */
+    rc = nffs_gc(NULL);
+    TEST_ASSERT(rc == 0);
+    nffs_test_util_assert_contents("/new", "new", 3);
+    nffs_test_checkpoint_detect(1);
+    nffs_test_assert_system_once(expected_after);
+
+    /* Without one, the old checkpoint doesn't match the areas. */
+    rc = nffs_checkpoint_area_set(NULL);
+    TEST_ASSERT(rc == 0);
+    rc = nffs_gc(NULL);
+    TEST_ASSERT(rc == 0);
+    nffs_test_util_assert_contents("/new", "new", 3);
+    rc = nffs_checkpoint_area_set(&nffs_test_checkpoint_desc);
+    TEST_ASSERT(rc == 0);
+    nffs_test_checkpoint_detect(0);
+    nffs_test_assert_system_once(expected_after);
+    nffs_test_checkpoint_detect(1);
+
+    /*** A corrupt checkpoint is ignored. */
+    rc = hal_flash_read(0, nffs_test_checkpoint_desc.nad_offset + 100,
+                        &byte, 1);
+    TEST_ASSERT(rc == 0);
+    rc = flash_native_memset(nffs_test_checkpoint_desc.nad_offset + 100,
+                             ~byte, 1);
+    TEST_ASSERT(rc == 0);
+    nffs_test_checkpoint_detect(0);
+    nffs_test_assert_system_once(expected_after);
+    nffs_test_checkpoint_detect(1);
+
+    /*** An unlinked file that is still open can't be checkpointed. */
+    rc = fs_open("/new", FS_ACCESS_READ, &file);
+    TEST_ASSERT(rc == 0);
+    rc = fs_unlink("/new");
+    TEST_ASSERT(rc == 0);
+    rc = nffs_checkpoint();
+    TEST_ASSERT(rc == FS_EUNEXP);
+    rc = fs_close(file);
+    TEST_ASSERT(rc == 0);
+    nffs_test_checkpoint_detect(0);
+
+    /*** Formatting drops the checkpoint. */
+    rc = nffs_checkpoint();
+    TEST_ASSERT(rc == 0);
+    rc = nffs_format(nffs_test_checkpoint_areas);
+    TEST_ASSERT(rc == 0);
+    nffs_test_checkpoint_detect(0);
+
+    rc = nffs_checkpoint_area_set(NULL);
+    TEST_ASSERT(rc == 0);
+    rc = nffs_checkpoint();
+    TEST_ASSERT(rc == FS_EINVAL);
+}
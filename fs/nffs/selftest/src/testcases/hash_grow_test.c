@@ -0,0 +1,70 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "nffs_test_utils.h"
+
+#define NFFS_TEST_HASH_GROW_FILES   100
+
+TEST_CASE_SELF(nffs_test_hash_grow)
+{
+    char filename[16];
+    char contents[16];
+    int rc;
+    int i;
+
+    /*** Setup. */
+    rc = nffs_format(nffs_current_area_descs);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(nffs_hash_size == MYNEWT_VAL(NFFS_HASH_SIZE));
+
+    for (i = 0; i < NFFS_TEST_HASH_GROW_FILES; i++) {
+        sprintf(filename, "/f%d", i);
+        sprintf(contents, "contents %d", i);
+        nffs_test_util_create_file(filename, contents, strlen(contents));
+    }
+
+    /* An inode and a data block per file; the selftest starts with a small
+     * table, so it must have grown.
+     */
+    TEST_ASSERT(nffs_hash_size > MYNEWT_VAL(NFFS_HASH_SIZE));
+    TEST_ASSERT(nffs_hash_size <= MYNEWT_VAL(NFFS_HASH_SIZE_MAX));
+
+    for (i = 0; i < NFFS_TEST_HASH_GROW_FILES; i++) {
+        sprintf(filename, "/f%d", i);
+        sprintf(contents, "contents %d", i);
+        nffs_test_util_assert_contents(filename, contents, strlen(contents));
+    }
+
+    /* Restore rebuilds the table, and grows it again. */
+    rc = nffs_detect(nffs_current_area_descs);
+    TEST_ASSERT(rc == 0);
+    for (i = 0; i < NFFS_TEST_HASH_GROW_FILES; i++) {
+        sprintf(filename, "/f%d", i);
+        sprintf(contents, "contents %d", i);
+        nffs_test_util_assert_contents(filename, contents, strlen(contents));
+    }
+
+    /* Deleting entries does not shrink the table. */
+    for (i = 0; i < NFFS_TEST_HASH_GROW_FILES; i++) {
+        sprintf(filename, "/f%d", i);
+        rc = fs_unlink(filename);
+        TEST_ASSERT(rc == 0);
+    }
+    nffs_test_util_create_file("/last", "x", 1);
+    nffs_test_util_assert_contents("/last", "x", 1);
+}
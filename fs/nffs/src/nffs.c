@@ -30,6 +30,7 @@
 #include "nffs_priv.h"
 #include "nffs/nffs.h"
 #include "fs/fs_if.h"
+#include "sysdown/sysdown.h"
 
 struct nffs_area *nffs_areas;
 uint8_t nffs_num_areas;
@@ -108,6 +109,7 @@ STATS_SECT_DECL(nffs_stats) nffs_stats;
 STATS_NAME_START(nffs_stats)
     STATS_NAME(nffs_stats, nffs_hashcnt_ins)
     STATS_NAME(nffs_stats, nffs_hashcnt_rm)
+    STATS_NAME(nffs_stats, nffs_hashcnt_grow)
     STATS_NAME(nffs_stats, nffs_object_count)
     STATS_NAME(nffs_stats, nffs_iocnt_read)
     STATS_NAME(nffs_stats, nffs_iocnt_write)
@@ -125,6 +127,12 @@ STATS_NAME_START(nffs_stats)
     STATS_NAME(nffs_stats, nffs_readcnt_filename)
     STATS_NAME(nffs_stats, nffs_readcnt_object)
     STATS_NAME(nffs_stats, nffs_readcnt_detect)
+    STATS_NAME(nffs_stats, nffs_cachecnt_inode_hit)
+    STATS_NAME(nffs_stats, nffs_cachecnt_inode_miss)
+    STATS_NAME(nffs_stats, nffs_cachecnt_block_hit)
+    STATS_NAME(nffs_stats, nffs_cachecnt_block_miss)
+    STATS_NAME(nffs_stats, nffs_checkpoint_writes)
+    STATS_NAME(nffs_stats, nffs_checkpoint_restores)
 STATS_NAME_END(nffs_stats)
 
 static void
@@ -141,6 +149,14 @@ nffs_unlock(void)
 {
     int rc;
 
+    /* No hash table iteration is in progress once the outermost lock is
+     * released; this is where the table gets resized.
+     */
+    if (nffs_mutex.mu_level <= 1) {
+        nffs_hash_grow();
+        nffs_checkpoint_write_pending();
+    }
+
     rc = os_mutex_release(&nffs_mutex);
     assert(rc == 0 || rc == OS_NOT_STARTED);
 }
@@ -677,6 +693,64 @@ nffs_detect(const struct nffs_area_desc *area_descs)
     return rc;
 }
 
+#if MYNEWT_VAL(NFFS_CHECKPOINT)
+/**
+ * Sets the flash region in which a checkpoint of the file system is kept.
+ * Restoring from a checkpoint only requires reading the objects written
+ * after it was taken, rather than every object on disk.  The region must
+ * not overlap any nffs area.  This should be called before nffs_detect().
+ *
+ * @param desc              The region to use; NULL to stop using
+ *                              checkpoints.
+ *
+ * @return                  0 on success;
+ *                          FS_EINVAL if the region is too small.
+ */
+int
+nffs_checkpoint_area_set(const struct nffs_area_desc *desc)
+{
+    int rc;
+
+    nffs_lock();
+    rc = nffs_checkpoint_set_desc(desc);
+    nffs_unlock();
+
+    return rc;
+}
+
+/**
+ * Writes a checkpoint of the current file system state.  Checkpoints are
+ * also written automatically after garbage collection and at sysdown.
+ *
+ * @return                  0 on success;
+ *                          FS_EINVAL if no checkpoint region is set;
+ *                          FS_EUNINIT if no file system is mounted;
+ *                          FS_EUNEXP if the file system can't be
+ *                              checkpointed in its current state (e.g., an
+ *                              unlinked file is still open);
+ *                          FS_EFULL if the checkpoint region is too small;
+ *                          other nonzero on error.
+ */
+int
+nffs_checkpoint(void)
+{
+    int rc;
+
+    nffs_lock();
+    rc = nffs_checkpoint_write();
+    nffs_unlock();
+
+    return rc;
+}
+
+int
+nffs_checkpoint_sysdown(int reason)
+{
+    nffs_checkpoint();
+    return SYSDOWN_COMPLETE;
+}
+#endif
+
 /**
  * Initializes internal nffs memory and data structures.  This must be called
  * before any nffs operations are attempted.
@@ -763,6 +837,10 @@ void
 nffs_pkg_init(void)
 {
     struct nffs_area_desc descs[MYNEWT_VAL(NFFS_NUM_AREAS) + 1];
+#if MYNEWT_VAL(NFFS_CHECKPOINT)
+    struct nffs_area_desc checkpoint_desc;
+    const struct flash_area *fa;
+#endif
     int cnt;
     int rc;
 
@@ -781,6 +859,18 @@ nffs_pkg_init(void)
         MYNEWT_VAL(NFFS_FLASH_AREA), &cnt, descs);
     SYSINIT_PANIC_ASSERT(rc == 0);
 
+#if MYNEWT_VAL(NFFS_CHECKPOINT)
+    rc = flash_area_open(MYNEWT_VAL(NFFS_CHECKPOINT_FLASH_AREA), &fa);
+    SYSINIT_PANIC_ASSERT(rc == 0);
+    checkpoint_desc.nad_offset = fa->fa_off;
+    checkpoint_desc.nad_length = fa->fa_size;
+    checkpoint_desc.nad_flash_id = fa->fa_device_id;
+    flash_area_close(fa);
+
+    rc = nffs_checkpoint_area_set(&checkpoint_desc);
+    SYSINIT_PANIC_ASSERT(rc == 0);
+#endif
+
     /* Attempt to restore an existing nffs file system from flash. */
     rc = nffs_detect(descs);
     switch (rc) {
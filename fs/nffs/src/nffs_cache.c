@@ -253,10 +253,17 @@ nffs_cache_inode_ensure(struct nffs_cache_inode **out_cache_inode,
 
     cache_inode = nffs_cache_inode_find(inode_entry);
     if (cache_inode != NULL) {
+        /* Keep the list in LRU order; the tail is evicted first. */
+        if (cache_inode != TAILQ_FIRST(&nffs_cache_inode_list)) {
+            TAILQ_REMOVE(&nffs_cache_inode_list, cache_inode, nci_link);
+            TAILQ_INSERT_HEAD(&nffs_cache_inode_list, cache_inode, nci_link);
+        }
+        STATS_INC(nffs_stats, nffs_cachecnt_inode_hit);
         rc = 0;
         goto done;
     }
 
+    STATS_INC(nffs_stats, nffs_cachecnt_inode_miss);
     cache_inode = nffs_cache_inode_acquire();
     rc = nffs_cache_inode_populate(cache_inode, inode_entry);
     if (rc != 0) {
@@ -384,6 +391,7 @@ nffs_cache_seek(struct nffs_cache_inode *cache_inode, uint32_t seek_offset,
     uint32_t cache_end;
     uint32_t block_start;
     uint32_t block_end;
+    int cached;
     int rc;
 
     /* Empty files have no blocks that can be cached. */
@@ -418,11 +426,13 @@ nffs_cache_seek(struct nffs_cache_inode *cache_inode, uint32_t seek_offset,
 
     /* Scan backwards until we find the block containing the seek offest. */
     while (1) {
+        cached = 1;
         if (block_end <= cache_start) {
             /* We are looking before the start of the cache.  Allocate a new
              * cache block and prepend it to the cache.
              */
             assert(cache_block == NULL);
+            cached = 0;
             cache_block = nffs_cache_block_acquire();
             rc = nffs_cache_block_populate(cache_block, block_entry,
                                            block_end);
@@ -463,6 +473,7 @@ nffs_cache_seek(struct nffs_cache_inode *cache_inode, uint32_t seek_offset,
                  * erase the current cache and populate it with this single
                  * block.
                  */
+                cached = 0;
                 cache_block = nffs_cache_block_acquire();
                 cache_block->ncb_block = block;
                 cache_block->ncb_file_offset = block_start;
@@ -478,6 +489,12 @@ nffs_cache_seek(struct nffs_cache_inode *cache_inode, uint32_t seek_offset,
                 }
             }
 
+            if (cached) {
+                STATS_INC(nffs_stats, nffs_cachecnt_block_hit);
+            } else {
+                STATS_INC(nffs_stats, nffs_cachecnt_block_miss);
+            }
+
             if (out_cache_block != NULL) {
                 *out_cache_block = cache_block;
             }
@@ -0,0 +1,819 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <assert.h>
+#include <string.h>
+#include "os/mynewt.h"
+#include "hal/hal_flash.h"
+#include "nffs/nffs.h"
+#include "nffs_priv.h"
+
+#if MYNEWT_VAL(NFFS_CHECKPOINT)
+
+/*
+ * A checkpoint is a copy of the RAM representation of the file system, kept
+ * in a flash region of its own.  Restoring from a checkpoint replaces the
+ * scan of every object on disk; only the objects written after the
+ * checkpoint are read.  The region holds, in order:
+ *
+ *     o struct nffs_disk_checkpoint (header).
+ *     o struct nffs_disk_checkpoint_area, one per area.
+ *     o Data blocks: ID, flash location.
+ *     o Inodes: ID, flash location, ID of last data block.
+ *     o Directories with children: ID, number of children, IDs of the
+ *       children in directory order.
+ *
+ * The header is written last and covers everything with a CRC, so an
+ * interrupted write leaves no valid checkpoint behind.
+ *
+ * A checkpoint is tied to the area headers it was taken with.  Objects are
+ * appended to an area until it gets garbage collected, which changes the
+ * area headers; a checkpoint taken before that no longer matches and is
+ * ignored.  A new one is written once the operation which caused the
+ * garbage collection completes.
+ */
+
+#define NFFS_CHECKPOINT_MAGIC       0x4ec7a5d1
+#define NFFS_CHECKPOINT_BUF_SZ      64
+
+/** On-disk representation of a checkpoint header. */
+struct nffs_disk_checkpoint {
+    uint32_t ndc_magic;             /* NFFS_CHECKPOINT_MAGIC */
+    uint32_t ndc_gen;               /* Incremented with each checkpoint. */
+    uint32_t ndc_len;               /* Bytes following the header. */
+    uint32_t ndc_next_file_id;
+    uint32_t ndc_next_dir_id;
+    uint32_t ndc_next_block_id;
+    uint32_t ndc_num_blocks;
+    uint32_t ndc_num_inodes;
+    uint32_t ndc_num_dirs;          /* Directories with children. */
+    uint16_t ndc_block_max_data_sz;
+    uint8_t ndc_num_areas;
+    uint8_t ndc_scratch_area_idx;
+    uint16_t reserved16;
+    uint16_t ndc_crc16;             /* Covers rest of header and the body. */
+};
+
+#define NFFS_DISK_CHECKPOINT_OFFSET_CRC  42
+
+/** On-disk representation of an area in a checkpoint. */
+struct nffs_disk_checkpoint_area {
+    uint32_t ndca_offset;
+    uint32_t ndca_length;
+    uint32_t ndca_cur;              /* End of the area's objects. */
+    uint8_t ndca_flash_id;
+    uint8_t ndca_id;
+    uint8_t ndca_gc_seq;
+    uint8_t reserved8;
+};
+
+/** Sequential, buffered access to the checkpoint region. */
+struct nffs_checkpoint_io {
+    uint32_t nci_off;               /* Next flash access; region relative. */
+    uint32_t nci_end;               /* End of readable data. */
+    uint16_t nci_crc;
+    uint8_t nci_len;                /* Bytes in buffer. */
+    uint8_t nci_pos;                /* Read position in buffer. */
+    uint8_t nci_buf[NFFS_CHECKPOINT_BUF_SZ];
+};
+
+/** Region holding the checkpoint; 0 length if none. */
+static struct nffs_area_desc nffs_checkpoint_desc;
+static uint32_t nffs_checkpoint_gen;
+static uint8_t nffs_checkpoint_pending;
+
+static int
+nffs_checkpoint_flush(struct nffs_checkpoint_io *io)
+{
+    int rc;
+
+    if (io->nci_len == 0) {
+        return 0;
+    }
+
+    io->nci_crc = crc16_ccitt(io->nci_crc, io->nci_buf, io->nci_len);
+    rc = hal_flash_write(nffs_checkpoint_desc.nad_flash_id,
+                         nffs_checkpoint_desc.nad_offset + io->nci_off,
+                         io->nci_buf, io->nci_len);
+    if (rc != 0) {
+        return FS_EHW;
+    }
+
+    io->nci_off += io->nci_len;
+    io->nci_len = 0;
+
+    return 0;
+}
+
+static int
+nffs_checkpoint_put(struct nffs_checkpoint_io *io, const void *data, int len)
+{
+    const uint8_t *u8p;
+    int chunk;
+    int rc;
+
+    u8p = data;
+    while (len > 0) {
+        if (io->nci_len == sizeof io->nci_buf) {
+            rc = nffs_checkpoint_flush(io);
+            if (rc != 0) {
+                return rc;
+            }
+        }
+
+        chunk = sizeof io->nci_buf - io->nci_len;
+        if (chunk > len) {
+            chunk = len;
+        }
+        memcpy(io->nci_buf + io->nci_len, u8p, chunk);
+        io->nci_len += chunk;
+        u8p += chunk;
+        len -= chunk;
+    }
+
+    return 0;
+}
+
+static int
+nffs_checkpoint_put32(struct nffs_checkpoint_io *io, uint32_t val)
+{
+    return nffs_checkpoint_put(io, &val, sizeof val);
+}
+
+static int
+nffs_checkpoint_get(struct nffs_checkpoint_io *io, void *data, int len)
+{
+    uint8_t *u8p;
+    uint32_t chunk;
+    int rc;
+
+    u8p = data;
+    while (len > 0) {
+        if (io->nci_pos == io->nci_len) {
+            chunk = io->nci_end - io->nci_off;
+            if (chunk == 0) {
+                return FS_ECORRUPT;
+            }
+            if (chunk > sizeof io->nci_buf) {
+                chunk = sizeof io->nci_buf;
+            }
+
+            rc = hal_flash_read(nffs_checkpoint_desc.nad_flash_id,
+                                nffs_checkpoint_desc.nad_offset + io->nci_off,
+                                io->nci_buf, chunk);
+            if (rc != 0) {
+                return FS_EHW;
+            }
+            io->nci_crc = crc16_ccitt(io->nci_crc, io->nci_buf, chunk);
+            io->nci_off += chunk;
+            io->nci_len = chunk;
+            io->nci_pos = 0;
+        }
+
+        chunk = io->nci_len - io->nci_pos;
+        if (chunk > len) {
+            chunk = len;
+        }
+        memcpy(u8p, io->nci_buf + io->nci_pos, chunk);
+        io->nci_pos += chunk;
+        u8p += chunk;
+        len -= chunk;
+    }
+
+    return 0;
+}
+
+static int
+nffs_checkpoint_get32(struct nffs_checkpoint_io *io, uint32_t *out_val)
+{
+    return nffs_checkpoint_get(io, out_val, sizeof *out_val);
+}
+
+/**
+ * Counts the objects to checkpoint and fills in the corresponding header
+ * fields.  Fails if the RAM representation holds anything that can't be
+ * restored from a checkpoint: dummy objects left by an incomplete restore,
+ * or inodes that are not in the directory tree (e.g., an unlinked file that
+ * is still open).
+ */
+static int
+nffs_checkpoint_count(struct nffs_disk_checkpoint *hdr)
+{
+    struct nffs_inode_entry *inode_entry;
+    struct nffs_inode_entry *child;
+    struct nffs_hash_entry *entry;
+    struct nffs_hash_entry *next;
+    uint32_t num_children;
+    int i;
+
+    hdr->ndc_len = nffs_num_areas * sizeof (struct nffs_disk_checkpoint_area);
+
+    NFFS_HASH_FOREACH(entry, i, next) {
+        if (nffs_hash_id_is_block(entry->nhe_id)) {
+            if (nffs_hash_entry_is_dummy(entry)) {
+                return FS_EUNEXP;
+            }
+            hdr->ndc_num_blocks++;
+            hdr->ndc_len += 2 * sizeof (uint32_t);
+        } else {
+            inode_entry = (struct nffs_inode_entry *)entry;
+            if (inode_entry->nie_flags !=
+                (NFFS_INODE_FLAG_INHASH | NFFS_INODE_FLAG_INTREE)) {
+
+                return FS_EUNEXP;
+            }
+            hdr->ndc_num_inodes++;
+            hdr->ndc_len += 3 * sizeof (uint32_t);
+
+            if (nffs_hash_id_is_dir(entry->nhe_id) &&
+                !SLIST_EMPTY(&inode_entry->nie_child_list)) {
+
+                num_children = 0;
+                SLIST_FOREACH(child, &inode_entry->nie_child_list,
+                              nie_sibling_next) {
+                    num_children++;
+                }
+                hdr->ndc_num_dirs++;
+                hdr->ndc_len += (2 + num_children) * sizeof (uint32_t);
+            }
+        }
+    }
+
+    return 0;
+}
+
+static int
+nffs_checkpoint_write_body(struct nffs_checkpoint_io *io)
+{
+    struct nffs_disk_checkpoint_area disk_area;
+    struct nffs_inode_entry *inode_entry;
+    struct nffs_inode_entry *child;
+    struct nffs_hash_entry *entry;
+    struct nffs_hash_entry *next;
+    struct nffs_area *area;
+    uint32_t lastblock_id;
+    uint32_t num_children;
+    int rc;
+    int i;
+
+    for (i = 0; i < nffs_num_areas; i++) {
+        area = nffs_areas + i;
+        memset(&disk_area, 0, sizeof disk_area);
+        disk_area.ndca_offset = area->na_offset;
+        disk_area.ndca_length = area->na_length;
+        disk_area.ndca_cur = area->na_cur;
+        disk_area.ndca_flash_id = area->na_flash_id;
+        disk_area.ndca_id = area->na_id;
+        disk_area.ndca_gc_seq = area->na_gc_seq;
+
+        rc = nffs_checkpoint_put(io, &disk_area, sizeof disk_area);
+        if (rc != 0) {
+            return rc;
+        }
+    }
+
+    /* Blocks first, so that inodes can refer to their last block when the
+     * checkpoint is read back.
+     */
+    NFFS_HASH_FOREACH(entry, i, next) {
+        if (nffs_hash_id_is_block(entry->nhe_id)) {
+            rc = nffs_checkpoint_put32(io, entry->nhe_id);
+            if (rc == 0) {
+                rc = nffs_checkpoint_put32(io, entry->nhe_flash_loc);
+            }
+            if (rc != 0) {
+                return rc;
+            }
+        }
+    }
+
+    NFFS_HASH_FOREACH(entry, i, next) {
+        if (nffs_hash_id_is_inode(entry->nhe_id)) {
+            inode_entry = (struct nffs_inode_entry *)entry;
+            lastblock_id = NFFS_ID_NONE;
+            if (nffs_hash_id_is_file(entry->nhe_id) &&
+                inode_entry->nie_last_block_entry != NULL) {
+
+                lastblock_id = inode_entry->nie_last_block_entry->nhe_id;
+            }
+
+            rc = nffs_checkpoint_put32(io, entry->nhe_id);
+            if (rc == 0) {
+                rc = nffs_checkpoint_put32(io, entry->nhe_flash_loc);
+            }
+            if (rc == 0) {
+                rc = nffs_checkpoint_put32(io, lastblock_id);
+            }
+            if (rc != 0) {
+                return rc;
+            }
+        }
+    }
+
+    /* Children are stored in directory order; restoring them doesn't need
+     * the filename comparisons that inserting them one by one does.
+     */
+    NFFS_HASH_FOREACH(entry, i, next) {
+        if (!nffs_hash_id_is_dir(entry->nhe_id)) {
+            continue;
+        }
+        inode_entry = (struct nffs_inode_entry *)entry;
+        if (SLIST_EMPTY(&inode_entry->nie_child_list)) {
+            continue;
+        }
+
+        num_children = 0;
+        SLIST_FOREACH(child, &inode_entry->nie_child_list, nie_sibling_next) {
+            num_children++;
+        }
+
+        rc = nffs_checkpoint_put32(io, entry->nhe_id);
+        if (rc == 0) {
+            rc = nffs_checkpoint_put32(io, num_children);
+        }
+        if (rc != 0) {
+            return rc;
+        }
+
+        SLIST_FOREACH(child, &inode_entry->nie_child_list, nie_sibling_next) {
+            rc = nffs_checkpoint_put32(io, child->nie_hash_entry.nhe_id);
+            if (rc != 0) {
+                return rc;
+            }
+        }
+    }
+
+    return nffs_checkpoint_flush(io);
+}
+
+/**
+ * Writes a checkpoint of the current RAM representation.  If the file system
+ * can't be checkpointed in its current state, any existing checkpoint is
+ * invalidated instead.
+ *
+ * @return                      0 on success;
+ *                              FS_EINVAL if no checkpoint region is
+ *                                  configured;
+ *                              FS_EUNINIT if no file system is mounted;
+ *                              FS_EUNEXP if the file system can't be
+ *                                  checkpointed in its current state;
+ *                              FS_EFULL if the checkpoint region is too
+ *                                  small;
+ *                              other nonzero on error.
+ */
+int
+nffs_checkpoint_write(void)
+{
+    struct nffs_disk_checkpoint hdr;
+    struct nffs_checkpoint_io io;
+    int rc;
+
+    nffs_checkpoint_pending = 0;
+
+    if (nffs_checkpoint_desc.nad_length == 0) {
+        return FS_EINVAL;
+    }
+    if (!nffs_misc_ready()) {
+        return FS_EUNINIT;
+    }
+
+    memset(&hdr, 0, sizeof hdr);
+    rc = nffs_checkpoint_count(&hdr);
+    if (rc == 0 && sizeof hdr + hdr.ndc_len > nffs_checkpoint_desc.nad_length) {
+        rc = FS_EFULL;
+    }
+    if (rc != 0) {
+        /* The checkpoint on disk, if any, may be older than the last garbage
+         * collection cycle; make sure it doesn't get used.
+         */
+        nffs_checkpoint_invalidate();
+        return rc;
+    }
+
+    rc = hal_flash_erase(nffs_checkpoint_desc.nad_flash_id,
+                         nffs_checkpoint_desc.nad_offset,
+                         sizeof hdr + hdr.ndc_len);
+    if (rc != 0) {
+        return FS_EHW;
+    }
+
+    memset(&io, 0, sizeof io);
+    io.nci_off = sizeof hdr;
+    rc = nffs_checkpoint_write_body(&io);
+    if (rc != 0) {
+        return rc;
+    }
+    assert(io.nci_off == sizeof hdr + hdr.ndc_len);
+
+    hdr.ndc_magic = NFFS_CHECKPOINT_MAGIC;
+    hdr.ndc_gen = nffs_checkpoint_gen + 1;
+    hdr.ndc_next_file_id = nffs_hash_next_file_id;
+    hdr.ndc_next_dir_id = nffs_hash_next_dir_id;
+    hdr.ndc_next_block_id = nffs_hash_next_block_id;
+    hdr.ndc_block_max_data_sz = nffs_block_max_data_sz;
+    hdr.ndc_num_areas = nffs_num_areas;
+    hdr.ndc_scratch_area_idx = nffs_scratch_area_idx;
+    hdr.ndc_crc16 = crc16_ccitt(io.nci_crc, &hdr,
+                                NFFS_DISK_CHECKPOINT_OFFSET_CRC);
+
+    rc = hal_flash_write(nffs_checkpoint_desc.nad_flash_id,
+                         nffs_checkpoint_desc.nad_offset, &hdr, sizeof hdr);
+    if (rc != 0) {
+        return FS_EHW;
+    }
+
+    nffs_checkpoint_gen = hdr.ndc_gen;
+    STATS_INC(nffs_stats, nffs_checkpoint_writes);
+
+    return 0;
+}
+
+static int
+nffs_checkpoint_loc_is_valid(uint32_t flash_loc)
+{
+    uint32_t area_offset;
+    uint8_t area_idx;
+
+    nffs_flash_loc_expand(flash_loc, &area_idx, &area_offset);
+
+    return area_idx < nffs_num_areas &&
+           area_idx != nffs_scratch_area_idx &&
+           area_offset >= sizeof (struct nffs_disk_area) &&
+           area_offset < nffs_areas[area_idx].na_cur;
+}
+
+static int
+nffs_checkpoint_restore_areas(struct nffs_checkpoint_io *io)
+{
+    struct nffs_disk_checkpoint_area disk_area;
+    struct nffs_area *area;
+    int rc;
+    int i;
+
+    for (i = 0; i < nffs_num_areas; i++) {
+        rc = nffs_checkpoint_get(io, &disk_area, sizeof disk_area);
+        if (rc != 0) {
+            return rc;
+        }
+
+        area = nffs_areas + i;
+        if (disk_area.ndca_offset != area->na_offset ||
+            disk_area.ndca_length != area->na_length ||
+            disk_area.ndca_flash_id != area->na_flash_id ||
+            disk_area.ndca_id != area->na_id ||
+            disk_area.ndca_gc_seq != area->na_gc_seq) {
+
+            /* The areas changed since the checkpoint was taken. */
+            return FS_ECORRUPT;
+        }
+
+        if (i != nffs_scratch_area_idx) {
+            if (disk_area.ndca_cur < sizeof (struct nffs_disk_area) ||
+                disk_area.ndca_cur > area->na_length) {
+
+                return FS_ECORRUPT;
+            }
+            area->na_cur = disk_area.ndca_cur;
+        }
+    }
+
+    return 0;
+}
+
+static int
+nffs_checkpoint_restore_blocks(struct nffs_checkpoint_io *io, uint32_t num)
+{
+    struct nffs_hash_entry *entry;
+    uint32_t flash_loc;
+    uint32_t id;
+    int rc;
+
+    while (num-- > 0) {
+        rc = nffs_checkpoint_get32(io, &id);
+        if (rc == 0) {
+            rc = nffs_checkpoint_get32(io, &flash_loc);
+        }
+        if (rc != 0) {
+            return rc;
+        }
+
+        if (!nffs_hash_id_is_block(id) || id == NFFS_ID_NONE ||
+            !nffs_checkpoint_loc_is_valid(flash_loc) ||
+            nffs_hash_find(id) != NULL) {
+
+            return FS_ECORRUPT;
+        }
+
+        entry = nffs_block_entry_alloc();
+        if (entry == NULL) {
+            return FS_ENOMEM;
+        }
+        entry->nhe_id = id;
+        entry->nhe_flash_loc = flash_loc;
+        nffs_hash_insert(entry);
+        nffs_hash_grow();
+    }
+
+    return 0;
+}
+
+static int
+nffs_checkpoint_restore_inodes(struct nffs_checkpoint_io *io, uint32_t num)
+{
+    struct nffs_inode_entry *inode_entry;
+    struct nffs_hash_entry *lastblock_entry;
+    uint32_t lastblock_id;
+    uint32_t flash_loc;
+    uint32_t id;
+    int rc;
+
+    while (num-- > 0) {
+        rc = nffs_checkpoint_get32(io, &id);
+        if (rc == 0) {
+            rc = nffs_checkpoint_get32(io, &flash_loc);
+        }
+        if (rc == 0) {
+            rc = nffs_checkpoint_get32(io, &lastblock_id);
+        }
+        if (rc != 0) {
+            return rc;
+        }
+
+        if (!nffs_hash_id_is_inode(id) ||
+            !nffs_checkpoint_loc_is_valid(flash_loc) ||
+            nffs_hash_find(id) != NULL) {
+
+            return FS_ECORRUPT;
+        }
+
+        lastblock_entry = NULL;
+        if (lastblock_id != NFFS_ID_NONE) {
+            if (!nffs_hash_id_is_file(id) ||
+                !nffs_hash_id_is_block(lastblock_id)) {
+
+                return FS_ECORRUPT;
+            }
+            lastblock_entry = nffs_hash_find_block(lastblock_id);
+            if (lastblock_entry == NULL) {
+                return FS_ECORRUPT;
+            }
+        }
+
+        inode_entry = nffs_inode_entry_alloc();
+        if (inode_entry == NULL) {
+            return FS_ENOMEM;
+        }
+        inode_entry->nie_hash_entry.nhe_id = id;
+        inode_entry->nie_hash_entry.nhe_flash_loc = flash_loc;
+        if (nffs_hash_id_is_file(id)) {
+            inode_entry->nie_last_block_entry = lastblock_entry;
+        }
+        inode_entry->nie_refcnt = 1;
+        nffs_hash_insert(&inode_entry->nie_hash_entry);
+
+        if (id == NFFS_ID_ROOT_DIR) {
+            nffs_root_dir = inode_entry;
+            nffs_inode_setflags(nffs_root_dir, NFFS_INODE_FLAG_INTREE);
+        }
+
+        nffs_hash_grow();
+    }
+
+    return 0;
+}
+
+static int
+nffs_checkpoint_restore_dirs(struct nffs_checkpoint_io *io, uint32_t num,
+                             uint32_t *out_num_children)
+{
+    struct nffs_inode_entry *parent;
+    struct nffs_inode_entry *child;
+    struct nffs_inode_entry *prev;
+    uint32_t num_children;
+    uint32_t id;
+    int rc;
+
+    *out_num_children = 0;
+
+    while (num-- > 0) {
+        rc = nffs_checkpoint_get32(io, &id);
+        if (rc == 0) {
+            rc = nffs_checkpoint_get32(io, &num_children);
+        }
+        if (rc != 0) {
+            return rc;
+        }
+
+        if (!nffs_hash_id_is_dir(id)) {
+            return FS_ECORRUPT;
+        }
+        parent = nffs_hash_find_inode(id);
+        if (parent == NULL || !SLIST_EMPTY(&parent->nie_child_list)) {
+            return FS_ECORRUPT;
+        }
+
+        prev = NULL;
+        while (num_children-- > 0) {
+            rc = nffs_checkpoint_get32(io, &id);
+            if (rc != 0) {
+                return rc;
+            }
+
+            if (!nffs_hash_id_is_inode(id) || id == NFFS_ID_ROOT_DIR) {
+                return FS_ECORRUPT;
+            }
+            child = nffs_hash_find_inode(id);
+            if (child == NULL ||
+                nffs_inode_getflags(child, NFFS_INODE_FLAG_INTREE)) {
+
+                return FS_ECORRUPT;
+            }
+
+            if (prev == NULL) {
+                SLIST_INSERT_HEAD(&parent->nie_child_list, child,
+                                  nie_sibling_next);
+            } else {
+                SLIST_INSERT_AFTER(prev, child, nie_sibling_next);
+            }
+            nffs_inode_setflags(child, NFFS_INODE_FLAG_INTREE);
+            prev = child;
+            (*out_num_children)++;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Loads the checkpoint into the RAM representation.  The areas must already
+ * have been detected; on success, the current offset of each area is set to
+ * where the objects written after the checkpoint start.  On failure, the RAM
+ * representation is left partially populated and needs to be reset.
+ *
+ * @param out_max_data_len      On success, the maximum data block size at the
+ *                                  time of the checkpoint gets written here.
+ *
+ * @return                      0 on success;
+ *                              FS_ENOENT if there is no checkpoint;
+ *                              FS_ECORRUPT if the checkpoint is invalid or
+ *                                  doesn't match the detected areas;
+ *                              other nonzero on error.
+ */
+int
+nffs_checkpoint_restore(uint16_t *out_max_data_len)
+{
+    struct nffs_disk_checkpoint hdr;
+    struct nffs_checkpoint_io io;
+    uint32_t num_children;
+    int rc;
+
+    if (nffs_checkpoint_desc.nad_length == 0) {
+        return FS_ENOENT;
+    }
+
+    rc = hal_flash_read(nffs_checkpoint_desc.nad_flash_id,
+                        nffs_checkpoint_desc.nad_offset, &hdr, sizeof hdr);
+    if (rc != 0) {
+        return FS_EHW;
+    }
+    if (hdr.ndc_magic != NFFS_CHECKPOINT_MAGIC) {
+        return FS_ENOENT;
+    }
+    if (hdr.ndc_len > nffs_checkpoint_desc.nad_length - sizeof hdr ||
+        hdr.ndc_num_areas != nffs_num_areas ||
+        hdr.ndc_scratch_area_idx != nffs_scratch_area_idx) {
+
+        return FS_ECORRUPT;
+    }
+
+    memset(&io, 0, sizeof io);
+    io.nci_off = sizeof hdr;
+    io.nci_end = sizeof hdr + hdr.ndc_len;
+
+    rc = nffs_checkpoint_restore_areas(&io);
+    if (rc == 0) {
+        rc = nffs_checkpoint_restore_blocks(&io, hdr.ndc_num_blocks);
+    }
+    if (rc == 0) {
+        rc = nffs_checkpoint_restore_inodes(&io, hdr.ndc_num_inodes);
+    }
+    if (rc == 0) {
+        rc = nffs_checkpoint_restore_dirs(&io, hdr.ndc_num_dirs,
+                                          &num_children);
+    }
+    if (rc != 0) {
+        return rc;
+    }
+
+    /* All of the body must have been consumed, every inode except the root
+     * directory must have a parent, and the CRC must match.
+     */
+    if (io.nci_pos != io.nci_len || io.nci_off != io.nci_end ||
+        nffs_root_dir == NULL || num_children + 1 != hdr.ndc_num_inodes ||
+        crc16_ccitt(io.nci_crc, &hdr, NFFS_DISK_CHECKPOINT_OFFSET_CRC) !=
+            hdr.ndc_crc16) {
+
+        return FS_ECORRUPT;
+    }
+
+    nffs_hash_next_file_id = hdr.ndc_next_file_id;
+    nffs_hash_next_dir_id = hdr.ndc_next_dir_id;
+    nffs_hash_next_block_id = hdr.ndc_next_block_id;
+    *out_max_data_len = hdr.ndc_block_max_data_sz;
+    nffs_checkpoint_gen = hdr.ndc_gen;
+    STATS_INC(nffs_stats, nffs_checkpoint_restores);
+
+    return 0;
+}
+
+/**
+ * Erases the checkpoint header, if there is a checkpoint.
+ */
+void
+nffs_checkpoint_invalidate(void)
+{
+    uint32_t magic;
+    int rc;
+
+    if (nffs_checkpoint_desc.nad_length == 0) {
+        return;
+    }
+
+    rc = hal_flash_read(nffs_checkpoint_desc.nad_flash_id,
+                        nffs_checkpoint_desc.nad_offset, &magic, sizeof magic);
+    if (rc == 0 && magic == NFFS_CHECKPOINT_MAGIC) {
+        hal_flash_erase(nffs_checkpoint_desc.nad_flash_id,
+                        nffs_checkpoint_desc.nad_offset,
+                        sizeof (struct nffs_disk_checkpoint));
+    }
+}
+
+/**
+ * Requests a new checkpoint once the current file system operation
+ * completes.  Called when the areas change in a way which invalidates the
+ * existing checkpoint.
+ */
+void
+nffs_checkpoint_schedule(void)
+{
+    if (nffs_checkpoint_desc.nad_length != 0) {
+        nffs_checkpoint_pending = 1;
+    }
+}
+
+/**
+ * Writes the checkpoint requested with nffs_checkpoint_schedule(), if any.
+ * Must only be called when no file system operation is in progress.
+ */
+void
+nffs_checkpoint_write_pending(void)
+{
+    if (nffs_checkpoint_pending) {
+        nffs_checkpoint_write();
+    }
+}
+
+/**
+ * Sets the flash region holding the checkpoint.
+ *
+ * @param desc                  The region to use; NULL to stop using
+ *                                  checkpoints.
+ *
+ * @return                      0 on success; FS_EINVAL if the region can't
+ *                                  hold a checkpoint header.
+ */
+int
+nffs_checkpoint_set_desc(const struct nffs_area_desc *desc)
+{
+    nffs_checkpoint_pending = 0;
+
+    if (desc == NULL) {
+        memset(&nffs_checkpoint_desc, 0, sizeof nffs_checkpoint_desc);
+        return 0;
+    }
+
+    if (desc->nad_length < sizeof (struct nffs_disk_checkpoint)) {
+        return FS_EINVAL;
+    }
+
+    nffs_checkpoint_desc = *desc;
+    return 0;
+}
+
+#endif
@@ -17,6 +17,7 @@
  * under the License.
  */
 
+#include "os/mynewt.h"
 #include "nffs/nffs.h"
 
 struct nffs_config nffs_config;
@@ -25,8 +26,8 @@ const struct nffs_config nffs_config_dflt = {
     .nc_num_inodes = 100,
     .nc_num_blocks = 100,
     .nc_num_files = 4,
-    .nc_num_cache_inodes = 4,
-    .nc_num_cache_blocks = 64,
+    .nc_num_cache_inodes = MYNEWT_VAL(NFFS_NUM_CACHE_INODES),
+    .nc_num_cache_blocks = MYNEWT_VAL(NFFS_NUM_CACHE_BLOCKS),
     .nc_num_dirs = 4,
 };
 
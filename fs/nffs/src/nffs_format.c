@@ -112,6 +112,7 @@ nffs_format_full(const struct nffs_area_desc *area_descs)
 
     /* Start from a clean state. */
     nffs_misc_reset();
+    nffs_checkpoint_invalidate();
 
     /* Select largest area to be the initial scratch area. */
     nffs_scratch_area_idx = 0;
@@ -467,7 +467,7 @@ nffs_gc(uint8_t *out_area_idx)
         return rc;
     }
 
-    for (i = 0; i < NFFS_HASH_SIZE; i++) {
+    for (i = 0; i < nffs_hash_size; i++) {
         entry = SLIST_FIRST(nffs_hash + i);
         while (entry != NULL) {
             next = SLIST_NEXT(entry, nhe_next);
@@ -535,6 +535,9 @@ nffs_gc(uint8_t *out_area_idx)
     nffs_gc_count++;
     STATS_INC(nffs_stats, nffs_gccnt);
 
+    /* The area headers changed; the checkpoint no longer applies. */
+    nffs_checkpoint_schedule();
+
     return 0;
 }
 
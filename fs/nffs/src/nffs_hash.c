@@ -23,7 +23,12 @@
 #include "nffs/nffs.h"
 #include "nffs_priv.h"
 
+/** Number of entries per bucket, on average, at which the table grows. */
+#define NFFS_HASH_LOAD_MAX  2
+
 struct nffs_hash_list *nffs_hash;
+int nffs_hash_size;
+static int nffs_hash_cnt;
 
 uint32_t nffs_hash_next_dir_id;
 uint32_t nffs_hash_next_file_id;
@@ -56,7 +61,7 @@ nffs_hash_id_is_block(uint32_t id)
 static int
 nffs_hash_fn(uint32_t id)
 {
-    return id % NFFS_HASH_SIZE;
+    return id % nffs_hash_size;
 }
 
 static struct nffs_hash_entry *
@@ -156,6 +161,7 @@ nffs_hash_insert(struct nffs_hash_entry *entry)
     list = nffs_hash + idx;
 
     SLIST_INSERT_HEAD(list, entry, nhe_next);
+    nffs_hash_cnt++;
     STATS_INC(nffs_stats, nffs_hashcnt_ins);
 
     if (nffs_hash_id_is_inode(entry->nhe_id)) {
@@ -186,6 +192,7 @@ nffs_hash_remove(struct nffs_hash_entry *entry)
     list = nffs_hash + idx;
 
     SLIST_REMOVE(list, entry, nffs_hash_entry, nhe_next);
+    nffs_hash_cnt--;
     STATS_INC(nffs_stats, nffs_hashcnt_rm);
 
     if (nffs_hash_id_is_inode(entry->nhe_id) && nie) {
@@ -201,14 +208,68 @@ nffs_hash_init(void)
 
     free(nffs_hash);
 
-    nffs_hash = malloc(NFFS_HASH_SIZE * sizeof *nffs_hash);
+    nffs_hash_size = MYNEWT_VAL(NFFS_HASH_SIZE);
+    nffs_hash_cnt = 0;
+    nffs_hash = malloc(nffs_hash_size * sizeof *nffs_hash);
     if (nffs_hash == NULL) {
         return FS_ENOMEM;
     }
 
-    for (i = 0; i < NFFS_HASH_SIZE; i++) {
+    for (i = 0; i < nffs_hash_size; i++) {
         SLIST_INIT(nffs_hash + i);
     }
 
     return 0;
 }
+
+/**
+ * Increases the number of hash buckets if the chains have gotten long, up to
+ * NFFS_HASH_SIZE_MAX.  Every entry gets rehashed, so this must not be called
+ * while the table is being iterated.  If memory for the larger table cannot
+ * be allocated, the current one is kept.
+ */
+void
+nffs_hash_grow(void)
+{
+    struct nffs_hash_entry *entry;
+    struct nffs_hash_list *list;
+    int new_size;
+    int i;
+
+    if (nffs_hash_cnt <= nffs_hash_size * NFFS_HASH_LOAD_MAX ||
+        nffs_hash_size >= MYNEWT_VAL(NFFS_HASH_SIZE_MAX)) {
+
+        return;
+    }
+
+    new_size = nffs_hash_size * 2;
+    while (new_size < MYNEWT_VAL(NFFS_HASH_SIZE_MAX) &&
+           nffs_hash_cnt > new_size * NFFS_HASH_LOAD_MAX) {
+
+        new_size *= 2;
+    }
+    if (new_size > MYNEWT_VAL(NFFS_HASH_SIZE_MAX)) {
+        new_size = MYNEWT_VAL(NFFS_HASH_SIZE_MAX);
+    }
+
+    list = malloc(new_size * sizeof *list);
+    if (list == NULL) {
+        return;
+    }
+    for (i = 0; i < new_size; i++) {
+        SLIST_INIT(list + i);
+    }
+
+    for (i = 0; i < nffs_hash_size; i++) {
+        while ((entry = SLIST_FIRST(nffs_hash + i)) != NULL) {
+            SLIST_REMOVE_HEAD(nffs_hash + i, nhe_next);
+            SLIST_INSERT_HEAD(list + entry->nhe_id % new_size, entry,
+                              nhe_next);
+        }
+    }
+
+    free(nffs_hash);
+    nffs_hash = list;
+    nffs_hash_size = new_size;
+    STATS_INC(nffs_stats, nffs_hashcnt_grow);
+}
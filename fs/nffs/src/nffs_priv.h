@@ -32,8 +32,6 @@
 extern "C" {
 #endif
 
-#define NFFS_HASH_SIZE               256
-
 #define NFFS_ID_DIR_MIN              0
 #define NFFS_ID_DIR_MAX              0x10000000
 #define NFFS_ID_FILE_MIN             0x10000000
@@ -250,6 +248,7 @@ struct nffs_dir {
 STATS_SECT_START(nffs_stats)
     STATS_SECT_ENTRY(nffs_hashcnt_ins)
     STATS_SECT_ENTRY(nffs_hashcnt_rm)
+    STATS_SECT_ENTRY(nffs_hashcnt_grow)
     STATS_SECT_ENTRY(nffs_object_count)
     STATS_SECT_ENTRY(nffs_iocnt_read)
     STATS_SECT_ENTRY(nffs_iocnt_write)
@@ -267,6 +266,12 @@ STATS_SECT_START(nffs_stats)
     STATS_SECT_ENTRY(nffs_readcnt_filename)
     STATS_SECT_ENTRY(nffs_readcnt_object)
     STATS_SECT_ENTRY(nffs_readcnt_detect)
+    STATS_SECT_ENTRY(nffs_cachecnt_inode_hit)
+    STATS_SECT_ENTRY(nffs_cachecnt_inode_miss)
+    STATS_SECT_ENTRY(nffs_cachecnt_block_hit)
+    STATS_SECT_ENTRY(nffs_cachecnt_block_miss)
+    STATS_SECT_ENTRY(nffs_checkpoint_writes)
+    STATS_SECT_ENTRY(nffs_checkpoint_restores)
 STATS_SECT_END
 extern STATS_SECT_DECL(nffs_stats) nffs_stats;
 
@@ -296,8 +301,10 @@ extern struct nffs_area_desc *nffs_current_area_descs;
 extern uint8_t nffs_flash_buf[NFFS_FLASH_BUF_SZ];
 
 extern struct nffs_hash_list *nffs_hash;
+extern int nffs_hash_size;
 extern struct nffs_inode_entry *nffs_root_dir;
 extern struct nffs_inode_entry *nffs_lost_found_dir;
+extern uint8_t nffs_restore_from_checkpoint;
 
 /* @area */
 int nffs_area_magic_is_set(const struct nffs_disk_area *disk_area);
@@ -359,6 +366,32 @@ int nffs_crc_disk_inode_validate(const struct nffs_disk_inode *disk_inode,
 void nffs_crc_disk_inode_fill(struct nffs_disk_inode *disk_inode,
                               const char *filename);
 
+/* @checkpoint */
+#if MYNEWT_VAL(NFFS_CHECKPOINT)
+int nffs_checkpoint_set_desc(const struct nffs_area_desc *desc);
+int nffs_checkpoint_write(void);
+int nffs_checkpoint_restore(uint16_t *out_max_data_len);
+void nffs_checkpoint_schedule(void);
+void nffs_checkpoint_write_pending(void);
+void nffs_checkpoint_invalidate(void);
+int nffs_checkpoint_sysdown(int reason);
+#else
+static inline void
+nffs_checkpoint_schedule(void)
+{
+}
+
+static inline void
+nffs_checkpoint_write_pending(void)
+{
+}
+
+static inline void
+nffs_checkpoint_invalidate(void)
+{
+}
+#endif
+
 /* @config */
 void nffs_config_init(void);
 
@@ -411,6 +444,7 @@ struct nffs_hash_entry *nffs_hash_find_block(uint32_t id);
 void nffs_hash_insert(struct nffs_hash_entry *entry);
 void nffs_hash_remove(struct nffs_hash_entry *entry);
 int nffs_hash_init(void);
+void nffs_hash_grow(void);
 int nffs_hash_entry_is_dummy(struct nffs_hash_entry *he);
 int nffs_hash_id_is_dummy(uint32_t id);
 
@@ -503,7 +537,7 @@ int nffs_write_to_file(struct nffs_file *file, const void *data, int len);
 
 
 #define NFFS_HASH_FOREACH(entry, i, next)                               \
-    for ((i) = 0; (i) < NFFS_HASH_SIZE; (i)++)                          \
+    for ((i) = 0; (i) < nffs_hash_size; (i)++)                          \
         for ((entry) = SLIST_FIRST(nffs_hash + (i));                    \
              (entry) && (((next)) = SLIST_NEXT((entry), nhe_next), 1);  \
              (entry) = ((next)))
@@ -32,6 +32,12 @@
  */
 static uint16_t nffs_restore_largest_block_data_len;
 
+/** Number of objects read from flash during the current restore. */
+static uint32_t nffs_restore_num_objects;
+
+/** Whether the last restore started from a checkpoint. */
+uint8_t nffs_restore_from_checkpoint;
+
 /**
  * Checks that each block a chain of data blocks was properly restored.
  *
@@ -287,7 +293,7 @@ nffs_restore_sweep(void)
     /* Iterate through every object in the hash table, deleting all inodes that
      * should be removed.
      */
-    for (i = 0; i < NFFS_HASH_SIZE; i++) {
+    for (i = 0; i < nffs_hash_size; i++) {
         list = nffs_hash + i;
 
         entry = SLIST_FIRST(list);
@@ -1030,7 +1036,7 @@ nffs_restore_disk_object_size(const struct nffs_disk_object *disk_object)
 
 /**
  * Reads the specified area from disk and loads its contents into the RAM
- * representation.
+ * representation.  Reading starts at the area's current offset.
  *
  * @param area_idx              The index of the area to read.
  *
@@ -1045,7 +1051,6 @@ nffs_restore_area_contents(int area_idx)
 
     area = nffs_areas + area_idx;
 
-    area->na_cur = sizeof (struct nffs_disk_area);
     while (1) {
         rc = nffs_restore_disk_object(area_idx, area->na_cur,  &disk_object);
         switch (rc) {
@@ -1064,8 +1069,12 @@ nffs_restore_area_contents(int area_idx)
                 area->na_cur++;
             } else {
                 STATS_INC(nffs_stats, nffs_object_count); /* restored objects */
+                nffs_restore_num_objects++;
                 area->na_cur += nffs_restore_disk_object_size(&disk_object);
             }
+
+            /* Lookups get slow with a crowded table; grow it as we go. */
+            nffs_hash_grow();
             break;
 
         case FS_ECORRUPT:
@@ -1159,7 +1168,7 @@ nffs_restore_corrupt_scratch(void)
     }
 
     /* Invalidate all objects resident in the bad area. */
-    for (i = 0; i < NFFS_HASH_SIZE; i++) {
+    for (i = 0; i < nffs_hash_size; i++) {
         entry = SLIST_FIRST(&nffs_hash[i]);
         while (entry != NULL) {
             next = SLIST_NEXT(entry, nhe_next);
@@ -1185,6 +1194,7 @@ nffs_restore_corrupt_scratch(void)
     /* Now that the objects in the scratch area have been invalidated, reload
      * everything from the good area.
      */
+    nffs_areas[good_idx].na_cur = sizeof (struct nffs_disk_area);
     rc = nffs_restore_area_contents(good_idx);
     if (rc != 0) {
         return rc;
@@ -1274,20 +1284,14 @@ nffs_log_contents(void)
 }
 
 /**
- * Searches for a valid nffs file system among the specified areas.  This
- * function succeeds if a file system is detected among any subset of the
- * supplied areas.  If the area set does not contain a valid file system,
- * a new one can be created via a call to nffs_format().
+ * Restores the file system from the specified areas.  With use_checkpoint
+ * set, the RAM representation is loaded from the checkpoint, and only the
+ * objects written after it are read from the areas.
  *
- * @param area_descs        The area set to search.  This array must be
- *                              terminated with a 0-length area.
- *
- * @return                  0 on success;
- *                          FS_ECORRUPT if no valid file system was detected;
- *                          other nonzero on error.
+ * @return                  0 on success; nonzero on failure.
  */
-int
-nffs_restore_full(const struct nffs_area_desc *area_descs)
+static int
+nffs_restore_all(const struct nffs_area_desc *area_descs, int use_checkpoint)
 {
     struct nffs_disk_area disk_area;
     int cur_area_idx;
@@ -1301,9 +1305,10 @@ nffs_restore_full(const struct nffs_area_desc *area_descs)
         return rc;
     }
     nffs_restore_largest_block_data_len = 0;
+    nffs_restore_num_objects = 0;
     nffs_current_area_descs = (struct nffs_area_desc*) area_descs;
 
-    /* Read each area from flash. */
+    /* Read each area header from flash. */
     for (i = 0; area_descs[i].nad_length != 0; i++) {
         if (i > NFFS_MAX_AREAS) {
             rc = FS_EINVAL;
@@ -1357,11 +1362,29 @@ nffs_restore_full(const struct nffs_area_desc *area_descs)
             } else {
                 nffs_areas[cur_area_idx].na_cur =
                     sizeof (struct nffs_disk_area);
-                nffs_restore_area_contents(cur_area_idx);
             }
         }
     }
 
+#if MYNEWT_VAL(NFFS_CHECKPOINT)
+    if (use_checkpoint) {
+        /* Load the checkpoint; this moves the current offset of each area
+         * past the objects it covers.
+         */
+        rc = nffs_checkpoint_restore(&nffs_restore_largest_block_data_len);
+        if (rc != 0) {
+            goto err;
+        }
+    }
+#endif
+
+    /* Read the contents of each area from flash. */
+    for (i = 0; i < nffs_num_areas; i++) {
+        if (i != nffs_scratch_area_idx) {
+            nffs_restore_area_contents(i);
+        }
+    }
+
     /* All areas have been restored from flash. */
 
     if (nffs_scratch_area_idx == NFFS_AREA_ID_NONE) {
@@ -1396,9 +1419,12 @@ nffs_restore_full(const struct nffs_area_desc *area_descs)
     }
 
     /* Delete from RAM any objects that were invalidated when subsequent areas
-     * were restored.
+     * were restored.  A checkpoint only holds valid objects; the sweep is
+     * only needed if objects were read on top of it.
      */
-    nffs_restore_sweep();
+    if (!use_checkpoint || nffs_restore_num_objects > 0) {
+        nffs_restore_sweep();
+    }
 
     /* Set the maximum data block size according to the size of the smallest
      * area.
@@ -1411,9 +1437,51 @@ nffs_restore_full(const struct nffs_area_desc *area_descs)
     NFFS_LOG_DEBUG("CONTENTS\n");
     nffs_log_contents();
 
+    nffs_restore_from_checkpoint = use_checkpoint;
+
     return 0;
 
 err:
     nffs_misc_reset();
     return rc;
 }
+
+/**
+ * Searches for a valid nffs file system among the specified areas.  This
+ * function succeeds if a file system is detected among any subset of the
+ * supplied areas.  If the area set does not contain a valid file system,
+ * a new one can be created via a call to nffs_format().
+ *
+ * If a checkpoint is configured and matches the areas, the file system is
+ * restored from it.  Otherwise, every object in the areas is read, and a new
+ * checkpoint is written for the next restore.
+ *
+ * @param area_descs        The area set to search.  This array must be
+ *                              terminated with a 0-length area.
+ *
+ * @return                  0 on success;
+ *                          FS_ECORRUPT if no valid file system was detected;
+ *                          other nonzero on error.
+ */
+int
+nffs_restore_full(const struct nffs_area_desc *area_descs)
+{
+    int rc;
+
+#if MYNEWT_VAL(NFFS_CHECKPOINT)
+    rc = nffs_restore_all(area_descs, 1);
+    if (rc == 0) {
+        return 0;
+    }
+#endif
+
+    rc = nffs_restore_all(area_descs, 0);
+
+#if MYNEWT_VAL(NFFS_CHECKPOINT)
+    if (rc == 0) {
+        nffs_checkpoint_write();
+    }
+#endif
+
+    return rc;
+}
@@ -0,0 +1,174 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef HW_BUS_DRIVERS_SIM_H_
+#define HW_BUS_DRIVERS_SIM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "os/mynewt.h"
+#include "bus/bus.h"
+#include "bus/bus_driver.h"
+#include "bus/bus_debug.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Queued transfers complete from event processed on configured queue */
+#define BUS_SIM_XFER_EVQ        0
+/** Queued transfers complete before xfer_start operation returns */
+#define BUS_SIM_XFER_IMMEDIATE  1
+/** No xfer_start operation, i.e. queued transfers use read and write */
+#define BUS_SIM_XFER_NONE       2
+
+/**
+ * Bus sim device configuration
+ */
+struct bus_sim_dev_cfg {
+    /** How queued transfers are executed (BUS_SIM_XFER_xxx) */
+    uint8_t xfer_mode;
+    /**
+     * Queue to post completion events to, NULL = default queue. Completion
+     * event stands for transfer complete interrupt, so task which processes
+     * this queue shall not lock the bus while transfers are queued.
+     */
+    struct os_eventq *evq;
+    /**
+     * Time it takes to complete each segment [ticks]. If 0, completion event
+     * is posted right away.
+     */
+    os_time_t latency;
+};
+
+/**
+ * Bus sim device object state
+ *
+ * Contents of these objects are managed internally by bus driver and shall not
+ * be accessed directly.
+ */
+struct bus_sim_dev {
+    struct bus_dev bdev;
+    struct bus_sim_dev_cfg cfg;
+    struct os_callout xfer_co;
+    /* Segment in flight */
+    struct bus_sim_node *xfer_node;
+    const struct bus_xfer_seg *xfer_seg;
+    uint16_t xfer_flags;
+    /** Number of times bus was configured for node */
+    uint32_t configure_cnt;
+
+#if MYNEWT_VAL(BUS_DEBUG_OS_DEV)
+    uint32_t devmagic;
+#endif
+};
+
+/**
+ * Bus sim node configuration
+ */
+struct bus_sim_node_cfg {
+    /** General node configuration */
+    struct bus_node_cfg node_cfg;
+};
+
+/**
+ * Bus sim node object state
+ *
+ * Node behaves like a typical register-mapped device: first byte written
+ * after a stop is a register address, following bytes are written to or read
+ * from consecutive registers. Registers can be accessed directly.
+ */
+struct bus_sim_node {
+    struct bus_node bnode;
+    /** Register contents */
+    uint8_t regs[256];
+    /** Current register address */
+    uint8_t reg;
+    /** Register address was written since last stop */
+    uint8_t reg_set;
+    /** If non-zero, all operations on node fail with this error */
+    int error;
+
+#if MYNEWT_VAL(BUS_DEBUG_OS_DEV)
+    uint32_t nodemagic;
+#endif
+};
+
+/**
+ * Initialize os_dev as bus sim device
+ *
+ * This can be passed as a parameter to os_dev_create() when creating os_dev
+ * object for bus sim device, however it's recommended to create devices using
+ * helper like bus_sim_dev_create().
+ *
+ * @param odev  Device object
+ * @param arg   Device configuration struct (struct bus_sim_dev_cfg)
+ */
+int
+bus_sim_dev_init_func(struct os_dev *odev, void *arg);
+
+/**
+ * Create bus sim device
+ *
+ * This is a convenient helper and recommended way to create os_dev for bus sim
+ * device instead of calling os_dev_create() directly.
+ *
+ * @param name  Name of device
+ * @param dev   Device state object
+ * @param cfg   Configuration
+ */
+static inline int
+bus_sim_dev_create(const char *name, struct bus_sim_dev *dev,
+                   struct bus_sim_dev_cfg *cfg)
+{
+    struct os_dev *odev = (struct os_dev *)dev;
+
+    return os_dev_create(odev, name, OS_DEV_INIT_PRIMARY, 0,
+                         bus_sim_dev_init_func, cfg);
+}
+
+/**
+ * Create bus sim node
+ *
+ * This is a convenient helper and recommended way to create os_dev for bus sim
+ * node instead of calling os_dev_create() directly.
+ *
+ * @param name  Name of device
+ * @param node  Node state object
+ * @param cfg   Configuration
+ * @param arg   Argument passed to node init callback
+ */
+static inline int
+bus_sim_node_create(const char *name, struct bus_sim_node *node,
+                    const struct bus_sim_node_cfg *cfg, void *arg)
+{
+    struct bus_node *bnode = (struct bus_node *)node;
+    struct os_dev *odev = (struct os_dev *)node;
+
+    bnode->init_arg = arg;
+
+    return os_dev_create(odev, name, OS_DEV_INIT_PRIMARY, 1,
+                         bus_node_init_func, (void *)cfg);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HW_BUS_DRIVERS_SIM_H_ */
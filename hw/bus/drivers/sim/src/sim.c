@@ -0,0 +1,228 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <assert.h>
+#include <string.h>
+#include "defs/error.h"
+#include "bus/bus.h"
+#include "bus/bus_debug.h"
+#include "bus/drivers/sim.h"
+
+static int
+bus_sim_node_write(struct bus_sim_node *node, const uint8_t *buf,
+                   uint16_t length, uint16_t flags)
+{
+    uint16_t i;
+
+    if (node->error) {
+        return node->error;
+    }
+
+    i = 0;
+    if (length && !node->reg_set) {
+        node->reg = buf[i++];
+        node->reg_set = 1;
+    }
+    for (; i < length; i++) {
+        node->regs[node->reg++] = buf[i];
+    }
+
+    if (!(flags & BUS_F_NOSTOP)) {
+        node->reg_set = 0;
+    }
+
+    return 0;
+}
+
+static int
+bus_sim_node_read(struct bus_sim_node *node, uint8_t *buf, uint16_t length,
+                  uint16_t flags)
+{
+    uint16_t i;
+
+    if (node->error) {
+        return node->error;
+    }
+
+    for (i = 0; i < length; i++) {
+        buf[i] = node->regs[node->reg++];
+    }
+
+    if (!(flags & BUS_F_NOSTOP)) {
+        node->reg_set = 0;
+    }
+
+    return 0;
+}
+
+#if MYNEWT_VAL(BUS_XFER_QUEUE)
+static int
+bus_sim_seg_exec(struct bus_sim_node *node, const struct bus_xfer_seg *seg,
+                 uint16_t flags)
+{
+    if (seg->type == BUS_XFER_SEG_WRITE) {
+        return bus_sim_node_write(node, seg->wbuf, seg->len, flags);
+    }
+
+    return bus_sim_node_read(node, seg->rbuf, seg->len, flags);
+}
+
+static void
+bus_sim_xfer_event(struct os_event *ev)
+{
+    struct bus_sim_dev *dev = ev->ev_arg;
+    int rc;
+
+    rc = bus_sim_seg_exec(dev->xfer_node, dev->xfer_seg, dev->xfer_flags);
+
+    bus_dev_xfer_done(&dev->bdev, rc);
+}
+#endif
+
+static int
+bus_sim_init_node(struct bus_dev *bdev, struct bus_node *bnode, void *arg)
+{
+    struct bus_sim_node *node = (struct bus_sim_node *)bnode;
+
+    BUS_DEBUG_POISON_NODE(node);
+
+    memset(node->regs, 0, sizeof(node->regs));
+    node->reg = 0;
+    node->reg_set = 0;
+    node->error = 0;
+
+    return 0;
+}
+
+static int
+bus_sim_configure(struct bus_dev *bdev, struct bus_node *bnode)
+{
+    struct bus_sim_dev *dev = (struct bus_sim_dev *)bdev;
+    struct bus_sim_node *node = (struct bus_sim_node *)bnode;
+
+    BUS_DEBUG_VERIFY_DEV(dev);
+    BUS_DEBUG_VERIFY_NODE(node);
+
+    dev->configure_cnt++;
+
+    return 0;
+}
+
+static int
+bus_sim_read(struct bus_dev *bdev, struct bus_node *bnode, uint8_t *buf,
+             uint16_t length, os_time_t timeout, uint16_t flags)
+{
+    struct bus_sim_node *node = (struct bus_sim_node *)bnode;
+
+    BUS_DEBUG_VERIFY_DEV((struct bus_sim_dev *)bdev);
+    BUS_DEBUG_VERIFY_NODE(node);
+
+    return bus_sim_node_read(node, buf, length, flags);
+}
+
+static int
+bus_sim_write(struct bus_dev *bdev, struct bus_node *bnode, const uint8_t *buf,
+              uint16_t length, os_time_t timeout, uint16_t flags)
+{
+    struct bus_sim_node *node = (struct bus_sim_node *)bnode;
+
+    BUS_DEBUG_VERIFY_DEV((struct bus_sim_dev *)bdev);
+    BUS_DEBUG_VERIFY_NODE(node);
+
+    return bus_sim_node_write(node, buf, length, flags);
+}
+
+#if MYNEWT_VAL(BUS_XFER_QUEUE)
+static int
+bus_sim_xfer_start(struct bus_dev *bdev, struct bus_node *bnode,
+                   const struct bus_xfer_seg *seg, uint16_t flags)
+{
+    struct bus_sim_dev *dev = (struct bus_sim_dev *)bdev;
+    struct bus_sim_node *node = (struct bus_sim_node *)bnode;
+    int rc;
+
+    BUS_DEBUG_VERIFY_DEV(dev);
+    BUS_DEBUG_VERIFY_NODE(node);
+
+    if (dev->cfg.xfer_mode == BUS_SIM_XFER_IMMEDIATE) {
+        rc = bus_sim_seg_exec(node, seg, flags);
+        bus_dev_xfer_done(bdev, rc);
+        return 0;
+    }
+
+    dev->xfer_node = node;
+    dev->xfer_seg = seg;
+    dev->xfer_flags = flags;
+    if (dev->cfg.latency) {
+        os_callout_reset(&dev->xfer_co, dev->cfg.latency);
+    } else {
+        os_eventq_put(dev->xfer_co.c_evq, &dev->xfer_co.c_ev);
+    }
+
+    return 0;
+}
+#endif
+
+static const struct bus_dev_ops bus_sim_ops = {
+    .init_node = bus_sim_init_node,
+    .configure = bus_sim_configure,
+    .read = bus_sim_read,
+    .write = bus_sim_write,
+#if MYNEWT_VAL(BUS_XFER_QUEUE)
+    .xfer_start = bus_sim_xfer_start,
+#endif
+};
+
+static const struct bus_dev_ops bus_sim_ops_no_xfer = {
+    .init_node = bus_sim_init_node,
+    .configure = bus_sim_configure,
+    .read = bus_sim_read,
+    .write = bus_sim_write,
+};
+
+int
+bus_sim_dev_init_func(struct os_dev *odev, void *arg)
+{
+    struct bus_sim_dev *dev = (struct bus_sim_dev *)odev;
+    struct bus_sim_dev_cfg *cfg = arg;
+    const struct bus_dev_ops *ops;
+    int rc;
+
+    BUS_DEBUG_POISON_DEV(dev);
+
+    dev->cfg = *cfg;
+    dev->xfer_node = NULL;
+    dev->xfer_seg = NULL;
+    dev->configure_cnt = 0;
+#if MYNEWT_VAL(BUS_XFER_QUEUE)
+    os_callout_init(&dev->xfer_co, cfg->evq ? cfg->evq : os_eventq_dflt_get(),
+                    bus_sim_xfer_event, dev);
+#endif
+
+    if (cfg->xfer_mode == BUS_SIM_XFER_NONE) {
+        ops = &bus_sim_ops_no_xfer;
+    } else {
+        ops = &bus_sim_ops;
+    }
+
+    rc = bus_dev_init_func(odev, (void *)ops);
+    assert(rc == 0);
+
+    return 0;
+}
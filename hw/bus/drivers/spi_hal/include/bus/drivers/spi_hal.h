@@ -33,6 +33,11 @@ struct bus_spi_hal_dev {
     struct bus_spi_dev spi_dev;
 #if MYNEWT_VAL(SPI_HAL_USE_NOBLOCK)
     struct os_sem sem;
+#if MYNEWT_VAL(BUS_XFER_QUEUE)
+    /* Node of queued transfer segment in flight, NULL if none */
+    struct bus_spi_node *xfer_node;
+    uint16_t xfer_flags;
+#endif
 #endif
 };
 
@@ -60,6 +60,18 @@ static void
 bus_spi_txrx_cb(void *arg, int len)
 {
     struct bus_spi_hal_dev *dev = arg;
+#if MYNEWT_VAL(BUS_XFER_QUEUE)
+    struct bus_spi_node *node = dev->xfer_node;
+
+    if (node) {
+        dev->xfer_node = NULL;
+        if (!(dev->xfer_flags & BUS_F_NOSTOP)) {
+            bus_spi_set_cs(node, 1);
+        }
+        bus_dev_xfer_done(&dev->spi_dev.bdev, 0);
+        return;
+    }
+#endif
 
     os_sem_release(&dev->sem);
 }
@@ -203,6 +215,46 @@ bus_spi_write(struct bus_dev *bdev, struct bus_node *bnode, const uint8_t *buf,
     return rc;
 }
 
+static int
+bus_spi_writev(struct bus_dev *bdev, struct bus_node *bnode,
+               const struct os_iovec *iov, int iov_cnt, os_time_t timeout,
+               uint16_t flags)
+{
+    struct bus_spi_hal_dev *dev = (struct bus_spi_hal_dev *)bdev;
+    struct bus_spi_node *node = (struct bus_spi_node *)bnode;
+    int rc = 0;
+    int i;
+
+    BUS_DEBUG_VERIFY_DEV(&dev->spi_dev);
+    BUS_DEBUG_VERIFY_NODE(node);
+
+    /* CS stays asserted across segments so this is a single transfer */
+    bus_spi_set_cs(node, 0);
+
+    for (i = 0; i < iov_cnt && rc == 0; i++) {
+        if (iov[i].iov_len == 0) {
+            continue;
+        }
+
+#if MYNEWT_VAL(SPI_HAL_USE_NOBLOCK)
+        rc = hal_spi_txrx_noblock(dev->spi_dev.cfg.spi_num, iov[i].iov_base,
+                                  NULL, iov[i].iov_len);
+        if (rc == 0) {
+            os_sem_pend(&dev->sem, OS_TIMEOUT_NEVER);
+        }
+#else
+        rc = hal_spi_txrx(dev->spi_dev.cfg.spi_num, iov[i].iov_base, NULL,
+                          iov[i].iov_len);
+#endif
+    }
+
+    if (rc || !(flags & BUS_F_NOSTOP)) {
+        bus_spi_set_cs(node, 1);
+    }
+
+    return rc;
+}
+
 static int
 bus_spi_write_read(struct bus_dev *bdev, struct bus_node *bnode,
                    const uint8_t *wbuf, uint16_t wlength,
@@ -294,6 +346,43 @@ bus_spi_duplex_write_read(struct bus_dev *bdev, struct bus_node *bnode,
     return rc;
 }
 
+#if MYNEWT_VAL(SPI_HAL_USE_NOBLOCK) && MYNEWT_VAL(BUS_XFER_QUEUE)
+static int
+bus_spi_xfer_start(struct bus_dev *bdev, struct bus_node *bnode,
+                   const struct bus_xfer_seg *seg, uint16_t flags)
+{
+    struct bus_spi_hal_dev *dev = (struct bus_spi_hal_dev *)bdev;
+    struct bus_spi_node *node = (struct bus_spi_node *)bnode;
+    int rc;
+
+    BUS_DEBUG_VERIFY_DEV(&dev->spi_dev);
+    BUS_DEBUG_VERIFY_NODE(node);
+
+    bus_spi_set_cs(node, 0);
+
+    dev->xfer_node = node;
+    dev->xfer_flags = flags;
+
+    if (seg->type == BUS_XFER_SEG_WRITE) {
+        /* XXX update HAL to accept const instead */
+        rc = hal_spi_txrx_noblock(dev->spi_dev.cfg.spi_num,
+                                  (uint8_t *)seg->wbuf, NULL, seg->len);
+    } else {
+        /* Same as in bus_spi_read() */
+        memset(seg->rbuf, 0xFF, seg->len);
+        rc = hal_spi_txrx_noblock(dev->spi_dev.cfg.spi_num, seg->rbuf,
+                                  seg->rbuf, seg->len);
+    }
+
+    if (rc) {
+        dev->xfer_node = NULL;
+        bus_spi_set_cs(node, 1);
+    }
+
+    return rc;
+}
+#endif
+
 static int bus_spi_disable(struct bus_dev *bdev)
 {
     struct bus_spi_dev *spi_dev = (struct bus_spi_dev *)bdev;
@@ -318,6 +407,10 @@ static const struct bus_dev_ops bus_spi_ops = {
     .disable = bus_spi_disable,
     .write_read = bus_spi_write_read,
     .duplex_write_read = bus_spi_duplex_write_read,
+    .writev = bus_spi_writev,
+#if MYNEWT_VAL(SPI_HAL_USE_NOBLOCK) && MYNEWT_VAL(BUS_XFER_QUEUE)
+    .xfer_start = bus_spi_xfer_start,
+#endif
 };
 
 int
@@ -346,6 +439,9 @@ bus_spi_hal_dev_init_func(struct os_dev *odev, void *arg)
 #if MYNEWT_VAL(SPI_HAL_USE_NOBLOCK)
     rc = os_sem_init(&dev->sem, 0);
     assert(rc == 0);
+#if MYNEWT_VAL(BUS_XFER_QUEUE)
+    dev->xfer_node = NULL;
+#endif
 #endif
 
     rc = bus_dev_init_func(odev, (void*)&bus_spi_ops);
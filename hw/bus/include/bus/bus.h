@@ -22,8 +22,10 @@
 
 #include <stdint.h>
 #include "os/os_dev.h"
+#include "os/os_eventq.h"
 #include "os/os_mutex.h"
 #include "os/os_time.h"
+#include "os/os_mbuf.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -61,6 +63,60 @@ union bus_pm_options {
     } pm_mode_auto;
 };
 
+/** Segment types for queued transfers */
+#define BUS_XFER_SEG_WRITE  0
+#define BUS_XFER_SEG_READ   1
+
+/**
+ * Segment of queued transfer
+ *
+ * Each segment is a single write to or read from node, i.e. what
+ * bus_node_write() or bus_node_read() would do.
+ */
+struct bus_xfer_seg {
+    /** Segment type (BUS_XFER_SEG_xxx) */
+    uint8_t type;
+    /** Length of data to be written or read */
+    uint16_t len;
+    union {
+        /** Buffer with data to be written */
+        const void *wbuf;
+        /** Buffer to read data into */
+        void *rbuf;
+    };
+};
+
+/**
+ * Queued transfer
+ *
+ * Transfer is a list of segments executed on node back-to-back, i.e. with
+ * BUS_F_NOSTOP set for each segment except the last one. Once submitted, the
+ * object and all buffers it points to shall remain valid until the completion
+ * event is posted.
+ */
+struct bus_xfer {
+    /** Segments to be executed */
+    const struct bus_xfer_seg *segs;
+    /** Number of segments */
+    uint8_t seg_cnt;
+    /** Flags for last segment */
+    uint16_t flags;
+    /** Queue to post completion event to, NULL = default queue */
+    struct os_eventq *evq;
+    /**
+     * Completion event, posted once all segments are executed or when any of
+     * them failed. Callback and argument shall be set by caller.
+     */
+    struct os_event ev;
+    /** Result of transfer, 0 on success or SYS_xxx on error */
+    int status;
+
+    /* Internal, shall not be accessed directly */
+    struct os_dev *node;
+    uint8_t seg_idx;
+    STAILQ_ENTRY(bus_xfer) next;
+};
+
 /**
  * Read data from node
  *
@@ -103,6 +159,30 @@ int
 bus_node_write(struct os_dev *node, const void *buf, uint16_t length,
                os_time_t timeout, uint16_t flags);
 
+/**
+ * Write gather list to node
+ *
+ * Writes all buffers in the list to node as a single transfer, i.e. the same
+ * as bus_node_write() on the concatenated data, but without copying it. This
+ * allows e.g. an mbuf chain to be sent directly from its data buffers (see
+ * os_mbuf_iov_fill()). Bus is locked automatically for the duration of
+ * operation.
+ *
+ * Lists with more than one element require bus driver support; single-element
+ * lists work with any driver.
+ *
+ * @param node     Node device object
+ * @param iov      Buffers with data to be written
+ * @param iov_cnt  Number of elements in iov
+ * @param timeout  Operation timeout
+ * @param flags    Flags
+ *
+ * @return 0 on success, SYS_xxx on error
+ */
+int
+bus_node_writev(struct os_dev *node, const struct os_iovec *iov, int iov_cnt,
+                os_time_t timeout, uint16_t flags);
+
 /**
  * Perform write and read transaction on node
  *
@@ -149,6 +229,30 @@ bus_node_duplex_write_read(struct os_dev *node, const void *wbuf,
                            void *rbuf, uint16_t length,
                            os_time_t timeout, uint16_t flags);
 
+/**
+ * Submit transfer to node
+ *
+ * Queues transfer for execution on parent bus of given node and returns
+ * immediately. Transfers queued on the same bus are executed in submission
+ * order, one after another, and each has its completion event posted when
+ * done. Transfers are not executed while bus is locked with bus_node_lock(),
+ * but can be submitted at any time. Transfer can be submitted again once its
+ * completion event is posted.
+ *
+ * If bus driver does not support queued transfers, each transfer is executed
+ * using regular read and write operations with default transaction timeout
+ * by the task which submitted it or which unlocked the bus.
+ *
+ * This shall be called from task context. Requires BUS_XFER_QUEUE.
+ *
+ * @param node  Node device object
+ * @param xfer  Transfer to be executed
+ *
+ * @return 0 on success, SYS_xxx on error
+ */
+int
+bus_node_xfer_submit(struct os_dev *node, struct bus_xfer *xfer);
+
 /**
  * Read data from node
  *
@@ -32,6 +32,8 @@ extern "C" {
 
 struct bus_dev;
 struct bus_node;
+struct bus_xfer;
+struct bus_xfer_seg;
 
 #if MYNEWT_VAL(BUS_STATS)
 STATS_SECT_START(bus_stats_section)
@@ -72,6 +74,20 @@ struct bus_dev_ops {
     int (* duplex_write_read)(struct bus_dev *bdev, struct bus_node *bnode,
                               const uint8_t *wbuf, uint8_t *rbuf, uint16_t length,
                               os_time_t timeout, uint16_t flags);
+    /* Write gather list to node as a single transfer (optional) */
+    int (* writev)(struct bus_dev *bdev, struct bus_node *bnode,
+                   const struct os_iovec *iov, int iov_cnt,
+                   os_time_t timeout, uint16_t flags);
+    /*
+     * Start segment of queued transfer and return without waiting for it to
+     * complete (optional). Driver shall call bus_dev_xfer_done() once segment
+     * is completed, this can be done also before returning. Non-zero return
+     * value means segment was not started. Note that configure operation is
+     * called from the same context as bus_dev_xfer_done() when driver
+     * implements this.
+     */
+    int (* xfer_start)(struct bus_dev *bdev, struct bus_node *bnode,
+                       const struct bus_xfer_seg *seg, uint16_t flags);
 };
 
 /**
@@ -126,6 +142,26 @@ struct bus_dev {
 
     bool enabled;
 
+#if MYNEWT_VAL(BUS_XFER_QUEUE)
+    STAILQ_HEAD(, bus_xfer) xfer_q;
+    struct bus_xfer *xfer_cur;
+    /* Released when queue is stopped and lock waiter is set */
+    struct os_sem xfer_sem;
+    int xfer_status;
+    /*
+     * Flags below are modified from both task and interrupt context, so each
+     * one has its own byte.
+     */
+    /* Queue is being executed, bus can't be used by lock owner */
+    uint8_t xfer_busy;
+    /* Queue is being executed in current context */
+    uint8_t xfer_running;
+    /* Segment completed and not processed yet */
+    uint8_t xfer_seg_done;
+    /* Lock owner waits for queue to stop */
+    uint8_t xfer_lock_waiter;
+#endif
+
 #if MYNEWT_VAL(BUS_DEBUG_OS_DEV)
     uint32_t devmagic;
 #endif
@@ -201,6 +237,20 @@ bus_node_init_func(struct os_dev *node, void *arg);
 void
 bus_node_set_callbacks(struct os_dev *node, struct bus_node_callbacks *cbs);
 
+/**
+ * Complete segment of queued transfer
+ *
+ * This shall be called by bus driver once segment started by xfer_start
+ * operation is completed. It can be called from interrupt context and from
+ * inside xfer_start. Next segment or transfer is started from this call, so
+ * driver shall be ready to accept it.
+ *
+ * @param bdev    Bus device object
+ * @param status  0 on success, SYS_xxx on error
+ */
+void
+bus_dev_xfer_done(struct bus_dev *bdev, int status);
+
 #ifdef __cplusplus
 }
 #endif
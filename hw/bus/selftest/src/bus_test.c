@@ -0,0 +1,36 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "bus_test.h"
+
+TEST_SUITE(bus_test_suite_xfer)
+{
+    bus_test_case_xfer_queue();
+    bus_test_case_xfer_lock();
+    bus_test_case_xfer_wait();
+    bus_test_case_xfer_immediate();
+    bus_test_case_xfer_fallback();
+}
+
+int
+main(int argc, char **argv)
+{
+    bus_test_suite_xfer();
+    return tu_any_failed;
+}
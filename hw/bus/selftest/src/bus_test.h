@@ -0,0 +1,56 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_BUS_TEST_H
+#define H_BUS_TEST_H
+
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+#include "bus/bus.h"
+#include "bus/drivers/sim.h"
+
+#define BUS_TEST_NODE_CNT       3
+#define BUS_TEST_MAX_DONE       16
+
+extern struct bus_sim_dev bus_test_dev;
+extern struct bus_sim_node bus_test_nodes[BUS_TEST_NODE_CNT];
+/* Segment completions, processed by bus_test_step() */
+extern struct os_eventq bus_test_bus_evq;
+/* Transfers in order of completion */
+extern struct bus_xfer *bus_test_done[BUS_TEST_MAX_DONE];
+extern int bus_test_done_cnt;
+/* Released for each completed transfer */
+extern struct os_sem bus_test_done_sem;
+
+void bus_test_init(uint8_t xfer_mode, struct os_eventq *evq,
+                   os_time_t latency);
+struct os_dev *bus_test_node(int idx);
+void bus_test_xfer_init(struct bus_xfer *xfer, const struct bus_xfer_seg *segs,
+                        int seg_cnt);
+int bus_test_step(void);
+int bus_test_run(void);
+
+TEST_SUITE_DECL(bus_test_suite_xfer);
+TEST_CASE_DECL(bus_test_case_xfer_queue);
+TEST_CASE_DECL(bus_test_case_xfer_lock);
+TEST_CASE_DECL(bus_test_case_xfer_wait);
+TEST_CASE_DECL(bus_test_case_xfer_immediate);
+TEST_CASE_DECL(bus_test_case_xfer_fallback);
+
+#endif
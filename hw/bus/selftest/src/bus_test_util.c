@@ -0,0 +1,133 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "bus_test.h"
+
+static const char *bus_test_node_names[BUS_TEST_NODE_CNT] = {
+    "bus_test_node0",
+    "bus_test_node1",
+    "bus_test_node2",
+};
+
+struct bus_sim_dev bus_test_dev;
+struct bus_sim_node bus_test_nodes[BUS_TEST_NODE_CNT];
+struct os_eventq bus_test_bus_evq;
+struct bus_xfer *bus_test_done[BUS_TEST_MAX_DONE];
+int bus_test_done_cnt;
+struct os_sem bus_test_done_sem;
+
+/**
+ * Creates sim bus with BUS_TEST_NODE_CNT nodes.  Segment completions are
+ * posted to `evq`, or to bus_test_bus_evq if it's NULL.
+ */
+void
+bus_test_init(uint8_t xfer_mode, struct os_eventq *evq, os_time_t latency)
+{
+    struct bus_sim_dev_cfg dev_cfg;
+    struct bus_sim_node_cfg node_cfg;
+    int rc;
+    int i;
+
+    os_eventq_init(&bus_test_bus_evq);
+    os_sem_init(&bus_test_done_sem, 0);
+    bus_test_done_cnt = 0;
+
+    memset(&dev_cfg, 0, sizeof(dev_cfg));
+    dev_cfg.xfer_mode = xfer_mode;
+    dev_cfg.evq = evq ? evq : &bus_test_bus_evq;
+    dev_cfg.latency = latency;
+    rc = bus_sim_dev_create("bus_test", &bus_test_dev, &dev_cfg);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    memset(&node_cfg, 0, sizeof(node_cfg));
+    node_cfg.node_cfg.bus_name = "bus_test";
+    for (i = 0; i < BUS_TEST_NODE_CNT; i++) {
+        rc = bus_sim_node_create(bus_test_node_names[i], &bus_test_nodes[i],
+                                 &node_cfg, NULL);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+}
+
+struct os_dev *
+bus_test_node(int idx)
+{
+    return (struct os_dev *)&bus_test_nodes[idx];
+}
+
+static void
+bus_test_xfer_done(struct os_event *ev)
+{
+    TEST_ASSERT_FATAL(bus_test_done_cnt < BUS_TEST_MAX_DONE);
+
+    bus_test_done[bus_test_done_cnt++] = ev->ev_arg;
+    os_sem_release(&bus_test_done_sem);
+}
+
+/**
+ * Sets up transfer to have its completion recorded in bus_test_done.  The
+ * completion event is posted to the default event queue.
+ */
+void
+bus_test_xfer_init(struct bus_xfer *xfer, const struct bus_xfer_seg *segs,
+                   int seg_cnt)
+{
+    memset(xfer, 0, sizeof(*xfer));
+    xfer->segs = segs;
+    xfer->seg_cnt = seg_cnt;
+    xfer->ev.ev_cb = bus_test_xfer_done;
+    xfer->ev.ev_arg = xfer;
+    /* So that it's obvious when transfer did not complete */
+    xfer->status = 1;
+}
+
+/**
+ * Completes segment in flight.  Returns 0 if there was none.
+ */
+int
+bus_test_step(void)
+{
+    struct os_event *ev;
+
+    ev = os_eventq_get_no_wait(&bus_test_bus_evq);
+    if (ev == NULL) {
+        return 0;
+    }
+
+    ev->ev_cb(ev);
+
+    return 1;
+}
+
+/**
+ * Completes segments until there is nothing in flight.  Returns number of
+ * segments completed.
+ */
+int
+bus_test_run(void)
+{
+    int cnt;
+
+    cnt = 0;
+    while (bus_test_step()) {
+        cnt++;
+    }
+
+    return cnt;
+}
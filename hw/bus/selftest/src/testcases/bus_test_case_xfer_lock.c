@@ -0,0 +1,140 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "bus_test.h"
+
+static const uint8_t btcl_reg = 0x20;
+
+TEST_CASE_TASK(bus_test_case_xfer_lock)
+{
+    static const uint8_t wdata_a[] = { 0x20, 0xaa, 0xbb };
+    static const uint8_t wdata_b[] = { 0x20, 0xcc, 0xdd };
+    static uint8_t rdata[2];
+    static struct bus_xfer_seg segs_a[2];
+    static struct bus_xfer_seg seg_b;
+    static struct bus_xfer xfer_a;
+    static struct bus_xfer xfer_b;
+    int rc;
+
+    bus_test_init(BUS_SIM_XFER_EVQ, NULL, 0);
+
+    segs_a[0].type = BUS_XFER_SEG_WRITE;
+    segs_a[0].len = 1;
+    segs_a[0].wbuf = &btcl_reg;
+    segs_a[1].type = BUS_XFER_SEG_READ;
+    segs_a[1].len = sizeof(rdata);
+    segs_a[1].rbuf = rdata;
+    bus_test_xfer_init(&xfer_a, segs_a, 2);
+
+    seg_b.type = BUS_XFER_SEG_WRITE;
+    seg_b.len = sizeof(wdata_b);
+    seg_b.wbuf = wdata_b;
+    bus_test_xfer_init(&xfer_b, &seg_b, 1);
+
+    bus_test_nodes[0].regs[btcl_reg] = 0x55;
+    bus_test_nodes[0].regs[btcl_reg + 1] = 0x66;
+
+    /*** Bus can't be locked while transfer is in progress. */
+    rc = bus_node_xfer_submit(bus_test_node(0), &xfer_a);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(bus_test_step() == 1);
+
+    rc = bus_node_lock(bus_test_node(1), OS_TICKS_PER_SEC / 10);
+    TEST_ASSERT(rc == SYS_ETIMEOUT);
+
+    TEST_ASSERT(bus_test_step() == 1);
+    TEST_ASSERT(bus_test_done_cnt == 1);
+    TEST_ASSERT(xfer_a.status == 0);
+    TEST_ASSERT(rdata[0] == 0x55 && rdata[1] == 0x66);
+
+    /*** Transfers submitted while bus is locked wait for unlock. */
+    rc = bus_node_lock(bus_test_node(1), BUS_NODE_LOCK_DEFAULT_TIMEOUT);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = bus_node_xfer_submit(bus_test_node(0), &xfer_b);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(bus_test_step() == 0);
+
+    rc = bus_node_simple_write(bus_test_node(1), wdata_a, sizeof(wdata_a));
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(bus_test_step() == 0);
+
+    rc = bus_node_unlock(bus_test_node(1));
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(bus_test_run() == 1);
+    TEST_ASSERT(bus_test_done_cnt == 2);
+    TEST_ASSERT(xfer_b.status == 0);
+
+    TEST_ASSERT(bus_test_nodes[0].regs[btcl_reg] == 0xcc);
+    TEST_ASSERT(bus_test_nodes[0].regs[btcl_reg + 1] == 0xdd);
+    TEST_ASSERT(bus_test_nodes[1].regs[btcl_reg] == 0xaa);
+    TEST_ASSERT(bus_test_nodes[1].regs[btcl_reg + 1] == 0xbb);
+}
+
+TEST_CASE_TASK(bus_test_case_xfer_wait)
+{
+    static const uint8_t wdata_a[] = { 0x30, 1, 2 };
+    static const uint8_t wdata_b[] = { 0x30, 3, 4 };
+    static const uint8_t wdata_c[] = { 0x30, 5 };
+    static struct bus_xfer_seg segs_a[2];
+    static struct bus_xfer_seg seg_b;
+    static struct bus_xfer xfer_a;
+    static struct bus_xfer xfer_b;
+    int rc;
+
+    /* Segments complete on timer, from default task. */
+    bus_test_init(BUS_SIM_XFER_EVQ, os_eventq_dflt_get(), 2);
+
+    segs_a[0].type = BUS_XFER_SEG_WRITE;
+    segs_a[0].len = 1;
+    segs_a[0].wbuf = wdata_a;
+    segs_a[1].type = BUS_XFER_SEG_WRITE;
+    segs_a[1].len = sizeof(wdata_a) - 1;
+    segs_a[1].wbuf = &wdata_a[1];
+    bus_test_xfer_init(&xfer_a, segs_a, 2);
+
+    seg_b.type = BUS_XFER_SEG_WRITE;
+    seg_b.len = sizeof(wdata_b);
+    seg_b.wbuf = wdata_b;
+    bus_test_xfer_init(&xfer_b, &seg_b, 1);
+
+    rc = bus_node_xfer_submit(bus_test_node(0), &xfer_a);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = bus_node_xfer_submit(bus_test_node(0), &xfer_b);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /*** Blocking write waits for transfer in progress only. */
+    rc = bus_node_simple_write(bus_test_node(1), wdata_c, sizeof(wdata_c));
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(xfer_a.status == 0);
+    TEST_ASSERT(xfer_b.status == 1);
+    TEST_ASSERT(bus_test_nodes[1].regs[0x30] == 5);
+
+    /*** Queue is resumed once bus is unlocked. */
+    rc = os_sem_pend(&bus_test_done_sem, OS_TICKS_PER_SEC);
+    TEST_ASSERT(rc == 0);
+    rc = os_sem_pend(&bus_test_done_sem, OS_TICKS_PER_SEC);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT_FATAL(bus_test_done_cnt == 2);
+    TEST_ASSERT(bus_test_done[0] == &xfer_a);
+    TEST_ASSERT(bus_test_done[1] == &xfer_b);
+    TEST_ASSERT(xfer_b.status == 0);
+    TEST_ASSERT(bus_test_nodes[0].regs[0x30] == 3);
+    TEST_ASSERT(bus_test_nodes[0].regs[0x31] == 4);
+}
@@ -0,0 +1,100 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "bus_test.h"
+
+static const uint8_t btcm_reg = 0x40;
+
+/*
+ * Runs transfers on bus which completes them without going through the event
+ * queue, either in xfer_start or using regular read and write operations.
+ */
+static void
+btcm_run(uint8_t xfer_mode)
+{
+    static const uint8_t wdata[] = { 0x40, 1, 2, 3 };
+    static uint8_t rdata[3];
+    static struct bus_xfer_seg seg_a;
+    static struct bus_xfer_seg segs_b[2];
+    static struct bus_xfer xfer_a;
+    static struct bus_xfer xfer_b;
+    static struct bus_xfer xfer_c;
+    int rc;
+
+    bus_test_init(xfer_mode, NULL, 0);
+
+    seg_a.type = BUS_XFER_SEG_WRITE;
+    seg_a.len = sizeof(wdata);
+    seg_a.wbuf = wdata;
+    bus_test_xfer_init(&xfer_a, &seg_a, 1);
+
+    segs_b[0].type = BUS_XFER_SEG_WRITE;
+    segs_b[0].len = 1;
+    segs_b[0].wbuf = &btcm_reg;
+    segs_b[1].type = BUS_XFER_SEG_READ;
+    segs_b[1].len = sizeof(rdata);
+    segs_b[1].rbuf = rdata;
+    bus_test_xfer_init(&xfer_b, segs_b, 2);
+    bus_test_xfer_init(&xfer_c, segs_b, 2);
+
+    /*** Failed transfer does not affect following ones. */
+    bus_test_nodes[1].error = SYS_EREMOTEIO;
+
+    rc = bus_node_xfer_submit(bus_test_node(0), &xfer_a);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = bus_node_xfer_submit(bus_test_node(1), &xfer_b);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = bus_node_xfer_submit(bus_test_node(0), &xfer_c);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    TEST_ASSERT(bus_test_run() == 0);
+    TEST_ASSERT_FATAL(bus_test_done_cnt == 3);
+    TEST_ASSERT(bus_test_done[0] == &xfer_a);
+    TEST_ASSERT(bus_test_done[1] == &xfer_b);
+    TEST_ASSERT(bus_test_done[2] == &xfer_c);
+    TEST_ASSERT(xfer_a.status == 0);
+    TEST_ASSERT(xfer_b.status == SYS_EREMOTEIO);
+    TEST_ASSERT(xfer_c.status == 0);
+    TEST_ASSERT(memcmp(rdata, &wdata[1], 3) == 0);
+
+    /*** Transfers submitted while bus is locked wait for unlock. */
+    rc = bus_node_lock(bus_test_node(2), BUS_NODE_LOCK_DEFAULT_TIMEOUT);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    bus_test_xfer_init(&xfer_a, &seg_a, 1);
+    rc = bus_node_xfer_submit(bus_test_node(2), &xfer_a);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(bus_test_done_cnt == 3);
+
+    rc = bus_node_unlock(bus_test_node(2));
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(bus_test_done_cnt == 4);
+    TEST_ASSERT(xfer_a.status == 0);
+    TEST_ASSERT(memcmp(&bus_test_nodes[2].regs[btcm_reg], &wdata[1], 3) == 0);
+}
+
+TEST_CASE_TASK(bus_test_case_xfer_immediate)
+{
+    btcm_run(BUS_SIM_XFER_IMMEDIATE);
+}
+
+TEST_CASE_TASK(bus_test_case_xfer_fallback)
+{
+    btcm_run(BUS_SIM_XFER_NONE);
+}
@@ -0,0 +1,104 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "bus_test.h"
+
+static const uint8_t btcq_reg = 0x10;
+
+TEST_CASE_TASK(bus_test_case_xfer_queue)
+{
+    static uint8_t wdata[BUS_TEST_NODE_CNT][4];
+    static uint8_t rdata[BUS_TEST_NODE_CNT][3];
+    static struct bus_xfer_seg wsegs[BUS_TEST_NODE_CNT];
+    static struct bus_xfer_seg rsegs[BUS_TEST_NODE_CNT][2];
+    static struct bus_xfer wxfers[BUS_TEST_NODE_CNT];
+    static struct bus_xfer rxfers[BUS_TEST_NODE_CNT];
+    int rc;
+    int i;
+
+    bus_test_init(BUS_SIM_XFER_EVQ, NULL, 0);
+
+    for (i = 0; i < BUS_TEST_NODE_CNT; i++) {
+        wdata[i][0] = btcq_reg;
+        wdata[i][1] = i;
+        wdata[i][2] = i + 1;
+        wdata[i][3] = i + 2;
+        wsegs[i].type = BUS_XFER_SEG_WRITE;
+        wsegs[i].len = sizeof(wdata[i]);
+        wsegs[i].wbuf = wdata[i];
+        bus_test_xfer_init(&wxfers[i], &wsegs[i], 1);
+
+        rsegs[i][0].type = BUS_XFER_SEG_WRITE;
+        rsegs[i][0].len = 1;
+        rsegs[i][0].wbuf = &btcq_reg;
+        rsegs[i][1].type = BUS_XFER_SEG_READ;
+        rsegs[i][1].len = sizeof(rdata[i]);
+        rsegs[i][1].rbuf = rdata[i];
+        bus_test_xfer_init(&rxfers[i], rsegs[i], 2);
+    }
+
+    /*** Register writes and reads on each node, executed in order. */
+    for (i = 0; i < BUS_TEST_NODE_CNT; i++) {
+        rc = bus_node_xfer_submit(bus_test_node(i), &wxfers[i]);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+    for (i = 0; i < BUS_TEST_NODE_CNT; i++) {
+        rc = bus_node_xfer_submit(bus_test_node(i), &rxfers[i]);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    /* One segment at a time is in flight. */
+    TEST_ASSERT(bus_test_done_cnt == 0);
+    TEST_ASSERT(bus_test_step() == 1);
+    TEST_ASSERT(bus_test_done_cnt == 1);
+    TEST_ASSERT(bus_test_done[0] == &wxfers[0]);
+    TEST_ASSERT(wxfers[1].status == 1);
+
+    TEST_ASSERT(bus_test_run() == 8);
+    TEST_ASSERT_FATAL(bus_test_done_cnt == 2 * BUS_TEST_NODE_CNT);
+    for (i = 0; i < BUS_TEST_NODE_CNT; i++) {
+        TEST_ASSERT(bus_test_done[i] == &wxfers[i]);
+        TEST_ASSERT(bus_test_done[BUS_TEST_NODE_CNT + i] == &rxfers[i]);
+        TEST_ASSERT(wxfers[i].status == 0);
+        TEST_ASSERT(rxfers[i].status == 0);
+        TEST_ASSERT(memcmp(rdata[i], &wdata[i][1], 3) == 0);
+        TEST_ASSERT(memcmp(&bus_test_nodes[i].regs[btcq_reg], &wdata[i][1],
+                           3) == 0);
+    }
+    TEST_ASSERT(bus_test_dev.configure_cnt == 2 * BUS_TEST_NODE_CNT);
+
+    /*** Bus is configured once for consecutive transfers on node. */
+    bus_test_done_cnt = 0;
+    memset(rdata, 0, sizeof(rdata));
+    rc = bus_node_xfer_submit(bus_test_node(0), &wxfers[0]);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = bus_node_xfer_submit(bus_test_node(0), &rxfers[0]);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(bus_test_run() == 3);
+    TEST_ASSERT(bus_test_done_cnt == 2);
+    TEST_ASSERT(rxfers[0].status == 0);
+    TEST_ASSERT(memcmp(rdata[0], &wdata[0][1], 3) == 0);
+    TEST_ASSERT(bus_test_dev.configure_cnt == 2 * BUS_TEST_NODE_CNT + 1);
+
+    /*** Invalid transfers are rejected. */
+    wxfers[0].seg_cnt = 0;
+    rc = bus_node_xfer_submit(bus_test_node(0), &wxfers[0]);
+    TEST_ASSERT(rc == SYS_EINVAL);
+    TEST_ASSERT(bus_test_step() == 0);
+}
@@ -84,6 +84,268 @@ bus_dev_disable(struct bus_dev *bdev)
     bdev->enabled = false;
 }
 
+#if MYNEWT_VAL(BUS_XFER_QUEUE)
+static void
+bus_dev_xfer_complete(struct bus_dev *bdev, int status)
+{
+    struct bus_xfer *xfer = bdev->xfer_cur;
+
+    bdev->xfer_cur = NULL;
+    xfer->status = status;
+
+    os_eventq_put(xfer->evq ? xfer->evq : os_eventq_dflt_get(), &xfer->ev);
+}
+
+static void
+bus_dev_xfer_seg_complete(struct bus_dev *bdev)
+{
+    struct bus_xfer *xfer = bdev->xfer_cur;
+    int status = bdev->xfer_status;
+
+    if (status) {
+        if (xfer->segs[xfer->seg_idx].type == BUS_XFER_SEG_WRITE) {
+            BUS_STATS_INC(bdev, (struct bus_node *)xfer->node, write_errors);
+        } else {
+            BUS_STATS_INC(bdev, (struct bus_node *)xfer->node, read_errors);
+        }
+        bus_dev_xfer_complete(bdev, status);
+        return;
+    }
+
+    xfer->seg_idx++;
+    if (xfer->seg_idx == xfer->seg_cnt) {
+        bus_dev_xfer_complete(bdev, 0);
+    }
+}
+
+static int
+bus_dev_xfer_seg_start(struct bus_dev *bdev)
+{
+    struct bus_xfer *xfer = bdev->xfer_cur;
+    struct bus_node *bnode = (struct bus_node *)xfer->node;
+    const struct bus_xfer_seg *seg = &xfer->segs[xfer->seg_idx];
+    os_time_t timeout;
+    uint16_t flags;
+    int rc;
+
+    if (xfer->seg_idx == xfer->seg_cnt - 1) {
+        flags = xfer->flags;
+    } else {
+        flags = BUS_F_NOSTOP;
+    }
+
+    if (seg->type == BUS_XFER_SEG_WRITE) {
+        BUS_STATS_INC(bdev, bnode, write_ops);
+    } else {
+        BUS_STATS_INC(bdev, bnode, read_ops);
+    }
+
+    if (bdev->dops->xfer_start) {
+        return bdev->dops->xfer_start(bdev, bnode, seg, flags);
+    }
+
+    /* No driver support, we are in task context here so just do it */
+    timeout = os_time_ms_to_ticks32(MYNEWT_VAL(BUS_DEFAULT_TRANSACTION_TIMEOUT_MS));
+    if (seg->type == BUS_XFER_SEG_WRITE) {
+        rc = bdev->dops->write(bdev, bnode, seg->wbuf, seg->len, timeout, flags);
+    } else {
+        rc = bdev->dops->read(bdev, bnode, seg->rbuf, seg->len, timeout, flags);
+    }
+    bus_dev_xfer_done(bdev, rc);
+
+    return 0;
+}
+
+/*
+ * Executes queued transfers until segment is in flight, queue is empty or bus
+ * is locked. Shall be called with xfer_running set, i.e. there can be only
+ * one context executing queue at any time. Completions reported while queue
+ * is executed are handled in the loop instead of recursively.
+ */
+static void
+bus_dev_xfer_run(struct bus_dev *bdev)
+{
+    struct bus_xfer *xfer;
+    struct bus_node *bnode;
+    os_sr_t sr;
+    int rc;
+
+    while (1) {
+        if (bdev->xfer_seg_done) {
+            bdev->xfer_seg_done = 0;
+            bus_dev_xfer_seg_complete(bdev);
+        }
+
+        if (!bdev->xfer_cur) {
+            OS_ENTER_CRITICAL(sr);
+            xfer = STAILQ_FIRST(&bdev->xfer_q);
+            if (!xfer || bdev->lock.mu_owner) {
+                bdev->xfer_busy = 0;
+                bdev->xfer_running = 0;
+                if (bdev->xfer_lock_waiter) {
+                    bdev->xfer_lock_waiter = 0;
+                    os_sem_release(&bdev->xfer_sem);
+                }
+                OS_EXIT_CRITICAL(sr);
+#if MYNEWT_VAL(BUS_PM)
+                /* Lock owner takes care of this otherwise */
+                if (!xfer && bdev->pm_mode == BUS_PM_MODE_AUTO) {
+                    os_callout_reset(&bdev->inactivity_tmo,
+                                     bdev->pm_opts.pm_mode_auto.disable_tmo);
+                }
+#endif
+                return;
+            }
+            STAILQ_REMOVE_HEAD(&bdev->xfer_q, next);
+            bdev->xfer_cur = xfer;
+            OS_EXIT_CRITICAL(sr);
+
+            bnode = (struct bus_node *)xfer->node;
+            rc = 0;
+            if (!bdev->enabled) {
+                rc = SYS_EIO;
+            } else if (bdev->configured_for != bnode) {
+                rc = bdev->dops->configure(bdev, bnode);
+                bdev->configured_for = rc ? NULL : bnode;
+            }
+            if (rc) {
+                bus_dev_xfer_complete(bdev, rc);
+                continue;
+            }
+        }
+
+        rc = bus_dev_xfer_seg_start(bdev);
+        if (rc) {
+            bdev->xfer_status = rc;
+            bdev->xfer_seg_done = 1;
+        }
+
+        OS_ENTER_CRITICAL(sr);
+        if (!bdev->xfer_seg_done) {
+            /* bus_dev_xfer_done() will continue from here */
+            bdev->xfer_running = 0;
+            OS_EXIT_CRITICAL(sr);
+            return;
+        }
+        OS_EXIT_CRITICAL(sr);
+    }
+}
+
+/*
+ * Starts executing queue unless it's already executed or bus is locked. This
+ * shall be called from task context.
+ */
+static void
+bus_dev_xfer_kick(struct bus_dev *bdev)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    if (bdev->xfer_busy || STAILQ_EMPTY(&bdev->xfer_q) ||
+        bdev->lock.mu_owner) {
+        OS_EXIT_CRITICAL(sr);
+        return;
+    }
+    bdev->xfer_busy = 1;
+    bdev->xfer_running = 1;
+    OS_EXIT_CRITICAL(sr);
+
+#if MYNEWT_VAL(BUS_PM)
+    if (bdev->pm_mode == BUS_PM_MODE_AUTO) {
+        os_callout_stop(&bdev->inactivity_tmo);
+        bus_dev_enable(bdev);
+    }
+#endif
+
+    bus_dev_xfer_run(bdev);
+}
+
+/*
+ * Waits until queue execution is stopped. This shall be called by lock owner
+ * since queue is not started again until bus is unlocked.
+ */
+static int
+bus_dev_xfer_wait(struct bus_dev *bdev, os_time_t timeout)
+{
+    os_error_t err;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    if (!bdev->xfer_busy) {
+        OS_EXIT_CRITICAL(sr);
+        return 0;
+    }
+    bdev->xfer_lock_waiter = 1;
+    OS_EXIT_CRITICAL(sr);
+
+    err = os_sem_pend(&bdev->xfer_sem, timeout);
+    if (err != OS_OK) {
+        OS_ENTER_CRITICAL(sr);
+        if (bdev->xfer_lock_waiter) {
+            bdev->xfer_lock_waiter = 0;
+            OS_EXIT_CRITICAL(sr);
+            return SYS_ETIMEOUT;
+        }
+        OS_EXIT_CRITICAL(sr);
+        /* Released right after timeout, consume it */
+        (void)os_sem_pend(&bdev->xfer_sem, 0);
+    }
+
+    return 0;
+}
+
+void
+bus_dev_xfer_done(struct bus_dev *bdev, int status)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    bdev->xfer_status = status;
+    bdev->xfer_seg_done = 1;
+    if (bdev->xfer_running) {
+        OS_EXIT_CRITICAL(sr);
+        return;
+    }
+    bdev->xfer_running = 1;
+    OS_EXIT_CRITICAL(sr);
+
+    bus_dev_xfer_run(bdev);
+}
+#endif
+
+/*
+ * Locks bus device for internal use, i.e. without configuring it for any
+ * node. Queued transfers are not executed until bus_dev_release() is called.
+ */
+static int
+bus_dev_acquire(struct bus_dev *bdev)
+{
+    int rc;
+
+    rc = os_mutex_pend(&bdev->lock, OS_TIMEOUT_NEVER);
+    if (rc) {
+        return rc;
+    }
+
+#if MYNEWT_VAL(BUS_XFER_QUEUE)
+    if (os_mutex_get_level(&bdev->lock) == 1) {
+        (void)bus_dev_xfer_wait(bdev, OS_TIMEOUT_NEVER);
+    }
+#endif
+
+    return 0;
+}
+
+static void
+bus_dev_release(struct bus_dev *bdev)
+{
+    os_mutex_release(&bdev->lock);
+
+#if MYNEWT_VAL(BUS_XFER_QUEUE)
+    bus_dev_xfer_kick(bdev);
+#endif
+}
+
 static int
 bus_dev_suspend_func(struct os_dev *odev, os_time_t suspend_at, int force)
 {
@@ -101,14 +363,14 @@ bus_dev_suspend_func(struct os_dev *odev, os_time_t suspend_at, int force)
         return OS_EINVAL;
     }
 
-    rc = os_mutex_pend(&bdev->lock, OS_TIMEOUT_NEVER);
+    rc = bus_dev_acquire(bdev);
     if (rc) {
         return rc;
     }
 
     bus_dev_disable(bdev);
 
-    os_mutex_release(&bdev->lock);
+    bus_dev_release(bdev);
 
     return OS_OK;
 }
@@ -125,14 +387,14 @@ bus_dev_resume_func(struct os_dev *odev)
     }
 #endif
 
-    rc = os_mutex_pend(&bdev->lock, OS_TIMEOUT_NEVER);
+    rc = bus_dev_acquire(bdev);
     if (rc) {
         return rc;
     }
 
     bus_dev_enable(bdev);
 
-    os_mutex_release(&bdev->lock);
+    bus_dev_release(bdev);
 
     return OS_OK;
 }
@@ -144,17 +406,24 @@ bus_dev_inactivity_tmo_func(struct os_event *ev)
     struct bus_dev *bdev = (struct bus_dev *)ev->ev_arg;
     int rc;
 
-    rc = os_mutex_pend(&bdev->lock, OS_TIMEOUT_NEVER);
+    rc = bus_dev_acquire(bdev);
     if (rc) {
         return;
     }
 
     /* Just in case PM was changed while timer was running */
     if (bdev->pm_mode == BUS_PM_MODE_AUTO) {
+#if MYNEWT_VAL(BUS_XFER_QUEUE)
+        /* Queued transfers would enable it again right away */
+        if (STAILQ_EMPTY(&bdev->xfer_q)) {
+            bus_dev_disable(bdev);
+        }
+#else
         bus_dev_disable(bdev);
+#endif
     }
 
-    os_mutex_release(&bdev->lock);
+    bus_dev_release(bdev);
 }
 #endif
 
@@ -235,6 +504,15 @@ bus_dev_init_func(struct os_dev *odev, void *arg)
     bdev->configured_for = NULL;
 
     os_mutex_init(&bdev->lock);
+#if MYNEWT_VAL(BUS_XFER_QUEUE)
+    STAILQ_INIT(&bdev->xfer_q);
+    bdev->xfer_cur = NULL;
+    os_sem_init(&bdev->xfer_sem, 0);
+    bdev->xfer_busy = 0;
+    bdev->xfer_running = 0;
+    bdev->xfer_seg_done = 0;
+    bdev->xfer_lock_waiter = 0;
+#endif
 #if MYNEWT_VAL(BUS_PM)
     /* XXX allow custom eventq */
     os_callout_init(&bdev->inactivity_tmo, os_eventq_dflt_get(),
@@ -394,6 +672,60 @@ done:
     return rc;
 }
 
+int
+bus_node_writev(struct os_dev *node, const struct os_iovec *iov, int iov_cnt,
+                os_time_t timeout, uint16_t flags)
+{
+    struct bus_node *bnode = (struct bus_node *)node;
+    struct bus_dev *bdev = bnode->parent_bus;
+    int rc;
+    int i;
+
+    BUS_DEBUG_VERIFY_DEV(bdev);
+    BUS_DEBUG_VERIFY_NODE(bnode);
+
+    for (i = 0; i < iov_cnt; i++) {
+        if (iov[i].iov_len > UINT16_MAX) {
+            return SYS_EINVAL;
+        }
+    }
+
+    /*
+     * Splitting the list into separate writes is not equivalent on every bus
+     * (e.g. I2C would re-address the node for each one), so drivers have to
+     * opt in to lists with more than one element.
+     */
+    if (!bdev->dops->writev && (iov_cnt != 1 || !bdev->dops->write)) {
+        return SYS_ENOTSUP;
+    }
+
+    rc = bus_node_lock(node, bus_node_get_lock_timeout(node));
+    if (rc) {
+        return rc;
+    }
+
+    if (!bdev->enabled) {
+        rc = SYS_EIO;
+        goto done;
+    }
+
+    BUS_STATS_INC(bdev, bnode, write_ops);
+    if (bdev->dops->writev) {
+        rc = bdev->dops->writev(bdev, bnode, iov, iov_cnt, timeout, flags);
+    } else {
+        rc = bdev->dops->write(bdev, bnode, iov[0].iov_base, iov[0].iov_len,
+                               timeout, flags);
+    }
+    if (rc) {
+        BUS_STATS_INC(bdev, bnode, write_errors);
+    }
+
+done:
+    (void)bus_node_unlock(node);
+
+    return rc;
+}
+
 int
 bus_node_write_read_transact(struct os_dev *node, const void *wbuf,
                              uint16_t wlength, void *rbuf, uint16_t rlength,
@@ -496,6 +828,54 @@ done:
     return rc;
 }
 
+int
+bus_node_xfer_submit(struct os_dev *node, struct bus_xfer *xfer)
+{
+#if MYNEWT_VAL(BUS_XFER_QUEUE)
+    struct bus_node *bnode = (struct bus_node *)node;
+    struct bus_dev *bdev = bnode->parent_bus;
+    os_sr_t sr;
+    int i;
+
+    BUS_DEBUG_VERIFY_DEV(bdev);
+    BUS_DEBUG_VERIFY_NODE(bnode);
+
+    if (!xfer->segs || !xfer->seg_cnt) {
+        return SYS_EINVAL;
+    }
+
+    for (i = 0; i < xfer->seg_cnt; i++) {
+        switch (xfer->segs[i].type) {
+        case BUS_XFER_SEG_WRITE:
+            if (!bdev->dops->xfer_start && !bdev->dops->write) {
+                return SYS_ENOTSUP;
+            }
+            break;
+        case BUS_XFER_SEG_READ:
+            if (!bdev->dops->xfer_start && !bdev->dops->read) {
+                return SYS_ENOTSUP;
+            }
+            break;
+        default:
+            return SYS_EINVAL;
+        }
+    }
+
+    xfer->node = node;
+    xfer->seg_idx = 0;
+
+    OS_ENTER_CRITICAL(sr);
+    STAILQ_INSERT_TAIL(&bdev->xfer_q, xfer, next);
+    OS_EXIT_CRITICAL(sr);
+
+    bus_dev_xfer_kick(bdev);
+
+    return 0;
+#else
+    return SYS_ENOTSUP;
+#endif
+}
+
 int
 bus_node_lock(struct os_dev *node, os_time_t timeout)
 {
@@ -521,6 +901,20 @@ bus_node_lock(struct os_dev *node, os_time_t timeout)
         assert(err == OS_OK || err == OS_NOT_STARTED);
     }
 
+#if MYNEWT_VAL(BUS_XFER_QUEUE)
+    /* Queued transfer can be in progress, it has to finish first */
+    if (!MYNEWT_VAL(OS_SCHEDULING) || (os_mutex_get_level(&bdev->lock) == 1)) {
+        rc = bus_dev_xfer_wait(bdev, timeout);
+        if (rc) {
+            BUS_STATS_INC(bdev, bnode, lock_timeouts);
+            if (MYNEWT_VAL(OS_SCHEDULING)) {
+                os_mutex_release(&bdev->lock);
+            }
+            return rc;
+        }
+    }
+#endif
+
 #if MYNEWT_VAL(BUS_PM)
     /* In auto PM we need to enable bus device on first lock */
     if ((bdev->pm_mode == BUS_PM_MODE_AUTO) &&
@@ -577,6 +971,9 @@ bus_node_unlock(struct os_dev *node)
 #endif
 
     if (!MYNEWT_VAL(OS_SCHEDULING)) {
+#if MYNEWT_VAL(BUS_XFER_QUEUE)
+        bus_dev_xfer_kick(bdev);
+#endif
         return 0;
     }
     err = os_mutex_release(&bdev->lock);
@@ -590,6 +987,11 @@ bus_node_unlock(struct os_dev *node)
      */
     assert(err == OS_OK || err == OS_NOT_STARTED);
 
+#if MYNEWT_VAL(BUS_XFER_QUEUE)
+    /* Transfers queued while bus was locked */
+    bus_dev_xfer_kick(bdev);
+#endif
+
     return 0;
 }
 
@@ -613,7 +1015,7 @@ bus_dev_set_pm(struct os_dev *bus, bus_pm_mode_t pm_mode,
 
     BUS_DEBUG_VERIFY_DEV(bdev);
 
-    rc = os_mutex_pend(&bdev->lock, OS_TIMEOUT_NEVER);
+    rc = bus_dev_acquire(bdev);
     if (rc) {
         return SYS_EACCES;
     }
@@ -626,7 +1028,7 @@ bus_dev_set_pm(struct os_dev *bus, bus_pm_mode_t pm_mode,
         memset(&bdev->pm_opts, 0, sizeof(*pm_opts));
     }
 
-    os_mutex_release(&bdev->lock);
+    bus_dev_release(bdev);
 
     return 0;
 #else
@@ -28,8 +28,10 @@ extern "C" {
 #endif
 
 struct sim_accel_cfg {
+    /* Samples per read, also the depth of the FIFO */
     uint8_t sac_nr_samples;
     uint8_t sac_nr_axises;
+    /* Sample interval in OS ticks; 0 keeps the FIFO full */
     uint16_t sac_sample_itvl;
     sensor_type_t sac_mask;
 };
@@ -39,6 +41,10 @@ struct sim_accel {
     struct sensor sa_sensor;
     struct sim_accel_cfg sa_cfg;
     os_time_t sa_last_read_time;
+    /* Time of the oldest sample in the FIFO */
+    os_time_t sa_fifo_time;
+    /* Sequence number of the oldest sample in the FIFO, returned as x */
+    uint32_t sa_fifo_seq;
 };
 
 int sim_accel_init(struct os_dev *, void *);
@@ -34,12 +34,18 @@ static int sim_accel_sensor_read(struct sensor *, sensor_type_t,
         sensor_data_func_t, void *, uint32_t);
 static int sim_accel_sensor_get_config(struct sensor *, sensor_type_t,
         struct sensor_cfg *);
+static int sim_accel_sensor_read_fifo(struct sensor *, sensor_type_t,
+        sensor_fifo_data_func_t, void *, uint16_t, uint32_t);
 
 static const struct sensor_driver g_sim_accel_sensor_driver = {
-    sim_accel_sensor_read,
-    sim_accel_sensor_get_config
+    .sd_read = sim_accel_sensor_read,
+    .sd_get_config = sim_accel_sensor_get_config,
+    .sd_read_fifo = sim_accel_sensor_read_fifo,
 };
 
+/* Number of samples passed to the data function at a time by FIFO reads. */
+#define SIM_ACCEL_FIFO_BLOCK_SZ     (16)
+
 /**
  * Expects to be called back through os_dev_create().
  *
@@ -86,6 +92,9 @@ sim_accel_config(struct sim_accel *sa, struct sim_accel_cfg *cfg)
     /* Overwrite the configuration associated with this generic accelleromter. */
     memcpy(&sa->sa_cfg, cfg, sizeof(*cfg));
 
+    /* Start with an empty FIFO. */
+    sa->sa_fifo_time = os_time_get();
+
     return (0);
 }
 
@@ -115,8 +124,13 @@ sim_accel_sensor_read(struct sensor *sensor, sensor_type_t type,
      */
     now = os_time_get();
 
-    num_samples = (now - sa->sa_last_read_time) / sa->sa_cfg.sac_sample_itvl;
-    num_samples = min(num_samples, sa->sa_cfg.sac_nr_samples);
+    if (sa->sa_cfg.sac_sample_itvl == 0) {
+        num_samples = sa->sa_cfg.sac_nr_samples;
+    } else {
+        num_samples = (now - sa->sa_last_read_time) /
+                      sa->sa_cfg.sac_sample_itvl;
+        num_samples = min(num_samples, sa->sa_cfg.sac_nr_samples);
+    }
 
     /* By default only readings are provided for 1-axis (x), however,
      * if number of axises is configured, up to 3-axises of data can be
@@ -150,6 +164,83 @@ err:
     return (rc);
 }
 
+/**
+ * Reads the simulated FIFO.  Samples are generated every sample interval
+ * since the last FIFO read, up to the FIFO depth, after which the oldest ones
+ * are dropped.  Samples carry a sequence number in x.
+ */
+static int
+sim_accel_sensor_read_fifo(struct sensor *sensor, sensor_type_t type,
+        sensor_fifo_data_func_t data_func, void *data_arg,
+        uint16_t max_samples, uint32_t timeout)
+{
+    struct sensor_accel_data sad[SIM_ACCEL_FIFO_BLOCK_SZ];
+    struct sensor_fifo_data sfd;
+    struct sim_accel *sa;
+    os_time_t now;
+    uint32_t avail;
+    uint32_t todo;
+    uint32_t cnt;
+    int i;
+    int rc;
+
+    if (!(type & SENSOR_TYPE_ACCELEROMETER)) {
+        return SYS_EINVAL;
+    }
+
+    sa = (struct sim_accel *) SENSOR_GET_DEVICE(sensor);
+
+    now = os_time_get();
+    if (sa->sa_cfg.sac_sample_itvl == 0) {
+        avail = sa->sa_cfg.sac_nr_samples;
+    } else {
+        avail = (now - sa->sa_fifo_time) / sa->sa_cfg.sac_sample_itvl;
+        if (avail > sa->sa_cfg.sac_nr_samples) {
+            /* Overflow */
+            sa->sa_fifo_seq += avail - sa->sa_cfg.sac_nr_samples;
+            avail = sa->sa_cfg.sac_nr_samples;
+            sa->sa_fifo_time = now - avail * sa->sa_cfg.sac_sample_itvl;
+        }
+    }
+    todo = avail;
+    if (max_samples != 0) {
+        todo = min(todo, max_samples);
+    }
+
+    memset(&sfd, 0, sizeof(sfd));
+    sfd.sfd_type = SENSOR_TYPE_ACCELEROMETER;
+    sfd.sfd_samples = sad;
+    sfd.sfd_sample_size = sizeof(sad[0]);
+    sfd.sfd_itvl_us = (uint64_t)sa->sa_cfg.sac_sample_itvl * 1000000 /
+                      OS_TICKS_PER_SEC;
+
+    while (todo > 0) {
+        cnt = min(todo, SIM_ACCEL_FIFO_BLOCK_SZ);
+        for (i = 0; i < cnt; i++) {
+            sad[i].sad_x = sa->sa_fifo_seq + i;
+            sad[i].sad_y = 0.0;
+            sad[i].sad_z = 0.0;
+            sad[i].sad_x_is_valid = 1;
+            sad[i].sad_y_is_valid = sa->sa_cfg.sac_nr_axises > 1;
+            sad[i].sad_z_is_valid = sa->sa_cfg.sac_nr_axises > 2;
+        }
+        todo -= cnt;
+        avail -= cnt;
+
+        sa->sa_fifo_seq += cnt;
+        sa->sa_fifo_time += cnt * sa->sa_cfg.sac_sample_itvl;
+
+        sfd.sfd_count = cnt;
+        sfd.sfd_pending = avail;
+        rc = data_func(sensor, data_arg, &sfd);
+        if (rc != 0) {
+            return rc;
+        }
+    }
+
+    return (0);
+}
+
 static int
 sim_accel_sensor_get_config(struct sensor *sensor, sensor_type_t type,
         struct sensor_cfg *cfg)
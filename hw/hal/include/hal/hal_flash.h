@@ -81,6 +81,32 @@ int hal_flash_read(uint8_t flash_id, uint32_t address, void *dst,
 int hal_flash_write(uint8_t flash_id, uint32_t address, const void *src,
   uint32_t num_bytes);
 
+struct os_iovec;
+
+/**
+ * @brief Writes a gather list of buffers to consecutive flash addresses.
+ *
+ * The buffers are programmed back to back starting at `address`, as if they
+ * had first been concatenated into a single buffer, but without the copy.
+ * Segment boundaries need not be aligned; bytes that straddle an alignment
+ * unit are staged through a small buffer on the stack.  If the total length
+ * is not a multiple of the device's write alignment, the final unit is
+ * padded with the erased value.
+ *
+ * @param flash_id              The ID of the flash device to write to.
+ * @param address               The address to write to; must be aligned to
+ *                                  the device's write alignment.
+ * @param iov                   The buffers to write.
+ * @param iov_cnt               The number of elements in `iov`.
+ *
+ * @return                      0 on success;
+ *                              SYS_EINVAL on bad argument error;
+ *                              SYS_EACCES if flash region is write protected;
+ *                              SYS_EIO on flash driver error.
+ */
+int hal_flash_writev(uint8_t flash_id, uint32_t address,
+                     const struct os_iovec *iov, int iov_cnt);
+
 /**
  * @brief Erases a single flash sector.
  *
@@ -193,6 +219,62 @@ int hal_flash_init(void);
  */
 int hal_flash_write_protect(uint8_t id, uint8_t protect);
 
+/**
+ * Counters kept by the flash read cache (HAL_FLASH_READ_CACHE).
+ */
+struct hal_flash_cache_stats {
+    /** The number of line lookups served from the cache. */
+    uint32_t hfcs_hits;
+    /** The number of line lookups that had to read the device. */
+    uint32_t hfcs_misses;
+    /** The number of lines read ahead of a sequential scan. */
+    uint32_t hfcs_prefetches;
+    /** The number of reads larger than a line, passed to the driver. */
+    uint32_t hfcs_bypasses;
+    /** The number of cached lines dropped by writes and erases. */
+    uint32_t hfcs_invalidations;
+};
+
+/**
+ * @brief Enables or disables the read cache for a flash device.
+ *
+ * The devices in HAL_FLASH_READ_CACHE_DEVICES are cached from start up.
+ * Only available when HAL_FLASH_READ_CACHE is enabled.
+ *
+ * @param id          The ID of the flash; must be below 32.
+ * @param enable      1 - cache reads from the device
+ *                    0 - pass reads straight to the driver
+ *
+ * @return           SYS_EINVAL - if flash id is not valid
+ *                   SYS_OK - on success
+ */
+int hal_flash_cache_enable(uint8_t id, int enable);
+
+/**
+ * @brief Drops every cached line of a flash device.
+ *
+ * Writes and erases done through hal_flash keep the cache coherent.  This is
+ * only needed if the device contents are changed some other way.
+ *
+ * @param id          The ID of the flash
+ *
+ * @return           SYS_EINVAL - if flash id is not valid
+ *                   SYS_OK - on success
+ */
+int hal_flash_cache_invalidate(uint8_t id);
+
+/**
+ * @brief Reads the flash read cache counters.
+ *
+ * @param stats       Filled with the current counter values.
+ */
+void hal_flash_cache_stats_get(struct hal_flash_cache_stats *stats);
+
+/**
+ * @brief Resets the flash read cache counters.
+ */
+void hal_flash_cache_stats_clear(void);
+
 #ifdef __cplusplus
 }
 #endif
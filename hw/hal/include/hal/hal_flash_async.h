@@ -0,0 +1,166 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * @addtogroup HAL
+ * @{
+ *   @defgroup HALFlashAsync HAL Flash asynchronous operations
+ *   @{
+ */
+
+#ifndef H_HAL_FLASH_ASYNC_
+#define H_HAL_FLASH_ASYNC_
+
+#include <inttypes.h>
+#include "os/os_eventq.h"
+#include "os/os_time.h"
+#include "os/queue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Erase and program operations can be handed to a low priority flash worker
+ * task (HAL_FLASH_ASYNC) instead of being run by the caller.  The caller
+ * gets an event when the operation completes, and can do other work, or
+ * sleep, while the device is busy.  Operations are run one at a time, in
+ * submission order, through the regular hal_flash functions, so write
+ * protection, verification and the read cache behave as for synchronous
+ * calls.
+ */
+
+#define HAL_FLASH_OP_IDLE       0   /* Never submitted, or cancelled */
+#define HAL_FLASH_OP_QUEUED     1   /* Waiting for the worker task */
+#define HAL_FLASH_OP_RUNNING    2   /* Being run by the worker task */
+#define HAL_FLASH_OP_DONE       3   /* Complete; hfo_rc holds the result */
+
+/**
+ * An asynchronous flash operation.  The memory is owned by the caller and
+ * must stay valid until the operation is complete or cancelled.
+ */
+struct hal_flash_op {
+    /**
+     * Posted to hfo_evq once the operation is complete.  ev_arg is left
+     * as set by hal_flash_op_init().
+     */
+    struct os_event hfo_ev;
+    struct os_eventq *hfo_evq;
+    /** Released once the operation is complete or cancelled. */
+    struct os_sem hfo_sem;
+    const void *hfo_src;
+    uint32_t hfo_addr;
+    uint32_t hfo_len;
+    /** Result of the operation, as returned by the synchronous function. */
+    int hfo_rc;
+    uint8_t hfo_id;
+    uint8_t hfo_type;
+    volatile uint8_t hfo_state;
+    STAILQ_ENTRY(hal_flash_op) hfo_next;
+};
+
+/**
+ * @brief Prepares an operation for submission.
+ *
+ * @param op          The operation to initialize.
+ * @param evq         The event queue the completion event is posted to;
+ *                    NULL for no event.
+ * @param cb          The completion event callback.
+ * @param arg         The completion event argument.
+ */
+void hal_flash_op_init(struct hal_flash_op *op, struct os_eventq *evq,
+                       os_event_fn *cb, void *arg);
+
+/**
+ * @brief Queues the erase of a sector, as by hal_flash_erase_sector().
+ *
+ * @return                      0 if the operation was queued;
+ *                              SYS_EINVAL on bad argument error;
+ *                              SYS_EBUSY if op is already in progress.
+ */
+int hal_flash_erase_sector_async(uint8_t flash_id, uint32_t sector_address,
+                                 struct hal_flash_op *op);
+
+/**
+ * @brief Queues the erase of a range, as by hal_flash_erase().
+ *
+ * @return                      0 if the operation was queued;
+ *                              SYS_EINVAL on bad argument error;
+ *                              SYS_EBUSY if op is already in progress.
+ */
+int hal_flash_erase_async(uint8_t flash_id, uint32_t address,
+                          uint32_t num_bytes, struct hal_flash_op *op);
+
+/**
+ * @brief Queues a write, as by hal_flash_write().  The source buffer must
+ * stay valid until the operation is complete.
+ *
+ * @return                      0 if the operation was queued;
+ *                              SYS_EINVAL on bad argument error;
+ *                              SYS_EBUSY if op is already in progress.
+ */
+int hal_flash_write_async(uint8_t flash_id, uint32_t address,
+                          const void *src, uint32_t num_bytes,
+                          struct hal_flash_op *op);
+
+/**
+ * @brief Removes an operation from the queue if the worker has not
+ * started it yet.
+ *
+ * @return                      0 if the operation was cancelled, or was
+ *                                  not queued;
+ *                              SYS_EBUSY if the operation is running.
+ */
+int hal_flash_op_cancel(struct hal_flash_op *op);
+
+/**
+ * @brief Waits for an operation to complete.  Must be called from a task
+ * other than the flash worker; only one task may wait for an operation.
+ *
+ * @param op          The operation to wait for.
+ * @param timeout     The maximum time to wait, in OS ticks, or
+ *                    OS_TIMEOUT_NEVER.
+ *
+ * @return                      The result of the operation;
+ *                              SYS_ETIMEOUT if it did not complete in time;
+ *                              SYS_EINVAL if it was never submitted or
+ *                                  cannot be waited for here.
+ */
+int hal_flash_op_wait(struct hal_flash_op *op, os_time_t timeout);
+
+/**
+ * @brief Tells whether an operation is queued or running.
+ */
+static inline int
+hal_flash_op_busy(const struct hal_flash_op *op)
+{
+    return op->hfo_state == HAL_FLASH_OP_QUEUED ||
+           op->hfo_state == HAL_FLASH_OP_RUNNING;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* H_HAL_FLASH_ASYNC_ */
+
+/**
+ *   @} HALFlashAsync
+ * @} HAL
+ */
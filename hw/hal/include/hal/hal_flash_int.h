@@ -30,6 +30,7 @@ extern "C" {
  * API that flash driver has to implement.
  */
 struct hal_flash;
+struct os_iovec;
 
 struct hal_flash_funcs {
     int (*hff_read)(const struct hal_flash *dev, uint32_t address, void *dst,
@@ -45,6 +46,11 @@ struct hal_flash_funcs {
     int (*hff_init)(const struct hal_flash *dev);
     int (*hff_erase)(const struct hal_flash *dev, uint32_t address,
             uint32_t num_bytes);
+    /* Optional; write a gather list back to back.  Drivers that can program
+     * (or DMA) straight from each segment implement this; otherwise
+     * hal_flash_writev() splits the list into aligned hff_write() calls. */
+    int (*hff_writev)(const struct hal_flash *dev, uint32_t address,
+            const struct os_iovec *iov, int iov_cnt);
 };
 
 struct hal_flash {
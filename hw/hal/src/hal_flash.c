@@ -25,6 +25,7 @@
 #include "hal/hal_bsp.h"
 #include "hal/hal_flash.h"
 #include "hal/hal_flash_int.h"
+#include "hal_flash_priv.h"
 
 static uint8_t protected_flash[1];
 
@@ -128,7 +129,7 @@ hal_flash_read(uint8_t id, uint32_t address, void *dst, uint32_t num_bytes)
         return SYS_EINVAL;
     }
 
-    rc = hf->hf_itf->hff_read(hf, address, dst, num_bytes);
+    rc = hal_flash_cache_read(hf, id, address, dst, num_bytes);
     if (rc != 0) {
         return SYS_EIO;
     }
@@ -201,6 +202,7 @@ hal_flash_write(uint8_t id, uint32_t address, const void *src,
     }
 
     rc = hf->hf_itf->hff_write(hf, address, src, num_bytes);
+    hal_flash_cache_inval(id, address, num_bytes);
     if (rc != 0) {
         return SYS_EIO;
     }
@@ -212,6 +214,143 @@ hal_flash_write(uint8_t id, uint32_t address, const void *src,
     return 0;
 }
 
+static int
+hal_flash_write_chunk(const struct hal_flash *hf, uint32_t address,
+                      const void *src, uint32_t num_bytes)
+{
+    int rc;
+
+    rc = hf->hf_itf->hff_write(hf, address, src, num_bytes);
+    if (rc != 0) {
+        return SYS_EIO;
+    }
+
+#if MYNEWT_VAL(HAL_FLASH_VERIFY_WRITES)
+    assert(hal_flash_cmp(hf, address, src, num_bytes) == 0);
+#endif
+
+    return 0;
+}
+
+static int
+hal_flash_writev_stitch(const struct hal_flash *hf, uint32_t address,
+                        const struct os_iovec *iov, int iov_cnt)
+{
+    uint8_t stage[MYNEWT_VAL(HAL_FLASH_WRITEV_MAX_ALIGN)];
+    const uint8_t *u8p;
+    uint32_t chunk;
+    uint32_t align;
+    uint32_t rem;
+    int staged;
+    int rc;
+    int i;
+
+    align = hf->hf_align ? hf->hf_align : 1;
+
+    /* Program the aligned middle of each segment directly from the caller's
+     * buffer.  Only the bytes that straddle an alignment unit are staged.
+     */
+    staged = 0;
+    for (i = 0; i < iov_cnt; i++) {
+        u8p = iov[i].iov_base;
+        rem = iov[i].iov_len;
+
+        if (staged > 0) {
+            chunk = min(align - staged, rem);
+            memcpy(stage + staged, u8p, chunk);
+            staged += chunk;
+            u8p += chunk;
+            rem -= chunk;
+
+            if (staged < align) {
+                continue;
+            }
+            rc = hal_flash_write_chunk(hf, address, stage, align);
+            if (rc != 0) {
+                return rc;
+            }
+            address += align;
+            staged = 0;
+        }
+
+        chunk = rem - rem % align;
+        if (chunk > 0) {
+            rc = hal_flash_write_chunk(hf, address, u8p, chunk);
+            if (rc != 0) {
+                return rc;
+            }
+            address += chunk;
+            u8p += chunk;
+            rem -= chunk;
+        }
+
+        if (rem > 0) {
+            memcpy(stage, u8p, rem);
+            staged = rem;
+        }
+    }
+
+    if (staged > 0) {
+        memset(stage + staged, hf->hf_erased_val, align - staged);
+        rc = hal_flash_write_chunk(hf, address, stage, align);
+        if (rc != 0) {
+            return rc;
+        }
+    }
+
+    return 0;
+}
+
+int
+hal_flash_writev(uint8_t id, uint32_t address, const struct os_iovec *iov,
+                 int iov_cnt)
+{
+    const struct hal_flash *hf;
+    uint32_t num_bytes;
+    uint32_t align;
+    int rc;
+    int i;
+
+    hf = hal_bsp_flash_dev(id);
+    if (!hf || iov_cnt < 0) {
+        return SYS_EINVAL;
+    }
+
+    align = hf->hf_align ? hf->hf_align : 1;
+    if (align > MYNEWT_VAL(HAL_FLASH_WRITEV_MAX_ALIGN) ||
+      address % align != 0) {
+        return SYS_EINVAL;
+    }
+
+    num_bytes = 0;
+    for (i = 0; i < iov_cnt; i++) {
+        num_bytes += iov[i].iov_len;
+    }
+    if (num_bytes % align != 0) {
+        num_bytes += align - num_bytes % align;
+    }
+    if (hal_flash_check_addr(hf, address) ||
+      hal_flash_check_addr(hf, address + num_bytes)) {
+        return SYS_EINVAL;
+    }
+
+    if (protected_flash[id / 8] & (1 << (id & 7))) {
+        return SYS_EACCES;
+    }
+
+    if (hf->hf_itf->hff_writev) {
+        rc = hf->hf_itf->hff_writev(hf, address, iov, iov_cnt);
+        if (rc != 0) {
+            rc = SYS_EIO;
+        }
+    } else {
+        rc = hal_flash_writev_stitch(hf, address, iov, iov_cnt);
+    }
+    hal_flash_cache_inval(id, address, num_bytes);
+
+    return rc;
+}
+
 int
 hal_flash_erase_sector(uint8_t id, uint32_t sector_address)
 {
@@ -238,20 +377,29 @@ hal_flash_erase_sector(uint8_t id, uint32_t sector_address)
     }
 
     rc = hf->hf_itf->hff_erase_sector(hf, sector_address);
+
+#if MYNEWT_VAL(HAL_FLASH_READ_CACHE) || MYNEWT_VAL(HAL_FLASH_VERIFY_ERASES)
+    /* Find the sector bounds to invalidate the cache and verify the erase. */
+    for (i = 0; i < hf->hf_sector_cnt; i++) {
+        if (hf->hf_itf->hff_sector_info(hf, i, &start, &size) == 0 &&
+            sector_address >= start && sector_address < start + size) {
+            break;
+        }
+    }
+    if (i < hf->hf_sector_cnt) {
+        hal_flash_cache_inval(id, start, size);
+    } else {
+        hal_flash_cache_inval(id, sector_address,
+                              hf->hf_base_addr + hf->hf_size - sector_address);
+    }
+#endif
     if (rc != 0) {
         return SYS_EIO;
     }
 
 #if MYNEWT_VAL(HAL_FLASH_VERIFY_ERASES)
-    /* Find the sector bounds so we can verify the erase. */
-    for (i = 0; i < hf->hf_sector_cnt; i++) {
-        rc = hf->hf_itf->hff_sector_info(hf, i, &start, &size);
-        assert(rc == 0);
-
-        if (sector_address == start) {
-            assert(hal_flash_isempty_no_buf(id, start, size) == 1);
-            break;
-        }
+    if (i < hf->hf_sector_cnt && sector_address == start) {
+        assert(hal_flash_isempty_no_buf(id, start, size) == 1);
     }
 #endif
 
@@ -290,7 +438,10 @@ hal_flash_erase(uint8_t id, uint32_t address, uint32_t num_bytes)
     }
 
     if (hf->hf_itf->hff_erase) {
-        if (hf->hf_itf->hff_erase(hf, address, num_bytes)) {
+        rc = hf->hf_itf->hff_erase(hf, address, num_bytes);
+        /* The driver may have erased whole sectors around the range. */
+        hal_flash_cache_inval(id, hf->hf_base_addr, hf->hf_size);
+        if (rc != 0) {
             return SYS_EIO;
         }
 #if MYNEWT_VAL(HAL_FLASH_VERIFY_ERASES)
@@ -306,7 +457,9 @@ hal_flash_erase(uint8_t id, uint32_t address, uint32_t num_bytes)
                  * If some region of eraseable area falls inside sector,
                  * erase the sector.
                  */
-                if (hf->hf_itf->hff_erase_sector(hf, start)) {
+                rc = hf->hf_itf->hff_erase_sector(hf, start);
+                hal_flash_cache_inval(id, start, size);
+                if (rc != 0) {
                     return SYS_EIO;
                 }
 
@@ -319,27 +472,32 @@ hal_flash_erase(uint8_t id, uint32_t address, uint32_t num_bytes)
     return 0;
 }
 
+static int
+hal_flash_buf_is_erased(const struct hal_flash *hf, const uint8_t *buf,
+                        uint32_t num_bytes)
+{
+    uint32_t i;
+
+    for (i = 0; i < num_bytes; i++) {
+        if (buf[i] != hf->hf_erased_val) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
 int
 hal_flash_is_erased(const struct hal_flash *hf, uint32_t address, void *dst,
         uint32_t num_bytes)
 {
-    uint32_t i;
-    uint8_t *buf;
     int rc;
 
-    buf = dst;
-
     rc = hf->hf_itf->hff_read(hf, address, dst, num_bytes);
     if (rc != 0) {
         return SYS_EIO;
     }
 
-    for (i = 0; i < num_bytes; i++) {
-        if (buf[i] != hf->hf_erased_val) {
-            return 0;
-        }
-    }
-    return 1;
+    return hal_flash_buf_is_erased(hf, dst, num_bytes);
 }
 
 int
@@ -364,7 +522,11 @@ hal_flash_isempty(uint8_t id, uint32_t address, void *dst, uint32_t num_bytes)
             return rc;
         }
     } else {
-        return hal_flash_is_erased(hf, address, dst, num_bytes);
+        rc = hal_flash_cache_read(hf, id, address, dst, num_bytes);
+        if (rc != 0) {
+            return SYS_EIO;
+        }
+        return hal_flash_buf_is_erased(hf, dst, num_bytes);
     }
 }
 
@@ -0,0 +1,257 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <assert.h>
+#include <string.h>
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(HAL_FLASH_ASYNC)
+
+#include "hal/hal_flash.h"
+#include "hal/hal_flash_async.h"
+
+/*
+ * Asynchronous flash operations.
+ *
+ * Submitted operations are queued and run one at a time by a dedicated low
+ * priority task, through the synchronous hal_flash functions.  Drivers that
+ * sleep while waiting for the device (e.g., spiflash for long erases) leave
+ * the CPU to other tasks for the duration of the operation; the submitter
+ * only blocks if it chooses to wait.
+ */
+
+#define HAL_FLASH_OP_T_ERASE_SECTOR 1
+#define HAL_FLASH_OP_T_ERASE        2
+#define HAL_FLASH_OP_T_WRITE        3
+
+struct hal_flash_async {
+    STAILQ_HEAD(, hal_flash_op) hfa_ops;
+    struct os_eventq hfa_evq;
+    struct os_event hfa_ev;
+    struct os_task hfa_task;
+};
+
+static struct hal_flash_async hal_flash_async;
+OS_TASK_STACK_DEFINE(hal_flash_async_stack,
+                     MYNEWT_VAL(HAL_FLASH_ASYNC_STACK_SIZE));
+
+void
+hal_flash_op_init(struct hal_flash_op *op, struct os_eventq *evq,
+                  os_event_fn *cb, void *arg)
+{
+    memset(op, 0, sizeof(*op));
+    os_sem_init(&op->hfo_sem, 0);
+    op->hfo_evq = evq;
+    op->hfo_ev.ev_cb = cb;
+    op->hfo_ev.ev_arg = arg;
+}
+
+static int
+hal_flash_async_submit(struct hal_flash_op *op, uint8_t type, uint8_t id,
+                       uint32_t address, const void *src, uint32_t num_bytes)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    if (hal_flash_op_busy(op)) {
+        OS_EXIT_CRITICAL(sr);
+        return SYS_EBUSY;
+    }
+    op->hfo_type = type;
+    op->hfo_id = id;
+    op->hfo_addr = address;
+    op->hfo_src = src;
+    op->hfo_len = num_bytes;
+    op->hfo_rc = 0;
+    /* Drop the token of a previous run nobody waited for. */
+    os_sem_init(&op->hfo_sem, 0);
+    op->hfo_state = HAL_FLASH_OP_QUEUED;
+    STAILQ_INSERT_TAIL(&hal_flash_async.hfa_ops, op, hfo_next);
+    OS_EXIT_CRITICAL(sr);
+
+    os_eventq_put(&hal_flash_async.hfa_evq, &hal_flash_async.hfa_ev);
+
+    return 0;
+}
+
+int
+hal_flash_erase_sector_async(uint8_t id, uint32_t sector_address,
+                             struct hal_flash_op *op)
+{
+    return hal_flash_async_submit(op, HAL_FLASH_OP_T_ERASE_SECTOR, id,
+                                  sector_address, NULL, 0);
+}
+
+int
+hal_flash_erase_async(uint8_t id, uint32_t address, uint32_t num_bytes,
+                      struct hal_flash_op *op)
+{
+    return hal_flash_async_submit(op, HAL_FLASH_OP_T_ERASE, id, address,
+                                  NULL, num_bytes);
+}
+
+int
+hal_flash_write_async(uint8_t id, uint32_t address, const void *src,
+                      uint32_t num_bytes, struct hal_flash_op *op)
+{
+    if (src == NULL && num_bytes > 0) {
+        return SYS_EINVAL;
+    }
+    return hal_flash_async_submit(op, HAL_FLASH_OP_T_WRITE, id, address,
+                                  src, num_bytes);
+}
+
+int
+hal_flash_op_cancel(struct hal_flash_op *op)
+{
+    os_sr_t sr;
+    int rc;
+
+    OS_ENTER_CRITICAL(sr);
+    if (op->hfo_state == HAL_FLASH_OP_RUNNING) {
+        rc = SYS_EBUSY;
+    } else {
+        if (op->hfo_state == HAL_FLASH_OP_QUEUED) {
+            STAILQ_REMOVE(&hal_flash_async.hfa_ops, op, hal_flash_op,
+                          hfo_next);
+            op->hfo_state = HAL_FLASH_OP_IDLE;
+            os_sem_release(&op->hfo_sem);
+        }
+        rc = 0;
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    return rc;
+}
+
+int
+hal_flash_op_wait(struct hal_flash_op *op, os_time_t timeout)
+{
+    if (op->hfo_state == HAL_FLASH_OP_IDLE) {
+        return SYS_EINVAL;
+    }
+    if (op->hfo_state == HAL_FLASH_OP_DONE) {
+        return op->hfo_rc;
+    }
+    if (!os_started() || os_arch_in_isr() ||
+        os_sched_get_current_task() == &hal_flash_async.hfa_task) {
+        return SYS_EINVAL;
+    }
+
+    /* hfo_sem gets its token when the operation is done or cancelled. */
+    if (os_sem_pend(&op->hfo_sem, timeout) == OS_TIMEOUT) {
+        return SYS_ETIMEOUT;
+    }
+
+    if (op->hfo_state == HAL_FLASH_OP_IDLE) {
+        /* Cancelled by another task. */
+        return SYS_EINVAL;
+    }
+    return op->hfo_rc;
+}
+
+static int
+hal_flash_async_run(const struct hal_flash_op *op)
+{
+    switch (op->hfo_type) {
+    case HAL_FLASH_OP_T_ERASE_SECTOR:
+        return hal_flash_erase_sector(op->hfo_id, op->hfo_addr);
+    case HAL_FLASH_OP_T_ERASE:
+        return hal_flash_erase(op->hfo_id, op->hfo_addr, op->hfo_len);
+    case HAL_FLASH_OP_T_WRITE:
+        return hal_flash_write(op->hfo_id, op->hfo_addr, op->hfo_src,
+                               op->hfo_len);
+    default:
+        assert(0);
+        return SYS_EINVAL;
+    }
+}
+
+/**
+ * Worker task event handler; runs all queued operations in order.
+ */
+static void
+hal_flash_async_drain(struct os_event *ev)
+{
+    struct hal_flash_op *op;
+    int rc;
+    os_sr_t sr;
+
+    while (1) {
+        OS_ENTER_CRITICAL(sr);
+        op = STAILQ_FIRST(&hal_flash_async.hfa_ops);
+        if (op == NULL) {
+            OS_EXIT_CRITICAL(sr);
+            break;
+        }
+        STAILQ_REMOVE_HEAD(&hal_flash_async.hfa_ops, hfo_next);
+        op->hfo_state = HAL_FLASH_OP_RUNNING;
+        OS_EXIT_CRITICAL(sr);
+
+        rc = hal_flash_async_run(op);
+
+        /*
+         * The submitter may reuse op as soon as it is marked done, so signal
+         * completion in the same critical section.
+         */
+        OS_ENTER_CRITICAL(sr);
+        op->hfo_rc = rc;
+        op->hfo_state = HAL_FLASH_OP_DONE;
+        if (op->hfo_evq != NULL) {
+            os_eventq_put(op->hfo_evq, &op->hfo_ev);
+        }
+        if (os_sem_get_count(&op->hfo_sem) == 0) {
+            os_sem_release(&op->hfo_sem);
+        }
+        OS_EXIT_CRITICAL(sr);
+    }
+}
+
+static void
+hal_flash_async_task_handler(void *arg)
+{
+    while (1) {
+        os_eventq_run(&hal_flash_async.hfa_evq);
+    }
+}
+
+void
+hal_flash_async_init(void)
+{
+    int rc;
+
+    /* Ensure this function only gets called by sysinit. */
+    SYSINIT_ASSERT_ACTIVE();
+
+    memset(&hal_flash_async, 0, sizeof(hal_flash_async));
+    STAILQ_INIT(&hal_flash_async.hfa_ops);
+
+    os_eventq_init(&hal_flash_async.hfa_evq);
+    hal_flash_async.hfa_ev.ev_cb = hal_flash_async_drain;
+
+    rc = os_task_init(&hal_flash_async.hfa_task, "flash_async",
+                      hal_flash_async_task_handler, NULL,
+                      MYNEWT_VAL(HAL_FLASH_ASYNC_TASK_PRIO), OS_WAIT_FOREVER,
+                      hal_flash_async_stack,
+                      MYNEWT_VAL(HAL_FLASH_ASYNC_STACK_SIZE));
+    SYSINIT_PANIC_ASSERT(rc == 0);
+}
+
+#endif
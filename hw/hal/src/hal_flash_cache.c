@@ -0,0 +1,332 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <inttypes.h>
+#include <string.h>
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(HAL_FLASH_READ_CACHE)
+
+#include "hal/hal_flash.h"
+#include "hal/hal_flash_int.h"
+#include "hal_flash_priv.h"
+
+/*
+ * Block read cache shared by all flash devices.
+ *
+ * Lines are filled in a ring, oldest first.  A miss on the line right after
+ * the last one filled is taken as a sequential scan, and the following
+ * lines are read along with it in a single driver transaction, into
+ * consecutive slots.
+ *
+ * The cache state is protected by short critical sections; driver reads run
+ * with interrupts enabled.  A slot being filled is marked busy so it is not
+ * reused meanwhile.  Writes and erases bump hfc_gen once they complete, and
+ * a fill that raced with one is discarded instead of being marked valid.
+ */
+
+#define HFC_LINE_SZ     MYNEWT_VAL(HAL_FLASH_READ_CACHE_LINE_SIZE)
+#define HFC_LINE_CNT    MYNEWT_VAL(HAL_FLASH_READ_CACHE_LINES)
+#define HFC_PREFETCH    MYNEWT_VAL(HAL_FLASH_READ_CACHE_PREFETCH)
+
+#if (HFC_LINE_SZ & (HFC_LINE_SZ - 1)) != 0
+#error "HAL_FLASH_READ_CACHE_LINE_SIZE must be a power of two"
+#endif
+
+#define HFC_LINE_ADDR(addr)     ((addr) & ~(uint32_t)(HFC_LINE_SZ - 1))
+
+#define HFC_F_VALID     0x01
+#define HFC_F_BUSY      0x02
+
+struct hal_flash_cache_line {
+    uint32_t hfcl_addr;
+    uint8_t hfcl_id;
+    uint8_t hfcl_flags;
+};
+
+static struct hal_flash_cache_line hfc_lines[HFC_LINE_CNT];
+static uint8_t hfc_data[HFC_LINE_CNT][HFC_LINE_SZ];
+
+/* Next slot to fill. */
+static uint8_t hfc_next;
+
+/* Where a sequential scan would miss next. */
+static uint8_t hfc_seq_id;
+static uint32_t hfc_seq_addr = UINT32_MAX;
+
+static uint32_t hfc_gen;
+static uint32_t hfc_enabled = MYNEWT_VAL(HAL_FLASH_READ_CACHE_DEVICES);
+static struct hal_flash_cache_stats hfc_stats;
+
+static int
+hfc_find(uint8_t id, uint32_t line_addr)
+{
+    int i;
+
+    for (i = 0; i < HFC_LINE_CNT; i++) {
+        if ((hfc_lines[i].hfcl_flags & HFC_F_VALID) &&
+            hfc_lines[i].hfcl_id == id &&
+            hfc_lines[i].hfcl_addr == line_addr) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/*
+ * Picks cnt consecutive slots to fill, starting at the ring position, or at
+ * the start of the ring if the run would not fit before its end.  Returns
+ * the first slot and trims cnt to the slots available; returns -1 if every
+ * slot is being filled.  Called in a critical section.
+ */
+static int
+hfc_alloc(uint8_t id, uint32_t line_addr, int *cnt)
+{
+    int slot;
+    int i;
+
+    slot = hfc_next;
+    if (slot + *cnt > HFC_LINE_CNT) {
+        slot = 0;
+    }
+    for (i = 0; i < HFC_LINE_CNT; i++) {
+        if (!(hfc_lines[slot].hfcl_flags & HFC_F_BUSY)) {
+            break;
+        }
+        slot = (slot + 1) % HFC_LINE_CNT;
+    }
+    if (i == HFC_LINE_CNT) {
+        return -1;
+    }
+
+    /* Stop at a busy slot, the end of the ring, or a line already cached. */
+    for (i = 1; i < *cnt && slot + i < HFC_LINE_CNT; i++) {
+        if ((hfc_lines[slot + i].hfcl_flags & HFC_F_BUSY) ||
+            hfc_find(id, line_addr + i * HFC_LINE_SZ) >= 0) {
+            break;
+        }
+    }
+    *cnt = i;
+
+    for (i = 0; i < *cnt; i++) {
+        hfc_lines[slot + i].hfcl_addr = line_addr + i * HFC_LINE_SZ;
+        hfc_lines[slot + i].hfcl_id = id;
+        hfc_lines[slot + i].hfcl_flags = HFC_F_BUSY;
+    }
+    hfc_next = (slot + *cnt) % HFC_LINE_CNT;
+
+    return slot;
+}
+
+/*
+ * Reads bytes from a single line, filling it on a miss.
+ */
+static int
+hfc_read_line(const struct hal_flash *hf, uint8_t id, uint32_t line_addr,
+              uint32_t off, void *dst, uint32_t num_bytes)
+{
+    uint32_t dev_end;
+    uint32_t len;
+    uint32_t gen;
+    int slot;
+    int cnt;
+    int rc;
+    int i;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    slot = hfc_find(id, line_addr);
+    if (slot >= 0) {
+        memcpy(dst, hfc_data[slot] + off, num_bytes);
+        hfc_stats.hfcs_hits++;
+        OS_EXIT_CRITICAL(sr);
+        return 0;
+    }
+    hfc_stats.hfcs_misses++;
+
+    dev_end = hf->hf_base_addr + hf->hf_size;
+    cnt = 1;
+    if (id == hfc_seq_id && line_addr == hfc_seq_addr) {
+        cnt = HFC_PREFETCH;
+        if (line_addr + cnt * HFC_LINE_SZ > dev_end) {
+            cnt = (dev_end - line_addr + HFC_LINE_SZ - 1) / HFC_LINE_SZ;
+        }
+    }
+    slot = hfc_alloc(id, line_addr, &cnt);
+    if (slot < 0) {
+        OS_EXIT_CRITICAL(sr);
+        return hf->hf_itf->hff_read(hf, line_addr + off, dst, num_bytes);
+    }
+    hfc_seq_id = id;
+    hfc_seq_addr = line_addr + cnt * HFC_LINE_SZ;
+    gen = hfc_gen;
+    OS_EXIT_CRITICAL(sr);
+
+    len = cnt * HFC_LINE_SZ;
+    if (line_addr + len > dev_end) {
+        len = dev_end - line_addr;
+    }
+    rc = hf->hf_itf->hff_read(hf, line_addr, hfc_data[slot], len);
+    if (rc == 0) {
+        memcpy(dst, hfc_data[slot] + off, num_bytes);
+    }
+
+    OS_ENTER_CRITICAL(sr);
+    for (i = 0; i < cnt; i++) {
+        if (rc == 0 && gen == hfc_gen) {
+            hfc_lines[slot + i].hfcl_flags = HFC_F_VALID;
+        } else {
+            hfc_lines[slot + i].hfcl_flags = 0;
+        }
+    }
+    hfc_stats.hfcs_prefetches += cnt - 1;
+    OS_EXIT_CRITICAL(sr);
+
+    return rc;
+}
+
+int
+hal_flash_cache_read(const struct hal_flash *hf, uint8_t id,
+                     uint32_t address, void *dst, uint32_t num_bytes)
+{
+    uint32_t line_addr;
+    uint32_t chunk;
+    uint32_t off;
+    uint8_t *u8p;
+    int rc;
+    os_sr_t sr;
+
+    if (id >= 32 || !(hfc_enabled & (1UL << id))) {
+        return hf->hf_itf->hff_read(hf, address, dst, num_bytes);
+    }
+    if (num_bytes > HFC_LINE_SZ) {
+        /* Large reads gain nothing from a copy through the cache. */
+        OS_ENTER_CRITICAL(sr);
+        hfc_stats.hfcs_bypasses++;
+        OS_EXIT_CRITICAL(sr);
+        return hf->hf_itf->hff_read(hf, address, dst, num_bytes);
+    }
+
+    u8p = dst;
+    while (num_bytes > 0) {
+        line_addr = HFC_LINE_ADDR(address);
+        off = address - line_addr;
+        chunk = min(num_bytes, HFC_LINE_SZ - off);
+
+        rc = hfc_read_line(hf, id, line_addr, off, u8p, chunk);
+        if (rc != 0) {
+            return rc;
+        }
+        address += chunk;
+        u8p += chunk;
+        num_bytes -= chunk;
+    }
+
+    return 0;
+}
+
+static void
+hfc_inval(uint8_t id, uint32_t first, uint32_t last)
+{
+    struct hal_flash_cache_line *line;
+    int i;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    hfc_gen++;
+    for (i = 0; i < HFC_LINE_CNT; i++) {
+        line = &hfc_lines[i];
+        if (line->hfcl_id == id && line->hfcl_addr <= last &&
+            line->hfcl_addr + (HFC_LINE_SZ - 1) >= first) {
+            if (line->hfcl_flags & HFC_F_VALID) {
+                hfc_stats.hfcs_invalidations++;
+            }
+            line->hfcl_flags &= ~HFC_F_VALID;
+        }
+    }
+    if (hfc_seq_id == id) {
+        hfc_seq_addr = UINT32_MAX;
+    }
+    OS_EXIT_CRITICAL(sr);
+}
+
+void
+hal_flash_cache_inval(uint8_t id, uint32_t address, uint32_t num_bytes)
+{
+    if (id >= 32 || !(hfc_enabled & (1UL << id)) || num_bytes == 0) {
+        return;
+    }
+    hfc_inval(id, address, address + num_bytes - 1);
+}
+
+int
+hal_flash_cache_enable(uint8_t id, int enable)
+{
+    os_sr_t sr;
+
+    if (id >= 32) {
+        return SYS_EINVAL;
+    }
+
+    OS_ENTER_CRITICAL(sr);
+    if (enable) {
+        hfc_enabled |= 1UL << id;
+    } else {
+        hfc_enabled &= ~(1UL << id);
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    hfc_inval(id, 0, UINT32_MAX);
+
+    return 0;
+}
+
+int
+hal_flash_cache_invalidate(uint8_t id)
+{
+    if (id >= 32) {
+        return SYS_EINVAL;
+    }
+    hfc_inval(id, 0, UINT32_MAX);
+
+    return 0;
+}
+
+void
+hal_flash_cache_stats_get(struct hal_flash_cache_stats *stats)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    *stats = hfc_stats;
+    OS_EXIT_CRITICAL(sr);
+}
+
+void
+hal_flash_cache_stats_clear(void)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    memset(&hfc_stats, 0, sizeof(hfc_stats));
+    OS_EXIT_CRITICAL(sr);
+}
+
+#endif
@@ -0,0 +1,53 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_HAL_FLASH_PRIV_
+#define H_HAL_FLASH_PRIV_
+
+#include <inttypes.h>
+#include "os/mynewt.h"
+#include "hal/hal_flash_int.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if MYNEWT_VAL(HAL_FLASH_READ_CACHE)
+int hal_flash_cache_read(const struct hal_flash *hf, uint8_t id,
+                         uint32_t address, void *dst, uint32_t num_bytes);
+void hal_flash_cache_inval(uint8_t id, uint32_t address, uint32_t num_bytes);
+#else
+static inline int
+hal_flash_cache_read(const struct hal_flash *hf, uint8_t id,
+                     uint32_t address, void *dst, uint32_t num_bytes)
+{
+    return hf->hf_itf->hff_read(hf, address, dst, num_bytes);
+}
+
+static inline void
+hal_flash_cache_inval(uint8_t id, uint32_t address, uint32_t num_bytes)
+{
+}
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* H_HAL_FLASH_PRIV_ */
@@ -19,11 +19,17 @@
 #ifndef __MCU_SIM_H__
 #define __MCU_SIM_H__
 
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 extern char *native_flash_file;
+/* Busy wait added to every flash read, in microseconds. */
+extern uint32_t native_flash_read_latency_us;
+/* Time each sector erase keeps the flash busy, in milliseconds. */
+extern uint32_t native_flash_erase_latency_ms;
 extern char *native_uart_log_file;
 extern const char *native_uart_dev_strs[];
 
@@ -24,6 +24,7 @@
 #include <inttypes.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <time.h>
 
 #include "os/mynewt.h"
 
@@ -31,6 +32,10 @@
 #include "mcu/mcu_sim.h"
 
 char *native_flash_file;
+uint32_t native_flash_read_latency_us =
+    MYNEWT_VAL(MCU_NATIVE_FLASH_READ_LATENCY_US);
+uint32_t native_flash_erase_latency_ms =
+    MYNEWT_VAL(MCU_NATIVE_FLASH_ERASE_LATENCY_MS);
 static int file = -1;
 static void *file_loc;
 
@@ -207,11 +212,38 @@ flash_native_memset(uint32_t offset, uint8_t c, uint32_t len)
     return 0;
 }
 
+/*
+ * Spins for the given time, to stand in for a flash operation.  Spins on
+ * the host clock rather than sleeping so OS timer signals do not cut the
+ * delay short.
+ */
+static void
+native_flash_spin_us(uint32_t usecs)
+{
+    struct timespec now;
+    struct timespec end;
+
+    if (usecs == 0) {
+        return;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    end.tv_nsec += (long)usecs * 1000;
+    end.tv_sec += end.tv_nsec / 1000000000;
+    end.tv_nsec %= 1000000000;
+    do {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+    } while (now.tv_sec < end.tv_sec ||
+             (now.tv_sec == end.tv_sec && now.tv_nsec < end.tv_nsec));
+}
+
 static int
 native_flash_read(const struct hal_flash *dev, uint32_t address, void *dst,
         uint32_t length)
 {
     flash_native_ensure_file_open();
+    /* Every read is a bus transaction on an external flash. */
+    native_flash_spin_us(native_flash_read_latency_us);
     memcpy(dst, (char *)file_loc + address, length);
 
     return 0;
@@ -244,6 +276,28 @@ flash_sector_len(int sector)
     return end - native_flash_sectors[sector];
 }
 
+/*
+ * Models the time a sector erase keeps the device busy.  Like the external
+ * flash drivers, the calling task sleeps through the erase once the OS is
+ * running.
+ */
+static void
+native_flash_erase_delay(void)
+{
+    os_time_t ticks;
+
+    if (native_flash_erase_latency_ms == 0) {
+        return;
+    }
+
+    ticks = os_time_ms_to_ticks32(native_flash_erase_latency_ms);
+    if (os_started() && ticks > 0) {
+        os_time_delay(ticks);
+    } else {
+        native_flash_spin_us(native_flash_erase_latency_ms * 1000);
+    }
+}
+
 static int
 native_flash_erase_sector(const struct hal_flash *dev, uint32_t sector_address)
 {
@@ -258,6 +312,7 @@ native_flash_erase_sector(const struct hal_flash *dev, uint32_t sector_address)
     }
     len = flash_sector_len(area_id);
     flash_native_erase(sector_address, len);
+    native_flash_erase_delay();
     return 0;
 }
 
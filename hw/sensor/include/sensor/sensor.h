@@ -238,6 +238,20 @@ typedef union {
 typedef int (*sensor_data_func_t)(struct sensor *, void *, void *,
              sensor_type_t);
 
+struct sensor_fifo_data;
+
+/**
+ * Callback for handling a block of samples read from a sensor FIFO.
+ *
+ * @param sensor The sensor for which data is being returned
+ * @param arg The argument provided to sensor_read_fifo() function.
+ * @param sfd The block of samples, oldest sample first
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+typedef int (*sensor_fifo_data_func_t)(struct sensor *, void *,
+             struct sensor_fifo_data *);
+
 /**
  * Callback for sending trigger notification.
  *
@@ -298,6 +312,12 @@ struct sensor_listener {
     /* Argument for the sensor listener */
     void *sl_arg;
 
+    /* Optional handler for blocks of samples read with sensor_read_fifo().
+     * If not set, sl_func is called for every sample in the block, with the
+     * sensor timestamp set to the one of that sample.
+     */
+    sensor_fifo_data_func_t sl_fifo_func;
+
     /* Next item in the sensor listener list.  The head of this list is
      * contained within the sensor object.
      */
@@ -413,6 +433,25 @@ struct sensor_notify_os_ev {
 typedef int (*sensor_read_func_t)(struct sensor *, sensor_type_t,
         sensor_data_func_t, void *, uint32_t);
 
+/**
+ * Read up to max_samples samples of a given type from the sensor FIFO.
+ * Samples are passed to data_func in blocks, oldest sample first.  The
+ * driver fills in everything in struct sensor_fifo_data but sfd_ts.
+ *
+ * @param sensor The sensor to read from
+ * @param type The type of sensor values to read
+ * @param data_func The function to call with each block of samples
+ * @param arg The argument to pass to the read callback.
+ * @param max_samples Maximum number of samples to read, 0 reads all samples
+ *        available.
+ * @param timeout Timeout. If block until result, specify OS_TIMEOUT_NEVER, 0 returns
+ *        immediately (no wait.)
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+typedef int (*sensor_read_fifo_func_t)(struct sensor *, sensor_type_t,
+        sensor_fifo_data_func_t, void *, uint16_t, uint32_t);
+
 /**
  * Get the configuration of the sensor for the sensor type.  This includes
  * the value type of the sensor.
@@ -515,6 +554,7 @@ struct sensor_driver {
     sensor_unset_notification_t sd_unset_notification;
     sensor_handle_interrupt_t sd_handle_interrupt;
     sensor_reset_t sd_reset;
+    sensor_read_fifo_func_t sd_read_fifo;
 };
 
 struct sensor_timestamp {
@@ -523,6 +563,35 @@ struct sensor_timestamp {
     uint32_t st_cputime;
 };
 
+/**
+ * A block of samples read from a sensor FIFO
+ */
+struct sensor_fifo_data {
+    /* The sensor type of the samples */
+    sensor_type_t sfd_type;
+
+    /* Array of sfd_count samples, sfd_sample_size bytes apart.  Every sample
+     * has the layout of a single reading of sfd_type, e.g.
+     * struct sensor_accel_data for SENSOR_TYPE_ACCELEROMETER.
+     */
+    void *sfd_samples;
+    uint16_t sfd_sample_size;
+    uint16_t sfd_count;
+
+    /* Number of samples that were in the FIFO at the time of the read, and
+     * are newer than the last sample in this block.
+     */
+    uint16_t sfd_pending;
+
+    /* Sample interval in microseconds */
+    uint32_t sfd_itvl_us;
+
+    /* Timestamp of the first sample in the block.  Filled in by the sensor
+     * framework, interpolated back from the time of the read.
+     */
+    struct sensor_timestamp sfd_ts;
+};
+
 struct sensor_int {
     int8_t host_pin;
     uint8_t device_pin;
@@ -613,6 +682,11 @@ struct sensor {
     /* The next time at which we want to poll data from this sensor */
     os_time_t s_next_run;
 
+#if MYNEWT_VAL(SENSOR_MGR_POLL_HEAP)
+    /* Position of the sensor in the sensor manager poll heap */
+    uint8_t s_poll_idx;
+#endif
+
     /* Sensor driver specific functions, created by the device registering the
      * sensor.
      */
@@ -807,6 +881,53 @@ int sensor_read(struct sensor *sensor, sensor_type_t type,
                 sensor_data_func_t data_func, void *arg,
                 uint32_t timeout);
 
+/**
+ * Read the samples of sensor type "type" queued in the FIFO of the given
+ * sensor, and pass them to the callback in blocks.  The sensor driver has
+ * to implement sd_read_fifo.
+ *
+ * Every sample gets a timestamp, counting back from the time of the read
+ * in steps of the sample interval.  The newest sample in the FIFO is taken
+ * to be as old as the read.
+ *
+ * @param sensor The sensor to read data from
+ * @param type The type of sensor data to read from the sensor
+ * @param data_func The callback to call for each block of samples
+ * @param arg The argument to pass to this callback.
+ * @param max_samples Maximum number of samples to read, 0 for all
+ * @param timeout Timeout before aborting sensor read
+ *
+ * @return 0 on success, SYS_ENOTSUP if the driver can't read the FIFO,
+ *         other non-zero error code on failure.
+ */
+int sensor_read_fifo(struct sensor *sensor, sensor_type_t type,
+                     sensor_fifo_data_func_t data_func, void *arg,
+                     uint16_t max_samples, uint32_t timeout);
+
+/**
+ * Get the timestamp of a sample in a block read with sensor_read_fifo().
+ *
+ * @param sfd The block of samples
+ * @param idx Index of the sample in the block
+ * @param sts Filled with the timestamp of the sample
+ */
+void sensor_fifo_sample_ts(const struct sensor_fifo_data *sfd, int idx,
+                           struct sensor_timestamp *sts);
+
+/**
+ * Get a sample from a block read with sensor_read_fifo().
+ *
+ * @param sfd The block of samples
+ * @param idx Index of the sample in the block
+ *
+ * @return Pointer to the sample
+ */
+static inline void *
+sensor_fifo_sample(const struct sensor_fifo_data *sfd, int idx)
+{
+    return (uint8_t *)sfd->sfd_samples + idx * sfd->sfd_sample_size;
+}
+
 /**
  * Set the driver functions for this sensor, along with the type of sensor
  * data available for the given sensor.
@@ -18,17 +18,11 @@
  */
 
 #include "os/mynewt.h"
-#include "sensor_test.h"
+#include "sensor_test/sensor_test.h"
 
 TEST_SUITE(sensor_test_suite_poll)
 {
     sensor_test_case_poll_err();
-}
-
-int
-main(int argc, char **argv)
-{
-    sensor_test_suite_poll();
-
-    return tu_any_failed;
+    sensor_test_case_read_fifo();
+    sensor_test_case_poll_sched();
 }
@@ -19,7 +19,7 @@
 
 #include "os/mynewt.h"
 #include "sensor/sensor.h"
-#include "sensor_test.h"
+#include "sensor_test/sensor_test.h"
 
 struct stcpe_error_rec {
     struct sensor *sensor;
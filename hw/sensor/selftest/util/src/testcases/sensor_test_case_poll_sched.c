@@ -0,0 +1,188 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "sensor/sensor.h"
+#include "sensor_test/sensor_test.h"
+
+#define STCPS_NUM_SENSORS   5
+#define STCPS_MAX_POLLS     32
+
+/* Tolerated poll delay, the simulator may run a tick late. */
+#define STCPS_MAX_LATE      2
+
+/* Offset between the two sensors sharing a wakeup, in ms. */
+#define STCPS_OFFSET_MS     20
+
+/* Whether the coalescing window covers STCPS_OFFSET_MS. */
+#define STCPS_COALESCE \
+    (MYNEWT_VAL(SENSOR_MGR_POLL_COALESCE_MS) >= STCPS_OFFSET_MS)
+
+struct stcps_sensor {
+    struct os_dev dev;
+    struct sensor sensor;
+    /* First scheduled poll */
+    os_time_t first_run;
+    os_time_t polls[STCPS_MAX_POLLS];
+    int num_polls;
+};
+
+static struct stcps_sensor stcps_sensors[STCPS_NUM_SENSORS];
+
+/**
+ * Sensor read function.  Records the time of the poll.
+ */
+static int
+stcps_sensor_read(struct sensor *sensor, sensor_type_t type,
+                  sensor_data_func_t data_func, void *arg, uint32_t timeout)
+{
+    struct stcps_sensor *ss;
+
+    ss = CONTAINER_OF(sensor, struct stcps_sensor, sensor);
+    if (ss->num_polls < STCPS_MAX_POLLS) {
+        ss->polls[ss->num_polls] = os_time_get();
+    }
+    ss->num_polls++;
+
+    return 0;
+}
+
+static void
+stcps_set_poll_rate(int idx, uint32_t poll_rate)
+{
+    int rc;
+
+    rc = sensor_set_poll_rate_ms(stcps_sensors[idx].dev.od_name, poll_rate);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    stcps_sensors[idx].first_run = stcps_sensors[idx].sensor.s_next_run;
+}
+
+/**
+ * Ensures that a sensor was polled 'cnt' times, give or take one, on its
+ * schedule.  Polls may be done up to 'early' ticks early.
+ */
+static void
+stcps_assert_polls(int idx, int cnt, uint32_t poll_rate, int early)
+{
+    struct stcps_sensor *ss;
+    os_time_t ticks;
+    int32_t diff;
+    int i;
+
+    ss = &stcps_sensors[idx];
+    ticks = os_time_ms_to_ticks32(poll_rate);
+
+    TEST_ASSERT_FATAL(ss->num_polls >= cnt - 1 && ss->num_polls <= cnt + 1,
+                      "sensor %d: %d polls, expected %d", idx, ss->num_polls,
+                      cnt);
+    for (i = 0; i < ss->num_polls; i++) {
+        diff = ss->polls[i] - (ss->first_run + i * ticks);
+        TEST_ASSERT(diff >= -early && diff <= STCPS_MAX_LATE,
+                    "sensor %d: poll %d off by %d ticks", idx, i, (int)diff);
+    }
+}
+
+TEST_CASE_TASK(sensor_test_case_poll_sched)
+{
+    static struct sensor_driver driver = {
+        .sd_read = stcps_sensor_read,
+    };
+    static char names[STCPS_NUM_SENSORS][8];
+
+    struct stcps_sensor *ss;
+    os_time_t window;
+    os_time_t offset;
+    int rc;
+    int i;
+
+    for (i = 0; i < STCPS_NUM_SENSORS; i++) {
+        ss = &stcps_sensors[i];
+        memset(ss, 0, sizeof(*ss));
+
+        sprintf(names[i], "stcps%d", i);
+        ss->dev.od_name = names[i];
+
+        rc = sensor_init(&ss->sensor, &ss->dev);
+        TEST_ASSERT_FATAL(rc == 0);
+        rc = sensor_set_driver(&ss->sensor, SENSOR_TYPE_ACCELEROMETER,
+                               &driver);
+        TEST_ASSERT_FATAL(rc == 0);
+        sensor_set_type_mask(&ss->sensor, SENSOR_TYPE_ACCELEROMETER);
+        rc = sensor_mgr_register(&ss->sensor);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    /*** Sensors polled at different rates, one not polled at all. */
+
+    /* Sensors due within the coalescing window may be polled early. */
+    window = os_time_ms_to_ticks32(MYNEWT_VAL(SENSOR_MGR_POLL_COALESCE_MS));
+
+    os_time_delay(1);
+    stcps_set_poll_rate(0, 50);
+    stcps_set_poll_rate(1, 100);
+    stcps_set_poll_rate(2, 250);
+
+    os_time_delay(os_time_ms_to_ticks32(1000) + 1);
+    stcps_assert_polls(0, 20, 50, window);
+    stcps_assert_polls(1, 10, 100, window);
+    stcps_assert_polls(2, 4, 250, window);
+    TEST_ASSERT(stcps_sensors[4].num_polls == 0);
+
+    /*** Polling stops when the poll rate is cleared. */
+
+    stcps_set_poll_rate(0, 0);
+    stcps_set_poll_rate(1, 0);
+    stcps_set_poll_rate(2, 0);
+    for (i = 0; i < 3; i++) {
+        stcps_sensors[i].num_polls = 0;
+    }
+
+    /***
+     * A sensor due within the coalescing window of another is polled by the
+     * same wakeup, but keeps its own schedule.  Without a window wide
+     * enough, each sensor is polled on time by a wakeup of its own.
+     */
+
+    stcps_set_poll_rate(3, 200);
+    os_time_delay(os_time_ms_to_ticks32(STCPS_OFFSET_MS));
+    stcps_set_poll_rate(4, 200);
+    offset = stcps_sensors[4].sensor.s_next_run -
+             stcps_sensors[3].sensor.s_next_run;
+
+    os_time_delay(os_time_ms_to_ticks32(1000) + 1);
+    stcps_assert_polls(3, 5, 200, 0);
+#if STCPS_COALESCE
+    stcps_assert_polls(4, 5, 200, offset);
+    for (i = 0; i < stcps_sensors[4].num_polls; i++) {
+        TEST_ASSERT(stcps_sensors[4].polls[i] == stcps_sensors[3].polls[i]);
+    }
+#else
+    stcps_assert_polls(4, 5, 200, 0);
+#endif
+    TEST_ASSERT(stcps_sensors[4].sensor.s_next_run -
+                stcps_sensors[3].sensor.s_next_run == offset);
+
+    for (i = 0; i < 3; i++) {
+        TEST_ASSERT(stcps_sensors[i].num_polls == 0);
+    }
+
+    stcps_set_poll_rate(3, 0);
+    stcps_set_poll_rate(4, 0);
+}
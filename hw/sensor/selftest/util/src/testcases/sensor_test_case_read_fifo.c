@@ -0,0 +1,269 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "sensor/sensor.h"
+#include "sensor/accel.h"
+#include "sensor_test/sensor_test.h"
+
+#define STCRF_FIFO_SZ       10
+#define STCRF_BLOCK_SZ      4
+#define STCRF_ITVL_US       1500
+
+/** Samples queued in the test driver's FIFO. */
+static int stcrf_fifo_cnt;
+static int stcrf_fifo_seq;
+
+/** Sample values and timestamps seen by the callbacks. */
+static struct stcrf_rec {
+    int seq;
+    struct sensor_timestamp sts;
+} stcrf_recs[3][STCRF_FIFO_SZ];
+static int stcrf_num_recs[3];
+static int stcrf_num_blocks[3];
+
+/**
+ * Sensor FIFO read function.  Passes the queued samples in blocks of
+ * STCRF_BLOCK_SZ, with a sequence number in x.
+ */
+static int
+stcrf_sensor_read_fifo(struct sensor *sensor, sensor_type_t type,
+                       sensor_fifo_data_func_t data_func, void *arg,
+                       uint16_t max_samples, uint32_t timeout)
+{
+    struct sensor_accel_data sad[STCRF_BLOCK_SZ];
+    struct sensor_fifo_data sfd;
+    int todo;
+    int rc;
+    int i;
+
+    todo = stcrf_fifo_cnt;
+    if (max_samples != 0 && todo > max_samples) {
+        todo = max_samples;
+    }
+
+    memset(&sfd, 0, sizeof(sfd));
+    sfd.sfd_type = SENSOR_TYPE_ACCELEROMETER;
+    sfd.sfd_samples = sad;
+    sfd.sfd_sample_size = sizeof(sad[0]);
+    sfd.sfd_itvl_us = STCRF_ITVL_US;
+
+    while (todo > 0) {
+        sfd.sfd_count = min(todo, STCRF_BLOCK_SZ);
+        for (i = 0; i < sfd.sfd_count; i++) {
+            memset(&sad[i], 0, sizeof(sad[i]));
+            sad[i].sad_x = stcrf_fifo_seq++;
+            sad[i].sad_x_is_valid = 1;
+        }
+        todo -= sfd.sfd_count;
+        stcrf_fifo_cnt -= sfd.sfd_count;
+        sfd.sfd_pending = stcrf_fifo_cnt;
+
+        rc = data_func(sensor, arg, &sfd);
+        if (rc != 0) {
+            return rc;
+        }
+    }
+
+    return 0;
+}
+
+static void
+stcrf_add_rec(int idx, const struct sensor_accel_data *sad,
+              const struct sensor_timestamp *sts)
+{
+    struct stcrf_rec *rec;
+
+    TEST_ASSERT_FATAL(stcrf_num_recs[idx] < STCRF_FIFO_SZ);
+
+    rec = &stcrf_recs[idx][stcrf_num_recs[idx]++];
+    rec->seq = sad->sad_x;
+    rec->sts = *sts;
+}
+
+/** Block callback; records every sample with its timestamp. */
+static int
+stcrf_fifo_func(struct sensor *sensor, void *arg,
+                struct sensor_fifo_data *sfd)
+{
+    struct sensor_timestamp sts;
+    int idx;
+    int i;
+
+    idx = (int)(intptr_t)arg;
+    TEST_ASSERT(sfd->sfd_type == SENSOR_TYPE_ACCELEROMETER);
+    TEST_ASSERT(sfd->sfd_count <= STCRF_BLOCK_SZ);
+
+    stcrf_num_blocks[idx]++;
+    for (i = 0; i < sfd->sfd_count; i++) {
+        sensor_fifo_sample_ts(sfd, i, &sts);
+        stcrf_add_rec(idx, sensor_fifo_sample(sfd, i), &sts);
+    }
+
+    return 0;
+}
+
+/** Single sample listener; records the sample with the sensor timestamp. */
+static int
+stcrf_data_func(struct sensor *sensor, void *arg, void *data,
+                sensor_type_t type)
+{
+    TEST_ASSERT(type == SENSOR_TYPE_ACCELEROMETER);
+    stcrf_add_rec(2, data, &sensor->s_sts);
+
+    return 0;
+}
+
+static void
+stcrf_reset(int fifo_cnt)
+{
+    stcrf_fifo_cnt = fifo_cnt;
+    stcrf_fifo_seq = 0;
+    memset(stcrf_num_recs, 0, sizeof(stcrf_num_recs));
+    memset(stcrf_num_blocks, 0, sizeof(stcrf_num_blocks));
+}
+
+/**
+ * Ensures that callback 'idx' saw 'cnt' samples in order, the newest one
+ * 'pending' sample intervals before the read.
+ */
+static void
+stcrf_assert_recs(struct sensor *sn, int idx, int cnt, int pending)
+{
+    struct sensor_timestamp expected;
+    struct os_timeval tv;
+    int i;
+
+    TEST_ASSERT_FATAL(stcrf_num_recs[idx] == cnt);
+
+    for (i = cnt - 1; i >= 0; i--) {
+        tv.tv_sec = 0;
+        tv.tv_usec = (cnt - 1 - i + pending) * STCRF_ITVL_US;
+        os_timersub(&sn->s_sts.st_ostv, &tv, &expected.st_ostv);
+        expected.st_cputime = sn->s_sts.st_cputime -
+                              os_cputime_usecs_to_ticks(tv.tv_usec);
+
+        TEST_ASSERT(stcrf_recs[idx][i].seq == i);
+        TEST_ASSERT(stcrf_recs[idx][i].sts.st_ostv.tv_sec ==
+                    expected.st_ostv.tv_sec);
+        TEST_ASSERT(stcrf_recs[idx][i].sts.st_ostv.tv_usec ==
+                    expected.st_ostv.tv_usec);
+        TEST_ASSERT(stcrf_recs[idx][i].sts.st_cputime ==
+                    expected.st_cputime);
+    }
+}
+
+TEST_CASE_SELF(sensor_test_case_read_fifo)
+{
+    static struct sensor_driver driver = {
+        .sd_read_fifo = stcrf_sensor_read_fifo,
+    };
+    static struct sensor_driver driver_nofifo;
+
+    struct sensor_listener fifo_listener = {
+        .sl_sensor_type = SENSOR_TYPE_ACCELEROMETER,
+        .sl_fifo_func = stcrf_fifo_func,
+        .sl_arg = (void *)1,
+    };
+    struct sensor_listener listener = {
+        .sl_sensor_type = SENSOR_TYPE_ACCELEROMETER,
+        .sl_func = stcrf_data_func,
+    };
+    struct sensor_timestamp sts;
+    struct sensor sn;
+    int rc;
+
+    rc = sensor_init(&sn, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = sensor_set_driver(&sn, SENSOR_TYPE_ACCELEROMETER, &driver);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    sensor_set_type_mask(&sn, SENSOR_TYPE_ALL);
+
+    /*** Samples arrive in blocks, timestamped back from the read. */
+
+    stcrf_reset(STCRF_FIFO_SZ);
+    rc = sensor_read_fifo(&sn, SENSOR_TYPE_ACCELEROMETER, stcrf_fifo_func,
+                          (void *)0, 0, OS_TIMEOUT_NEVER);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(stcrf_num_blocks[0] == 3);
+    stcrf_assert_recs(&sn, 0, STCRF_FIFO_SZ, 0);
+    TEST_ASSERT(stcrf_fifo_cnt == 0);
+
+    /*** Samples left in the FIFO are newer than the ones read. */
+
+    stcrf_reset(STCRF_FIFO_SZ);
+    rc = sensor_read_fifo(&sn, SENSOR_TYPE_ACCELEROMETER, stcrf_fifo_func,
+                          (void *)0, 6, OS_TIMEOUT_NEVER);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(stcrf_num_blocks[0] == 2);
+    stcrf_assert_recs(&sn, 0, 6, STCRF_FIFO_SZ - 6);
+    TEST_ASSERT(stcrf_fifo_cnt == STCRF_FIFO_SZ - 6);
+
+    /***
+     * Block listeners get the blocks, other listeners one sample at a time
+     * with the sensor timestamp of the sample.
+     */
+
+    rc = sensor_register_listener(&sn, &fifo_listener);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = sensor_register_listener(&sn, &listener);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    stcrf_reset(STCRF_FIFO_SZ);
+    rc = sensor_read_fifo(&sn, SENSOR_TYPE_ACCELEROMETER, NULL, NULL, 0,
+                          OS_TIMEOUT_NEVER);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(stcrf_num_recs[0] == 0);
+    TEST_ASSERT(stcrf_num_blocks[1] == 3);
+    stcrf_assert_recs(&sn, 1, STCRF_FIFO_SZ, 0);
+    stcrf_assert_recs(&sn, 2, STCRF_FIFO_SZ, 0);
+
+    /* The sensor timestamp is the one of the read again. */
+    sts = sn.s_sts;
+    TEST_ASSERT(stcrf_recs[2][STCRF_FIFO_SZ - 1].sts.st_cputime ==
+                sts.st_cputime);
+
+    /*** Listeners can be skipped. */
+
+    stcrf_reset(STCRF_FIFO_SZ);
+    rc = sensor_read_fifo(&sn, SENSOR_TYPE_ACCELEROMETER, stcrf_fifo_func,
+                          (void *)SENSOR_IGN_LISTENER, 0, OS_TIMEOUT_NEVER);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(stcrf_num_recs[1] == STCRF_FIFO_SZ);
+    TEST_ASSERT(stcrf_num_recs[2] == 0);
+
+    rc = sensor_unregister_listener(&sn, &fifo_listener);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = sensor_unregister_listener(&sn, &listener);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /*** Types the sensor doesn't have and drivers without a FIFO. */
+
+    rc = sensor_read_fifo(&sn, SENSOR_TYPE_LIGHT, stcrf_fifo_func, NULL, 0,
+                          OS_TIMEOUT_NEVER);
+    TEST_ASSERT(rc == SYS_ENOENT);
+
+    rc = sensor_set_driver(&sn, SENSOR_TYPE_ACCELEROMETER, &driver_nofifo);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = sensor_read_fifo(&sn, SENSOR_TYPE_ACCELEROMETER, stcrf_fifo_func,
+                          NULL, 0, OS_TIMEOUT_NEVER);
+    TEST_ASSERT(rc == SYS_ENOTSUP);
+}
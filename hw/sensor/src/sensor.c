@@ -34,6 +34,9 @@
 #include "sensor/humidity.h"
 #include "sensor/gyro.h"
 #include "console/console.h"
+#if MYNEWT_VAL(SENSOR_MGR_POLL_STATS)
+#include "stats/stats.h"
+#endif
 
 #ifdef MYNEWT_VAL_SENSOR_MGR_EVQ
 extern struct os_eventq MYNEWT_VAL(SENSOR_MGR_EVQ);
@@ -65,6 +68,34 @@ struct {
     SLIST_HEAD(, sensor) mgr_sensor_list;
 } sensor_mgr;
 
+#if MYNEWT_VAL(SENSOR_MGR_POLL_STATS)
+/* Define the stats section and records */
+STATS_SECT_START(sensor_mgr_stat_section)
+    STATS_SECT_ENTRY(wakeups)
+    STATS_SECT_ENTRY(polls)
+    STATS_SECT_ENTRY(coalesced)
+    STATS_SECT_ENTRY(late_polls)
+    STATS_SECT_ENTRY(late_ticks)
+    STATS_SECT_ENTRY(late_ticks_max)
+STATS_SECT_END
+
+/* Define stat names for querying */
+STATS_NAME_START(sensor_mgr_stat_section)
+    STATS_NAME(sensor_mgr_stat_section, wakeups)
+    STATS_NAME(sensor_mgr_stat_section, polls)
+    STATS_NAME(sensor_mgr_stat_section, coalesced)
+    STATS_NAME(sensor_mgr_stat_section, late_polls)
+    STATS_NAME(sensor_mgr_stat_section, late_ticks)
+    STATS_NAME(sensor_mgr_stat_section, late_ticks_max)
+STATS_NAME_END(sensor_mgr_stat_section)
+
+/* Global variable used to hold stats data */
+STATS_SECT_DECL(sensor_mgr_stat_section) g_sensor_mgr_stats;
+
+/* Largest poll delay seen, mirrored in late_ticks_max */
+static int32_t sensor_mgr_late_max;
+#endif
+
 struct sensor_timestamp sensor_base_ts;
 struct os_callout st_up_osco;
 
@@ -114,6 +145,153 @@ sensor_mgr_remove(struct sensor *sensor)
     SLIST_REMOVE(&sensor_mgr.mgr_sensor_list, sensor, sensor, s_next);
 }
 
+#if MYNEWT_VAL(SENSOR_MGR_POLL_HEAP)
+
+/*
+ * Polled sensors are kept in a binary min-heap ordered by next run time, so
+ * the sensor to poll next is always at index 0.  Each sensor remembers its
+ * heap index in s_poll_idx.  mgr_sensor_list holds all registered sensors
+ * in registration order.
+ */
+static struct sensor *
+    sensor_mgr_poll_heap[MYNEWT_VAL(SENSOR_MGR_POLL_HEAP_SIZE)];
+static uint8_t sensor_mgr_poll_heap_cnt;
+
+#define SENSOR_MGR_POLL_HEAP_LT(_s1, _s2) \
+    OS_TIME_TICK_LT((_s1)->s_next_run, (_s2)->s_next_run)
+
+static void
+sensor_mgr_poll_heap_set(int idx, struct sensor *sensor)
+{
+    sensor_mgr_poll_heap[idx] = sensor;
+    sensor->s_poll_idx = idx;
+}
+
+static void
+sensor_mgr_poll_heap_up(int idx)
+{
+    struct sensor *sensor;
+    int parent;
+
+    sensor = sensor_mgr_poll_heap[idx];
+    while (idx > 0) {
+        parent = (idx - 1) / 2;
+        if (!SENSOR_MGR_POLL_HEAP_LT(sensor, sensor_mgr_poll_heap[parent])) {
+            break;
+        }
+        sensor_mgr_poll_heap_set(idx, sensor_mgr_poll_heap[parent]);
+        idx = parent;
+    }
+    sensor_mgr_poll_heap_set(idx, sensor);
+}
+
+static void
+sensor_mgr_poll_heap_down(int idx)
+{
+    struct sensor *sensor;
+    int child;
+
+    sensor = sensor_mgr_poll_heap[idx];
+    while (1) {
+        child = 2 * idx + 1;
+        if (child >= sensor_mgr_poll_heap_cnt) {
+            break;
+        }
+        if (child + 1 < sensor_mgr_poll_heap_cnt &&
+            SENSOR_MGR_POLL_HEAP_LT(sensor_mgr_poll_heap[child + 1],
+                                    sensor_mgr_poll_heap[child])) {
+            child++;
+        }
+        if (!SENSOR_MGR_POLL_HEAP_LT(sensor_mgr_poll_heap[child], sensor)) {
+            break;
+        }
+        sensor_mgr_poll_heap_set(idx, sensor_mgr_poll_heap[child]);
+        idx = child;
+    }
+    sensor_mgr_poll_heap_set(idx, sensor);
+}
+
+static void
+sensor_mgr_insert(struct sensor *sensor)
+{
+    struct sensor *cursor, *prev;
+
+    prev = NULL;
+    SLIST_FOREACH(cursor, &sensor_mgr.mgr_sensor_list, s_next) {
+        prev = cursor;
+    }
+
+    if (prev == NULL) {
+        SLIST_INSERT_HEAD(&sensor_mgr.mgr_sensor_list, sensor, s_next);
+    } else {
+        SLIST_INSERT_AFTER(prev, sensor, s_next);
+    }
+}
+
+/**
+ * Adds a polled sensor to the poll heap.
+ *
+ * @return 0 on success, SYS_ENOMEM if SENSOR_MGR_POLL_HEAP_SIZE sensors
+ *         are already polled.
+ */
+static int
+sensor_mgr_poll_insert(struct sensor *sensor)
+{
+    if (!sensor->s_poll_rate) {
+        return 0;
+    }
+
+    if (sensor_mgr_poll_heap_cnt >= MYNEWT_VAL(SENSOR_MGR_POLL_HEAP_SIZE)) {
+        return SYS_ENOMEM;
+    }
+    sensor_mgr_poll_heap_set(sensor_mgr_poll_heap_cnt, sensor);
+    sensor_mgr_poll_heap_cnt++;
+    sensor_mgr_poll_heap_up(sensor->s_poll_idx);
+
+    return 0;
+}
+
+static void
+sensor_mgr_poll_remove(struct sensor *sensor)
+{
+    struct sensor *last;
+    int idx;
+
+    idx = sensor->s_poll_idx;
+    if (idx >= sensor_mgr_poll_heap_cnt ||
+        sensor_mgr_poll_heap[idx] != sensor) {
+        /* Not polled */
+        return;
+    }
+
+    sensor_mgr_poll_heap_cnt--;
+    if (idx != sensor_mgr_poll_heap_cnt) {
+        last = sensor_mgr_poll_heap[sensor_mgr_poll_heap_cnt];
+        sensor_mgr_poll_heap_set(idx, last);
+        if (idx > 0 &&
+            SENSOR_MGR_POLL_HEAP_LT(last, sensor_mgr_poll_heap[(idx - 1) / 2])) {
+            sensor_mgr_poll_heap_up(idx);
+        } else {
+            sensor_mgr_poll_heap_down(idx);
+        }
+    }
+}
+
+/**
+ * Returns the polled sensor with the earliest next run, or NULL if no
+ * sensor is polled.
+ */
+static struct sensor *
+sensor_mgr_poll_first(void)
+{
+    if (sensor_mgr_poll_heap_cnt == 0) {
+        return NULL;
+    }
+    return sensor_mgr_poll_heap[0];
+}
+
+#else
+
 static void
 sensor_mgr_insert(struct sensor *sensor)
 {
@@ -148,6 +326,37 @@ insert:
     }
 }
 
+/*
+ * Without the poll heap, the sensor list is sorted by next run time, with
+ * the sensors that aren't polled at the end.
+ */
+static int
+sensor_mgr_poll_insert(struct sensor *sensor)
+{
+    sensor_mgr_insert(sensor);
+    return 0;
+}
+
+static void
+sensor_mgr_poll_remove(struct sensor *sensor)
+{
+    sensor_mgr_remove(sensor);
+}
+
+static struct sensor *
+sensor_mgr_poll_first(void)
+{
+    struct sensor *head;
+
+    head = SLIST_FIRST(&sensor_mgr.mgr_sensor_list);
+    if (head == NULL || !head->s_poll_rate) {
+        return NULL;
+    }
+    return head;
+}
+
+#endif
+
 /**
  * Remove a sensor type trait. This allows a calling application to clear
  * sensortype trait for a given sensor object.
@@ -328,46 +537,91 @@ sensor_calc_nextrun_delta(struct sensor *sensor, os_time_t now)
     return sensor_ticks;
 }
 
+/**
+ * Returns the polled sensor to run first, or NULL if there is none.
+ */
 static struct sensor *
 sensor_find_min_nextrun_sensor(os_time_t now, os_time_t *min_nextrun)
 {
     struct sensor *head;
 
-    head = NULL;
-
     sensor_mgr_lock();
 
-    head = SLIST_FIRST(&sensor_mgr.mgr_sensor_list);
-
-    *min_nextrun = sensor_calc_nextrun_delta(head, now);
+    head = sensor_mgr_poll_first();
+    if (head != NULL) {
+        *min_nextrun = sensor_calc_nextrun_delta(head, now);
+    }
 
     sensor_mgr_unlock();
 
     return head;
-
 }
 
-static void
-sensor_update_nextrun(struct sensor *sensor, os_time_t now)
+/**
+ * Returns the poll interval of a sensor in OS ticks, at least one.
+ */
+static os_time_t
+sensor_poll_ticks(struct sensor *sensor)
 {
     os_time_t sensor_ticks;
 
     os_time_ms_to_ticks(sensor->s_poll_rate, &sensor_ticks);
+    if (sensor_ticks == 0) {
+        sensor_ticks = 1;
+    }
 
+    return sensor_ticks;
+}
+
+static int
+sensor_set_nextrun(struct sensor *sensor, os_time_t next_run)
+{
+    int rc;
+
+    sensor_mgr_lock();
     sensor_lock(sensor);
 
-    /* Remove the sensor from the sensor list for insert. */
-    sensor_mgr_remove(sensor);
+    /* Remove the sensor from the poll queue for insert. */
+    sensor_mgr_poll_remove(sensor);
 
-    /* Set next wakeup, and insert the sensor back into the
-     * list.
-     */
-    sensor->s_next_run = sensor_ticks + now;
+    sensor->s_next_run = next_run;
 
-    /* Re-insert the sensor manager, with the new wakeup time. */
-    sensor_mgr_insert(sensor);
+    /* Re-insert the sensor, with the new wakeup time. */
+    rc = sensor_mgr_poll_insert(sensor);
 
     sensor_unlock(sensor);
+    sensor_mgr_unlock();
+
+    return rc;
+}
+
+static int
+sensor_update_nextrun(struct sensor *sensor, os_time_t now)
+{
+    return sensor_set_nextrun(sensor, now + sensor_poll_ticks(sensor));
+}
+
+/**
+ * Moves the next run of a sensor that has just been polled on by one poll
+ * interval, so polls stay on the same schedule even if they are done late
+ * or early.  A sensor that is behind by a full interval or more is
+ * rescheduled one interval from now.
+ */
+static void
+sensor_advance_nextrun(struct sensor *sensor, os_time_t now)
+{
+    os_time_t sensor_ticks;
+    os_time_t next_run;
+
+    sensor_ticks = sensor_poll_ticks(sensor);
+
+    next_run = sensor->s_next_run + sensor_ticks;
+    if (OS_TIME_TICK_GEQ(now, next_run)) {
+        next_run = now + sensor_ticks;
+    }
+
+    /* The sensor was in the poll queue, re-inserting it cannot fail. */
+    (void)sensor_set_nextrun(sensor, next_run);
 }
 
 /**
@@ -375,6 +629,9 @@ sensor_update_nextrun(struct sensor *sensor, os_time_t now)
  *
  * @param The devname
  * @param The poll rate in milli seconds
+ *
+ * @return 0 on success, SYS_EINVAL if there is no such sensor, SYS_ENOMEM
+ *         if too many sensors are polled; the sensor is then not polled.
  */
 int
 sensor_set_poll_rate_ms(const char *devname, uint32_t poll_rate)
@@ -386,30 +643,33 @@ sensor_set_poll_rate_ms(const char *devname, uint32_t poll_rate)
 
     os_callout_stop(&sensor_mgr.mgr_wakeup_callout);
 
+    now = os_time_get();
+
     sensor = sensor_mgr_find_next_bydevname(devname, NULL);
     if (!sensor) {
         rc = SYS_EINVAL;
-        goto err;
+        goto done;
     }
 
+    sensor_mgr_lock();
     sensor_lock(sensor);
 
-    now = os_time_get();
-
-    os_time_ms_to_ticks(poll_rate, &next_wakeup);
-
     sensor_update_poll_rate(sensor, poll_rate);
 
-    sensor_update_nextrun(sensor, now);
+    rc = sensor_update_nextrun(sensor, now);
+    if (rc != 0) {
+        sensor_update_poll_rate(sensor, 0);
+    }
 
     sensor_unlock(sensor);
+    sensor_mgr_unlock();
 
-    sensor = sensor_find_min_nextrun_sensor(now, &next_wakeup);
-
-    os_callout_reset(&sensor_mgr.mgr_wakeup_callout, next_wakeup);
+done:
+    /* Other sensors may still be polled. */
+    if (sensor_find_min_nextrun_sensor(now, &next_wakeup) != NULL) {
+        os_callout_reset(&sensor_mgr.mgr_wakeup_callout, next_wakeup);
+    }
 
-    return 0;
-err:
     return rc;
 }
 
@@ -437,12 +697,17 @@ sensor_mgr_register(struct sensor *sensor)
     }
 
     sensor_mgr_insert(sensor);
+#if MYNEWT_VAL(SENSOR_MGR_POLL_HEAP)
+    rc = sensor_mgr_poll_insert(sensor);
+    if (rc != 0) {
+        sensor_mgr_remove(sensor);
+    }
+#endif
 
     sensor_unlock(sensor);
 
     sensor_mgr_unlock();
 
-    return (0);
 err:
     return (rc);
 }
@@ -524,6 +789,47 @@ sensor_poll_per_type_trait(struct sensor *sensor, os_time_t now,
     sensor_unlock(sensor);
 }
 
+#if MYNEWT_VAL(SENSOR_MGR_POLL_STATS)
+/**
+ * Records how far off its schedule a sensor is polled.
+ */
+static void
+sensor_mgr_poll_stats_update(struct sensor *sensor)
+{
+    int32_t late;
+
+    STATS_INC(g_sensor_mgr_stats, polls);
+
+    late = (int32_t)(os_time_get() - sensor->s_next_run);
+    if (late < 0) {
+        STATS_INC(g_sensor_mgr_stats, coalesced);
+    } else if (late > 0) {
+        STATS_INC(g_sensor_mgr_stats, late_polls);
+        STATS_INCN(g_sensor_mgr_stats, late_ticks, late);
+        if (late > sensor_mgr_late_max) {
+            sensor_mgr_late_max = late;
+            STATS_SET(g_sensor_mgr_stats, late_ticks_max, late);
+        }
+    }
+}
+#endif
+
+/**
+ * Returns whether a sensor that is due to run 'delta' ticks from now gets
+ * polled by the current wakeup.  Sensors due within the coalescing window
+ * are, unless the window is as long as their poll interval.
+ */
+static int
+sensor_mgr_poll_due(struct sensor *sensor, os_time_t delta,
+                    os_time_t window)
+{
+    if (delta == 0) {
+        return 1;
+    }
+
+    return delta <= window && delta < sensor_poll_ticks(sensor);
+}
+
 /**
  * Event that wakes up the sensor manager, this goes through the sensor
  * list and polls any active sensors.
@@ -536,37 +842,43 @@ sensor_mgr_wakeup_event(struct os_event *ev)
     struct sensor *cursor;
     os_time_t now;
     os_time_t next_wakeup;
+    os_time_t window;
 
     now = os_time_get();
+    window = os_time_ms_to_ticks32(MYNEWT_VAL(SENSOR_MGR_POLL_COALESCE_MS));
 
 #if MYNEWT_VAL(SENSOR_POLL_TEST_LOG)
     smgr_wakeup[smgr_wakeup_idx++%500] = now;
 #endif
+#if MYNEWT_VAL(SENSOR_MGR_POLL_STATS)
+    STATS_INC(g_sensor_mgr_stats, wakeups);
+#endif
 
     sensor_mgr_lock();
 
-    cursor = NULL;
     while (1) {
 
         cursor = sensor_find_min_nextrun_sensor(now, &next_wakeup);
-
-        sensor_lock(cursor);
-        /* Sensors that are not periodic are inserted at the end of the sensor
-         * list.
-         */
-        if (!cursor->s_poll_rate) {
-            sensor_unlock(cursor);
+        if (cursor == NULL) {
+            /* No sensor is polled. */
             sensor_mgr_unlock();
             return;
         }
 
-        /* List is sorted by what runs first.  If we reached the first element that
-         * doesn't run, break out.
+        sensor_lock(cursor);
+
+        /* Sensors are sorted by what runs first.  If we reached the first one
+         * that doesn't run, break out.
          */
-        if (next_wakeup > 0) {
+        if (!sensor_mgr_poll_due(cursor, next_wakeup, window)) {
+            sensor_unlock(cursor);
             break;
         }
 
+#if MYNEWT_VAL(SENSOR_MGR_POLL_STATS)
+        sensor_mgr_poll_stats_update(cursor);
+#endif
+
         if (sensor_type_traits_empty(cursor)) {
 
             sensor_mgr_poll_bytype(cursor, cursor->s_mask, NULL, now);
@@ -574,7 +886,7 @@ sensor_mgr_wakeup_event(struct os_event *ev)
             sensor_poll_per_type_trait(cursor, now, next_wakeup);
         }
 
-        sensor_update_nextrun(cursor, now);
+        sensor_advance_nextrun(cursor, now);
 
         sensor_unlock(cursor);
     }
@@ -662,6 +974,20 @@ sensor_mgr_init(void)
                          "sensor_notif_evts");
     assert(rc == OS_OK);
 
+    SLIST_INIT(&sensor_mgr.mgr_sensor_list);
+#if MYNEWT_VAL(SENSOR_MGR_POLL_HEAP)
+    sensor_mgr_poll_heap_cnt = 0;
+#endif
+
+#if MYNEWT_VAL(SENSOR_MGR_POLL_STATS)
+    sensor_mgr_late_max = 0;
+    rc = stats_init_and_reg(
+        STATS_HDR(g_sensor_mgr_stats),
+        STATS_SIZE_INIT_PARMS(g_sensor_mgr_stats, STATS_SIZE_32),
+        STATS_NAME_INIT_PARMS(sensor_mgr_stat_section), "sensor_mgr");
+    assert(rc == 0);
+#endif
+
     /**
      * Initialize sensor polling callout and set it to fire on boot.
      */
@@ -1190,6 +1516,123 @@ sensor_read_data_func(struct sensor *sensor, void *arg, void *data,
     return (0);
 }
 
+/**
+ * Read context for sensor_read_fifo()
+ */
+struct sensor_read_fifo_ctx {
+    sensor_fifo_data_func_t user_func;
+    void *user_arg;
+    /* Time of the read */
+    struct sensor_timestamp sts;
+};
+
+static void
+sensor_ts_add_usecs(struct sensor_timestamp *sts, uint32_t usecs)
+{
+    struct os_timeval tv;
+
+    tv.tv_sec = usecs / 1000000;
+    tv.tv_usec = usecs % 1000000;
+    os_timeradd(&sts->st_ostv, &tv, &sts->st_ostv);
+    sts->st_cputime += os_cputime_usecs_to_ticks(usecs);
+}
+
+static void
+sensor_ts_sub_usecs(struct sensor_timestamp *sts, uint32_t usecs)
+{
+    struct os_timeval tv;
+
+    tv.tv_sec = usecs / 1000000;
+    tv.tv_usec = usecs % 1000000;
+    os_timersub(&sts->st_ostv, &tv, &sts->st_ostv);
+    sts->st_cputime -= os_cputime_usecs_to_ticks(usecs);
+}
+
+void
+sensor_fifo_sample_ts(const struct sensor_fifo_data *sfd, int idx,
+                      struct sensor_timestamp *sts)
+{
+    *sts = sfd->sfd_ts;
+    sensor_ts_add_usecs(sts, idx * sfd->sfd_itvl_us);
+}
+
+/**
+ * Passes the samples of a FIFO block one by one to a listener which only
+ * handles single readings.  The sensor timestamp is set to the one of each
+ * sample for the duration of the call.
+ */
+static void
+sensor_fifo_notify_listener(struct sensor *sensor,
+                            struct sensor_listener *listener,
+                            struct sensor_fifo_data *sfd)
+{
+    struct sensor_timestamp sts;
+    struct os_timeval itvl;
+    uint32_t itvl_ticks;
+    int i;
+
+    sts = sensor->s_sts;
+
+    itvl.tv_sec = sfd->sfd_itvl_us / 1000000;
+    itvl.tv_usec = sfd->sfd_itvl_us % 1000000;
+    itvl_ticks = os_cputime_usecs_to_ticks(sfd->sfd_itvl_us);
+
+    sensor->s_sts = sfd->sfd_ts;
+    for (i = 0; i < sfd->sfd_count; i++) {
+        if (i > 0) {
+            os_timeradd(&sensor->s_sts.st_ostv, &itvl,
+                        &sensor->s_sts.st_ostv);
+            sensor->s_sts.st_cputime += itvl_ticks;
+        }
+        listener->sl_func(sensor, listener->sl_arg,
+                          sensor_fifo_sample(sfd, i), sfd->sfd_type);
+    }
+
+    sensor->s_sts = sts;
+}
+
+static int
+sensor_read_fifo_data_func(struct sensor *sensor, void *arg,
+                           struct sensor_fifo_data *sfd)
+{
+    struct sensor_listener *listener;
+    struct sensor_read_fifo_ctx *ctx;
+
+    ctx = (struct sensor_read_fifo_ctx *) arg;
+
+    if (sfd->sfd_count == 0) {
+        return (0);
+    }
+
+    /* The newest sample in the FIFO is timestamped with the time of the
+     * read, older ones one sample interval apart.
+     */
+    sfd->sfd_ts = ctx->sts;
+    sensor_ts_sub_usecs(&sfd->sfd_ts,
+        (uint32_t)(sfd->sfd_count - 1 + sfd->sfd_pending) * sfd->sfd_itvl_us);
+
+    if ((uint8_t)(uintptr_t)(ctx->user_arg) != SENSOR_IGN_LISTENER) {
+        /* Notify all listeners first */
+        SLIST_FOREACH(listener, &sensor->s_listener_list, sl_next) {
+            if (!(listener->sl_sensor_type & sfd->sfd_type)) {
+                continue;
+            }
+            if (listener->sl_fifo_func != NULL) {
+                listener->sl_fifo_func(sensor, listener->sl_arg, sfd);
+            } else {
+                sensor_fifo_notify_listener(sensor, listener, sfd);
+            }
+        }
+    }
+
+    /* Call data function */
+    if (ctx->user_func != NULL) {
+        return (ctx->user_func(sensor, ctx->user_arg, sfd));
+    }
+
+    return (0);
+}
+
 /**
  * Puts a interrupt event on the sensor manager evq
  *
@@ -2213,6 +2656,62 @@ err:
     return (rc);
 }
 
+/**
+ * Read the samples of sensor type "type" queued in the FIFO of the given
+ * sensor, and pass them to the callback in blocks.
+ *
+ * @param The sensor to read data from
+ * @param The type of sensor data to read from the sensor
+ * @param The callback to call for each block of samples
+ * @param The argument to pass to this callback.
+ * @param Maximum number of samples to read, 0 for all
+ * @param Timeout before aborting sensor read
+ *
+ * @return 0 on success, non-zero on failure.
+ */
+int
+sensor_read_fifo(struct sensor *sensor, sensor_type_t type,
+                 sensor_fifo_data_func_t data_func, void *arg,
+                 uint16_t max_samples, uint32_t timeout)
+{
+    struct sensor_read_fifo_ctx srfc;
+    int rc;
+
+    if (!sensor->s_funcs->sd_read_fifo) {
+        return SYS_ENOTSUP;
+    }
+
+    rc = sensor_lock(sensor);
+    if (rc) {
+        return rc;
+    }
+
+    srfc.user_func = data_func;
+    srfc.user_arg = arg;
+
+    if (!sensor_mgr_match_bytype(sensor, (void *)&type)) {
+        rc = SYS_ENOENT;
+        goto err;
+    }
+
+    sensor_up_timestamp(sensor);
+    srfc.sts = sensor->s_sts;
+
+    rc = sensor->s_funcs->sd_read_fifo(sensor, type,
+                                       sensor_read_fifo_data_func, &srfc,
+                                       max_samples, timeout);
+    if (rc) {
+        if (sensor->s_err_fn != NULL) {
+            sensor->s_err_fn(sensor, sensor->s_err_arg, rc);
+        }
+        goto err;
+    }
+
+err:
+    sensor_unlock(sensor);
+    return (rc);
+}
+
 /**
  * Reset sensor
  *
@@ -48,6 +48,10 @@ struct os_callout {
 
     /** Next callout in the list */
     TAILQ_ENTRY(os_callout) c_next;
+#if MYNEWT_VAL(OS_CALLOUT_WHEEL)
+    /** Timer wheel slot the callout is queued in */
+    uint8_t c_slot;
+#endif
 };
 
 /**
@@ -30,6 +30,8 @@
 #define H_OS_HEAP_
 
 #include <stddef.h>
+#include <stdint.h>
+#include "syscfg/syscfg.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -70,6 +72,48 @@ void os_free(void *mem);
  */
 void *os_realloc(void *ptr, size_t size);
 
+#if MYNEWT_VAL(OS_MALLOC_SLAB)
+/**
+ * Information about an os_malloc() size class.
+ */
+struct os_malloc_slab_info {
+    /** Size of the blocks of this class, in bytes. */
+    uint32_t omsi_block_size;
+    /** The number of blocks in this class. */
+    uint16_t omsi_num_blocks;
+    /** The number of free blocks left. */
+    uint16_t omsi_num_free;
+    /** The lowest number of free blocks seen. */
+    uint16_t omsi_min_free;
+    /** The number of allocations served by this class. */
+    uint32_t omsi_allocs;
+    /** The number of blocks of this class freed. */
+    uint32_t omsi_frees;
+    /**
+     * The number of requests fitting this class which it could not serve
+     * because it had no free blocks.
+     */
+    uint32_t omsi_fallbacks;
+    /**
+     * Total number of bytes requested by the allocations served by this
+     * class.  Compared with omsi_allocs * omsi_block_size it gives the
+     * share of the blocks lost to internal fragmentation.
+     */
+    uint64_t omsi_req_bytes;
+};
+
+/**
+ * Get information about an os_malloc() size class.
+ *
+ * @param idx                   Index of the size class, starting from 0.
+ * @param omsi                  The structure to return the information into.
+ *
+ * @return                      0 on success;
+ *                              OS_ENOENT if there is no such size class.
+ */
+int os_malloc_slab_info_get(int idx, struct os_malloc_slab_info *omsi);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -43,6 +43,41 @@ extern "C" {
  * size, in bytes, should be:
  *  os_mbuf_count * (omp_databuf_len + sizeof(struct os_mbuf))
  */
+#if MYNEWT_VAL(MSYS_STATS)
+/** Number of requested size buckets in the msys histogram. */
+#define OS_MSYS_HIST_BUCKETS    8
+
+/**
+ * Allocation counters of a pool registered with msys.
+ */
+struct os_msys_stats {
+    /** The number of requests served from this pool. */
+    uint32_t oms_reqs;
+    /** The number of blocks handed out; more than oms_reqs with chains. */
+    uint32_t oms_blocks;
+    /** The number of requests served with a chain of several blocks. */
+    uint32_t oms_chains;
+    /**
+     * The number of requests for which this pool was the best fit, but which
+     * were served by another pool because this one had no free blocks.
+     */
+    uint32_t oms_fallbacks;
+    /**
+     * The number of requests for which this pool was the best fit, but which
+     * could not be served at all.
+     */
+    uint32_t oms_failures;
+    /** Total number of bytes requested by the requests served. */
+    uint32_t oms_req_bytes;
+    /**
+     * Requested sizes of the requests served.  Bucket n counts requests
+     * smaller than 32 << n bytes; the last bucket counts all larger ones.
+     * Requests with a size of 0 ("any size") are not counted.
+     */
+    uint32_t oms_hist[OS_MSYS_HIST_BUCKETS];
+};
+#endif
+
 struct os_mbuf_pool {
     /**
      * Total length of the databuf in each mbuf.  This is the size of the
@@ -58,6 +93,14 @@ struct os_mbuf_pool {
      * Next mbuf pool in the list
      */
     STAILQ_ENTRY(os_mbuf_pool) omp_next;
+
+#if MYNEWT_VAL(MSYS_STATS)
+    /**
+     * Msys allocation counters; only maintained while the pool is
+     * registered with msys.
+     */
+    struct os_msys_stats omp_msys_stats;
+#endif
 };
 
 
@@ -318,6 +361,12 @@ int os_msys_register(struct os_mbuf_pool *new_pool);
  * Allocate a mbuf from msys.  Based upon the data size requested,
  * os_msys_get() will choose the mbuf pool that has the best fit.
  *
+ * If the best fitting pool has no free blocks, the largest pool with free
+ * blocks is used instead.  With MSYS_CHAIN_FALLBACK, when that pool has
+ * smaller blocks than requested, a chain of empty mbufs covering dsize is
+ * returned if enough blocks are free.  os_mbuf_append() fills the empty
+ * mbufs of a chain before allocating new ones.
+ *
  * @param dsize                 The estimated size of the data being stored in
  *                                  the mbuf
  * @param leadingspace          The amount of leadingspace to allocate in
@@ -361,6 +410,41 @@ int os_msys_count(void);
  */
 int os_msys_num_free(void);
 
+#if MYNEWT_VAL(MSYS_STATS)
+/**
+ * Information about a pool registered with msys.
+ */
+struct os_msys_info {
+    /** Size of the data buffer of the pool's mbufs, in bytes. */
+    uint16_t omsi_databuf_len;
+    /** The number of blocks in the pool. */
+    uint16_t omsi_num_blocks;
+    /** The number of free blocks left. */
+    uint16_t omsi_num_free;
+    /** The lowest number of free blocks seen. */
+    uint16_t omsi_min_free;
+    /** The pool's allocation counters. */
+    struct os_msys_stats omsi_stats;
+};
+
+/**
+ * Get information about a pool registered with msys.  Pools are ordered from
+ * the smallest to the biggest block size.
+ *
+ * @param idx                   Index of the pool, starting from 0.
+ * @param omsi                  The structure to return the information into.
+ *
+ * @return                      0 on success;
+ *                              OS_ENOENT if there is no such pool.
+ */
+int os_msys_info_get(int idx, struct os_msys_info *omsi);
+
+/**
+ * Clear the allocation counters of all pools registered with msys.
+ */
+void os_msys_stats_clear(void);
+#endif
+
 /**
  * Initialize a pool of mbufs.
  *
@@ -690,6 +774,90 @@ int os_mbuf_widen(struct os_mbuf *om, uint16_t off, uint16_t len);
  */
 struct os_mbuf *os_mbuf_pack_chains(struct os_mbuf *m1, struct os_mbuf *m2);
 
+/**
+ * A single contiguous region of memory; one element of a scatter-gather
+ * list handed to vectored I/O routines (e.g., hal_flash_writev()).
+ */
+struct os_iovec {
+    /** Start of the region. */
+    void *iov_base;
+    /** Length of the region, in bytes. */
+    uint32_t iov_len;
+};
+
+/**
+ * Iterator over the data segments of an mbuf chain.  Each step yields a
+ * pointer into the mbuf's own data buffer, so a chain can be handed to a
+ * driver without first flattening it into a scratch buffer.
+ *
+ * The iterator only borrows the chain; the chain must not be modified while
+ * the iterator (or any iovec it produced) is in use.
+ */
+struct os_mbuf_iov_iter {
+    /** Current mbuf; NULL once the iterator is exhausted. */
+    const struct os_mbuf *omi_om;
+    /** Offset of the next unread byte within omi_om. */
+    uint16_t omi_off;
+    /** Number of bytes still to be produced. */
+    uint32_t omi_rem;
+};
+
+/**
+ * Prepares an iterator over "len" bytes of an mbuf chain, starting "off"
+ * bytes from the beginning of the chain.  If the chain ends before off + len
+ * bytes, iteration stops at the end of the chain.
+ *
+ * @param it                    The iterator to initialize.
+ * @param om                    The mbuf chain to iterate over.
+ * @param off                   The offset of the first byte to produce.
+ * @param len                   The maximum number of bytes to produce.
+ *
+ * @return                      0 on success;
+ *                              SYS_EINVAL if the offset is out of bounds.
+ */
+int os_mbuf_iov_init(struct os_mbuf_iov_iter *it, const struct os_mbuf *om,
+                     int off, int len);
+
+/**
+ * Produces the next contiguous segment of an mbuf chain.  Empty mbufs are
+ * skipped.
+ *
+ * @param it                    The iterator to advance.
+ * @param iov                   On success, describes the segment.
+ *
+ * @return                      1 if a segment was produced;
+ *                              0 if the iterator is exhausted.
+ */
+int os_mbuf_iov_next(struct os_mbuf_iov_iter *it, struct os_iovec *iov);
+
+/**
+ * Fills an iovec array with consecutive segments of an mbuf chain.  If the
+ * array is too small to hold the remainder of the chain, the iterator is left
+ * positioned at the first segment that did not fit, and a subsequent call
+ * continues from there.
+ *
+ * @param it                    The iterator to advance.
+ * @param iov                   The array to fill.
+ * @param iov_cnt               The number of elements in the array.
+ *
+ * @return                      The number of elements filled.
+ */
+int os_mbuf_iov_fill(struct os_mbuf_iov_iter *it, struct os_iovec *iov,
+                     int iov_cnt);
+
+/**
+ * Indicates whether an mbuf iterator has produced all of its data.
+ *
+ * @param it                    The iterator to query.
+ *
+ * @return                      1 if the iterator is exhausted; 0 otherwise.
+ */
+static inline int
+os_mbuf_iov_done(const struct os_mbuf_iov_iter *it)
+{
+    return it->omi_om == NULL;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -47,6 +47,8 @@ struct os_memblock {
     SLIST_ENTRY(os_memblock) mb_next;
 };
 
+struct os_mempool_cache;
+
 /* XXX: Change this structure so that we keep the first address in the pool? */
 /* XXX: add memory debug structure and associated code */
 /* XXX: Change how I coded the SLIST_HEAD here. It should be named:
@@ -74,6 +76,10 @@ struct os_mempool {
     SLIST_HEAD(,os_memblock);
     /** Name for memory block */
     char *name;
+#if MYNEWT_VAL(OS_MEMPOOL_CACHE)
+    /** Per-task caches of this pool. */
+    SLIST_HEAD(, os_mempool_cache) mp_caches;
+#endif
 };
 
 /**
@@ -82,6 +88,35 @@ struct os_mempool {
  */
 #define OS_MEMPOOL_F_EXT        0x01
 
+#if MYNEWT_VAL(OS_MEMPOOL_CACHE)
+/**
+ * A per-task cache of free blocks of a memory pool.  While the owning task
+ * runs, os_memblock_get() and os_memblock_put() are served from the cache
+ * without disabling interrupts.  The cache is refilled from, and drained to,
+ * the pool in batches of half its size.  Blocks held by a cache are counted
+ * as in use by the pool, so mp_num_free and mp_min_free keep describing the
+ * blocks available to every user of the pool.
+ */
+struct os_mempool_cache {
+    /** Memory pool the cached blocks belong to. */
+    struct os_mempool *mpc_pool;
+    /** Task owning the cache. */
+    struct os_task *mpc_task;
+    /** Maximum number of blocks held by the cache. */
+    uint16_t mpc_size;
+    /** Number of blocks currently held by the cache. */
+    uint16_t mpc_count;
+    /** Number of times the cache was refilled from the pool. */
+    uint32_t mpc_refills;
+    /** Number of times the cache was drained to the pool. */
+    uint32_t mpc_drains;
+    /** Free blocks held by the cache. */
+    SLIST_HEAD(, os_memblock) mpc_blocks;
+    /** Next cache of the same memory pool. */
+    SLIST_ENTRY(os_mempool_cache) mpc_next;
+};
+#endif
+
 struct os_mempool_ext;
 
 /**
@@ -304,6 +339,65 @@ os_error_t os_memblock_put_from_cb(struct os_mempool *mp, void *block_addr);
  */
 os_error_t os_memblock_put(struct os_mempool *mp, void *block_addr);
 
+/**
+ * Puts several memory blocks back into the same pool.  The blocks are linked
+ * together first and then spliced onto the pool's free list in a single
+ * critical section, instead of one per block.
+ *
+ * Blocks are handled one at a time, exactly as by os_memblock_put(), if the
+ * pool has a put callback, if the running task has a cache of the pool, or
+ * if OS_MEMPOOL_CHECK is enabled.
+ *
+ * @param mp                    Pointer to memory pool
+ * @param blocks                Array of pointers to memory blocks
+ * @param num_blocks            Number of elements in the array
+ *
+ * @return                      0 on success;
+ *                              Non-zero error code on failure.
+ */
+os_error_t os_memblock_put_batch(struct os_mempool *mp, void **blocks,
+                                 int num_blocks);
+
+#if MYNEWT_VAL(OS_MEMPOOL_CACHE)
+/**
+ * Initializes a per-task cache and attaches it to a memory pool.  Once
+ * attached, blocks allocated and freed by the task are taken from and
+ * returned to the cache.  Blocks allocated and freed from interrupt context
+ * always go to the pool.
+ *
+ * @param mpc                   The cache to initialize.
+ * @param mp                    The memory pool to cache blocks of.
+ * @param task                  The task owning the cache.
+ * @param size                  Maximum number of blocks held by the cache;
+ *                                  must be at least 2.
+ *
+ * @return                      0 on success;
+ *                              OS_INVALID_PARM on invalid arguments.
+ */
+os_error_t os_mempool_cache_init(struct os_mempool_cache *mpc,
+                                 struct os_mempool *mp, struct os_task *task,
+                                 uint16_t size);
+
+/**
+ * Returns all blocks held by a cache to its memory pool.  This must be
+ * called by the task owning the cache, or while that task is not running.
+ *
+ * @param mpc                   The cache to flush.
+ */
+void os_mempool_cache_flush(struct os_mempool_cache *mpc);
+
+/**
+ * Flushes a cache and detaches it from its memory pool.  This must be
+ * called before the owning task is removed.
+ *
+ * @param mpc                   The cache to remove.
+ *
+ * @return                      0 on success;
+ *                              OS_INVALID_PARM if the cache is not attached.
+ */
+os_error_t os_mempool_cache_remove(struct os_mempool_cache *mpc);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -45,6 +45,12 @@ extern struct os_task_list g_os_sleep_list;
 
 void os_sched_ctx_sw_hook(struct os_task *next_t);
 
+/**
+ * Resets the run and sleep lists to empty.  Only needed by architectures
+ * that re-initialize the OS at runtime (sim).
+ */
+void os_sched_init(void);
+
 /** @endcond */
 
 /**
@@ -165,6 +165,14 @@ struct os_task {
     TAILQ_ENTRY(os_task) t_os_list;
     /** Entry for a singly-linked object list. */
     SLIST_ENTRY(os_task) t_obj_list;
+#if MYNEWT_VAL(OS_SCHED_PRIO_BITMAP)
+    /** Priority the task was queued at in the run list */
+    uint8_t t_sched_prio;
+#endif
+#if MYNEWT_VAL(OS_SCHED_SLEEP_HEAP)
+    /** Position of the task in the sleep heap */
+    uint8_t t_sleep_idx;
+#endif
 };
 
 /** @cond INTERNAL_HIDDEN */
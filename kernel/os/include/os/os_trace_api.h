@@ -59,6 +59,7 @@ extern "C" {
 #define OS_TRACE_ID_MEMBLOCK_GET                (80)
 #define OS_TRACE_ID_MEMBLOCK_PUT_FROM_CB        (81)
 #define OS_TRACE_ID_MEMBLOCK_PUT                (82)
+#define OS_TRACE_ID_MEMBLOCK_PUT_BATCH          (83)
 #define OS_TRACE_ID_MBUF_GET                    (90)
 #define OS_TRACE_ID_MBUF_GET_PKTHDR             (91)
 #define OS_TRACE_ID_MBUF_FREE                   (92)
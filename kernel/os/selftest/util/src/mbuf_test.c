@@ -94,12 +94,14 @@ TEST_CASE_DECL(os_mbuf_test_alloc)
 TEST_CASE_DECL(os_mbuf_test_dup)
 TEST_CASE_DECL(os_mbuf_test_dup_pool)
 TEST_CASE_DECL(os_mbuf_test_append)
+TEST_CASE_DECL(os_mbuf_test_append_chain)
 TEST_CASE_DECL(os_mbuf_test_pullup)
 TEST_CASE_DECL(os_mbuf_test_extend)
 TEST_CASE_DECL(os_mbuf_test_adj)
 TEST_CASE_DECL(os_mbuf_test_get_pkthdr)
 TEST_CASE_DECL(os_mbuf_test_widen)
 TEST_CASE_DECL(os_mbuf_test_pack_chains)
+TEST_CASE_DECL(os_mbuf_test_iov)
 
 TEST_SUITE(os_mbuf_test_suite)
 {
@@ -107,10 +109,12 @@ TEST_SUITE(os_mbuf_test_suite)
     os_mbuf_test_dup();
     os_mbuf_test_dup_pool();
     os_mbuf_test_append();
+    os_mbuf_test_append_chain();
     os_mbuf_test_pullup();
     os_mbuf_test_extend();
     os_mbuf_test_adj();
     os_mbuf_test_get_pkthdr();
     os_mbuf_test_widen();
     os_mbuf_test_pack_chains();
+    os_mbuf_test_iov();
 }
@@ -23,7 +23,7 @@
 #include "mem/mem.h"
 #include "os_test_priv.h"
 #include "msys_test.h"
-#include "os_priv.h"
+#include "os/../../src/os_priv.h"
 
 os_membuf_t msys_mbuf_membuf1[OS_MEMPOOL_SIZE(MSYS_TEST_POOL_BIG_BUF_SIZE, MSYS_TEST_POOL_BIG_BUF_COUNT)];
 os_membuf_t msys_mbuf_membuf2[OS_MEMPOOL_SIZE(MSYS_TEST_POOL_SMALL_BUF_SIZE, MSYS_TEST_POOL_SMALL_BUF_COUNT)];
@@ -90,6 +90,8 @@ TEST_CASE_DECL(os_msys_test_limit1)
 TEST_CASE_DECL(os_msys_test_limit2)
 TEST_CASE_DECL(os_msys_test_limit3)
 TEST_CASE_DECL(os_msys_test_alloc1)
+TEST_CASE_DECL(os_msys_test_stats)
+TEST_CASE_DECL(os_msys_test_chain)
 
 TEST_SUITE(os_msys_test_suite)
 {
@@ -97,4 +99,6 @@ TEST_SUITE(os_msys_test_suite)
     os_msys_test_limit2();
     os_msys_test_limit3();
     os_msys_test_alloc1();
+    os_msys_test_stats();
+    os_msys_test_chain();
 }
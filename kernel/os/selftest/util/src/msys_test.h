@@ -52,6 +52,14 @@ extern os_membuf_t msys_mbuf_membuf1[];
 extern os_membuf_t msys_mbuf_membuf2[];
 extern os_membuf_t msys_mbuf_membuf3[];
 
+extern struct os_mempool msys_mempool1;
+extern struct os_mempool msys_mempool2;
+extern struct os_mempool msys_mempool3;
+
+extern struct os_mbuf_pool msys_mbuf_pool1;
+extern struct os_mbuf_pool msys_mbuf_pool2;
+extern struct os_mbuf_pool msys_mbuf_pool3;
+
 extern struct os_mbuf_pool os_mbuf_pool;
 extern struct os_mempool os_mbuf_mempool;
 extern uint8_t os_mbuf_test_data[MBUF_TEST_DATA_LEN];
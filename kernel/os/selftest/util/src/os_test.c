@@ -71,13 +71,8 @@ os_test_all(void)
     os_eventq_test_suite();
     os_callout_test_suite();
     os_time_test_suite();
+    os_sched_test_suite();
+    os_malloc_test_suite();
 
     return tu_case_failed;
 }
-
-int
-main(int argc, char **argv)
-{
-    os_test_all();
-    return tu_any_failed;
-}
@@ -0,0 +1,78 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "os_test_priv.h"
+
+#define CALLOUT_ORDER_NUM   (12)
+
+static const os_time_t callout_order_ticks[CALLOUT_ORDER_NUM] = {
+    200, 1, 33, 32, 5, 250, 31, 64, 2, 150, 100, 33
+};
+
+static struct os_callout callout_order[CALLOUT_ORDER_NUM];
+static struct os_eventq callout_order_evq;
+static os_time_t callout_order_last;
+static int callout_order_cnt;
+
+static void
+callout_order_cb(struct os_event *ev)
+{
+    struct os_callout *c;
+
+    c = (struct os_callout *)ev;
+
+    /* Callouts must not fire early and must fire in order of expiry. */
+    TEST_ASSERT(OS_TIME_TICK_GEQ(os_time_get(), c->c_ticks));
+    TEST_ASSERT(OS_TIME_TICK_GEQ(c->c_ticks, callout_order_last));
+    TEST_ASSERT(!os_callout_queued(c));
+
+    callout_order_last = c->c_ticks;
+    callout_order_cnt++;
+}
+
+/* Test case of callouts armed at different distances expiring in order */
+TEST_CASE_TASK(callout_test_order)
+{
+    int rc;
+    int i;
+
+    os_eventq_init(&callout_order_evq);
+    for (i = 0; i < CALLOUT_ORDER_NUM; i++) {
+        os_callout_init(&callout_order[i], &callout_order_evq,
+                        callout_order_cb, NULL);
+    }
+
+    callout_order_last = os_time_get();
+    callout_order_cnt = 0;
+    for (i = 0; i < CALLOUT_ORDER_NUM; i++) {
+        rc = os_callout_reset(&callout_order[i], callout_order_ticks[i]);
+        TEST_ASSERT_FATAL(rc == 0);
+        TEST_ASSERT(os_callout_queued(&callout_order[i]));
+    }
+
+    /* Stopped callout must never fire. */
+    os_callout_stop(&callout_order[9]);
+    TEST_ASSERT(!os_callout_queued(&callout_order[9]));
+
+    while (callout_order_cnt < CALLOUT_ORDER_NUM - 1) {
+        os_eventq_run(&callout_order_evq);
+    }
+
+    os_time_delay(OS_TICKS_PER_SEC);
+    TEST_ASSERT(os_eventq_get_no_wait(&callout_order_evq) == NULL);
+}
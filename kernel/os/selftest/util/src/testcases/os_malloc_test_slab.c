@@ -0,0 +1,105 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os_test_priv.h"
+
+#define MALLOC_TEST_MAX_BLOCKS  (256)
+
+TEST_CASE_SELF(os_malloc_test_slab)
+{
+#if MYNEWT_VAL(OS_MALLOC_SLAB)
+    static void *blocks[MALLOC_TEST_MAX_BLOCKS];
+    struct os_malloc_slab_info first;
+    struct os_malloc_slab_info last;
+    struct os_malloc_slab_info omsi;
+    uint8_t *big;
+    uint8_t *p;
+    int num_classes;
+    int rc;
+    int i;
+
+    rc = os_malloc_slab_info_get(0, &first);
+    TEST_ASSERT_FATAL(rc == 0, "no os_malloc size class configured");
+    TEST_ASSERT_FATAL(first.omsi_num_blocks < MALLOC_TEST_MAX_BLOCKS);
+    TEST_ASSERT(first.omsi_num_free == first.omsi_num_blocks);
+
+    for (num_classes = 1; ; num_classes++) {
+        rc = os_malloc_slab_info_get(num_classes, &last);
+        if (rc != 0) {
+            break;
+        }
+    }
+    TEST_ASSERT(rc == OS_ENOENT);
+    rc = os_malloc_slab_info_get(num_classes - 1, &last);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* Requests bigger than the largest class go to the heap. */
+    big = os_malloc(last.omsi_block_size + 1);
+    TEST_ASSERT_FATAL(big != NULL);
+    os_malloc_slab_info_get(num_classes - 1, &omsi);
+    TEST_ASSERT(omsi.omsi_allocs == last.omsi_allocs);
+
+    /* Small requests are served by the smallest class. */
+    p = os_malloc(1);
+    TEST_ASSERT_FATAL(p != NULL);
+    os_malloc_slab_info_get(0, &omsi);
+    TEST_ASSERT(omsi.omsi_num_free == first.omsi_num_free - 1);
+    TEST_ASSERT(omsi.omsi_allocs == first.omsi_allocs + 1);
+    TEST_ASSERT(omsi.omsi_req_bytes == first.omsi_req_bytes + 1);
+
+    /* Growing within the block keeps the block. */
+    memset(p, 0xa5, first.omsi_block_size);
+    TEST_ASSERT(os_realloc(p, first.omsi_block_size) == p);
+
+    /* Growing beyond the block moves the data. */
+    p = os_realloc(p, last.omsi_block_size + 1);
+    TEST_ASSERT_FATAL(p != NULL);
+    for (i = 0; i < first.omsi_block_size; i++) {
+        TEST_ASSERT_FATAL(p[i] == 0xa5);
+    }
+    os_malloc_slab_info_get(0, &omsi);
+    TEST_ASSERT(omsi.omsi_num_free == first.omsi_num_free);
+    TEST_ASSERT(omsi.omsi_frees == first.omsi_frees + 1);
+    os_free(p);
+
+    /* Exhaust the smallest class; the next request falls back. */
+    for (i = 0; i < first.omsi_num_blocks; i++) {
+        blocks[i] = os_malloc(first.omsi_block_size);
+        TEST_ASSERT_FATAL(blocks[i] != NULL);
+    }
+    os_malloc_slab_info_get(0, &omsi);
+    TEST_ASSERT(omsi.omsi_num_free == 0);
+    TEST_ASSERT(omsi.omsi_min_free == 0);
+
+    p = os_malloc(first.omsi_block_size);
+    TEST_ASSERT_FATAL(p != NULL);
+    os_malloc_slab_info_get(0, &omsi);
+    TEST_ASSERT(omsi.omsi_fallbacks == first.omsi_fallbacks + 1);
+    os_free(p);
+
+    for (i = 0; i < first.omsi_num_blocks; i++) {
+        os_free(blocks[i]);
+    }
+    os_malloc_slab_info_get(0, &omsi);
+    TEST_ASSERT(omsi.omsi_num_free == omsi.omsi_num_blocks);
+
+    os_free(big);
+#endif
+}
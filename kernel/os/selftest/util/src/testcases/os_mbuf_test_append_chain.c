@@ -0,0 +1,104 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "os_test_priv.h"
+
+TEST_CASE_SELF(os_mbuf_test_append_chain)
+{
+    struct os_mbuf *om;
+    struct os_mbuf *om2;
+    struct os_mbuf *om3;
+    int num_free;
+    int len;
+    int rc;
+
+    os_mbuf_test_setup();
+
+    /*** Empty head with empty mbufs after it; they are filled in order. */
+    om = os_mbuf_get_pkthdr(&os_mbuf_pool, 0);
+    TEST_ASSERT_FATAL(om != NULL);
+    om2 = os_mbuf_get(&os_mbuf_pool, 0);
+    TEST_ASSERT_FATAL(om2 != NULL);
+    om3 = os_mbuf_get(&os_mbuf_pool, 0);
+    TEST_ASSERT_FATAL(om3 != NULL);
+    SLIST_NEXT(om, om_next) = om2;
+    SLIST_NEXT(om2, om_next) = om3;
+
+    len = OS_MBUF_TRAILINGSPACE(om) + OS_MBUF_TRAILINGSPACE(om2) +
+          OS_MBUF_TRAILINGSPACE(om3);
+    num_free = os_mbuf_mempool.mp_num_free;
+
+    rc = os_mbuf_append(om, os_mbuf_test_data, len);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(os_mbuf_mempool.mp_num_free == num_free);
+    TEST_ASSERT(SLIST_NEXT(om, om_next) == om2);
+    TEST_ASSERT(SLIST_NEXT(om2, om_next) == om3);
+    TEST_ASSERT(SLIST_NEXT(om3, om_next) == NULL);
+    os_mbuf_test_misc_assert_sane(om, os_mbuf_test_data,
+                                  len - om2->om_len - om3->om_len, len,
+                                  sizeof(struct os_mbuf_pkthdr));
+
+    /* The chain is full; one more byte takes a new mbuf. */
+    rc = os_mbuf_append(om, os_mbuf_test_data + len, 1);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(os_mbuf_mempool.mp_num_free == num_free - 1);
+    os_mbuf_test_misc_assert_sane(om, os_mbuf_test_data,
+                                  len - om2->om_len - om3->om_len, len + 1,
+                                  sizeof(struct os_mbuf_pkthdr));
+
+    os_mbuf_free_chain(om);
+
+    /*** Head holding data, with an empty mbuf after it. */
+    om = os_mbuf_get_pkthdr(&os_mbuf_pool, 0);
+    TEST_ASSERT_FATAL(om != NULL);
+    rc = os_mbuf_append(om, os_mbuf_test_data, 10);
+    TEST_ASSERT_FATAL(rc == 0);
+    om2 = os_mbuf_get(&os_mbuf_pool, 0);
+    TEST_ASSERT_FATAL(om2 != NULL);
+    SLIST_NEXT(om, om_next) = om2;
+
+    len = OS_MBUF_TRAILINGSPACE(om) + 20;
+    num_free = os_mbuf_mempool.mp_num_free;
+
+    rc = os_mbuf_append(om, os_mbuf_test_data + 10, len);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(os_mbuf_mempool.mp_num_free == num_free);
+    TEST_ASSERT(om2->om_len == 20);
+    TEST_ASSERT(SLIST_NEXT(om2, om_next) == NULL);
+    os_mbuf_test_misc_assert_sane(om, os_mbuf_test_data, 10 + len - 20,
+                                  10 + len, sizeof(struct os_mbuf_pkthdr));
+
+    os_mbuf_free_chain(om);
+
+    /*** Empty head, data after an empty mbuf is kept in order. */
+    om = os_mbuf_get(&os_mbuf_pool, 0);
+    TEST_ASSERT_FATAL(om != NULL);
+    om2 = os_mbuf_get(&os_mbuf_pool, 0);
+    TEST_ASSERT_FATAL(om2 != NULL);
+    SLIST_NEXT(om, om_next) = om2;
+    rc = os_mbuf_append(om2, os_mbuf_test_data, 10);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = os_mbuf_append(om, os_mbuf_test_data + 10, 10);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(om->om_len == 0);
+    TEST_ASSERT(om2->om_len == 20);
+    os_mbuf_test_misc_assert_sane(om, os_mbuf_test_data, 0, 20, 0);
+
+    os_mbuf_free_chain(om);
+}
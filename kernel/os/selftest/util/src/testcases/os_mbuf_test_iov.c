@@ -0,0 +1,128 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "os_test_priv.h"
+#include "os_test_priv.h"
+
+static int
+omti_gather(struct os_mbuf_iov_iter *it, uint8_t *dst, int *out_cnt)
+{
+    struct os_iovec iov;
+    int total;
+    int cnt;
+
+    total = 0;
+    cnt = 0;
+    while (os_mbuf_iov_next(it, &iov)) {
+        TEST_ASSERT(iov.iov_len > 0);
+        memcpy(dst + total, iov.iov_base, iov.iov_len);
+        total += iov.iov_len;
+        cnt++;
+    }
+
+    *out_cnt = cnt;
+    return total;
+}
+
+TEST_CASE_SELF(os_mbuf_test_iov)
+{
+    struct os_mbuf_iov_iter it;
+    struct os_iovec iov[2];
+    struct os_mbuf *empty;
+    struct os_mbuf *om1;
+    struct os_mbuf *om2;
+    uint8_t buf[300];
+    int total;
+    int cnt;
+    int rc;
+
+    os_mbuf_test_setup();
+
+    /* 100 bytes, an empty mbuf, then 200 bytes. */
+    om1 = os_mbuf_get(&os_mbuf_pool, 0);
+    TEST_ASSERT_FATAL(om1 != NULL);
+    rc = os_mbuf_append(om1, os_mbuf_test_data, 100);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    empty = os_mbuf_get(&os_mbuf_pool, 0);
+    TEST_ASSERT_FATAL(empty != NULL);
+
+    om2 = os_mbuf_get(&os_mbuf_pool, 0);
+    TEST_ASSERT_FATAL(om2 != NULL);
+    rc = os_mbuf_append(om2, os_mbuf_test_data + 100, 200);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    os_mbuf_concat(om1, empty);
+    os_mbuf_concat(om1, om2);
+
+    /*** Whole chain; segments point into the mbufs and skip the empty one. */
+    rc = os_mbuf_iov_init(&it, om1, 0, 300);
+    TEST_ASSERT_FATAL(rc == 0);
+    cnt = os_mbuf_iov_fill(&it, iov, 2);
+    TEST_ASSERT_FATAL(cnt == 2);
+    TEST_ASSERT(os_mbuf_iov_done(&it));
+    TEST_ASSERT(iov[0].iov_base == om1->om_data && iov[0].iov_len == 100);
+    TEST_ASSERT(iov[1].iov_base == om2->om_data && iov[1].iov_len == 200);
+
+    /*** Sub-range spanning the empty mbuf. */
+    rc = os_mbuf_iov_init(&it, om1, 50, 100);
+    TEST_ASSERT_FATAL(rc == 0);
+    total = omti_gather(&it, buf, &cnt);
+    TEST_ASSERT(total == 100);
+    TEST_ASSERT(cnt == 2);
+    TEST_ASSERT(memcmp(buf, os_mbuf_test_data + 50, 100) == 0);
+
+    /*** Offset on an mbuf boundary. */
+    rc = os_mbuf_iov_init(&it, om1, 100, 10);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT_FATAL(os_mbuf_iov_next(&it, &iov[0]));
+    TEST_ASSERT(iov[0].iov_base == om2->om_data && iov[0].iov_len == 10);
+    TEST_ASSERT(!os_mbuf_iov_next(&it, &iov[0]));
+
+    /*** Fill resumes where a short array left off. */
+    rc = os_mbuf_iov_init(&it, om1, 0, 300);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(os_mbuf_iov_fill(&it, iov, 1) == 1);
+    TEST_ASSERT(!os_mbuf_iov_done(&it));
+    TEST_ASSERT(os_mbuf_iov_fill(&it, iov, 2) == 1);
+    TEST_ASSERT(iov[0].iov_base == om2->om_data);
+    TEST_ASSERT(os_mbuf_iov_fill(&it, iov, 2) == 0);
+
+    /*** Length beyond the end of the chain is clipped. */
+    rc = os_mbuf_iov_init(&it, om1, 250, 1000);
+    TEST_ASSERT_FATAL(rc == 0);
+    total = omti_gather(&it, buf, &cnt);
+    TEST_ASSERT(total == 50);
+    TEST_ASSERT(memcmp(buf, os_mbuf_test_data + 250, 50) == 0);
+
+    /*** Zero length and end-of-chain offset produce nothing. */
+    rc = os_mbuf_iov_init(&it, om1, 10, 0);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(os_mbuf_iov_done(&it));
+    rc = os_mbuf_iov_init(&it, om1, 300, 10);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(os_mbuf_iov_done(&it));
+
+    /*** Invalid offset. */
+    rc = os_mbuf_iov_init(&it, om1, 301, 1);
+    TEST_ASSERT(rc == SYS_EINVAL);
+    TEST_ASSERT(os_mbuf_iov_done(&it));
+
+    rc = os_mbuf_free_chain(om1);
+    TEST_ASSERT(rc == 0);
+}
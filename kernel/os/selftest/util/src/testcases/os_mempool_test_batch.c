@@ -0,0 +1,91 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "os_test_priv.h"
+
+#define OMTB_NUM_BLOCKS     (10)
+#define OMTB_BLOCK_SIZE     (32)
+
+static struct os_mempool_ext omtb_pool;
+static int omtb_cb_calls;
+
+static os_error_t
+omtb_put_cb(struct os_mempool_ext *mpe, void *block, void *arg)
+{
+    omtb_cb_calls++;
+    return os_memblock_put_from_cb(&mpe->mpe_mp, block);
+}
+
+TEST_CASE_SELF(os_mempool_test_batch)
+{
+    uint8_t buf[OS_MEMPOOL_BYTES(OMTB_NUM_BLOCKS, OMTB_BLOCK_SIZE)];
+    struct os_mempool *mp;
+    void *blocks[OMTB_NUM_BLOCKS];
+    void *bad[2];
+    int rc;
+    int i;
+
+    /* Attempt to unregister the pool in case this test has already run. */
+    os_mempool_unregister(&omtb_pool.mpe_mp);
+
+    rc = os_mempool_ext_init(&omtb_pool, OMTB_NUM_BLOCKS, OMTB_BLOCK_SIZE,
+                             buf, "test_batch");
+    TEST_ASSERT_FATAL(rc == 0);
+    mp = &omtb_pool.mpe_mp;
+
+    for (i = 0; i < OMTB_NUM_BLOCKS; i++) {
+        blocks[i] = os_memblock_get(mp);
+        TEST_ASSERT_FATAL(blocks[i] != NULL);
+    }
+    TEST_ASSERT(mp->mp_num_free == 0);
+
+    /*** Empty batch. */
+    rc = os_memblock_put_batch(mp, blocks, 0);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(mp->mp_num_free == 0);
+
+    /*** Invalid arguments leave the pool untouched. */
+    bad[0] = blocks[0];
+    bad[1] = NULL;
+    rc = os_memblock_put_batch(mp, bad, 2);
+    TEST_ASSERT(rc == OS_INVALID_PARM);
+    rc = os_memblock_put_batch(NULL, blocks, 1);
+    TEST_ASSERT(rc == OS_INVALID_PARM);
+    TEST_ASSERT(mp->mp_num_free == 0);
+
+    /*** Blocks come back out in array order. */
+    rc = os_memblock_put_batch(mp, blocks, 6);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(mp->mp_num_free == 6);
+    TEST_ASSERT(os_mempool_is_sane(mp));
+
+    for (i = 0; i < 6; i++) {
+        TEST_ASSERT(os_memblock_get(mp) == blocks[i]);
+    }
+    TEST_ASSERT(mp->mp_num_free == 0);
+
+    /*** Put callback is still invoked for every block. */
+    omtb_pool.mpe_put_cb = omtb_put_cb;
+    rc = os_memblock_put_batch(mp, blocks, OMTB_NUM_BLOCKS);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(omtb_cb_calls == OMTB_NUM_BLOCKS);
+    TEST_ASSERT(mp->mp_num_free == OMTB_NUM_BLOCKS);
+    TEST_ASSERT(os_mempool_is_sane(mp));
+
+    omtb_pool.mpe_put_cb = NULL;
+}
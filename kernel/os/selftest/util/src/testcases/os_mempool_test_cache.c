@@ -0,0 +1,115 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os_test_priv.h"
+
+#if MYNEWT_VAL(OS_MEMPOOL_CACHE)
+static struct os_mempool cache_pool;
+static struct os_mempool_cache cache;
+#endif
+
+TEST_CASE_TASK(os_mempool_test_cache)
+{
+#if MYNEWT_VAL(OS_MEMPOOL_CACHE)
+    uint8_t buf[OS_MEMPOOL_BYTES(10, 32)];
+    void *blocks[10];
+    int rc;
+    int i;
+
+    /* Attempt to unregister the pool in case this test has already run. */
+    os_mempool_unregister(&cache_pool);
+
+    rc = os_mempool_init(&cache_pool, 10, 32, buf, "test_cache");
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = os_mempool_cache_init(&cache, &cache_pool,
+                               os_sched_get_current_task(), 1);
+    TEST_ASSERT(rc == OS_INVALID_PARM);
+    rc = os_mempool_cache_init(&cache, &cache_pool,
+                               os_sched_get_current_task(), 4);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* The first allocation refills half the cache. */
+    blocks[0] = os_memblock_get(&cache_pool);
+    TEST_ASSERT_FATAL(blocks[0] != NULL);
+    TEST_ASSERT(cache.mpc_count == 1);
+    TEST_ASSERT(cache_pool.mp_num_free == 8);
+    TEST_ASSERT(cache_pool.mp_min_free == 8);
+
+    /* Exhaust the pool through the cache. */
+    for (i = 1; i < 10; i++) {
+        blocks[i] = os_memblock_get(&cache_pool);
+        TEST_ASSERT_FATAL(blocks[i] != NULL);
+        TEST_ASSERT(os_memblock_from(&cache_pool, blocks[i]));
+    }
+    TEST_ASSERT(os_memblock_get(&cache_pool) == NULL);
+    TEST_ASSERT(cache.mpc_count == 0);
+    TEST_ASSERT(cache_pool.mp_num_free == 0);
+    TEST_ASSERT(cache_pool.mp_min_free == 0);
+
+    /* Freed blocks stay in the cache until it overflows. */
+    for (i = 0; i < 4; i++) {
+        rc = os_memblock_put(&cache_pool, blocks[i]);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+    TEST_ASSERT(cache.mpc_count == 4);
+    TEST_ASSERT(cache_pool.mp_num_free == 0);
+
+    rc = os_memblock_put(&cache_pool, blocks[4]);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(cache.mpc_count == 3);
+    TEST_ASSERT(cache_pool.mp_num_free == 2);
+    TEST_ASSERT(os_mempool_is_sane(&cache_pool));
+
+    /* Cached blocks are handed out again. */
+    blocks[0] = os_memblock_get(&cache_pool);
+    TEST_ASSERT(blocks[0] == blocks[4]);
+    TEST_ASSERT(cache_pool.mp_num_free == 2);
+
+    rc = os_memblock_put(&cache_pool, blocks[0]);
+    TEST_ASSERT_FATAL(rc == 0);
+    for (i = 5; i < 10; i++) {
+        rc = os_memblock_put(&cache_pool, blocks[i]);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+    TEST_ASSERT(os_mempool_is_sane(&cache_pool));
+    TEST_ASSERT(cache_pool.mp_num_free + cache.mpc_count == 10);
+    TEST_ASSERT(cache_pool.mp_min_free == 0);
+
+    /* Removing the cache returns all blocks to the pool. */
+    rc = os_mempool_cache_remove(&cache);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(cache.mpc_count == 0);
+    TEST_ASSERT(cache_pool.mp_num_free == 10);
+    TEST_ASSERT(os_mempool_is_sane(&cache_pool));
+
+    rc = os_mempool_cache_remove(&cache);
+    TEST_ASSERT(rc == OS_INVALID_PARM);
+
+    /* Without a cache, blocks come straight from the pool. */
+    blocks[0] = os_memblock_get(&cache_pool);
+    TEST_ASSERT_FATAL(blocks[0] != NULL);
+    TEST_ASSERT(cache_pool.mp_num_free == 9);
+    rc = os_memblock_put(&cache_pool, blocks[0]);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(cache_pool.mp_num_free == 10);
+
+    os_mempool_unregister(&cache_pool);
+#endif
+}
@@ -0,0 +1,96 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "os_test_priv.h"
+#include "msys_test.h"
+
+TEST_CASE_SELF(os_msys_test_chain)
+{
+#if MYNEWT_VAL(MSYS_CHAIN_FALLBACK)
+    struct os_mbuf *m[MSYS_TEST_POOL_BIG_BUF_COUNT];
+    struct msys_context context;
+    struct os_mbuf *om;
+    struct os_mbuf *cur;
+    const int dsize = 3 * MSYS_TEST_SMALL_BUF_SIZE;
+    int num_free;
+    int blocks;
+    int rc;
+    int i;
+
+    os_msys_test_setup(2, &context);
+
+    /* With a fitting pool available there is no chain. */
+    om = os_msys_get_pkthdr(dsize, 0);
+    TEST_ASSERT_FATAL(om != NULL);
+    TEST_ASSERT(om->om_omp->omp_databuf_len == MSYS_TEST_BIG_BUF_SIZE);
+    TEST_ASSERT(SLIST_NEXT(om, om_next) == NULL);
+    os_mbuf_free_chain(om);
+
+    for (i = 0; i < MSYS_TEST_POOL_BIG_BUF_COUNT; i++) {
+        m[i] = os_msys_get(MSYS_TEST_BIG_BUF_SIZE, 0);
+        TEST_ASSERT_FATAL(m[i] != NULL);
+    }
+
+    /* The big pool ran dry; the request is served by a small chain. */
+    om = os_msys_get_pkthdr(dsize, 0);
+    TEST_ASSERT_FATAL(om != NULL);
+    TEST_ASSERT(om->om_omp->omp_databuf_len == MSYS_TEST_SMALL_BUF_SIZE);
+    blocks = 0;
+    for (cur = om; cur != NULL; cur = SLIST_NEXT(cur, om_next)) {
+        TEST_ASSERT(cur->om_len == 0);
+        blocks++;
+    }
+    TEST_ASSERT(blocks == 4, "unexpected chain length %d", blocks);
+    TEST_ASSERT(OS_MBUF_PKTLEN(om) == 0);
+
+#if MYNEWT_VAL(MSYS_STATS)
+    {
+        struct os_msys_info omsi;
+
+        rc = os_msys_info_get(0, &omsi);
+        TEST_ASSERT_FATAL(rc == 0);
+        TEST_ASSERT(omsi.omsi_stats.oms_chains == 1);
+        TEST_ASSERT(omsi.omsi_stats.oms_blocks == blocks);
+    }
+#endif
+
+    /* Appending fills the preallocated mbufs without allocating more. */
+    num_free = msys_mempool2.mp_num_free;
+    rc = os_mbuf_append(om, os_mbuf_test_data, dsize);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(msys_mempool2.mp_num_free == num_free);
+    TEST_ASSERT(OS_MBUF_PKTLEN(om) == dsize);
+    TEST_ASSERT(os_mbuf_cmpf(om, 0, os_mbuf_test_data, dsize) == 0);
+    os_mbuf_free_chain(om);
+
+    /* Not enough small blocks for a chain: a single mbuf as before. */
+    num_free = msys_mempool2.mp_num_free;
+    TEST_ASSERT_FATAL(num_free == MSYS_TEST_POOL_SMALL_BUF_COUNT);
+    om = os_msys_get(MSYS_TEST_SMALL_BUF_SIZE * (num_free + 1), 0);
+    TEST_ASSERT_FATAL(om != NULL);
+    TEST_ASSERT(SLIST_NEXT(om, om_next) == NULL);
+    TEST_ASSERT(msys_mempool2.mp_num_free == num_free - 1);
+    os_mbuf_free_chain(om);
+
+    for (i = 0; i < MSYS_TEST_POOL_BIG_BUF_COUNT; i++) {
+        os_mbuf_free(m[i]);
+    }
+
+    os_msys_test_teardown(&context);
+#endif
+}
@@ -0,0 +1,140 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "os_test_priv.h"
+#include "msys_test.h"
+
+#if MYNEWT_VAL(MSYS_STATS)
+static void
+os_msys_test_stats_get(int idx, struct os_msys_stats *stats)
+{
+    struct os_msys_info omsi;
+    int rc;
+
+    rc = os_msys_info_get(idx, &omsi);
+    TEST_ASSERT_FATAL(rc == 0, "os_msys_info_get(%d) failed; rc=%d", idx, rc);
+    *stats = omsi.omsi_stats;
+}
+#endif
+
+TEST_CASE_SELF(os_msys_test_stats)
+{
+#if MYNEWT_VAL(MSYS_STATS)
+    struct os_mbuf *m[MSYS_TEST_POOL_MED_BUF_COUNT + 1];
+    struct os_msys_stats small;
+    struct os_msys_stats med;
+    struct os_msys_stats big;
+    struct os_msys_info omsi;
+    struct msys_context context;
+    struct os_mbuf *om;
+    struct os_mbuf *om2;
+    int rc;
+    int i;
+
+    os_msys_test_setup(3, &context);
+
+    /* Pools are reported from the smallest to the biggest. */
+    rc = os_msys_info_get(0, &omsi);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(omsi.omsi_databuf_len == MSYS_TEST_SMALL_BUF_SIZE);
+    TEST_ASSERT(omsi.omsi_num_blocks == MSYS_TEST_POOL_SMALL_BUF_COUNT);
+    rc = os_msys_info_get(2, &omsi);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(omsi.omsi_databuf_len == MSYS_TEST_BIG_BUF_SIZE);
+    rc = os_msys_info_get(3, &omsi);
+    TEST_ASSERT(rc == OS_ENOENT);
+
+    /* Best fit requests land in the histogram of the serving pool. */
+    om = os_msys_get(10, 0);
+    TEST_ASSERT_FATAL(om != NULL);
+    om2 = os_msys_get_pkthdr(100, 0);
+    TEST_ASSERT_FATAL(om2 != NULL);
+    TEST_ASSERT_FATAL(om2->om_omp->omp_databuf_len == MSYS_TEST_MED_BUF_SIZE);
+
+    os_msys_test_stats_get(0, &small);
+    TEST_ASSERT(small.oms_reqs == 1);
+    TEST_ASSERT(small.oms_blocks == 1);
+    TEST_ASSERT(small.oms_req_bytes == 10);
+    TEST_ASSERT(small.oms_hist[0] == 1);
+    os_msys_test_stats_get(1, &med);
+    TEST_ASSERT(med.oms_reqs == 1);
+    TEST_ASSERT(med.oms_req_bytes == 100 + sizeof(struct os_mbuf_pkthdr));
+    TEST_ASSERT(med.oms_hist[2] == 1);
+    TEST_ASSERT(med.oms_fallbacks == 0);
+
+    os_mbuf_free(om);
+    os_mbuf_free(om2);
+
+    /* Requests served by another pool count as fallbacks of the best fit. */
+    for (i = 0; i < MSYS_TEST_POOL_MED_BUF_COUNT; i++) {
+        m[i] = os_msys_get(MSYS_TEST_MED_BUF_SIZE, 0);
+        TEST_ASSERT_FATAL(m[i] != NULL);
+    }
+    m[i] = os_msys_get(MSYS_TEST_MED_BUF_SIZE, 0);
+    TEST_ASSERT_FATAL(m[i] != NULL);
+    TEST_ASSERT(m[i]->om_omp->omp_databuf_len == MSYS_TEST_BIG_BUF_SIZE);
+
+    os_msys_test_stats_get(1, &med);
+    os_msys_test_stats_get(2, &big);
+    TEST_ASSERT(med.oms_reqs == 1 + MSYS_TEST_POOL_MED_BUF_COUNT);
+    TEST_ASSERT(med.oms_fallbacks == 1);
+    TEST_ASSERT(big.oms_reqs == 1);
+    TEST_ASSERT(big.oms_fallbacks == 0);
+
+    for (i = 0; i <= MSYS_TEST_POOL_MED_BUF_COUNT; i++) {
+        os_mbuf_free(m[i]);
+    }
+
+    /* Failed requests are charged to the best fit. */
+    for (i = 0; i < MSYS_TEST_POOL_BIG_BUF_COUNT; i++) {
+        m[i] = os_msys_get(MSYS_TEST_BIG_BUF_SIZE, 0);
+        TEST_ASSERT_FATAL(m[i] != NULL);
+    }
+    om = os_msys_get(MSYS_TEST_BIG_BUF_SIZE, 0);
+    os_msys_test_stats_get(2, &big);
+#if !MYNEWT_VAL(MSYS_CHAIN_FALLBACK)
+    TEST_ASSERT(om != NULL);
+    TEST_ASSERT(om->om_omp->omp_databuf_len == MSYS_TEST_MED_BUF_SIZE);
+    TEST_ASSERT(big.oms_fallbacks == 1);
+    os_mbuf_free(om);
+#else
+    TEST_ASSERT_FATAL(om != NULL);
+    TEST_ASSERT(big.oms_fallbacks == 1);
+    os_mbuf_free_chain(om);
+#endif
+    TEST_ASSERT(big.oms_failures == 0);
+
+    os_msys_reset();
+    os_msys_register(&msys_mbuf_pool1);
+    om = os_msys_get(MSYS_TEST_BIG_BUF_SIZE, 0);
+    TEST_ASSERT(om == NULL);
+    os_msys_test_stats_get(0, &big);
+    TEST_ASSERT(big.oms_failures == 1);
+
+    for (i = 0; i < MSYS_TEST_POOL_BIG_BUF_COUNT; i++) {
+        os_mbuf_free(m[i]);
+    }
+
+    os_msys_stats_clear();
+    os_msys_test_stats_get(0, &big);
+    TEST_ASSERT(big.oms_reqs == 0);
+    TEST_ASSERT(big.oms_failures == 0);
+
+    os_msys_test_teardown(&context);
+#endif
+}
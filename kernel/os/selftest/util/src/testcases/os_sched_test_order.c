@@ -0,0 +1,108 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#include <string.h>
+#include "os/mynewt.h"
+#include "os_test_priv.h"
+
+#define SCHED_TEST_NUM_TASKS    (8)
+
+static struct os_task sched_test_tasks[SCHED_TEST_NUM_TASKS];
+
+/* Verifies the run list is sorted by priority. */
+static void
+sched_test_verify_sorted(void)
+{
+    struct os_task *prev;
+    struct os_task *t;
+
+    prev = NULL;
+    TAILQ_FOREACH(t, &g_os_run_list, t_os_list) {
+        if (prev != NULL) {
+            TEST_ASSERT_FATAL(prev->t_prio <= t->t_prio);
+        }
+        prev = t;
+    }
+}
+
+TEST_CASE_SELF(os_sched_test_order)
+{
+    static const uint8_t prios[SCHED_TEST_NUM_TASKS] = {
+        5, 3, 7, 3, 1, 7, 5, 3
+    };
+    struct os_task *t;
+    os_sr_t sr;
+    int rc;
+    int i;
+
+    memset(sched_test_tasks, 0, sizeof(sched_test_tasks));
+    for (i = 0; i < SCHED_TEST_NUM_TASKS; i++) {
+        t = &sched_test_tasks[i];
+        t->t_name = "sched_test";
+        t->t_prio = prios[i];
+        t->t_state = OS_TASK_READY;
+        rc = os_sched_insert(t);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+    sched_test_verify_sorted();
+    TEST_ASSERT(os_sched_next_task() == &sched_test_tasks[4]);
+
+    /* Tasks with equal priority are queued in FIFO order. */
+    t = TAILQ_NEXT(&sched_test_tasks[4], t_os_list);
+    TEST_ASSERT(t == &sched_test_tasks[1]);
+    t = TAILQ_NEXT(t, t_os_list);
+    TEST_ASSERT(t == &sched_test_tasks[3]);
+    t = TAILQ_NEXT(t, t_os_list);
+    TEST_ASSERT(t == &sched_test_tasks[7]);
+
+    OS_ENTER_CRITICAL(sr);
+
+    /* Raise the priority of a task in the middle of the list. */
+    sched_test_tasks[6].t_prio = 2;
+    os_sched_resort(&sched_test_tasks[6]);
+    sched_test_verify_sorted();
+    TEST_ASSERT(TAILQ_NEXT(&sched_test_tasks[4], t_os_list) ==
+                &sched_test_tasks[6]);
+
+    /* Put the head of the list to sleep and wake it up again. */
+    os_sched_sleep(&sched_test_tasks[4], OS_TIMEOUT_NEVER);
+    TEST_ASSERT(os_sched_next_task() == &sched_test_tasks[6]);
+    sched_test_verify_sorted();
+
+    os_sched_wakeup(&sched_test_tasks[4]);
+    TEST_ASSERT(os_sched_next_task() == &sched_test_tasks[4]);
+    sched_test_verify_sorted();
+
+    /* Remove the last task of a priority group. */
+    os_sched_sleep(&sched_test_tasks[7], OS_TIMEOUT_NEVER);
+    sched_test_verify_sorted();
+    sched_test_tasks[7].t_prio = 4;
+    os_sched_wakeup(&sched_test_tasks[7]);
+    sched_test_verify_sorted();
+    TEST_ASSERT(TAILQ_NEXT(&sched_test_tasks[3], t_os_list) ==
+                &sched_test_tasks[7]);
+
+    /* Don't leave tasks that can never run on the run list. */
+    for (i = 0; i < SCHED_TEST_NUM_TASKS; i++) {
+        os_sched_sleep(&sched_test_tasks[i], OS_TIMEOUT_NEVER);
+    }
+
+    OS_EXIT_CRITICAL(sr);
+}
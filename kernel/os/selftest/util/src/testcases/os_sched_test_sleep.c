@@ -0,0 +1,86 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os/mynewt.h"
+#include "os_test_priv.h"
+
+#define SCHED_SLEEP_TEST_NUM_TASKS  (8)
+
+static struct os_task sched_sleep_test_tasks[SCHED_SLEEP_TEST_NUM_TASKS];
+
+TEST_CASE_SELF(os_sched_test_sleep)
+{
+    static const os_time_t ticks[SCHED_SLEEP_TEST_NUM_TASKS] = {
+        50, 10, 30, 80, 70, 20, 60, 40
+    };
+    /* Order in which the tasks are expected to time out. */
+    static const int order[SCHED_SLEEP_TEST_NUM_TASKS] = {
+        1, 5, 2, 7, 0, 6, 4, 3
+    };
+    struct os_task *t;
+    os_time_t now;
+    os_sr_t sr;
+    int rc;
+    int i;
+
+    memset(sched_sleep_test_tasks, 0, sizeof(sched_sleep_test_tasks));
+
+    OS_ENTER_CRITICAL(sr);
+
+    now = os_time_get();
+    for (i = 0; i < SCHED_SLEEP_TEST_NUM_TASKS; i++) {
+        t = &sched_sleep_test_tasks[i];
+        t->t_name = "sched_sleep_test";
+        t->t_prio = OS_TASK_PRI_LOWEST - 1;
+        t->t_state = OS_TASK_READY;
+        rc = os_sched_insert(t);
+        TEST_ASSERT_FATAL(rc == 0);
+        os_sched_sleep(t, ticks[i]);
+    }
+    TEST_ASSERT(os_sched_wakeup_ticks(now) == 10);
+
+    /* Waking up a task before its timeout leaves the others in order. */
+    os_sched_wakeup(&sched_sleep_test_tasks[5]);
+    os_sched_wakeup(&sched_sleep_test_tasks[3]);
+    TEST_ASSERT(os_sched_wakeup_ticks(now) == 10);
+
+    /* Tasks which sleep forever never determine the next wakeup. */
+    os_sched_sleep(&sched_sleep_test_tasks[3], OS_TIMEOUT_NEVER);
+    os_sched_sleep(&sched_sleep_test_tasks[5], ticks[5]);
+
+    /* Wake the tasks in the order their timeouts expire. */
+    for (i = 0; i < SCHED_SLEEP_TEST_NUM_TASKS - 1; i++) {
+        t = &sched_sleep_test_tasks[order[i]];
+        TEST_ASSERT(os_sched_wakeup_ticks(now) == ticks[order[i]]);
+        TEST_ASSERT(t->t_state == OS_TASK_SLEEP);
+        os_sched_wakeup(t);
+    }
+    TEST_ASSERT(os_sched_wakeup_ticks(now) == OS_TIMEOUT_NEVER);
+
+    /* Don't leave tasks that can never run on the run list. */
+    for (i = 0; i < SCHED_SLEEP_TEST_NUM_TASKS; i++) {
+        t = &sched_sleep_test_tasks[i];
+        if (t->t_state == OS_TASK_READY) {
+            os_sched_sleep(t, OS_TIMEOUT_NEVER);
+        }
+    }
+
+    OS_EXIT_CRITICAL(sr);
+}
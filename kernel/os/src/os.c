@@ -237,7 +237,7 @@ os_init(int (*main_fn)(int argc, char **arg))
     SEGGER_RTT_Init();
 #endif
 
-    TAILQ_INIT(&g_callout_list);
+    os_callout_module_init();
     STAILQ_INIT(&g_os_task_list);
     os_eventq_init(os_eventq_dflt_get());
 
@@ -315,6 +315,9 @@ os_pkg_init(void)
 
     os_mempool_module_init();
     os_msys_init();
+#if MYNEWT_VAL(OS_MALLOC_SLAB)
+    os_malloc_slab_init();
+#endif
 }
 
 /**
@@ -26,8 +26,218 @@
 #include "os/mynewt.h"
 #include "os_priv.h"
 
+#if MYNEWT_VAL(OS_CALLOUT_WHEEL)
+
+#define OS_CALLOUT_WHEEL_SLOT_BITS  (5)
+#define OS_CALLOUT_WHEEL_SLOTS      (1 << OS_CALLOUT_WHEEL_SLOT_BITS)
+#define OS_CALLOUT_WHEEL_SLOT_MASK  (OS_CALLOUT_WHEEL_SLOTS - 1)
+#define OS_CALLOUT_WHEEL_LEVELS     MYNEWT_VAL(OS_CALLOUT_WHEEL_LEVELS)
+#define OS_CALLOUT_WHEEL_RANGE      \
+    ((os_time_t)1 << (OS_CALLOUT_WHEEL_SLOT_BITS * OS_CALLOUT_WHEEL_LEVELS))
+
+/*
+ * Hierarchical timing wheel.  Level 0 has one slot per tick, every slot of
+ * level N spans one full rotation of level N - 1.  An armed callout sits in
+ * the slot its expiry time falls into and is moved down ("cascaded") to a
+ * lower level when that level wraps around.  A bitmap per level tracks the
+ * non-empty slots, so that the next expiry can be found without looking at
+ * the slots themselves.
+ */
+static struct os_callout_list
+    os_callout_wheel[OS_CALLOUT_WHEEL_LEVELS * OS_CALLOUT_WHEEL_SLOTS];
+static uint32_t os_callout_wheel_map[OS_CALLOUT_WHEEL_LEVELS];
+
+/* Next tick to be processed by os_callout_tick(). */
+static os_time_t os_callout_wheel_time;
+
+static void
+os_callout_wheel_insert(struct os_callout *c)
+{
+    os_time_t expiry;
+    os_time_t delta;
+    int level;
+    int slot;
+
+    expiry = c->c_ticks;
+    delta = expiry - os_callout_wheel_time;
+    if ((os_stime_t)delta < 0) {
+        /* Already expired; fire on the next processed tick. */
+        expiry = os_callout_wheel_time;
+        delta = 0;
+    } else if (delta >= OS_CALLOUT_WHEEL_RANGE) {
+        /*
+         * Out of reach of the wheel.  Park the callout in the farthest slot;
+         * it is filed again when that slot is cascaded.
+         */
+        delta = OS_CALLOUT_WHEEL_RANGE - 1;
+        expiry = os_callout_wheel_time + delta;
+    }
+
+    level = 0;
+    while (delta >> (OS_CALLOUT_WHEEL_SLOT_BITS * (level + 1))) {
+        level++;
+    }
+    slot = (expiry >> (OS_CALLOUT_WHEEL_SLOT_BITS * level)) &
+           OS_CALLOUT_WHEEL_SLOT_MASK;
+
+    c->c_slot = level * OS_CALLOUT_WHEEL_SLOTS + slot;
+    TAILQ_INSERT_TAIL(&os_callout_wheel[c->c_slot], c, c_next);
+    os_callout_wheel_map[level] |= 1UL << slot;
+}
+
+static void
+os_callout_wheel_remove(struct os_callout *c)
+{
+    struct os_callout_list *list;
+
+    list = &os_callout_wheel[c->c_slot];
+    TAILQ_REMOVE(list, c, c_next);
+    c->c_next.tqe_prev = NULL;
+    if (TAILQ_EMPTY(list)) {
+        os_callout_wheel_map[c->c_slot / OS_CALLOUT_WHEEL_SLOTS] &=
+            ~(1UL << (c->c_slot & OS_CALLOUT_WHEEL_SLOT_MASK));
+    }
+}
+
+/**
+ * Refiles all callouts in the current slot of 'level' into the lower levels.
+ *
+ * @return                      The index of the cascaded slot.
+ */
+static int
+os_callout_wheel_cascade(int level)
+{
+    struct os_callout_list *list;
+    struct os_callout *c;
+    int slot;
+
+    slot = (os_callout_wheel_time >> (OS_CALLOUT_WHEEL_SLOT_BITS * level)) &
+           OS_CALLOUT_WHEEL_SLOT_MASK;
+    list = &os_callout_wheel[level * OS_CALLOUT_WHEEL_SLOTS + slot];
+
+    while ((c = TAILQ_FIRST(list)) != NULL) {
+        TAILQ_REMOVE(list, c, c_next);
+        os_callout_wheel_insert(c);
+    }
+    os_callout_wheel_map[level] &= ~(1UL << slot);
+
+    return slot;
+}
+
+/**
+ * Finds the earliest tick at which the wheel needs servicing, i.e. either a
+ * callout expires or a slot has to be cascaded.
+ *
+ * @return                      0 if the wheel is empty, 1 otherwise.
+ */
+static int
+os_callout_wheel_next(os_time_t *next)
+{
+    uint32_t map;
+    os_time_t pos;
+    os_time_t t;
+    int found;
+    int shift;
+    int level;
+    int idx;
+
+    found = 0;
+    for (level = 0; level < OS_CALLOUT_WHEEL_LEVELS; level++) {
+        map = os_callout_wheel_map[level];
+        if (map == 0) {
+            continue;
+        }
+
+        /*
+         * A slot of this level is serviced when all lower levels are at
+         * slot 0; find the first such position at or after the current time.
+         */
+        shift = OS_CALLOUT_WHEEL_SLOT_BITS * level;
+        pos = os_callout_wheel_time >> shift;
+        if (os_callout_wheel_time & (((os_time_t)1 << shift) - 1)) {
+            pos++;
+        }
+        idx = pos & OS_CALLOUT_WHEEL_SLOT_MASK;
+        if (idx != 0) {
+            map = (map >> idx) | (map << (OS_CALLOUT_WHEEL_SLOTS - idx));
+        }
+        t = (pos + __builtin_ctz(map)) << shift;
+
+        if (!found || OS_TIME_TICK_LT(t, *next)) {
+            *next = t;
+            found = 1;
+        }
+    }
+
+    return found;
+}
+
+/**
+ * Advances the wheel up to 'now' and removes the first expired callout.
+ * Must be called with interrupts disabled.
+ *
+ * @return                      The expired callout, NULL if there is none.
+ */
+static struct os_callout *
+os_callout_wheel_expire(os_time_t now)
+{
+    struct os_callout *c;
+    os_time_t next;
+    int level;
+
+    while (OS_TIME_TICK_GEQ(now, os_callout_wheel_time)) {
+        if (!os_callout_wheel_next(&next) || OS_TIME_TICK_GT(next, now)) {
+            os_callout_wheel_time = now + 1;
+            break;
+        }
+
+        /* Skip over ticks with nothing to do. */
+        os_callout_wheel_time = next;
+
+        if ((os_callout_wheel_time & OS_CALLOUT_WHEEL_SLOT_MASK) == 0) {
+            for (level = 1; level < OS_CALLOUT_WHEEL_LEVELS; level++) {
+                if (os_callout_wheel_cascade(level) != 0) {
+                    break;
+                }
+            }
+        }
+
+        c = TAILQ_FIRST(&os_callout_wheel[os_callout_wheel_time &
+                                          OS_CALLOUT_WHEEL_SLOT_MASK]);
+        if (c != NULL) {
+            os_callout_wheel_remove(c);
+            return c;
+        }
+        os_callout_wheel_time++;
+    }
+
+    return NULL;
+}
+
+void
+os_callout_module_init(void)
+{
+    int i;
+
+    for (i = 0; i < OS_CALLOUT_WHEEL_LEVELS * OS_CALLOUT_WHEEL_SLOTS; i++) {
+        TAILQ_INIT(&os_callout_wheel[i]);
+    }
+    memset(os_callout_wheel_map, 0, sizeof(os_callout_wheel_map));
+    os_callout_wheel_time = os_time_get() + 1;
+}
+
+#else
+
 struct os_callout_list g_callout_list;
 
+void
+os_callout_module_init(void)
+{
+    TAILQ_INIT(&g_callout_list);
+}
+
+#endif
+
 void os_callout_init(struct os_callout *c, struct os_eventq *evq,
                      os_event_fn *ev_cb, void *ev_arg)
 {
@@ -51,8 +261,12 @@ os_callout_stop(struct os_callout *c)
     OS_ENTER_CRITICAL(sr);
 
     if (os_callout_queued(c)) {
+#if MYNEWT_VAL(OS_CALLOUT_WHEEL)
+        os_callout_wheel_remove(c);
+#else
         TAILQ_REMOVE(&g_callout_list, c, c_next);
         c->c_next.tqe_prev = NULL;
+#endif
     }
 
     if (c->c_evq) {
@@ -67,7 +281,9 @@ os_callout_stop(struct os_callout *c)
 int
 os_callout_reset(struct os_callout *c, os_time_t ticks)
 {
+#if !MYNEWT_VAL(OS_CALLOUT_WHEEL)
     struct os_callout *entry;
+#endif
     os_sr_t sr;
     int ret;
 
@@ -91,6 +307,9 @@ os_callout_reset(struct os_callout *c, os_time_t ticks)
 
     c->c_ticks = os_time_get() + ticks;
 
+#if MYNEWT_VAL(OS_CALLOUT_WHEEL)
+    os_callout_wheel_insert(c);
+#else
     entry = NULL;
     TAILQ_FOREACH(entry, &g_callout_list, c_next) {
         if (OS_TIME_TICK_LT(c->c_ticks, entry->c_ticks)) {
@@ -103,6 +322,7 @@ os_callout_reset(struct os_callout *c, os_time_t ticks)
     } else {
         TAILQ_INSERT_TAIL(&g_callout_list, c, c_next);
     }
+#endif
 
     OS_EXIT_CRITICAL(sr);
 
@@ -127,6 +347,9 @@ os_callout_tick(void)
 
     while (1) {
         OS_ENTER_CRITICAL(sr);
+#if MYNEWT_VAL(OS_CALLOUT_WHEEL)
+        c = os_callout_wheel_expire(now);
+#else
         c = TAILQ_FIRST(&g_callout_list);
         if (c) {
             if (OS_TIME_TICK_GEQ(now, c->c_ticks)) {
@@ -136,6 +359,7 @@ os_callout_tick(void)
                 c = NULL;
             }
         }
+#endif
         OS_EXIT_CRITICAL(sr);
 
         if (c) {
@@ -156,6 +380,25 @@ os_time_t
 os_callout_wakeup_ticks(os_time_t now)
 {
     os_time_t rt;
+#if MYNEWT_VAL(OS_CALLOUT_WHEEL)
+    os_time_t next;
+
+    OS_ASSERT_CRITICAL();
+
+    /*
+     * This may return the time of a cascade rather than of an actual expiry;
+     * waking up early for it is harmless.
+     */
+    if (os_callout_wheel_next(&next)) {
+        if (OS_TIME_TICK_GEQ(next, now)) {
+            rt = next - now;
+        } else {
+            rt = 0;
+        }
+    } else {
+        rt = OS_TIMEOUT_NEVER;
+    }
+#else
     struct os_callout *c;
 
     OS_ASSERT_CRITICAL();
@@ -170,6 +413,7 @@ os_callout_wakeup_ticks(os_time_t now)
     } else {
         rt = OS_TIMEOUT_NEVER;
     }
+#endif
 
     return (rt);
 }
@@ -18,7 +18,13 @@
  */
 
 #include <assert.h>
+#include <stdio.h>
+#include <string.h>
 #include "os/mynewt.h"
+#include "os_priv.h"
+#if MYNEWT_VAL(OS_MALLOC_SLAB_STATS)
+#include "stats/stats.h"
+#endif
 
 #if MYNEWT_VAL(OS_SCHEDULING)
 static struct os_mutex os_malloc_mutex;
@@ -50,11 +56,258 @@ os_malloc_unlock(void)
 #endif
 }
 
+#if MYNEWT_VAL(OS_MALLOC_SLAB)
+
+#if MYNEWT_VAL(OS_MALLOC_SLAB_STATS)
+STATS_SECT_START(os_malloc_slab_stats)
+    STATS_SECT_ENTRY(allocs)
+    STATS_SECT_ENTRY(frees)
+    STATS_SECT_ENTRY(fallbacks)
+    STATS_SECT_ENTRY(high_water)
+    STATS_SECT_ENTRY(slack_bytes)
+STATS_SECT_END
+
+STATS_NAME_START(os_malloc_slab_stats)
+    STATS_NAME(os_malloc_slab_stats, allocs)
+    STATS_NAME(os_malloc_slab_stats, frees)
+    STATS_NAME(os_malloc_slab_stats, fallbacks)
+    STATS_NAME(os_malloc_slab_stats, high_water)
+    STATS_NAME(os_malloc_slab_stats, slack_bytes)
+STATS_NAME_END(os_malloc_slab_stats)
+#endif
+
+/** An os_malloc() size class. */
+struct os_malloc_slab {
+    struct os_mempool oms_pool;
+    uint32_t oms_allocs;
+    uint32_t oms_frees;
+    uint32_t oms_fallbacks;
+    uint64_t oms_req_bytes;
+#if MYNEWT_VAL(OS_MALLOC_SLAB_STATS)
+    char oms_stats_name[sizeof("os_malloc_slab_4294967295")];
+    STATS_SECT_DECL(os_malloc_slab_stats) oms_stats;
+#endif
+};
+
+#define OS_MALLOC_SLAB_DATA(n)                                          \
+    static os_membuf_t os_malloc_slab_##n##_data[                       \
+        OS_MEMPOOL_SIZE(MYNEWT_VAL(OS_MALLOC_SLAB_##n##_BLOCK_COUNT),   \
+                        MYNEWT_VAL(OS_MALLOC_SLAB_##n##_BLOCK_SIZE))]
+
+#if MYNEWT_VAL(OS_MALLOC_SLAB_1_BLOCK_COUNT) > 0
+OS_MALLOC_SLAB_DATA(1);
+#endif
+#if MYNEWT_VAL(OS_MALLOC_SLAB_2_BLOCK_COUNT) > 0
+OS_MALLOC_SLAB_DATA(2);
+#endif
+#if MYNEWT_VAL(OS_MALLOC_SLAB_3_BLOCK_COUNT) > 0
+OS_MALLOC_SLAB_DATA(3);
+#endif
+#if MYNEWT_VAL(OS_MALLOC_SLAB_4_BLOCK_COUNT) > 0
+OS_MALLOC_SLAB_DATA(4);
+#endif
+
+#define OS_MALLOC_SLAB_MAX_CLASSES  (4)
+
+/* Size classes in increasing block size order. */
+static struct os_malloc_slab os_malloc_slabs[OS_MALLOC_SLAB_MAX_CLASSES];
+static int os_malloc_slab_cnt;
+
+static void
+os_malloc_slab_add(os_membuf_t *data, uint16_t count, uint32_t size,
+                   char *name)
+{
+    struct os_malloc_slab *oms;
+    int rc;
+
+    assert(os_malloc_slab_cnt == 0 ||
+           os_malloc_slabs[os_malloc_slab_cnt - 1].oms_pool.mp_block_size <
+           size);
+
+    oms = &os_malloc_slabs[os_malloc_slab_cnt];
+    memset(oms, 0, sizeof(*oms));
+    rc = os_mempool_init(&oms->oms_pool, count, size, data, name);
+    assert(rc == 0);
+
+#if MYNEWT_VAL(OS_MALLOC_SLAB_STATS)
+    rc = stats_init(STATS_HDR(oms->oms_stats),
+                    STATS_SIZE_INIT_PARMS(oms->oms_stats, STATS_SIZE_32),
+                    STATS_NAME_INIT_PARMS(os_malloc_slab_stats));
+    assert(rc == 0);
+#endif
+
+    os_malloc_slab_cnt++;
+}
+
+void
+os_malloc_slab_init(void)
+{
+    os_malloc_slab_cnt = 0;
+
+#if MYNEWT_VAL(OS_MALLOC_SLAB_1_BLOCK_COUNT) > 0
+    os_malloc_slab_add(os_malloc_slab_1_data,
+                       MYNEWT_VAL(OS_MALLOC_SLAB_1_BLOCK_COUNT),
+                       MYNEWT_VAL(OS_MALLOC_SLAB_1_BLOCK_SIZE),
+                       "os_malloc_slab_1");
+#endif
+#if MYNEWT_VAL(OS_MALLOC_SLAB_2_BLOCK_COUNT) > 0
+    os_malloc_slab_add(os_malloc_slab_2_data,
+                       MYNEWT_VAL(OS_MALLOC_SLAB_2_BLOCK_COUNT),
+                       MYNEWT_VAL(OS_MALLOC_SLAB_2_BLOCK_SIZE),
+                       "os_malloc_slab_2");
+#endif
+#if MYNEWT_VAL(OS_MALLOC_SLAB_3_BLOCK_COUNT) > 0
+    os_malloc_slab_add(os_malloc_slab_3_data,
+                       MYNEWT_VAL(OS_MALLOC_SLAB_3_BLOCK_COUNT),
+                       MYNEWT_VAL(OS_MALLOC_SLAB_3_BLOCK_SIZE),
+                       "os_malloc_slab_3");
+#endif
+#if MYNEWT_VAL(OS_MALLOC_SLAB_4_BLOCK_COUNT) > 0
+    os_malloc_slab_add(os_malloc_slab_4_data,
+                       MYNEWT_VAL(OS_MALLOC_SLAB_4_BLOCK_COUNT),
+                       MYNEWT_VAL(OS_MALLOC_SLAB_4_BLOCK_SIZE),
+                       "os_malloc_slab_4");
+#endif
+}
+
+#if MYNEWT_VAL(OS_MALLOC_SLAB_STATS)
+void
+os_malloc_slab_stats_init(void)
+{
+    struct os_malloc_slab *oms;
+    int rc;
+    int i;
+
+    /* Ensure this function only gets called by sysinit. */
+    SYSINIT_ASSERT_ACTIVE();
+
+    for (i = 0; i < os_malloc_slab_cnt; i++) {
+        oms = &os_malloc_slabs[i];
+        snprintf(oms->oms_stats_name, sizeof(oms->oms_stats_name),
+                 "os_malloc_slab_%lu",
+                 (unsigned long)oms->oms_pool.mp_block_size);
+        rc = stats_register(oms->oms_stats_name, STATS_HDR(oms->oms_stats));
+        SYSINIT_PANIC_ASSERT(rc == 0);
+    }
+}
+#endif
+
+/**
+ * Returns the size class a block was allocated from, or NULL if it comes from
+ * the heap.
+ */
+static struct os_malloc_slab *
+os_malloc_slab_find(const void *ptr)
+{
+    int i;
+
+    for (i = 0; i < os_malloc_slab_cnt; i++) {
+        if (os_memblock_from(&os_malloc_slabs[i].oms_pool, ptr)) {
+            return &os_malloc_slabs[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Allocates a block from the smallest size class that fits the request and
+ * has free blocks.  Returns NULL if the request needs to go to the heap.
+ */
+static void *
+os_malloc_slab_get(size_t size)
+{
+    struct os_malloc_slab *oms;
+    void *ptr;
+    int i;
+
+    ptr = NULL;
+    for (i = 0; i < os_malloc_slab_cnt; i++) {
+        oms = &os_malloc_slabs[i];
+        if (size > oms->oms_pool.mp_block_size) {
+            continue;
+        }
+
+        ptr = os_memblock_get(&oms->oms_pool);
+        if (ptr != NULL) {
+            break;
+        }
+
+        oms->oms_fallbacks++;
+#if MYNEWT_VAL(OS_MALLOC_SLAB_STATS)
+        STATS_INC(oms->oms_stats, fallbacks);
+#endif
+    }
+
+    if (ptr != NULL) {
+        /* Statistics are not protected; an occasional lost update is fine. */
+        oms->oms_allocs++;
+        oms->oms_req_bytes += size;
+#if MYNEWT_VAL(OS_MALLOC_SLAB_STATS)
+        STATS_INC(oms->oms_stats, allocs);
+        STATS_INCN(oms->oms_stats, slack_bytes,
+                   oms->oms_pool.mp_block_size - size);
+        STATS_SET(oms->oms_stats, high_water,
+                  oms->oms_pool.mp_num_blocks - oms->oms_pool.mp_min_free);
+#endif
+    }
+
+    return ptr;
+}
+
+static void
+os_malloc_slab_put(struct os_malloc_slab *oms, void *ptr)
+{
+    int rc;
+
+    rc = os_memblock_put(&oms->oms_pool, ptr);
+    assert(rc == 0);
+
+    oms->oms_frees++;
+#if MYNEWT_VAL(OS_MALLOC_SLAB_STATS)
+    STATS_INC(oms->oms_stats, frees);
+#endif
+}
+
+int
+os_malloc_slab_info_get(int idx, struct os_malloc_slab_info *omsi)
+{
+    struct os_malloc_slab *oms;
+
+    if (idx < 0 || idx >= os_malloc_slab_cnt) {
+        return OS_ENOENT;
+    }
+
+    oms = &os_malloc_slabs[idx];
+    omsi->omsi_block_size = oms->oms_pool.mp_block_size;
+    omsi->omsi_num_blocks = oms->oms_pool.mp_num_blocks;
+    omsi->omsi_num_free = oms->oms_pool.mp_num_free;
+    omsi->omsi_min_free = oms->oms_pool.mp_min_free;
+    omsi->omsi_allocs = oms->oms_allocs;
+    omsi->omsi_frees = oms->oms_frees;
+    omsi->omsi_fallbacks = oms->oms_fallbacks;
+    omsi->omsi_req_bytes = oms->oms_req_bytes;
+
+    return 0;
+}
+
+#endif
+
 void *
 os_malloc(size_t size)
 {
     void *ptr;
 
+#if MYNEWT_VAL(OS_MALLOC_SLAB)
+    /* Size classes are memory pools; they don't need the heap lock. */
+    if (size != 0) {
+        ptr = os_malloc_slab_get(size);
+        if (ptr != NULL) {
+            return ptr;
+        }
+    }
+#endif
+
     os_malloc_lock();
     ptr = malloc(size);
     os_malloc_unlock();
@@ -65,6 +318,16 @@ os_malloc(size_t size)
 void
 os_free(void *mem)
 {
+#if MYNEWT_VAL(OS_MALLOC_SLAB)
+    struct os_malloc_slab *oms;
+
+    oms = os_malloc_slab_find(mem);
+    if (oms != NULL) {
+        os_malloc_slab_put(oms, mem);
+        return;
+    }
+#endif
+
     os_malloc_lock();
     free(mem);
     os_malloc_unlock();
@@ -74,6 +337,31 @@ void *
 os_realloc(void *ptr, size_t size)
 {
     void *new_ptr;
+#if MYNEWT_VAL(OS_MALLOC_SLAB)
+    struct os_malloc_slab *oms;
+
+    if (ptr == NULL) {
+        return os_malloc(size);
+    }
+
+    oms = os_malloc_slab_find(ptr);
+    if (oms != NULL) {
+        if (size == 0) {
+            os_malloc_slab_put(oms, ptr);
+            return NULL;
+        }
+        if (size <= oms->oms_pool.mp_block_size) {
+            return ptr;
+        }
+
+        new_ptr = os_malloc(size);
+        if (new_ptr != NULL) {
+            memcpy(new_ptr, ptr, oms->oms_pool.mp_block_size);
+            os_malloc_slab_put(oms, ptr);
+        }
+        return new_ptr;
+    }
+#endif
 
     os_malloc_lock();
     new_ptr = realloc(ptr, size);
@@ -81,4 +369,3 @@ os_realloc(void *ptr, size_t size)
 
     return new_ptr;
 }
-
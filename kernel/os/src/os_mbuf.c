@@ -42,6 +42,11 @@
 #endif
 #include "os/mynewt.h"
 
+/* Maximum number of mbufs returned to their pool with one call (and one
+ * critical section) by os_mbuf_free_chain().
+ */
+#define OS_MBUF_FREE_BATCH  16
+
 int
 os_mqueue_init(struct os_mqueue *mq, os_event_fn *ev_cb, void *arg)
 {
@@ -206,22 +211,47 @@ done:
 int
 os_mbuf_free_chain(struct os_mbuf *om)
 {
+    void *blocks[OS_MBUF_FREE_BATCH];
+    struct os_mempool *pool;
     struct os_mbuf *next;
+    int num_blocks;
     int rc;
 
     os_trace_api_u32(OS_TRACE_ID_MBUF_FREE_CHAIN, (uintptr_t)om);
 
+    /* Runs of mbufs from the same pool are returned with a single call, so
+     * the pool's free list is only locked once per run.
+     */
+    pool = NULL;
+    num_blocks = 0;
     while (om != NULL) {
         next = SLIST_NEXT(om, om_next);
 
-        rc = os_mbuf_free(om);
-        if (rc != 0) {
-            goto done;
+        if (om->om_omp != NULL) {
+            if (num_blocks == OS_MBUF_FREE_BATCH ||
+                (num_blocks > 0 && om->om_omp->omp_pool != pool)) {
+
+                rc = os_memblock_put_batch(pool, blocks, num_blocks);
+                if (rc != 0) {
+                    goto done;
+                }
+                num_blocks = 0;
+            }
+
+            pool = om->om_omp->omp_pool;
+            blocks[num_blocks++] = om;
         }
 
         om = next;
     }
 
+    if (num_blocks > 0) {
+        rc = os_memblock_put_batch(pool, blocks, num_blocks);
+        if (rc != 0) {
+            goto done;
+        }
+    }
+
     rc = 0;
 
 done:
@@ -278,28 +308,40 @@ os_mbuf_append(struct os_mbuf *om, const void *data,  uint16_t len)
 
     omp = om->om_omp;
 
-    /* Scroll to last mbuf in the chain */
+    /* Scroll to the last mbuf holding data.  Empty mbufs after it were
+     * preallocated (e.g., by os_msys_get()) and get filled first.
+     */
     last = om;
-    while (SLIST_NEXT(last, om_next) != NULL) {
-        last = SLIST_NEXT(last, om_next);
+    for (new = SLIST_NEXT(om, om_next); new != NULL;
+         new = SLIST_NEXT(new, om_next)) {
+        if (new->om_len != 0) {
+            last = new;
+        }
     }
 
     remainder = len;
-    space = OS_MBUF_TRAILINGSPACE(last);
+    while (1) {
+        space = OS_MBUF_TRAILINGSPACE(last);
 
-    /* If room in current mbuf, copy the first part of the data into the
-     * remaining space in that mbuf.
-     */
-    if (space > 0) {
-        if (space > remainder) {
-            space = remainder;
-        }
+        /* If room in current mbuf, copy the first part of the data into the
+         * remaining space in that mbuf.
+         */
+        if (space > 0) {
+            if (space > remainder) {
+                space = remainder;
+            }
 
-        memcpy(OS_MBUF_DATA(last, uint8_t *) + last->om_len , data, space);
+            memcpy(OS_MBUF_DATA(last, uint8_t *) + last->om_len , data, space);
 
-        last->om_len += space;
-        data += space;
-        remainder -= space;
+            last->om_len += space;
+            data += space;
+            remainder -= space;
+        }
+
+        if (remainder == 0 || SLIST_NEXT(last, om_next) == NULL) {
+            break;
+        }
+        last = SLIST_NEXT(last, om_next);
     }
 
     /* Take the remaining data, and keep allocating new mbufs and copying
@@ -472,6 +514,86 @@ os_mbuf_copydata(const struct os_mbuf *om, int off, int len, void *dst)
     return (len > 0 ? -1 : 0);
 }
 
+/* Skips over any empty mbufs and stops the iterator at the end of the
+ * requested range.
+ */
+static void
+os_mbuf_iov_settle(struct os_mbuf_iov_iter *it)
+{
+    while (it->omi_om != NULL && it->omi_off >= it->omi_om->om_len) {
+        it->omi_om = SLIST_NEXT(it->omi_om, om_next);
+        it->omi_off = 0;
+    }
+
+    if (it->omi_rem == 0) {
+        it->omi_om = NULL;
+    }
+}
+
+int
+os_mbuf_iov_init(struct os_mbuf_iov_iter *it, const struct os_mbuf *om,
+                 int off, int len)
+{
+    uint16_t om_off;
+
+    it->omi_om = NULL;
+    it->omi_off = 0;
+    it->omi_rem = 0;
+
+    if (off < 0 || len < 0) {
+        return SYS_EINVAL;
+    }
+
+    om = os_mbuf_off(om, off, &om_off);
+    if (om == NULL) {
+        return SYS_EINVAL;
+    }
+
+    it->omi_om = om;
+    it->omi_off = om_off;
+    it->omi_rem = len;
+    os_mbuf_iov_settle(it);
+
+    return 0;
+}
+
+int
+os_mbuf_iov_next(struct os_mbuf_iov_iter *it, struct os_iovec *iov)
+{
+    const struct os_mbuf *om;
+    uint32_t count;
+
+    om = it->omi_om;
+    if (om == NULL) {
+        return 0;
+    }
+
+    count = min(om->om_len - it->omi_off, it->omi_rem);
+    iov->iov_base = om->om_data + it->omi_off;
+    iov->iov_len = count;
+
+    it->omi_off += count;
+    it->omi_rem -= count;
+    os_mbuf_iov_settle(it);
+
+    return 1;
+}
+
+int
+os_mbuf_iov_fill(struct os_mbuf_iov_iter *it, struct os_iovec *iov,
+                 int iov_cnt)
+{
+    int i;
+
+    for (i = 0; i < iov_cnt; i++) {
+        if (!os_mbuf_iov_next(it, &iov[i])) {
+            break;
+        }
+    }
+
+    return i;
+}
+
 void
 os_mbuf_adj(struct os_mbuf *om, int req_len)
 {
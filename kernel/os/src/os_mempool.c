@@ -151,6 +151,9 @@ os_mempool_init_internal(struct os_mempool *mp, uint16_t blocks,
     mp->mp_membuf_addr = (uintptr_t)membuf;
     mp->name = name;
     SLIST_FIRST(mp) = membuf;
+#if MYNEWT_VAL(OS_MEMPOOL_CACHE)
+    SLIST_INIT(&mp->mp_caches);
+#endif
 
     if (blocks > 0) {
         os_mempool_poison(mp, membuf);
@@ -243,6 +246,9 @@ os_mempool_unregister(struct os_mempool *mp)
 os_error_t
 os_mempool_clear(struct os_mempool *mp)
 {
+#if MYNEWT_VAL(OS_MEMPOOL_CACHE)
+    struct os_mempool_cache *mpc;
+#endif
     struct os_memblock *block_ptr;
     int true_block_size;
     uint8_t *block_addr;
@@ -254,6 +260,14 @@ os_mempool_clear(struct os_mempool *mp)
 
     true_block_size = OS_MEMPOOL_TRUE_BLOCK_SIZE(mp);
 
+#if MYNEWT_VAL(OS_MEMPOOL_CACHE)
+    /* All blocks go back to the pool; empty the caches. */
+    SLIST_FOREACH(mpc, &mp->mp_caches, mpc_next) {
+        SLIST_INIT(&mpc->mpc_blocks);
+        mpc->mpc_count = 0;
+    }
+#endif
+
     /* cleanup the memory pool structure */
     mp->mp_num_free = mp->mp_num_blocks;
     mp->mp_min_free = mp->mp_num_blocks;
@@ -284,6 +298,9 @@ os_mempool_clear(struct os_mempool *mp)
 bool
 os_mempool_is_sane(const struct os_mempool *mp)
 {
+#if MYNEWT_VAL(OS_MEMPOOL_CACHE)
+    const struct os_mempool_cache *mpc;
+#endif
     struct os_memblock *block;
 
     /* Verify that each block in the free list belongs to the mempool. */
@@ -295,6 +312,19 @@ os_mempool_is_sane(const struct os_mempool *mp)
         os_mempool_guard_check(mp, block);
     }
 
+#if MYNEWT_VAL(OS_MEMPOOL_CACHE)
+    /* Same for blocks held by the caches. */
+    SLIST_FOREACH(mpc, &mp->mp_caches, mpc_next) {
+        SLIST_FOREACH(block, &mpc->mpc_blocks, mb_next) {
+            if (!os_memblock_from(mp, block)) {
+                return false;
+            }
+            os_mempool_poison_check(mp, block);
+            os_mempool_guard_check(mp, block);
+        }
+    }
+#endif
+
     return true;
 }
 
@@ -322,17 +352,186 @@ os_memblock_from(const struct os_mempool *mp, const void *block_addr)
     return 1;
 }
 
+#if MYNEWT_VAL(OS_MEMPOOL_CACHE)
+/**
+ * Returns the cache of the specified pool owned by the running task, or NULL
+ * if there is none or we are in interrupt context.  The cache list is only
+ * modified with interrupts disabled and new caches are fully initialized
+ * before they are linked, so it can be walked without disabling interrupts.
+ */
+static struct os_mempool_cache *
+os_mempool_cache_find(struct os_mempool *mp)
+{
+    struct os_mempool_cache *mpc;
+    struct os_task *t;
+
+    if (SLIST_EMPTY(&mp->mp_caches) || os_arch_in_isr()) {
+        return NULL;
+    }
+
+    t = os_sched_get_current_task();
+    SLIST_FOREACH(mpc, &mp->mp_caches, mpc_next) {
+        if (mpc->mpc_task == t) {
+            return mpc;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Moves up to half a cache worth of blocks from the pool to the cache, with
+ * a single critical section.
+ */
+static void
+os_mempool_cache_refill(struct os_mempool_cache *mpc)
+{
+    struct os_mempool *mp;
+    struct os_memblock *block;
+    os_sr_t sr;
+    int cnt;
+
+    mp = mpc->mpc_pool;
+
+    OS_ENTER_CRITICAL(sr);
+    for (cnt = mpc->mpc_size / 2; cnt > 0 && mp->mp_num_free; cnt--) {
+        block = SLIST_FIRST(mp);
+        SLIST_FIRST(mp) = SLIST_NEXT(block, mb_next);
+        mp->mp_num_free--;
+
+        SLIST_INSERT_HEAD(&mpc->mpc_blocks, block, mb_next);
+        mpc->mpc_count++;
+    }
+    if (mp->mp_min_free > mp->mp_num_free) {
+        mp->mp_min_free = mp->mp_num_free;
+    }
+    mpc->mpc_refills++;
+    OS_EXIT_CRITICAL(sr);
+}
+
+/**
+ * Returns the specified number of blocks from the cache to the pool, with a
+ * single critical section.  The blocks are unlinked from the cache first, so
+ * the cache is consistent at all times for the owning task.
+ */
+static void
+os_mempool_cache_drain(struct os_mempool_cache *mpc, int cnt)
+{
+    struct os_mempool *mp;
+    struct os_memblock *first;
+    struct os_memblock *last;
+    os_sr_t sr;
+    int i;
+
+    if (cnt == 0) {
+        return;
+    }
+
+    mp = mpc->mpc_pool;
+
+    first = SLIST_FIRST(&mpc->mpc_blocks);
+    last = first;
+    for (i = 1; i < cnt; i++) {
+        last = SLIST_NEXT(last, mb_next);
+    }
+    SLIST_FIRST(&mpc->mpc_blocks) = SLIST_NEXT(last, mb_next);
+    mpc->mpc_count -= cnt;
+
+    OS_ENTER_CRITICAL(sr);
+    SLIST_NEXT(last, mb_next) = SLIST_FIRST(mp);
+    SLIST_FIRST(mp) = first;
+    mp->mp_num_free += cnt;
+    mpc->mpc_drains++;
+    OS_EXIT_CRITICAL(sr);
+}
+
+os_error_t
+os_mempool_cache_init(struct os_mempool_cache *mpc, struct os_mempool *mp,
+                      struct os_task *task, uint16_t size)
+{
+    os_sr_t sr;
+
+    if (!mpc || !mp || !task || size < 2) {
+        return OS_INVALID_PARM;
+    }
+
+    mpc->mpc_pool = mp;
+    mpc->mpc_task = task;
+    mpc->mpc_size = size;
+    mpc->mpc_count = 0;
+    mpc->mpc_refills = 0;
+    mpc->mpc_drains = 0;
+    SLIST_INIT(&mpc->mpc_blocks);
+
+    OS_ENTER_CRITICAL(sr);
+    SLIST_INSERT_HEAD(&mp->mp_caches, mpc, mpc_next);
+    OS_EXIT_CRITICAL(sr);
+
+    return OS_OK;
+}
+
+void
+os_mempool_cache_flush(struct os_mempool_cache *mpc)
+{
+    os_mempool_cache_drain(mpc, mpc->mpc_count);
+}
+
+os_error_t
+os_mempool_cache_remove(struct os_mempool_cache *mpc)
+{
+    struct os_mempool_cache *cur;
+    os_sr_t sr;
+
+    os_mempool_cache_flush(mpc);
+
+    OS_ENTER_CRITICAL(sr);
+    SLIST_FOREACH(cur, &mpc->mpc_pool->mp_caches, mpc_next) {
+        if (cur == mpc) {
+            break;
+        }
+    }
+    if (cur != NULL) {
+        SLIST_REMOVE(&mpc->mpc_pool->mp_caches, mpc, os_mempool_cache,
+                     mpc_next);
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    if (cur == NULL) {
+        return OS_INVALID_PARM;
+    }
+
+    return OS_OK;
+}
+#endif
+
 void *
 os_memblock_get(struct os_mempool *mp)
 {
     os_sr_t sr;
     struct os_memblock *block;
+#if MYNEWT_VAL(OS_MEMPOOL_CACHE)
+    struct os_mempool_cache *mpc;
+#endif
 
     os_trace_api_u32(OS_TRACE_ID_MEMBLOCK_GET, (uintptr_t)mp);
 
     /* Check to make sure they passed in a memory pool (or something) */
     block = NULL;
     if (mp) {
+#if MYNEWT_VAL(OS_MEMPOOL_CACHE)
+        mpc = os_mempool_cache_find(mp);
+        if (mpc) {
+            if (mpc->mpc_count == 0) {
+                os_mempool_cache_refill(mpc);
+            }
+            block = SLIST_FIRST(&mpc->mpc_blocks);
+            if (block) {
+                SLIST_FIRST(&mpc->mpc_blocks) = SLIST_NEXT(block, mb_next);
+                mpc->mpc_count--;
+            }
+            goto check;
+        }
+#endif
         OS_ENTER_CRITICAL(sr);
         /* Check for any free */
         if (mp->mp_num_free) {
@@ -350,6 +549,9 @@ os_memblock_get(struct os_mempool *mp)
         }
         OS_EXIT_CRITICAL(sr);
 
+#if MYNEWT_VAL(OS_MEMPOOL_CACHE)
+check:
+#endif
         if (block) {
             os_mempool_poison_check(mp, block);
             os_mempool_guard_check(mp, block);
@@ -391,6 +593,40 @@ os_memblock_put_from_cb(struct os_mempool *mp, void *block_addr)
     return OS_OK;
 }
 
+#if MYNEWT_VAL(OS_MEMPOOL_CACHE)
+/**
+ * Puts a block into the running task's cache of the pool.  When the cache is
+ * full, half of it is drained to the pool first.
+ *
+ * @return                      0 if the block was cached;
+ *                              -1 if there is no cache to put the block in.
+ */
+static int
+os_mempool_cache_put(struct os_mempool *mp, void *block_addr)
+{
+    struct os_mempool_cache *mpc;
+    struct os_memblock *block;
+
+    mpc = os_mempool_cache_find(mp);
+    if (mpc == NULL) {
+        return -1;
+    }
+
+    os_mempool_guard_check(mp, block_addr);
+    os_mempool_poison(mp, block_addr);
+
+    if (mpc->mpc_count >= mpc->mpc_size) {
+        os_mempool_cache_drain(mpc, mpc->mpc_size / 2);
+    }
+
+    block = (struct os_memblock *)block_addr;
+    SLIST_INSERT_HEAD(&mpc->mpc_blocks, block, mb_next);
+    mpc->mpc_count++;
+
+    return 0;
+}
+#endif
+
 os_error_t
 os_memblock_put(struct os_mempool *mp, void *block_addr)
 {
@@ -398,6 +634,9 @@ os_memblock_put(struct os_mempool *mp, void *block_addr)
     os_error_t ret;
 #if MYNEWT_VAL(OS_MEMPOOL_CHECK)
     struct os_memblock *block;
+#if MYNEWT_VAL(OS_MEMPOOL_CACHE)
+    struct os_mempool_cache *mpc;
+#endif
     int sr;
 #endif
 
@@ -421,6 +660,13 @@ os_memblock_put(struct os_mempool *mp, void *block_addr)
     SLIST_FOREACH(block, mp, mb_next) {
         assert(block != (struct os_memblock *)block_addr);
     }
+#if MYNEWT_VAL(OS_MEMPOOL_CACHE)
+    SLIST_FOREACH(mpc, &mp->mp_caches, mpc_next) {
+        SLIST_FOREACH(block, &mpc->mpc_blocks, mb_next) {
+            assert(block != (struct os_memblock *)block_addr);
+        }
+    }
+#endif
     OS_EXIT_CRITICAL(sr);
 
 #endif
@@ -435,6 +681,13 @@ os_memblock_put(struct os_mempool *mp, void *block_addr)
         }
     }
 
+#if MYNEWT_VAL(OS_MEMPOOL_CACHE)
+    if (os_mempool_cache_put(mp, block_addr) == 0) {
+        ret = OS_OK;
+        goto done;
+    }
+#endif
+
     /* No callback; free the block. */
     ret = os_memblock_put_from_cb(mp, block_addr);
 
@@ -443,6 +696,84 @@ done:
     return ret;
 }
 
+os_error_t
+os_memblock_put_batch(struct os_mempool *mp, void **blocks, int num_blocks)
+{
+    struct os_memblock *first;
+    struct os_memblock *last;
+    struct os_memblock *block;
+    os_error_t ret;
+    os_sr_t sr;
+    int i;
+
+    os_trace_api_u32x2(OS_TRACE_ID_MEMBLOCK_PUT_BATCH, (uintptr_t)mp,
+                       (uint32_t)num_blocks);
+
+    if ((mp == NULL) || (blocks == NULL) || (num_blocks < 0)) {
+        ret = OS_INVALID_PARM;
+        goto done;
+    }
+
+    for (i = 0; i < num_blocks; i++) {
+        if (blocks[i] == NULL) {
+            ret = OS_INVALID_PARM;
+            goto done;
+        }
+    }
+
+    /* Put callbacks, task caches and the duplicate free check all operate
+     * on one block at a time.
+     */
+    if (MYNEWT_VAL(OS_MEMPOOL_CHECK) ||
+        ((mp->mp_flags & OS_MEMPOOL_F_EXT) &&
+         ((struct os_mempool_ext *)mp)->mpe_put_cb != NULL)
+#if MYNEWT_VAL(OS_MEMPOOL_CACHE)
+        || os_mempool_cache_find(mp) != NULL
+#endif
+        ) {
+
+        for (i = num_blocks - 1; i >= 0; i--) {
+            ret = os_memblock_put(mp, blocks[i]);
+            if (ret != OS_OK) {
+                goto done;
+            }
+        }
+        ret = OS_OK;
+        goto done;
+    }
+
+    /* Link the blocks outside the critical section, preserving their order
+     * at the head of the free list.
+     */
+    first = NULL;
+    last = NULL;
+    for (i = num_blocks - 1; i >= 0; i--) {
+        os_mempool_guard_check(mp, blocks[i]);
+        os_mempool_poison(mp, blocks[i]);
+
+        block = blocks[i];
+        SLIST_NEXT(block, mb_next) = first;
+        first = block;
+        if (last == NULL) {
+            last = block;
+        }
+    }
+
+    if (first != NULL) {
+        OS_ENTER_CRITICAL(sr);
+        SLIST_NEXT(last, mb_next) = SLIST_FIRST(mp);
+        SLIST_FIRST(mp) = first;
+        mp->mp_num_free += num_blocks;
+        OS_EXIT_CRITICAL(sr);
+    }
+
+    ret = OS_OK;
+
+done:
+    os_trace_api_ret_u32(OS_TRACE_ID_MEMBLOCK_PUT_BATCH, (uint32_t)ret);
+    return ret;
+}
+
 struct os_mempool *
 os_mempool_info_get_next(struct os_mempool *mp, struct os_mempool_info *omi)
 {
@@ -18,9 +18,13 @@
  */
 
 #include <assert.h>
+#include <string.h>
 #include "os/mynewt.h"
 #include "mem/mem.h"
 #include "os_priv.h"
+#if MYNEWT_VAL(MSYS_STATS_REGISTER)
+#include "stats/stats.h"
+#endif
 
 static STAILQ_HEAD(os_mbuf_list, os_mbuf_pool) g_msys_pool_list =
     STAILQ_HEAD_INITIALIZER(g_msys_pool_list);
@@ -55,12 +59,37 @@ static struct os_mempool os_msys_2_mempool;
 static struct os_sanity_check os_msys_sc;
 #endif
 
+#if MYNEWT_VAL(MSYS_STATS_REGISTER)
+STATS_SECT_START(os_msys_stats)
+    STATS_SECT_ENTRY(reqs)
+    STATS_SECT_ENTRY(blocks)
+    STATS_SECT_ENTRY(chains)
+    STATS_SECT_ENTRY(fallbacks)
+    STATS_SECT_ENTRY(failures)
+STATS_SECT_END
+
+STATS_NAME_START(os_msys_stats)
+    STATS_NAME(os_msys_stats, reqs)
+    STATS_NAME(os_msys_stats, blocks)
+    STATS_NAME(os_msys_stats, chains)
+    STATS_NAME(os_msys_stats, fallbacks)
+    STATS_NAME(os_msys_stats, failures)
+STATS_NAME_END(os_msys_stats)
+
+/* Totals over all msys pools; the per pool figures are in os_msys_info. */
+static STATS_SECT_DECL(os_msys_stats) os_msys_stats;
+#endif
+
 int
 os_msys_register(struct os_mbuf_pool *new_pool)
 {
     struct os_mbuf_pool *pool;
     struct os_mbuf_pool *prev;
 
+#if MYNEWT_VAL(MSYS_STATS)
+    memset(&new_pool->omp_msys_stats, 0, sizeof(new_pool->omp_msys_stats));
+#endif
+
     /* We want to have order from smallest to biggest mempool. */
     prev = NULL;
     pool = NULL;
@@ -86,22 +115,33 @@ os_msys_reset(void)
     STAILQ_INIT(&g_msys_pool_list);
 }
 
-static struct os_mbuf_pool *os_msys_find_pool(uint16_t dsize);
-
-static struct os_mbuf_pool *
-os_msys_find_biggest_pool(void)
-{
-    return os_msys_find_pool(0xFFFF);
-}
-
+/**
+ * Finds the pool to allocate dsize bytes from: the smallest pool with free
+ * blocks that fits, else the biggest pool with free blocks.
+ *
+ * @param dsize                 The requested size; 0xFFFF for the biggest
+ *                                  pool.
+ * @param out_fit               Set to the smallest pool that fits,
+ *                                  regardless of free blocks; the biggest
+ *                                  pool if none does, NULL without pools.
+ *
+ * @return                      The pool to allocate from;
+ *                              NULL if all pools are empty.
+ */
 static struct os_mbuf_pool *
-os_msys_find_pool(uint16_t dsize)
+os_msys_find_pool(uint16_t dsize, struct os_mbuf_pool **out_fit)
 {
     struct os_mbuf_pool *pool;
     struct os_mbuf_pool *pool_with_free_blocks = NULL;
+    struct os_mbuf_pool *fit = NULL;
+    struct os_mbuf_pool *last = NULL;
     uint16_t pool_free_blocks;
 
     STAILQ_FOREACH(pool, &g_msys_pool_list, omp_next) {
+        if (fit == NULL && dsize <= pool->omp_databuf_len) {
+            fit = pool;
+        }
+        last = pool;
         pool_free_blocks = pool->omp_pool->mp_num_free;
         if (pool_free_blocks != 0) {
             pool_with_free_blocks = pool;
@@ -111,33 +151,175 @@ os_msys_find_pool(uint16_t dsize)
         }
     }
 
+    /* Nothing fits; the loop went through all pools. */
+    if (fit == NULL) {
+        fit = last;
+    }
+    *out_fit = fit;
+
     return pool_with_free_blocks;
 }
 
+static struct os_mbuf_pool *
+os_msys_find_biggest_pool(struct os_mbuf_pool **out_fit)
+{
+    return os_msys_find_pool(0xFFFF, out_fit);
+}
+
+#if MYNEWT_VAL(MSYS_STATS)
+static int
+os_msys_hist_bucket(uint16_t size)
+{
+    int bucket;
+
+    for (bucket = 0; bucket < OS_MSYS_HIST_BUCKETS - 1; bucket++) {
+        if (size < (32 << bucket)) {
+            break;
+        }
+    }
+
+    return bucket;
+}
+
+/**
+ * Accounts for an msys request.
+ *
+ * @param fit                   The best fitting pool for the request.
+ * @param om                    The allocated mbuf (chain); NULL if the
+ *                                  request failed.
+ * @param size                  The requested size; 0 if unspecified.
+ */
+static void
+os_msys_stats_update(struct os_mbuf_pool *fit, const struct os_mbuf *om,
+                     uint16_t size)
+{
+    struct os_msys_stats *stats;
+    const struct os_mbuf *cur;
+    os_sr_t sr;
+    int blocks;
+
+    blocks = 0;
+    for (cur = om; cur != NULL; cur = SLIST_NEXT(cur, om_next)) {
+        blocks++;
+    }
+
+    OS_ENTER_CRITICAL(sr);
+
+    if (om == NULL) {
+        if (fit != NULL) {
+            fit->omp_msys_stats.oms_failures++;
+        }
+#if MYNEWT_VAL(MSYS_STATS_REGISTER)
+        STATS_INC(os_msys_stats, failures);
+#endif
+    } else {
+        if (om->om_omp != fit) {
+            fit->omp_msys_stats.oms_fallbacks++;
+#if MYNEWT_VAL(MSYS_STATS_REGISTER)
+            STATS_INC(os_msys_stats, fallbacks);
+#endif
+        }
+
+        stats = &om->om_omp->omp_msys_stats;
+        stats->oms_reqs++;
+        stats->oms_blocks += blocks;
+        if (blocks > 1) {
+            stats->oms_chains++;
+        }
+        if (size != 0) {
+            stats->oms_req_bytes += size;
+            stats->oms_hist[os_msys_hist_bucket(size)]++;
+        }
+#if MYNEWT_VAL(MSYS_STATS_REGISTER)
+        STATS_INC(os_msys_stats, reqs);
+        STATS_INCN(os_msys_stats, blocks, blocks);
+        if (blocks > 1) {
+            STATS_INC(os_msys_stats, chains);
+        }
+#endif
+    }
+
+    OS_EXIT_CRITICAL(sr);
+}
+#endif
+
+#if MYNEWT_VAL(MSYS_CHAIN_FALLBACK)
+/**
+ * Extends a freshly allocated mbuf with empty mbufs from the same pool until
+ * the chain can hold len bytes.  The chain is left as is if the pool doesn't
+ * have enough free blocks.
+ */
+static void
+os_msys_chain_extend(struct os_mbuf *om, uint16_t len)
+{
+    struct os_mbuf_pool *pool;
+    struct os_mbuf *last;
+    struct os_mbuf *next;
+    int space;
+    int blocks;
+
+    space = OS_MBUF_TRAILINGSPACE(om);
+    if (len <= space) {
+        return;
+    }
+
+    pool = om->om_omp;
+    blocks = (len - space + pool->omp_databuf_len - 1) / pool->omp_databuf_len;
+    if (pool->omp_pool->mp_num_free < blocks) {
+        return;
+    }
+
+    last = om;
+    while (blocks-- > 0) {
+        next = os_mbuf_get(pool, 0);
+        if (next == NULL) {
+            /* Lost a race for the free blocks; give back what we got. */
+            os_mbuf_free_chain(SLIST_NEXT(om, om_next));
+            SLIST_NEXT(om, om_next) = NULL;
+            return;
+        }
+        SLIST_NEXT(last, om_next) = next;
+        last = next;
+    }
+}
+#endif
 
 struct os_mbuf *
 os_msys_get(uint16_t dsize, uint16_t leadingspace)
 {
     struct os_mbuf *m;
     struct os_mbuf_pool *pool;
+    struct os_mbuf_pool *fit;
 
     /* If dsize = 0 that means user has no idea how big block size is needed,
     * therefore lets find for him the biggest one
     */
     if (dsize == 0) {
-        pool = os_msys_find_biggest_pool();
+        pool = os_msys_find_biggest_pool(&fit);
     } else {
-        pool = os_msys_find_pool(dsize);
+        pool = os_msys_find_pool(dsize, &fit);
     }
 
     if (!pool) {
-        goto err;
+        m = NULL;
+        goto done;
     }
 
     m = os_mbuf_get(pool, leadingspace);
+#if MYNEWT_VAL(MSYS_CHAIN_FALLBACK)
+    /* The fitting pool ran dry; make up for it with a chain. */
+    if (m != NULL && pool->omp_databuf_len < dsize &&
+        fit->omp_databuf_len >= dsize) {
+
+        os_msys_chain_extend(m, dsize);
+    }
+#endif
+
+done:
+#if MYNEWT_VAL(MSYS_STATS)
+    os_msys_stats_update(fit, m, dsize);
+#endif
     return (m);
-err:
-    return (NULL);
 }
 
 struct os_mbuf *
@@ -146,6 +328,7 @@ os_msys_get_pkthdr(uint16_t dsize, uint16_t user_hdr_len)
     uint16_t total_pkthdr_len;
     struct os_mbuf *m;
     struct os_mbuf_pool *pool;
+    struct os_mbuf_pool *fit;
 
     total_pkthdr_len =  user_hdr_len + sizeof(struct os_mbuf_pkthdr);
 
@@ -153,19 +336,32 @@ os_msys_get_pkthdr(uint16_t dsize, uint16_t user_hdr_len)
      * therefore lets find for him the biggest one
      */
     if (dsize == 0) {
-        pool = os_msys_find_biggest_pool();
+        pool = os_msys_find_biggest_pool(&fit);
     } else {
-        pool = os_msys_find_pool(dsize + total_pkthdr_len);
+        pool = os_msys_find_pool(dsize + total_pkthdr_len, &fit);
     }
 
     if (!pool) {
-        goto err;
+        m = NULL;
+        goto done;
     }
 
     m = os_mbuf_get_pkthdr(pool, user_hdr_len);
+#if MYNEWT_VAL(MSYS_CHAIN_FALLBACK)
+    /* The fitting pool ran dry; make up for it with a chain. */
+    if (m != NULL && dsize != 0 &&
+        pool->omp_databuf_len < dsize + total_pkthdr_len &&
+        fit->omp_databuf_len >= dsize + total_pkthdr_len) {
+
+        os_msys_chain_extend(m, dsize);
+    }
+#endif
+
+done:
+#if MYNEWT_VAL(MSYS_STATS)
+    os_msys_stats_update(fit, m, dsize != 0 ? dsize + total_pkthdr_len : 0);
+#endif
     return (m);
-err:
-    return (NULL);
 }
 
 int
@@ -196,6 +392,64 @@ os_msys_num_free(void)
     return total;
 }
 
+#if MYNEWT_VAL(MSYS_STATS)
+int
+os_msys_info_get(int idx, struct os_msys_info *omsi)
+{
+    struct os_mbuf_pool *omp;
+    os_sr_t sr;
+
+    STAILQ_FOREACH(omp, &g_msys_pool_list, omp_next) {
+        if (idx-- == 0) {
+            break;
+        }
+    }
+    if (omp == NULL) {
+        return OS_ENOENT;
+    }
+
+    omsi->omsi_databuf_len = omp->omp_databuf_len;
+    omsi->omsi_num_blocks = omp->omp_pool->mp_num_blocks;
+    omsi->omsi_num_free = omp->omp_pool->mp_num_free;
+    omsi->omsi_min_free = omp->omp_pool->mp_min_free;
+
+    OS_ENTER_CRITICAL(sr);
+    omsi->omsi_stats = omp->omp_msys_stats;
+    OS_EXIT_CRITICAL(sr);
+
+    return 0;
+}
+
+void
+os_msys_stats_clear(void)
+{
+    struct os_mbuf_pool *omp;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    STAILQ_FOREACH(omp, &g_msys_pool_list, omp_next) {
+        memset(&omp->omp_msys_stats, 0, sizeof(omp->omp_msys_stats));
+    }
+    OS_EXIT_CRITICAL(sr);
+}
+#endif
+
+#if MYNEWT_VAL(MSYS_STATS_REGISTER)
+void
+os_msys_stats_init(void)
+{
+    int rc;
+
+    /* Ensure this function only gets called by sysinit. */
+    SYSINIT_ASSERT_ACTIVE();
+
+    rc = stats_init_and_reg(STATS_HDR(os_msys_stats),
+                            STATS_SIZE_INIT_PARMS(os_msys_stats, STATS_SIZE_32),
+                            STATS_NAME_INIT_PARMS(os_msys_stats), "msys");
+    SYSINIT_PANIC_ASSERT(rc == 0);
+}
+#endif
+
 #if OS_MSYS_SANITY_ENABLED
 
 /**
@@ -18,6 +18,7 @@
  */
 
 #include <assert.h>
+#include <string.h>
 #include "os/mynewt.h"
 #include "os_priv.h"
 
@@ -30,30 +31,318 @@ extern os_time_t g_os_time;
 os_time_t g_os_last_ctx_sw_time;
 static uint8_t os_sched_lock_count;
 
-os_error_t
-os_sched_insert(struct os_task *t)
+#if MYNEWT_VAL(OS_SCHED_PRIO_BITMAP)
+
+#define OS_SCHED_PRIO_CNT       (OS_TASK_PRI_LOWEST + 1)
+#define OS_SCHED_PRIO_WORDS     (OS_SCHED_PRIO_CNT / 32)
+
+/*
+ * The run list is still kept sorted by priority, but the insertion point is
+ * found through a two level bitmap instead of walking the list.  Bit N of
+ * os_sched_prio_map is set when at least one task of priority N is on the
+ * run list, bit W of os_sched_prio_grp is set when word W of the map is
+ * non-zero.  os_sched_prio_head[N] is the first task of priority N on the
+ * run list.
+ */
+static uint32_t os_sched_prio_map[OS_SCHED_PRIO_WORDS];
+static uint8_t os_sched_prio_grp;
+static struct os_task *os_sched_prio_head[OS_SCHED_PRIO_CNT];
+
+/**
+ * Returns the first task on the run list whose priority is lower (i.e.
+ * numerically greater) than 'prio', or NULL if there is no such task.
+ */
+static struct os_task *
+os_sched_prio_next(uint8_t prio)
+{
+    uint32_t bits;
+    uint8_t grp;
+    int word;
+
+    word = prio >> 5;
+    if ((prio & 31) != 31) {
+        bits = os_sched_prio_map[word] & (UINT32_MAX << ((prio & 31) + 1));
+        if (bits) {
+            return os_sched_prio_head[(word << 5) + __builtin_ctz(bits)];
+        }
+    }
+
+    grp = os_sched_prio_grp & (uint8_t)~((2 << word) - 1);
+    if (!grp) {
+        return NULL;
+    }
+    word = __builtin_ctz(grp);
+
+    return os_sched_prio_head[(word << 5) +
+                              __builtin_ctz(os_sched_prio_map[word])];
+}
+
+static void
+os_sched_run_list_insert(struct os_task *t)
 {
     struct os_task *entry;
-    os_sr_t sr;
-    os_error_t rc;
+    uint8_t prio;
 
-    if (t->t_state != OS_TASK_READY) {
-        rc = OS_EINVAL;
-        goto err;
+    prio = t->t_prio;
+    t->t_sched_prio = prio;
+
+    /* Tasks of equal priority are kept in FIFO order */
+    entry = os_sched_prio_next(prio);
+    if (entry) {
+        TAILQ_INSERT_BEFORE(entry, t, t_os_list);
+    } else {
+        TAILQ_INSERT_TAIL(&g_os_run_list, t, t_os_list);
     }
 
-    entry = NULL;
-    OS_ENTER_CRITICAL(sr);
+    if (!os_sched_prio_head[prio]) {
+        os_sched_prio_head[prio] = t;
+        os_sched_prio_map[prio >> 5] |= 1UL << (prio & 31);
+        os_sched_prio_grp |= 1 << (prio >> 5);
+    }
+}
+
+static void
+os_sched_run_list_remove(struct os_task *t)
+{
+    struct os_task *next;
+    uint8_t prio;
+
+    /*
+     * Use the priority the task was queued at; the caller may have already
+     * changed t_prio (see os_sched_resort()).
+     */
+    prio = t->t_sched_prio;
+    if (os_sched_prio_head[prio] == t) {
+        next = TAILQ_NEXT(t, t_os_list);
+        if (next && next->t_sched_prio == prio) {
+            os_sched_prio_head[prio] = next;
+        } else {
+            os_sched_prio_head[prio] = NULL;
+            os_sched_prio_map[prio >> 5] &= ~(1UL << (prio & 31));
+            if (!os_sched_prio_map[prio >> 5]) {
+                os_sched_prio_grp &= ~(1 << (prio >> 5));
+            }
+        }
+    }
+    TAILQ_REMOVE(&g_os_run_list, t, t_os_list);
+}
+
+#else
+
+static void
+os_sched_run_list_insert(struct os_task *t)
+{
+    struct os_task *entry;
+
     TAILQ_FOREACH(entry, &g_os_run_list, t_os_list) {
         if (t->t_prio < entry->t_prio) {
             break;
         }
     }
     if (entry) {
-        TAILQ_INSERT_BEFORE(entry, (struct os_task *) t, t_os_list);
+        TAILQ_INSERT_BEFORE(entry, t, t_os_list);
     } else {
-        TAILQ_INSERT_TAIL(&g_os_run_list, (struct os_task *) t, t_os_list);
+        TAILQ_INSERT_TAIL(&g_os_run_list, t, t_os_list);
+    }
+}
+
+static void
+os_sched_run_list_remove(struct os_task *t)
+{
+    TAILQ_REMOVE(&g_os_run_list, t, t_os_list);
+}
+
+#endif
+
+#if MYNEWT_VAL(OS_SCHED_SLEEP_HEAP)
+
+/*
+ * Sleeping tasks that have a timeout are kept in a binary min-heap ordered
+ * by wakeup time, so the earliest wakeup is always at index 0.  Each task
+ * remembers its heap index in t_sleep_idx, allowing it to be removed when
+ * it is woken up before its timeout.  g_os_sleep_list holds all sleeping
+ * tasks in no particular order.
+ */
+static struct os_task *
+    os_sched_sleep_heap[MYNEWT_VAL(OS_SCHED_SLEEP_HEAP_SIZE)];
+static uint8_t os_sched_sleep_heap_cnt;
+
+#define OS_SCHED_SLEEP_HEAP_LT(_t1, _t2) \
+    OS_TIME_TICK_LT((_t1)->t_next_wakeup, (_t2)->t_next_wakeup)
+
+static void
+os_sched_sleep_heap_set(int idx, struct os_task *t)
+{
+    os_sched_sleep_heap[idx] = t;
+    t->t_sleep_idx = idx;
+}
+
+static void
+os_sched_sleep_heap_up(int idx)
+{
+    struct os_task *t;
+    int parent;
+
+    t = os_sched_sleep_heap[idx];
+    while (idx > 0) {
+        parent = (idx - 1) / 2;
+        if (!OS_SCHED_SLEEP_HEAP_LT(t, os_sched_sleep_heap[parent])) {
+            break;
+        }
+        os_sched_sleep_heap_set(idx, os_sched_sleep_heap[parent]);
+        idx = parent;
+    }
+    os_sched_sleep_heap_set(idx, t);
+}
+
+static void
+os_sched_sleep_heap_down(int idx)
+{
+    struct os_task *t;
+    int child;
+
+    t = os_sched_sleep_heap[idx];
+    while (1) {
+        child = 2 * idx + 1;
+        if (child >= os_sched_sleep_heap_cnt) {
+            break;
+        }
+        if (child + 1 < os_sched_sleep_heap_cnt &&
+            OS_SCHED_SLEEP_HEAP_LT(os_sched_sleep_heap[child + 1],
+                                   os_sched_sleep_heap[child])) {
+            child++;
+        }
+        if (!OS_SCHED_SLEEP_HEAP_LT(os_sched_sleep_heap[child], t)) {
+            break;
+        }
+        os_sched_sleep_heap_set(idx, os_sched_sleep_heap[child]);
+        idx = child;
+    }
+    os_sched_sleep_heap_set(idx, t);
+}
+
+static void
+os_sched_sleep_list_insert(struct os_task *t)
+{
+    TAILQ_INSERT_TAIL(&g_os_sleep_list, t, t_os_list);
+    if (!(t->t_flags & OS_TASK_FLAG_NO_TIMEOUT)) {
+        assert(os_sched_sleep_heap_cnt < MYNEWT_VAL(OS_SCHED_SLEEP_HEAP_SIZE));
+        os_sched_sleep_heap_set(os_sched_sleep_heap_cnt, t);
+        os_sched_sleep_heap_cnt++;
+        os_sched_sleep_heap_up(t->t_sleep_idx);
     }
+}
+
+static void
+os_sched_sleep_list_remove(struct os_task *t)
+{
+    struct os_task *last;
+    int idx;
+
+    TAILQ_REMOVE(&g_os_sleep_list, t, t_os_list);
+    if (!(t->t_flags & OS_TASK_FLAG_NO_TIMEOUT)) {
+        idx = t->t_sleep_idx;
+        os_sched_sleep_heap_cnt--;
+        if (idx != os_sched_sleep_heap_cnt) {
+            last = os_sched_sleep_heap[os_sched_sleep_heap_cnt];
+            os_sched_sleep_heap_set(idx, last);
+            if (idx > 0 &&
+                OS_SCHED_SLEEP_HEAP_LT(last, os_sched_sleep_heap[(idx - 1) / 2])) {
+                os_sched_sleep_heap_up(idx);
+            } else {
+                os_sched_sleep_heap_down(idx);
+            }
+        }
+    }
+}
+
+/**
+ * Returns the sleeping task with the earliest timeout, or NULL if no task is
+ * sleeping with a timeout.
+ */
+static struct os_task *
+os_sched_sleep_list_first(void)
+{
+    if (os_sched_sleep_heap_cnt == 0) {
+        return NULL;
+    }
+    return os_sched_sleep_heap[0];
+}
+
+#else
+
+static void
+os_sched_sleep_list_insert(struct os_task *t)
+{
+    struct os_task *entry;
+
+    if (t->t_flags & OS_TASK_FLAG_NO_TIMEOUT) {
+        TAILQ_INSERT_TAIL(&g_os_sleep_list, t, t_os_list);
+        return;
+    }
+
+    TAILQ_FOREACH(entry, &g_os_sleep_list, t_os_list) {
+        if ((entry->t_flags & OS_TASK_FLAG_NO_TIMEOUT) ||
+                OS_TIME_TICK_GT(entry->t_next_wakeup, t->t_next_wakeup)) {
+            break;
+        }
+    }
+    if (entry) {
+        TAILQ_INSERT_BEFORE(entry, t, t_os_list);
+    } else {
+        TAILQ_INSERT_TAIL(&g_os_sleep_list, t, t_os_list);
+    }
+}
+
+static void
+os_sched_sleep_list_remove(struct os_task *t)
+{
+    TAILQ_REMOVE(&g_os_sleep_list, t, t_os_list);
+}
+
+static struct os_task *
+os_sched_sleep_list_first(void)
+{
+    struct os_task *t;
+
+    /* Tasks waiting forever are at the end of the list */
+    t = TAILQ_FIRST(&g_os_sleep_list);
+    if (t == NULL || (t->t_flags & OS_TASK_FLAG_NO_TIMEOUT)) {
+        return NULL;
+    }
+    return t;
+}
+
+#endif
+
+void
+os_sched_init(void)
+{
+    TAILQ_INIT(&g_os_run_list);
+    TAILQ_INIT(&g_os_sleep_list);
+#if MYNEWT_VAL(OS_SCHED_PRIO_BITMAP)
+    memset(os_sched_prio_map, 0, sizeof(os_sched_prio_map));
+    memset(os_sched_prio_head, 0, sizeof(os_sched_prio_head));
+    os_sched_prio_grp = 0;
+#endif
+#if MYNEWT_VAL(OS_SCHED_SLEEP_HEAP)
+    os_sched_sleep_heap_cnt = 0;
+#endif
+}
+
+os_error_t
+os_sched_insert(struct os_task *t)
+{
+    os_sr_t sr;
+    os_error_t rc;
+
+    if (t->t_state != OS_TASK_READY) {
+        rc = OS_EINVAL;
+        goto err;
+    }
+
+    OS_ENTER_CRITICAL(sr);
+    os_sched_run_list_insert(t);
     OS_EXIT_CRITICAL(sr);
 
     return (0);
@@ -145,32 +434,17 @@ os_sched_resume(void)
 int
 os_sched_sleep(struct os_task *t, os_time_t nticks)
 {
-    struct os_task *entry;
-
     if (os_sched_lock_count) {
         return 0;
     }
-    entry = NULL;
 
-    TAILQ_REMOVE(&g_os_run_list, t, t_os_list);
+    os_sched_run_list_remove(t);
     t->t_state = OS_TASK_SLEEP;
     t->t_next_wakeup = os_time_get() + nticks;
     if (nticks == OS_TIMEOUT_NEVER) {
         t->t_flags |= OS_TASK_FLAG_NO_TIMEOUT;
-        TAILQ_INSERT_TAIL(&g_os_sleep_list, t, t_os_list);
-    } else {
-        TAILQ_FOREACH(entry, &g_os_sleep_list, t_os_list) {
-            if ((entry->t_flags & OS_TASK_FLAG_NO_TIMEOUT) ||
-                    OS_TIME_TICK_GT(entry->t_next_wakeup, t->t_next_wakeup)) {
-                break;
-            }
-        }
-        if (entry) {
-            TAILQ_INSERT_BEFORE(entry, t, t_os_list);
-        } else {
-            TAILQ_INSERT_TAIL(&g_os_sleep_list, t, t_os_list);
-        }
     }
+    os_sched_sleep_list_insert(t);
 
     os_trace_task_stop_ready(t, OS_TASK_SLEEP);
     return (0);
@@ -181,9 +455,9 @@ os_sched_remove(struct os_task *t)
 {
 
     if (t->t_state == OS_TASK_SLEEP) {
-        TAILQ_REMOVE(&g_os_sleep_list, t, t_os_list);
+        os_sched_sleep_list_remove(t);
     } else if (t->t_state == OS_TASK_READY) {
-        TAILQ_REMOVE(&g_os_run_list, t, t_os_list);
+        os_sched_run_list_remove(t);
     }
     t->t_next_wakeup = 0;
     t->t_flags |= OS_TASK_FLAG_NO_TIMEOUT;
@@ -211,10 +485,10 @@ os_sched_wakeup(struct os_task *t)
     }
 
     /* Remove task from sleep list */
+    os_sched_sleep_list_remove(t);
     t->t_state = OS_TASK_READY;
     t->t_next_wakeup = 0;
     t->t_flags &= ~OS_TASK_FLAG_NO_TIMEOUT;
-    TAILQ_REMOVE(&g_os_sleep_list, t, t_os_list);
     os_sched_insert(t);
 
     os_trace_task_start_ready(t);
@@ -226,7 +500,6 @@ void
 os_sched_os_timer_exp(void)
 {
     struct os_task *t;
-    struct os_task *next;
     os_time_t now;
     os_sr_t sr;
 
@@ -237,19 +510,12 @@ os_sched_os_timer_exp(void)
     /*
      * Wakeup any tasks that have their sleep timer expired
      */
-    t = TAILQ_FIRST(&g_os_sleep_list);
-    while (t) {
-        /* If task waiting forever, do not check next wakeup time */
-        if (t->t_flags & OS_TASK_FLAG_NO_TIMEOUT) {
-            break;
-        }
-        next = TAILQ_NEXT(t, t_os_list);
+    while ((t = os_sched_sleep_list_first()) != NULL) {
         if (OS_TIME_TICK_GEQ(now, t->t_next_wakeup)) {
             os_sched_wakeup(t);
         } else {
             break;
         }
-        t = next;
     }
 
     OS_EXIT_CRITICAL(sr);
@@ -263,8 +529,8 @@ os_sched_wakeup_ticks(os_time_t now)
 
     OS_ASSERT_CRITICAL();
 
-    t = TAILQ_FIRST(&g_os_sleep_list);
-    if (t == NULL || (t->t_flags & OS_TASK_FLAG_NO_TIMEOUT)) {
+    t = os_sched_sleep_list_first();
+    if (t == NULL) {
         rt = OS_TIMEOUT_NEVER;
     } else if (OS_TIME_TICK_GEQ(t->t_next_wakeup, now)) {
         rt = t->t_next_wakeup - now;
@@ -284,7 +550,7 @@ void
 os_sched_resort(struct os_task *t)
 {
     if (t->t_state == OS_TASK_READY) {
-        TAILQ_REMOVE(&g_os_run_list, t, t_os_list);
+        os_sched_run_list_remove(t);
         os_sched_insert(t);
     }
 }
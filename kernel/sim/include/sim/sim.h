@@ -48,6 +48,26 @@ void sim_restore_sr(os_sr_t osr);
 int sim_in_critical(void);
 void sim_tick_idle(os_time_t ticks);
 
+typedef void sim_irq_fd_fn(void *arg);
+
+/**
+ * A host file descriptor that acts as an interrupt source.  While the idle
+ * task sleeps it waits for the descriptor to become readable as well as for
+ * the OS tick timer.  The callback is executed by the idle task with
+ * interrupts disabled, so it is subject to the same restrictions as an
+ * interrupt handler (e.g., it may release a semaphore or put an event, but
+ * must not block).
+ */
+struct sim_irq_fd {
+    int sif_fd;
+    sim_irq_fd_fn *sif_cb;
+    void *sif_arg;
+    SLIST_ENTRY(sim_irq_fd) sif_next;
+};
+
+void sim_irq_fd_add(struct sim_irq_fd *sif);
+void sim_irq_fd_remove(struct sim_irq_fd *sif);
+
 /**
  * Prints information about a crash to stdout.  This functionality is defined
  * as a macro rather than a function to ensure that it gets inlined, enforcing
@@ -21,6 +21,7 @@
 #define H_SIM_PRIV_
 
 #include <sys/types.h>
+#include <signal.h>
 #include "os/mynewt.h"
 
 #ifdef __cplusplus
@@ -33,6 +34,8 @@ void sim_switch_tasks(void);
 void sim_tick(void);
 void sim_signals_init(void);
 void sim_signals_cleanup(void);
+int sim_irq_fd_wait(const sigset_t *sigmask);
+void sim_irq_fd_run(void);
 
 extern pid_t sim_pid;
 
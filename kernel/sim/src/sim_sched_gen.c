@@ -36,6 +36,7 @@
 #include <setjmp.h>
 #include <signal.h>
 #include <sys/time.h>
+#include <sys/select.h>
 #include <assert.h>
 #include "sim/sim.h"
 #include "sim_priv.h"
@@ -45,6 +46,10 @@
 
 pid_t sim_pid;
 
+static SLIST_HEAD(, sim_irq_fd) sim_irq_fds =
+    SLIST_HEAD_INITIALIZER(sim_irq_fds);
+static fd_set sim_irq_fds_ready;
+
 void
 sim_switch_tasks(void)
 {
@@ -121,6 +126,83 @@ sim_tick(void)
     }
 }
 
+/**
+ * Registers a host file descriptor as an interrupt source for the idle task.
+ */
+void
+sim_irq_fd_add(struct sim_irq_fd *sif)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    SLIST_INSERT_HEAD(&sim_irq_fds, sif, sif_next);
+    OS_EXIT_CRITICAL(sr);
+}
+
+void
+sim_irq_fd_remove(struct sim_irq_fd *sif)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    SLIST_REMOVE(&sim_irq_fds, sif, sim_irq_fd, sif_next);
+    FD_CLR(sif->sif_fd, &sim_irq_fds_ready);
+    OS_EXIT_CRITICAL(sr);
+}
+
+/*
+ * Waits for a signal to be delivered or for one of the registered file
+ * descriptors to become readable.  'sigmask' is installed for the duration
+ * of the wait, as with sigsuspend().
+ *
+ * Returns 1 if a file descriptor is readable and 0 otherwise.
+ */
+int
+sim_irq_fd_wait(const sigset_t *sigmask)
+{
+    struct sim_irq_fd *sif;
+    int nfds;
+    int rc;
+
+    OS_ASSERT_CRITICAL();
+
+    nfds = 0;
+    FD_ZERO(&sim_irq_fds_ready);
+    SLIST_FOREACH(sif, &sim_irq_fds, sif_next) {
+        FD_SET(sif->sif_fd, &sim_irq_fds_ready);
+        if (sif->sif_fd >= nfds) {
+            nfds = sif->sif_fd + 1;
+        }
+    }
+
+    rc = pselect(nfds, &sim_irq_fds_ready, NULL, NULL, NULL, sigmask);
+    if (rc <= 0) {
+        /* Woken up by a signal; the descriptor set is not valid. */
+        FD_ZERO(&sim_irq_fds_ready);
+        return 0;
+    }
+    return 1;
+}
+
+/*
+ * Calls the handlers of the file descriptors that were found readable by the
+ * last sim_irq_fd_wait().
+ */
+void
+sim_irq_fd_run(void)
+{
+    struct sim_irq_fd *sif;
+
+    OS_ASSERT_CRITICAL();
+
+    SLIST_FOREACH(sif, &sim_irq_fds, sif_next) {
+        if (FD_ISSET(sif->sif_fd, &sim_irq_fds_ready)) {
+            FD_CLR(sif->sif_fd, &sim_irq_fds_ready);
+            sif->sif_cb(sif->sif_arg);
+        }
+    }
+}
+
 static void
 sim_start_timer(void)
 {
@@ -233,10 +315,10 @@ sim_os_init(void)
 {
     sim_pid = getpid();
     g_current_task = NULL;
+    SLIST_INIT(&sim_irq_fds);
 
     STAILQ_INIT(&g_os_task_list);
-    TAILQ_INIT(&g_os_run_list);
-    TAILQ_INIT(&g_os_sleep_list);
+    os_sched_init();
 
     sim_signals_init();
 
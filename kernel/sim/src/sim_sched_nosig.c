@@ -154,6 +154,7 @@ sig_handler_alrm(int sig)
 void
 sim_tick_idle(os_time_t ticks)
 {
+    int fd_ready;
     int rc;
     struct itimerval it;
 
@@ -175,7 +176,7 @@ sim_tick_idle(os_time_t ticks)
     unblock_timer();
 
     sigemptyset(&suspsigs);
-    sigsuspend(&nosigs);        /* Wait for a signal to wake us up */
+    fd_ready = sim_irq_fd_wait(&nosigs);    /* Wait for a signal or fd */
 
     block_timer();
 
@@ -184,9 +185,12 @@ sim_tick_idle(os_time_t ticks)
      * The SIGALRM handler is called before any other handlers to ensure that
      * OS time is always correct.
      */
-    if (sigismember(&suspsigs, SIGALRM)) {
+    if (sigismember(&suspsigs, SIGALRM) || fd_ready) {
         sim_tick();
     }
+    if (fd_ready) {
+        sim_irq_fd_run();
+    }
 
     if (ticks > 0) {
         /*
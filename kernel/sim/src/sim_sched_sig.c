@@ -166,6 +166,7 @@ void
 sim_tick_idle(os_time_t ticks)
 {
     int i, rc, sig;
+    int fd_ready;
     struct itimerval it;
     void (*handler)(int sig);
 
@@ -186,7 +187,7 @@ sim_tick_idle(os_time_t ticks)
 
     suspended = true;
     sigemptyset(&suspsigs);
-    sigsuspend(&nosigs);        /* Wait for a signal to wake us up */
+    fd_ready = sim_irq_fd_wait(&nosigs);    /* Wait for a signal or fd */
     suspended = false;
 
     /*
@@ -194,9 +195,12 @@ sim_tick_idle(os_time_t ticks)
      * The SIGALRM handler is called before any other handlers to ensure that
      * OS time is always correct.
      */
-    if (sigismember(&suspsigs, SIGALRM)) {
+    if (sigismember(&suspsigs, SIGALRM) || fd_ready) {
         sim_tick();
     }
+    if (fd_ready) {
+        sim_irq_fd_run();
+    }
     for (i = 0; i < NUMSIGS; i++) {
         sig = signals[i].num;
         handler = signals[i].handler;
@@ -25,6 +25,9 @@
 
 #include <flash_map/flash_map.h>
 #include <hal/hal_bsp.h>
+#if MYNEWT_VAL(HAL_FLASH_ASYNC)
+#include <hal/hal_flash_async.h>
+#endif
 
 #include <shell/shell.h>
 
@@ -195,6 +198,29 @@ imgr_cli_confirm(struct streamer *streamer)
     }
 }
 
+#if MYNEWT_VAL(HAL_FLASH_ASYNC)
+/*
+ * Erasing a whole slot takes seconds on some parts; it is left to the flash
+ * worker task so the shell stays responsive.  The result is reported on the
+ * console when done.
+ */
+static struct hal_flash_op imgr_cli_erase_op;
+
+static void
+imgr_cli_erase_done(struct os_event *ev)
+{
+    struct hal_flash_op *op;
+
+    op = ev->ev_arg;
+    if (op->hfo_rc) {
+        streamer_printf(streamer_console_get(),
+                        "Error erasing area rc=%d\n", op->hfo_rc);
+    } else {
+        streamer_printf(streamer_console_get(), "Erase done\n");
+    }
+}
+#endif
+
 static void
 imgr_cli_erase(struct streamer *streamer)
 {
@@ -209,7 +235,21 @@ imgr_cli_erase(struct streamer *streamer)
             streamer_printf(streamer, "Error opening area %d\n", area_id);
             return;
         }
+#if MYNEWT_VAL(HAL_FLASH_ASYNC)
+        if (hal_flash_op_busy(&imgr_cli_erase_op)) {
+            streamer_printf(streamer, "Erase already in progress\n");
+            flash_area_close(fa);
+            return;
+        }
+        hal_flash_op_init(&imgr_cli_erase_op, os_eventq_dflt_get(),
+                          imgr_cli_erase_done, &imgr_cli_erase_op);
+        rc = flash_area_erase_async(fa, 0, fa->fa_size, &imgr_cli_erase_op);
+        if (rc == 0) {
+            streamer_printf(streamer, "Erasing area %d\n", area_id);
+        }
+#else
         rc = flash_area_erase(fa, 0, fa->fa_size);
+#endif
         flash_area_close(fa);
         if (rc) {
             streamer_printf(streamer, "Error erasing area rc=%d\n", rc);
@@ -93,6 +93,59 @@ smp_def_console_echo(struct mgmt_ctxt *cb)
     return (0);
 }
 
+#if MYNEWT_VAL(MSYS_STATS)
+/**
+ * Encodes the msys allocation counters as an array of maps, one per pool,
+ * ordered by block size.
+ */
+static CborError
+smp_def_msys_stats_encode(CborEncoder *enc)
+{
+    struct os_msys_info omsi;
+    CborError g_err = CborNoError;
+    CborEncoder pools;
+    CborEncoder pool;
+    CborEncoder hist;
+    int i;
+    int j;
+
+    g_err |= cbor_encode_text_stringz(enc, "msys");
+    g_err |= cbor_encoder_create_array(enc, &pools, CborIndefiniteLength);
+
+    for (i = 0; os_msys_info_get(i, &omsi) == 0; i++) {
+        g_err |= cbor_encoder_create_map(&pools, &pool, CborIndefiniteLength);
+        g_err |= cbor_encode_text_stringz(&pool, "blksiz");
+        g_err |= cbor_encode_uint(&pool, omsi.omsi_databuf_len);
+        g_err |= cbor_encode_text_stringz(&pool, "reqs");
+        g_err |= cbor_encode_uint(&pool, omsi.omsi_stats.oms_reqs);
+        g_err |= cbor_encode_text_stringz(&pool, "blocks");
+        g_err |= cbor_encode_uint(&pool, omsi.omsi_stats.oms_blocks);
+        g_err |= cbor_encode_text_stringz(&pool, "chains");
+        g_err |= cbor_encode_uint(&pool, omsi.omsi_stats.oms_chains);
+        g_err |= cbor_encode_text_stringz(&pool, "fallbacks");
+        g_err |= cbor_encode_uint(&pool, omsi.omsi_stats.oms_fallbacks);
+        g_err |= cbor_encode_text_stringz(&pool, "failures");
+        g_err |= cbor_encode_uint(&pool, omsi.omsi_stats.oms_failures);
+        g_err |= cbor_encode_text_stringz(&pool, "reqbytes");
+        g_err |= cbor_encode_uint(&pool, omsi.omsi_stats.oms_req_bytes);
+
+        /* Bucket n counts requests below 32 << n bytes. */
+        g_err |= cbor_encode_text_stringz(&pool, "hist");
+        g_err |= cbor_encoder_create_array(&pool, &hist, OS_MSYS_HIST_BUCKETS);
+        for (j = 0; j < OS_MSYS_HIST_BUCKETS; j++) {
+            g_err |= cbor_encode_uint(&hist, omsi.omsi_stats.oms_hist[j]);
+        }
+        g_err |= cbor_encoder_close_container(&pool, &hist);
+
+        g_err |= cbor_encoder_close_container(&pools, &pool);
+    }
+
+    g_err |= cbor_encoder_close_container(enc, &pools);
+
+    return g_err;
+}
+#endif
+
 static int
 smp_def_mpstat_read(struct mgmt_ctxt *cb)
 {
@@ -130,6 +183,10 @@ smp_def_mpstat_read(struct mgmt_ctxt *cb)
 
     g_err |= cbor_encoder_close_container(&cb->encoder, &pools);
 
+#if MYNEWT_VAL(MSYS_STATS)
+    g_err |= smp_def_msys_stats_encode(&cb->encoder);
+#endif
+
     if (g_err) {
         return MGMT_ERR_ENOMEM;
     }
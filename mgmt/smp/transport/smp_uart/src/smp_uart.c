@@ -220,7 +220,8 @@ smp_uart_tx_char(void *arg)
         }
     }
 
-    os_mbuf_copydata(sus->sus_tx, sus->sus_tx_off++, 1, &ch);
+    /* The loop above leaves sus_tx_off inside the current mbuf. */
+    ch = sus->sus_tx->om_data[sus->sus_tx_off++];
 
     return ch;
 }
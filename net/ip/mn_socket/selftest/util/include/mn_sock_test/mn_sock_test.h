@@ -29,10 +29,14 @@
 
 extern struct os_sem test_sem;
 
+TEST_SUITE_DECL(mn_socket_test_all);
+
 void sock_open_close(void);
 void sock_listen(void);
 void sock_tcp_connect(void);
 void sock_udp_data(void);
+void sock_udp_large(void);
+void sock_udp_chain(void);
 void sock_tcp_data(void);
 void sock_itf_list(void);
 void sock_udp_ll(void);
@@ -24,7 +24,7 @@
 #include "testutil/testutil.h"
 
 #include "mn_socket/mn_socket.h"
-#include "mn_sock_test.h"
+#include "mn_sock_test/mn_sock_test.h"
 
 #define MB_CNT 10
 #define MB_SZ  512
@@ -47,7 +47,7 @@ mn_socket_test_init(void *arg)
     TEST_ASSERT_FATAL(rc == 0);
 
     rc = os_mbuf_pool_init(&test_mbuf_pool, &test_mbuf_mpool,
-                           MB_CNT, MB_CNT);
+                           MB_SZ, MB_CNT);
     TEST_ASSERT_FATAL(rc == 0);
 
     rc = os_msys_register(&test_mbuf_pool);
@@ -63,10 +63,3 @@ TEST_SUITE(mn_socket_test_all)
     inet_ntop_test();
     socket_tests();
 }
-
-int
-main(int argc, char **argv)
-{
-    mn_socket_test_all();
-    return tu_any_failed;
-}
@@ -277,6 +277,160 @@ sock_udp_data(void)
     mn_close(sock2);
 }
 
+/*
+ * Datagram which spans several msys buffers, and is larger than the default
+ * 2kB limit native sockets used to have.
+ */
+void
+sock_udp_large(void)
+{
+    struct mn_socket *sock1;
+    struct mn_socket *sock2;
+    struct mn_sockaddr_in msin;
+    struct mn_sockaddr_in msin2;
+    int rc;
+    int i;
+    union mn_socket_cb sock_cbs = {
+        .socket.readable = sud_readable
+    };
+    struct os_mbuf *m;
+    uint8_t data[2200];
+
+    for (i = 0; i < sizeof(data); i++) {
+        data[i] = i;
+    }
+
+    rc = mn_socket(&sock1, MN_PF_INET, MN_SOCK_DGRAM, 0);
+    TEST_ASSERT(rc == 0);
+    mn_socket_set_cbs(sock1, NULL, &sock_cbs);
+
+    rc = mn_socket(&sock2, MN_PF_INET, MN_SOCK_DGRAM, 0);
+    TEST_ASSERT(rc == 0);
+
+    msin.msin_family = MN_PF_INET;
+    msin.msin_len = sizeof(msin);
+    msin.msin_port = htons(12446);
+
+    mn_inet_pton(MN_PF_INET, "127.0.0.1", &msin.msin_addr);
+
+    rc = mn_bind(sock1, (struct mn_sockaddr *)&msin);
+    TEST_ASSERT(rc == 0);
+
+    m = os_msys_get_pkthdr(sizeof(data), 0);
+    TEST_ASSERT(m);
+    rc = os_mbuf_append(m, data, sizeof(data));
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(SLIST_NEXT(m, om_next) != NULL);
+    rc = mn_sendto(sock2, m, (struct mn_sockaddr *)&msin);
+    TEST_ASSERT(rc == 0);
+
+    rc = os_sem_pend(&test_sem, OS_TICKS_PER_SEC);
+    TEST_ASSERT(rc == 0);
+
+    rc = mn_recvfrom(sock1, &m, (struct mn_sockaddr *)&msin2);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(m != NULL);
+    if (m) {
+        TEST_ASSERT(OS_MBUF_IS_PKTHDR(m));
+        TEST_ASSERT(OS_MBUF_PKTLEN(m) == sizeof(data));
+        TEST_ASSERT(os_mbuf_cmpf(m, 0, data, sizeof(data)) == 0);
+        os_mbuf_free_chain(m);
+    }
+
+    mn_close(sock1);
+    mn_close(sock2);
+}
+
+#if MYNEWT_VAL(MSYS_CHAIN_FALLBACK)
+#define SUC_BIG_SZ  2400
+static os_membuf_t suc_big_area[OS_MEMPOOL_SIZE(1, SUC_BIG_SZ)];
+static struct os_mempool suc_big_mpool;
+static struct os_mbuf_pool suc_big_pool;
+
+/*
+ * Receives a datagram into an msys chain.  The only pool big enough for it is
+ * busy, so msys hands out chains of empty mbufs from the smaller pool.  All
+ * of the chain must be used, and nothing may leak.
+ */
+void
+sock_udp_chain(void)
+{
+    struct mn_socket *sock1;
+    struct mn_socket *sock2;
+    struct mn_sockaddr_in msin;
+    struct mn_sockaddr_in msin2;
+    int rc;
+    int i;
+    union mn_socket_cb sock_cbs = {
+        .socket.readable = sud_readable
+    };
+    struct os_mbuf *big;
+    struct os_mbuf *m;
+    int num_free;
+    uint8_t data[2200];
+
+    rc = os_mempool_init(&suc_big_mpool, 1, SUC_BIG_SZ, suc_big_area,
+                         "mb_big");
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = os_mbuf_pool_init(&suc_big_pool, &suc_big_mpool, SUC_BIG_SZ, 1);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = os_msys_register(&suc_big_pool);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    big = os_msys_get_pkthdr(sizeof(data), 0);
+    TEST_ASSERT_FATAL(big != NULL && big->om_omp == &suc_big_pool);
+
+    for (i = 0; i < sizeof(data); i++) {
+        data[i] = i;
+    }
+
+    rc = mn_socket(&sock1, MN_PF_INET, MN_SOCK_DGRAM, 0);
+    TEST_ASSERT(rc == 0);
+    mn_socket_set_cbs(sock1, NULL, &sock_cbs);
+
+    rc = mn_socket(&sock2, MN_PF_INET, MN_SOCK_DGRAM, 0);
+    TEST_ASSERT(rc == 0);
+
+    msin.msin_family = MN_PF_INET;
+    msin.msin_len = sizeof(msin);
+    msin.msin_port = htons(12447);
+
+    mn_inet_pton(MN_PF_INET, "127.0.0.1", &msin.msin_addr);
+
+    rc = mn_bind(sock1, (struct mn_sockaddr *)&msin);
+    TEST_ASSERT(rc == 0);
+
+    num_free = os_msys_num_free();
+
+    m = os_msys_get_pkthdr(sizeof(data), 0);
+    TEST_ASSERT(m);
+    rc = os_mbuf_append(m, data, sizeof(data));
+    TEST_ASSERT(rc == 0);
+    rc = mn_sendto(sock2, m, (struct mn_sockaddr *)&msin);
+    TEST_ASSERT(rc == 0);
+
+    rc = os_sem_pend(&test_sem, OS_TICKS_PER_SEC);
+    TEST_ASSERT(rc == 0);
+
+    rc = mn_recvfrom(sock1, &m, (struct mn_sockaddr *)&msin2);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(m != NULL);
+    if (m) {
+        TEST_ASSERT(OS_MBUF_IS_PKTHDR(m));
+        TEST_ASSERT(SLIST_NEXT(m, om_next) != NULL);
+        TEST_ASSERT(OS_MBUF_PKTLEN(m) == sizeof(data));
+        TEST_ASSERT(os_mbuf_cmpf(m, 0, data, sizeof(data)) == 0);
+        os_mbuf_free_chain(m);
+    }
+    TEST_ASSERT(os_msys_num_free() == num_free);
+
+    mn_close(sock1);
+    mn_close(sock2);
+
+    os_mbuf_free_chain(big);
+}
+#endif
+
 void
 std_writable(void *cb_arg, int err)
 {
@@ -16,7 +16,7 @@
  * specific language governing permissions and limitations
  * under the License.
  */
-#include "mn_sock_test.h"
+#include "mn_sock_test/mn_sock_test.h"
 
 TEST_CASE_SELF(inet6_pton_test)
 {
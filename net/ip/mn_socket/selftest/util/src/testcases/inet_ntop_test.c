@@ -17,7 +17,7 @@
  * under the License.
  */
 
-#include "mn_sock_test.h"
+#include "mn_sock_test/mn_sock_test.h"
 
 TEST_CASE_SELF(inet_ntop_test)
 {
@@ -17,7 +17,7 @@
  * under the License.
  */
 
-#include "mn_sock_test.h"
+#include "mn_sock_test/mn_sock_test.h"
 
 TEST_CASE_TASK(socket_tests)
 {
@@ -27,9 +27,14 @@ TEST_CASE_TASK(socket_tests)
     sock_listen();
     sock_tcp_connect();
     sock_udp_data();
+    sock_udp_large();
     sock_tcp_data();
     sock_itf_list();
     sock_udp_ll();
     sock_udp_mcast_v4();
     sock_udp_mcast_v6();
+#if MYNEWT_VAL(MSYS_CHAIN_FALLBACK)
+    /* Last, it leaves a pool registered. */
+    sock_udp_chain();
+#endif
 }
@@ -27,10 +27,16 @@
 #include <fcntl.h>
 #include <sys/ioctl.h>
 #include <sys/un.h>
+#include <sys/uio.h>
 #include <stdio.h>
 #include <signal.h>
+#include <limits.h>
+#ifdef MN_LINUX
+#include <sys/epoll.h>
+#endif
 
 #include "os/mynewt.h"
+#include "sim/sim.h"
 #include "mn_socket/mn_socket.h"
 #include "mn_socket/mn_socket_ops.h"
 #include "native_sockets/native_sock.h"
@@ -39,6 +45,13 @@
 
 OS_TASK_STACK_DEFINE(native_sock_stack, MYNEWT_VAL(NATIVE_SOCKETS_STACK_SZ));
 
+/* Maximum number of mbufs in a chain passed to or from the host in one go. */
+#ifdef IOV_MAX
+#define NATIVE_SOCK_IOV_MAX     IOV_MAX
+#else
+#define NATIVE_SOCK_IOV_MAX     1024
+#endif
+
 static struct native_sock {
     struct mn_socket ns_sock;
     int ns_fd;
@@ -47,16 +60,33 @@ static struct native_sock {
     unsigned int ns_listen:1;
     uint8_t ns_type;
     uint8_t ns_pf;
+#ifdef MN_LINUX
+    uint32_t ns_events;         /* Events registered with epoll. */
+    unsigned int ns_rx_pend:1;  /* Readable reported, not yet received;
+                                   for listeners, accept is out of room. */
+#endif
     struct os_sem ns_sem;
     STAILQ_HEAD(, os_mbuf_pkthdr) ns_rx;
     struct os_mbuf *ns_tx;
 } native_socks[MYNEWT_VAL(NATIVE_SOCKETS_MAX)];
 
+/*
+ * On Linux the sockets are kept in an epoll set, which the idle task waits on
+ * as an interrupt source.  Elsewhere the socket task polls them periodically.
+ */
 static struct native_sock_state {
+#ifdef MN_LINUX
+    int epoll_fd;
+    struct sim_irq_fd irq_fd;
+    struct os_sem sem;
+#else
     struct pollfd poll_fds[MYNEWT_VAL(NATIVE_SOCKETS_MAX)];
     int poll_fd_cnt;
+#endif
     struct os_mutex mtx;
     struct os_task task;
+    /* Describes mbuf chains to the host; protected by mtx. */
+    struct iovec iov[NATIVE_SOCK_IOV_MAX];
 } native_sock_state;
 
 static const struct mn_socket_ops native_sock_ops = {
@@ -89,14 +119,64 @@ native_get_sock(void)
     for (i = 0; i < MYNEWT_VAL(NATIVE_SOCKETS_MAX); i++) {
         if (native_socks[i].ns_fd < 0) {
             ns = &native_socks[i];
+            ns->ns_connect = 0;
             ns->ns_poll = 0;
             ns->ns_listen = 0;
+#ifdef MN_LINUX
+            ns->ns_events = 0;
+            ns->ns_rx_pend = 0;
+#endif
             return ns;
         }
     }
     return NULL;
 }
 
+#ifdef MN_LINUX
+/*
+ * Brings the epoll registration of a socket in line with its state.  Once a
+ * socket has been reported readable it is not polled for readability again
+ * until the application receives from it; the registration is level-triggered
+ * and would otherwise keep waking the idle task until then.  Writability is
+ * only of interest while a connect or a stream transmit is pending, for the
+ * same reason.
+ */
+static void
+native_sock_poll_update(struct native_sock_state *nss, struct native_sock *ns)
+{
+    struct epoll_event ev;
+    uint32_t events;
+    int op;
+    int rc;
+
+    os_mutex_pend(&nss->mtx, OS_WAIT_FOREVER);
+    events = 0;
+    if (ns->ns_fd >= 0 && ns->ns_poll) {
+        if (!ns->ns_rx_pend) {
+            events = EPOLLIN;
+        }
+        if (ns->ns_connect || ns->ns_tx) {
+            events |= EPOLLOUT;
+        }
+    }
+    if (events != ns->ns_events) {
+        if (events == 0) {
+            op = EPOLL_CTL_DEL;
+        } else if (ns->ns_events == 0) {
+            op = EPOLL_CTL_ADD;
+        } else {
+            op = EPOLL_CTL_MOD;
+        }
+        memset(&ev, 0, sizeof(ev));
+        ev.events = events;
+        ev.data.ptr = ns;
+        rc = epoll_ctl(nss->epoll_fd, op, ns->ns_fd, &ev);
+        assert(rc == 0);
+        ns->ns_events = events;
+    }
+    os_mutex_release(&nss->mtx);
+}
+#else
 static struct native_sock *
 native_find_sock(int fd)
 {
@@ -135,6 +215,62 @@ native_sock_poll_rebuild(struct native_sock_state *nss)
     os_mutex_release(&nss->mtx);
 }
 
+static void
+native_sock_poll_update(struct native_sock_state *nss, struct native_sock *ns)
+{
+    native_sock_poll_rebuild(nss);
+}
+#endif
+
+/*
+ * Polls a socket for readability again once the application receives from it.
+ * Anything still queued afterwards is reported as a new readable event.
+ */
+static void
+native_sock_rx_rearm(struct native_sock_state *nss, struct native_sock *ns)
+{
+#ifdef MN_LINUX
+    os_mutex_pend(&nss->mtx, OS_WAIT_FOREVER);
+    if (ns->ns_rx_pend) {
+        ns->ns_rx_pend = 0;
+        native_sock_poll_update(nss, ns);
+    }
+    os_mutex_release(&nss->mtx);
+#endif
+}
+
+/*
+ * Stops polling a listening socket while there is no room to accept its
+ * pending connection, so it doesn't keep waking the idle task.  Closing any
+ * socket re-arms it.
+ */
+static void
+native_sock_listen_disarm(struct native_sock_state *nss,
+                          struct native_sock *ns)
+{
+#ifdef MN_LINUX
+    ns->ns_rx_pend = 1;
+    native_sock_poll_update(nss, ns);
+#endif
+}
+
+static void
+native_sock_listen_rearm(struct native_sock_state *nss)
+{
+#ifdef MN_LINUX
+    struct native_sock *ns;
+    int i;
+
+    for (i = 0; i < MYNEWT_VAL(NATIVE_SOCKETS_MAX); i++) {
+        ns = &native_socks[i];
+        if (ns->ns_fd >= 0 && ns->ns_listen && ns->ns_rx_pend) {
+            ns->ns_rx_pend = 0;
+            native_sock_poll_update(nss, ns);
+        }
+    }
+#endif
+}
+
 int
 native_sock_err_to_mn_err(int err)
 {
@@ -325,8 +461,11 @@ native_sock_close(struct mn_socket *s)
     struct os_mbuf_pkthdr *m;
 
     os_mutex_pend(&nss->mtx, OS_WAIT_FOREVER);
+    ns->ns_poll = 0;
+    native_sock_poll_update(nss, ns);
     close(ns->ns_fd);
     ns->ns_fd = -1;
+    native_sock_listen_rearm(nss);
 
     /*
      * When socket is closed, we must free all mbufs which might be
@@ -337,7 +476,7 @@ native_sock_close(struct mn_socket *s)
         os_mbuf_free_chain(OS_MBUF_PKTHDR_TO_MBUF(m));
     }
     os_mbuf_free_chain(ns->ns_tx);
-    native_sock_poll_rebuild(nss);
+    ns->ns_tx = NULL;
     os_mutex_release(&nss->mtx);
     return 0;
 }
@@ -371,7 +510,7 @@ native_sock_connect(struct mn_socket *s, struct mn_sockaddr *addr)
         }
     }
     ns->ns_poll = 1;
-    native_sock_poll_rebuild(nss);
+    native_sock_poll_update(nss, ns);
     os_mutex_release(&nss->mtx);
 
     /* Indicate writability if connection fully established. */
@@ -415,7 +554,7 @@ native_sock_bind(struct mn_socket *s, struct mn_sockaddr *addr)
     }
     if (ns->ns_type == SOCK_DGRAM) {
         ns->ns_poll = 1;
-        native_sock_poll_rebuild(nss);
+        native_sock_poll_update(nss, ns);
     }
     os_mutex_release(&nss->mtx);
     return 0;
@@ -440,15 +579,98 @@ native_sock_listen(struct mn_socket *s, uint8_t qlen)
     }
     ns->ns_poll = 1;
     ns->ns_listen = 1;
-    native_sock_poll_rebuild(nss);
+    native_sock_poll_update(nss, ns);
     os_mutex_release(&nss->mtx);
     return 0;
 }
 
+/*
+ * Describes the data in an mbuf chain with an iovec array, skipping empty
+ * mbufs.  Stops when the array is full.  Returns the number of entries used;
+ * the number of bytes they cover is stored in 'len'.
+ */
+static int
+native_sock_mbuf_to_iov(struct os_mbuf *om, struct iovec *iov, int iov_max,
+                        int *len)
+{
+    int cnt;
+
+    *len = 0;
+    for (cnt = 0; om && cnt < iov_max; om = SLIST_NEXT(om, om_next)) {
+        if (om->om_len == 0) {
+            continue;
+        }
+        iov[cnt].iov_base = om->om_data;
+        iov[cnt].iov_len = om->om_len;
+        *len += om->om_len;
+        cnt++;
+    }
+    return cnt;
+}
+
+/*
+ * Allocates an msys chain with room for 'len' bytes of received data, and
+ * describes it with an iovec array.  The chain already has length 'len'; it
+ * is trimmed once the amount of data actually read is known.
+ */
+static struct os_mbuf *
+native_sock_rx_alloc(int len, struct iovec *iov, int *iov_cnt)
+{
+    struct os_mbuf *om;
+    struct os_mbuf *m;
+    int cnt;
+    int n;
+
+    om = os_msys_get_pkthdr(len, 0);
+    if (!om) {
+        return NULL;
+    }
+    m = om;
+    cnt = 0;
+    while (1) {
+        /*
+         * msys may hand out a chain of empty mbufs; fill the whole chain
+         * before allocating more.
+         */
+        n = min(len, OS_MBUF_TRAILINGSPACE(m));
+        if (n > 0) {
+            if (cnt == NATIVE_SOCK_IOV_MAX) {
+                goto err;
+            }
+            iov[cnt].iov_base = m->om_data + m->om_len;
+            iov[cnt].iov_len = n;
+            cnt++;
+            m->om_len += n;
+            OS_MBUF_PKTHDR(om)->omp_len += n;
+            len -= n;
+        }
+        if (len == 0) {
+            break;
+        }
+        if (!SLIST_NEXT(m, om_next)) {
+            SLIST_NEXT(m, om_next) = os_msys_get(len, 0);
+            if (!SLIST_NEXT(m, om_next)) {
+                goto err;
+            }
+        }
+        m = SLIST_NEXT(m, om_next);
+    }
+    if (SLIST_NEXT(m, om_next)) {
+        /* Unused tail of a preallocated chain. */
+        os_mbuf_free_chain(SLIST_NEXT(m, om_next));
+        SLIST_NEXT(m, om_next) = NULL;
+    }
+    *iov_cnt = cnt;
+    return om;
+err:
+    os_mbuf_free_chain(om);
+    return NULL;
+}
+
 /*
  * TX routine for stream sockets (TCP). The data to send is pointed
  * by ns_tx.
- * Keep sending mbufs until socket says that it can't take anymore.
+ * Keep writing the chain until socket says that it can't take anymore.
  * then wait for send event notification before continuing.
  */
 static int
@@ -457,27 +679,20 @@ native_sock_stream_tx(struct native_sock *ns, int notify)
     struct native_sock_state *nss = &native_sock_state;
     struct os_mbuf *m;
     struct os_mbuf *n;
+    int cnt;
+    int len;
     int rc;
 
     rc = 0;
 
     os_mutex_pend(&nss->mtx, OS_TIMEOUT_NEVER);
-    while (ns->ns_tx && rc == 0) {
-        m = ns->ns_tx;
-        n = SLIST_NEXT(m, om_next);
-
-        errno = 0;
-        rc = write(ns->ns_fd, m->om_data, m->om_len);
-        if (rc == m->om_len) {
-            /* Complete write. */
-            ns->ns_tx = n;
-            os_mbuf_free(m);
-            rc = 0;
-        } else if (rc != -1) {
-            /* Partial write. */
-            os_mbuf_adj(m, m->om_len - rc);
-            rc = 0;
-        } else {
+    while (ns->ns_tx) {
+        cnt = native_sock_mbuf_to_iov(ns->ns_tx, nss->iov,
+                                      NATIVE_SOCK_IOV_MAX, &len);
+        if (cnt > 0) {
+            rc = writev(ns->ns_fd, nss->iov, cnt);
+        }
+        if (rc < 0) {
             /* Error. */
             rc = errno;
             if (rc == EAGAIN) {
@@ -492,7 +707,28 @@ native_sock_stream_tx(struct native_sock *ns, int notify)
             }
             break;
         }
+
+        /* Free the mbufs which were written completely. */
+        m = ns->ns_tx;
+        while (m && m->om_len <= rc) {
+            rc -= m->om_len;
+            n = SLIST_NEXT(m, om_next);
+            os_mbuf_free(m);
+            m = n;
+        }
+        if (m) {
+            /* Partial write. */
+            os_mbuf_adj(m, rc);
+        }
+        ns->ns_tx = m;
+        rc = 0;
+
+        if (cnt < NATIVE_SOCK_IOV_MAX) {
+            /* The whole chain was offered; anything left didn't fit. */
+            break;
+        }
     }
+    native_sock_poll_update(nss, ns);
     os_mutex_release(&nss->mtx);
     if (notify) {
         mn_socket_writable(&ns->ns_sock, rc);
@@ -522,13 +758,13 @@ int
 native_sock_sendto(struct mn_socket *s, struct os_mbuf *m,
   struct mn_sockaddr *addr)
 {
+    struct native_sock_state *nss = &native_sock_state;
     struct native_sock *ns = (struct native_sock *)s;
     struct sockaddr_storage ss;
     struct sockaddr *sa = (struct sockaddr *)&ss;
-    uint8_t tmpbuf[MYNEWT_VAL(NATIVE_SOCKETS_MAX_UDP)];
-    struct os_mbuf *o;
+    struct msghdr msg;
     int sa_len;
-    int off;
+    int len;
     int rc;
 
     if (ns->ns_type == SOCK_DGRAM) {
@@ -536,18 +772,25 @@ native_sock_sendto(struct mn_socket *s, struct os_mbuf *m,
         if (rc) {
             return rc;
         }
-        off = 0;
-        for (o = m; o; o = SLIST_NEXT(o, om_next)) {
-            if (off + o->om_len > sizeof(tmpbuf)) {
-                return MN_ENOBUFS;
-            }
-            os_mbuf_copydata(o, 0, o->om_len, &tmpbuf[off]);
-            off += o->om_len;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_name = sa;
+        msg.msg_namelen = sa_len;
+        msg.msg_iov = nss->iov;
+
+        os_mutex_pend(&nss->mtx, OS_WAIT_FOREVER);
+        msg.msg_iovlen = native_sock_mbuf_to_iov(m, nss->iov,
+                                                 NATIVE_SOCK_IOV_MAX, &len);
+        if (len != os_mbuf_len(m)) {
+            os_mutex_release(&nss->mtx);
+            return MN_ENOBUFS;
         }
-        rc = sendto(ns->ns_fd, tmpbuf, off, 0, sa, sa_len);
-        if (rc != off) {
-            return native_sock_err_to_mn_err(errno);
+        rc = sendmsg(ns->ns_fd, &msg, 0);
+        if (rc != len) {
+            rc = errno;
+            os_mutex_release(&nss->mtx);
+            return native_sock_err_to_mn_err(rc);
         }
+        os_mutex_release(&nss->mtx);
         os_mbuf_free_chain(m);
         return 0;
     } else {
@@ -561,41 +804,112 @@ native_sock_sendto(struct mn_socket *s, struct os_mbuf *m,
     }
 }
 
+/*
+ * Finds out how much to read from a socket, so that received data can go
+ * straight into an mbuf chain of the right size.  For datagram sockets this
+ * is the size of the next datagram; outside Linux it is an upper bound for
+ * it.  Nothing is allocated while there is no data.
+ */
+static int
+native_sock_rx_len(struct native_sock *ns, int *len)
+{
+    uint8_t c;
+    int rc;
+
+#ifdef MN_LINUX
+    if (ns->ns_type == SOCK_DGRAM) {
+        rc = recv(ns->ns_fd, NULL, 0, MSG_PEEK | MSG_TRUNC);
+        if (rc < 0) {
+            return native_sock_err_to_mn_err(errno);
+        }
+        *len = rc;
+        return 0;
+    }
+#endif
+    if (ioctl(ns->ns_fd, FIONREAD, len)) {
+        return native_sock_err_to_mn_err(errno);
+    }
+    if (*len == 0) {
+        /* Nothing queued, a zero-length datagram or the end of a stream. */
+        rc = recv(ns->ns_fd, &c, 1, MSG_PEEK);
+        if (rc < 0) {
+            return native_sock_err_to_mn_err(errno);
+        }
+        if (rc > 0 && ioctl(ns->ns_fd, FIONREAD, len)) {
+            return native_sock_err_to_mn_err(errno);
+        }
+    }
+    if (ns->ns_type == SOCK_STREAM) {
+        /* A read of at least one byte tells EOF apart from no data. */
+        *len = max(*len, 1);
+        *len = min(*len, MYNEWT_VAL(NATIVE_SOCKETS_MAX_UDP));
+    }
+    return 0;
+}
+
 int
 native_sock_recvfrom(struct mn_socket *s, struct os_mbuf **mp,
   struct mn_sockaddr *addr)
 {
+    struct native_sock_state *nss = &native_sock_state;
     struct native_sock *ns = (struct native_sock *)s;
     struct sockaddr_storage ss;
     struct sockaddr *sa = (struct sockaddr *)&ss;
-    uint8_t tmpbuf[MYNEWT_VAL(NATIVE_SOCKETS_MAX_UDP)];
+    struct msghdr msg;
     struct os_mbuf *m;
     socklen_t slen;
+    int avail;
+    int cnt;
     int rc;
 
+    native_sock_rx_rearm(nss, ns);
+
+    rc = native_sock_rx_len(ns, &avail);
+    if (rc != 0) {
+        return rc;
+    }
+
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = nss->iov;
+
+    os_mutex_pend(&nss->mtx, OS_WAIT_FOREVER);
+    m = native_sock_rx_alloc(avail, nss->iov, &cnt);
+    if (!m) {
+        if (ns->ns_type == SOCK_DGRAM) {
+            /* Drop the datagram, it would stay readable otherwise. */
+            recv(ns->ns_fd, NULL, 0, 0);
+        }
+        os_mutex_release(&nss->mtx);
+        return MN_ENOBUFS;
+    }
+    msg.msg_iovlen = cnt;
+
     slen = sizeof(ss);
     if (ns->ns_type == SOCK_DGRAM) {
-        rc = recvfrom(ns->ns_fd, tmpbuf, sizeof(tmpbuf), 0, sa, &slen);
+        msg.msg_name = sa;
+        msg.msg_namelen = slen;
+        rc = recvmsg(ns->ns_fd, &msg, 0);
     } else {
         rc = getpeername(ns->ns_fd, sa, &slen);
         if (rc == 0) {
-            rc = read(ns->ns_fd, tmpbuf, sizeof(tmpbuf));
+            rc = readv(ns->ns_fd, nss->iov, cnt);
         }
     }
     if (rc < 0) {
-        return native_sock_err_to_mn_err(errno);
+        rc = errno;
+        os_mutex_release(&nss->mtx);
+        os_mbuf_free_chain(m);
+        return native_sock_err_to_mn_err(rc);
     }
+    os_mutex_release(&nss->mtx);
     if (ns->ns_type == SOCK_STREAM && rc == 0) {
+        os_mbuf_free_chain(m);
         ns->ns_poll = 0;
-        native_sock_poll_rebuild(&native_sock_state);
+        native_sock_poll_update(nss, ns);
         return MN_ECONNABORTED;
     }
 
-    m = os_msys_get_pkthdr(rc, 0);
-    if (!m) {
-        return MN_ENOBUFS;
-    }
-    os_mbuf_copyinto(m, 0, tmpbuf, rc);
+    os_mbuf_adj(m, rc - OS_MBUF_PKTLEN(m));
     *mp = m;
     if (addr) {
         native_sock_addr_to_mn_addr(sa, addr);
@@ -738,21 +1052,146 @@ native_sock_getpeername(struct mn_socket *s, struct mn_sockaddr *addr)
 }
 
 /*
- * XXX should do this task with SIGIO as well.
+ * Handles readiness of a socket.  Called by the socket task with the state
+ * mutex held.
  */
 static void
-socket_task(void *arg)
+native_sock_event(struct native_sock_state *nss, struct native_sock *ns,
+                  int readable, int writable)
 {
-    struct native_sock_state *nss = arg;
-    struct native_sock *ns, *new_ns;
+    struct native_sock *new_ns;
     struct sockaddr_storage ss;
     struct sockaddr *sa = (struct sockaddr *)&ss;
-    int revents;
-    int i;
     socklen_t slen;
     int sock_err;
     int rc;
 
+    if (readable) {
+        if (ns->ns_listen) {
+            new_ns = native_get_sock();
+            if (!new_ns) {
+                native_sock_listen_disarm(nss, ns);
+                return;
+            }
+            slen = sizeof(ss);
+            new_ns->ns_fd = accept(ns->ns_fd, sa, &slen);
+            if (new_ns->ns_fd < 0) {
+                if (errno == EMFILE || errno == ENFILE ||
+                    errno == ENOBUFS || errno == ENOMEM) {
+                    native_sock_listen_disarm(nss, ns);
+                }
+                return;
+            }
+            new_ns->ns_type = ns->ns_type;
+            new_ns->ns_sock.ms_ops = &native_sock_ops;
+            native_sock_set_nonblocking(new_ns);
+
+            os_mutex_release(&nss->mtx);
+            if (mn_socket_newconn(&ns->ns_sock, &new_ns->ns_sock)) {
+                /*
+                 * should close
+                 */
+            }
+            os_mutex_pend(&nss->mtx, OS_WAIT_FOREVER);
+            new_ns->ns_poll = 1;
+            native_sock_poll_update(nss, new_ns);
+        } else {
+#ifdef MN_LINUX
+            ns->ns_rx_pend = 1;
+            native_sock_poll_update(nss, ns);
+#endif
+            mn_socket_readable(&ns->ns_sock, 0);
+        }
+    }
+
+    if (writable) {
+        if (ns->ns_connect) {
+            /*
+             * The connection attempt has completed.  Report whether it
+             * succeeded.
+             */
+            ns->ns_connect = 0;
+            native_sock_poll_update(nss, ns);
+
+            slen = sizeof(sock_err);
+            rc = getsockopt(ns->ns_fd, SOL_SOCKET, SO_ERROR,
+                            &sock_err, &slen);
+            if (rc != 0) {
+                rc = native_sock_err_to_mn_err(errno);
+            } else if (sock_err != 0) {
+                rc = native_sock_err_to_mn_err(sock_err);
+            }
+            mn_socket_writable(&ns->ns_sock, rc);
+        } else if (ns->ns_type == SOCK_STREAM && ns->ns_tx) {
+            native_sock_stream_tx(ns, 1);
+        }
+    }
+}
+
+#ifdef MN_LINUX
+/*
+ * Called by the idle task, with interrupts disabled, when the epoll set has
+ * pending events.
+ */
+static void
+native_sock_irq(void *arg)
+{
+    struct native_sock_state *nss = arg;
+
+    if (os_sem_get_count(&nss->sem) == 0) {
+        os_sem_release(&nss->sem);
+    }
+}
+
+static void
+socket_task(void *arg)
+{
+    struct native_sock_state *nss = arg;
+    struct epoll_event events[MYNEWT_VAL(NATIVE_SOCKETS_MAX)];
+    struct native_sock *ns;
+    uint32_t revents;
+    int cnt;
+    int i;
+
+    os_mutex_pend(&nss->mtx, OS_WAIT_FOREVER);
+    while (1) {
+        os_mutex_release(&nss->mtx);
+        /*
+         * Events are signalled by the idle task.  The timeout only matters if
+         * the system is kept too busy to ever go idle.
+         */
+        os_sem_pend(&nss->sem, os_time_ms_to_ticks32(
+                        MYNEWT_VAL(NATIVE_SOCKETS_POLL_INTERVAL_MS)));
+        os_mutex_pend(&nss->mtx, OS_WAIT_FOREVER);
+
+        cnt = epoll_wait(nss->epoll_fd, events,
+                         MYNEWT_VAL(NATIVE_SOCKETS_MAX), 0);
+        for (i = 0; i < cnt; i++) {
+            ns = events[i].data.ptr;
+            if (ns->ns_events == 0) {
+                /* Closed by a callback of an earlier event. */
+                continue;
+            }
+
+            /* Errors are reported through the read or connect paths. */
+            revents = events[i].events;
+            if (revents & (EPOLLERR | EPOLLHUP)) {
+                revents |= ns->ns_events;
+            }
+            native_sock_event(nss, ns, revents & EPOLLIN, revents & EPOLLOUT);
+        }
+    }
+}
+#else
+static void
+socket_task(void *arg)
+{
+    struct native_sock_state *nss = arg;
+    struct native_sock *ns;
+    int revents;
+    int i;
+    int rc;
+
     os_mutex_pend(&nss->mtx, OS_WAIT_FOREVER);
     while (1) {
         os_mutex_release(&nss->mtx);
@@ -777,59 +1216,11 @@ socket_task(void *arg)
             ns = native_find_sock(nss->poll_fds[i].fd);
             assert(ns);
 
-            if (revents & POLLIN) {
-                if (ns->ns_listen) {
-                    new_ns = native_get_sock();
-                    if (!new_ns) {
-                        continue;
-                    }
-                    slen = sizeof(ss);
-                    new_ns->ns_fd = accept(ns->ns_fd, sa, &slen);
-                    if (new_ns->ns_fd < 0) {
-                        continue;
-                    }
-                    new_ns->ns_type = ns->ns_type;
-                    new_ns->ns_sock.ms_ops = &native_sock_ops;
-                    native_sock_set_nonblocking(new_ns);
-
-                    os_mutex_release(&nss->mtx);
-                    if (mn_socket_newconn(&ns->ns_sock, &new_ns->ns_sock)) {
-                        /*
-                         * should close
-                         */
-                    }
-                    os_mutex_pend(&nss->mtx, OS_WAIT_FOREVER);
-                    new_ns->ns_poll = 1;
-                    native_sock_poll_rebuild(nss);
-                } else {
-                    mn_socket_readable(&ns->ns_sock, 0);
-                }
-            }
-
-            if (revents & POLLOUT) {
-                if (ns->ns_connect) {
-                    /*
-                     * The connection attempt has completed.  Report whether it
-                     * succeeded.
-                     */
-                    ns->ns_connect = 0;
-
-                    slen = sizeof(sock_err);
-                    rc = getsockopt(ns->ns_fd, SOL_SOCKET, SO_ERROR,
-                                    &sock_err, &slen);
-                    if (rc != 0) {
-                        rc = native_sock_err_to_mn_err(errno);
-                    } else if (sock_err != 0) {
-                        rc = native_sock_err_to_mn_err(sock_err);
-                    }
-                    mn_socket_writable(&ns->ns_sock, rc);
-                } else if (ns->ns_type == SOCK_STREAM && ns->ns_tx) {
-                    native_sock_stream_tx(ns, 1);
-                }
-            }
+            native_sock_event(nss, ns, revents & POLLIN, revents & POLLOUT);
         }
     }
 }
+#endif
 
 int
 native_sock_init(void)
@@ -846,6 +1237,17 @@ native_sock_init(void)
     }
 
     os_mutex_init(&nss->mtx);
+#ifdef MN_LINUX
+    nss->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (nss->epoll_fd < 0) {
+        return -1;
+    }
+    os_sem_init(&nss->sem, 0);
+    nss->irq_fd.sif_fd = nss->epoll_fd;
+    nss->irq_fd.sif_cb = native_sock_irq;
+    nss->irq_fd.sif_arg = nss;
+    sim_irq_fd_add(&nss->irq_fd);
+#endif
     i = os_task_init(&nss->task, "socket", socket_task, &native_sock_state,
                      MYNEWT_VAL(NATIVE_SOCKETS_PRIO), OS_WAIT_FOREVER, native_sock_stack,
                      MYNEWT_VAL(NATIVE_SOCKETS_STACK_SZ));
@@ -21,6 +21,8 @@
 
 #include <fcb/fcb.h>
 
+#include "os/mynewt.h"
+
 #include "config/config.h"
 #include "config/config_store.h"
 
@@ -28,9 +30,26 @@
 extern "C" {
 #endif
 
+#if MYNEWT_VAL(CONFIG_FCB_INDEX)
+/*
+ * Location of the latest value of a setting in the config FCB.
+ */
+struct conf_fcb_idx_entry {
+    uint32_t cie_hash;
+    struct flash_area *cie_area;
+    uint32_t cie_data_off;
+    uint16_t cie_data_len;
+};
+#endif
+
 struct conf_fcb {
     struct conf_store cf_store;
     struct fcb cf_fcb;
+#if MYNEWT_VAL(CONFIG_FCB_INDEX)
+    /* Open addressed hash table, indexed by setting name hash. */
+    struct conf_fcb_idx_entry cf_idx[MYNEWT_VAL(CONFIG_FCB_INDEX_SIZE)];
+    uint8_t cf_idx_state;
+#endif
 };
 
 /**
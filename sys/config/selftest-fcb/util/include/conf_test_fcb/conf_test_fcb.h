@@ -27,7 +27,7 @@
 #include <fcb/fcb.h>
 #include <config/config.h>
 #include <config/config_fcb.h>
-#include "config_priv.h"
+#include "config/../../src/config_priv.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -97,6 +97,12 @@ TEST_CASE_DECL(config_test_compress_reset)
 TEST_CASE_DECL(config_test_save_one_fcb)
 TEST_CASE_DECL(config_test_custom_compress)
 TEST_CASE_DECL(config_test_get_stored_fcb)
+TEST_CASE_DECL(config_test_fcb_index)
+
+TEST_SUITE_DECL(config_test_c0);
+TEST_SUITE_DECL(config_test_c1);
+TEST_SUITE_DECL(config_test_c2);
+TEST_SUITE_DECL(config_test_c3);
 
 #ifdef __cplusplus
 }
@@ -27,8 +27,8 @@
 #include "config/config.h"
 #include "config/config_file.h"
 #include "config/config_fcb.h"
-#include "config_priv.h"
-#include "conf_test_fcb.h"
+#include "config/../../src/config_priv.h"
+#include "conf_test_fcb/conf_test_fcb.h"
 
 char val_string[CONF_TEST_FCB_VAL_STR_CNT][CONF_MAX_VAL_LEN];
 
@@ -392,15 +392,6 @@ TEST_SUITE(config_test_c3)
 
     config_test_compress_reset();
     config_test_custom_compress();
-}
-
-int
-main(int argc, char **argv)
-{
-    config_test_c0();
-    config_test_c1();
-    config_test_c2();
-    config_test_c3();
 
-    return tu_any_failed;
+    config_test_fcb_index();
 }
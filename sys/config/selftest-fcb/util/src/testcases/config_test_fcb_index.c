@@ -0,0 +1,167 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "conf_test_fcb/conf_test_fcb.h"
+
+#define CONF_TEST_FCB_IDX_NAMES     40
+#define CONF_TEST_FCB_IDX_ROUNDS    100
+
+static void
+config_test_fcb_index_name(char *name, int len, int i)
+{
+    /*
+     * Mix in names longer than one flash read chunk, and names which are
+     * prefixes of others.
+     */
+    if (i % 2) {
+        snprintf(name, len, "idx/a_long_setting_name_spanning_chunks/%d", i);
+    } else {
+        snprintf(name, len, "idx/%d", i);
+    }
+}
+
+static void
+config_test_fcb_index_verify(int num, int round, int skip)
+{
+    char name[CONF_MAX_NAME_LEN];
+    char val[16];
+    int rc;
+    int i;
+
+    for (i = 0; i < num; i++) {
+        config_test_fcb_index_name(name, sizeof(name), i);
+        rc = conf_get_stored_value(name, val, sizeof(val));
+        if (i == skip) {
+            TEST_ASSERT(rc == OS_ENOENT);
+        } else {
+            TEST_ASSERT(rc == 0);
+            TEST_ASSERT(atoi(val) == round * 1000 + i);
+        }
+    }
+}
+
+static int
+config_test_fcb_index_filter(const char *name, const char *val, void *arg)
+{
+    return !strcmp(name, "idx/0");
+}
+
+static void
+config_test_fcb_index_setup(struct conf_fcb *cf)
+{
+    int rc;
+
+    config_wipe_srcs();
+    config_wipe_fcb(fcb_areas, sizeof(fcb_areas) / sizeof(fcb_areas[0]));
+
+    memset(cf, 0, sizeof(*cf));
+    cf->cf_fcb.f_magic = MYNEWT_VAL(CONFIG_FCB_MAGIC);
+    cf->cf_fcb.f_sectors = fcb_areas;
+    cf->cf_fcb.f_sector_cnt = sizeof(fcb_areas) / sizeof(fcb_areas[0]);
+
+    rc = conf_fcb_src(cf);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = conf_fcb_dst(cf);
+    TEST_ASSERT_FATAL(rc == 0);
+}
+
+static void
+config_test_fcb_index_save(int num, int round)
+{
+    char name[CONF_MAX_NAME_LEN];
+    char val[16];
+    int rc;
+    int i;
+
+    for (i = 0; i < num; i++) {
+        config_test_fcb_index_name(name, sizeof(name), i);
+        snprintf(val, sizeof(val), "%d", round * 1000 + i);
+        rc = conf_save_one(name, val);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+}
+
+TEST_CASE_SELF(config_test_fcb_index)
+{
+    static struct conf_fcb cf;
+    struct flash_area *oldest;
+    struct fcb_entry active;
+    int rotations;
+    int round;
+    int rc;
+    int i;
+
+    config_test_fcb_index_setup(&cf);
+
+    /*
+     * Keep overwriting the same settings until the FCB has been compressed
+     * a couple of times; the latest values must always be found.
+     */
+    rotations = 0;
+    oldest = cf.cf_fcb.f_oldest;
+    for (round = 0; round < CONF_TEST_FCB_IDX_ROUNDS; round++) {
+        config_test_fcb_index_save(CONF_TEST_FCB_IDX_NAMES, round);
+        if (cf.cf_fcb.f_oldest != oldest) {
+            oldest = cf.cf_fcb.f_oldest;
+            rotations++;
+        }
+        if (round % 10 == 0) {
+            config_test_fcb_index_verify(CONF_TEST_FCB_IDX_NAMES, round, -1);
+        }
+    }
+    round--;
+    TEST_ASSERT(rotations >= 2);
+    config_test_fcb_index_verify(CONF_TEST_FCB_IDX_NAMES, round, -1);
+
+    /*
+     * Saving the current values again must not append anything.
+     */
+    active = cf.cf_fcb.f_active;
+    config_test_fcb_index_save(CONF_TEST_FCB_IDX_NAMES, round);
+    TEST_ASSERT(cf.cf_fcb.f_active.fe_area == active.fe_area);
+    TEST_ASSERT(cf.cf_fcb.f_active.fe_elem_off == active.fe_elem_off);
+
+    /*
+     * Settings dropped by a custom compression are gone.
+     */
+    for (i = 0; i < cf.cf_fcb.f_sector_cnt - 1; i++) {
+        conf_fcb_compress(&cf, config_test_fcb_index_filter, NULL);
+    }
+    config_test_fcb_index_verify(CONF_TEST_FCB_IDX_NAMES, round, 0);
+
+    /*
+     * The index is rebuilt when the FCB is mounted again.
+     */
+    config_wipe_srcs();
+    rc = conf_fcb_src(&cf);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = conf_fcb_dst(&cf);
+    TEST_ASSERT_FATAL(rc == 0);
+    config_test_fcb_index_verify(CONF_TEST_FCB_IDX_NAMES, round, 0);
+
+#if MYNEWT_VAL(CONFIG_FCB_INDEX)
+    /*
+     * More settings than index slots; lookups fall back to walking the FCB.
+     */
+    config_test_fcb_index_setup(&cf);
+    config_test_fcb_index_save(MYNEWT_VAL(CONFIG_FCB_INDEX_SIZE) + 8, 2);
+    config_test_fcb_index_verify(MYNEWT_VAL(CONFIG_FCB_INDEX_SIZE) + 8, 2, -1);
+#endif
+}
@@ -16,7 +16,7 @@
  * specific language governing permissions and limitations
  * under the License.
  */
-#include "conf_test_fcb.h"
+#include "conf_test_fcb/conf_test_fcb.h"
 
 TEST_CASE_SELF(config_test_save_3_fcb)
 {
@@ -33,9 +33,22 @@
 
 #define CONF_FCB_VERS		1
 
+#if MYNEWT_VAL(CONFIG_FCB_INDEX)
+/* cf_idx_state values. */
+#define CONF_FCB_IDX_NONE       0   /* Not built yet. */
+#define CONF_FCB_IDX_VALID      1
+#define CONF_FCB_IDX_OVERFLOW   2   /* Too many settings; not used. */
+
+/* Slot marking a removed entry; lookups probe past it. */
+#define CONF_FCB_IDX_DELETED    UINT16_MAX
+#endif
+
 struct conf_fcb_load_cb_arg {
     conf_store_load_cb cb;
     void *cb_arg;
+#if MYNEWT_VAL(CONFIG_FCB_INDEX)
+    struct conf_fcb *cf;
+#endif
 };
 
 struct conf_kv_load_cb_arg {
@@ -48,18 +61,204 @@ static int conf_fcb_load(struct conf_store *, conf_store_load_cb cb,
                          void *cb_arg);
 static int conf_fcb_save(struct conf_store *, const char *name,
                          const char *value);
+#if MYNEWT_VAL(CONFIG_FCB_INDEX)
+static int conf_fcb_load_one(struct conf_store *, const char *name,
+                             conf_store_load_cb cb, void *cb_arg);
+#endif
 
 static struct conf_store_itf conf_fcb_itf = {
     .csi_load = conf_fcb_load,
+#if MYNEWT_VAL(CONFIG_FCB_INDEX)
+    .csi_load_one = conf_fcb_load_one,
+#endif
     .csi_save = conf_fcb_save,
 };
 
+#if MYNEWT_VAL(CONFIG_FCB_INDEX)
+static uint32_t
+conf_fcb_idx_hash(const char *name)
+{
+    uint32_t hash;
+
+    /* FNV-1a */
+    hash = 2166136261;
+    while (*name) {
+        hash ^= (uint8_t)*name++;
+        hash *= 16777619;
+    }
+    return hash;
+}
+
+static bool
+conf_fcb_idx_empty(const struct conf_fcb_idx_entry *ent)
+{
+    return ent->cie_area == NULL && ent->cie_data_len != CONF_FCB_IDX_DELETED;
+}
+
+static bool
+conf_fcb_idx_deleted(const struct conf_fcb_idx_entry *ent)
+{
+    return ent->cie_area == NULL && ent->cie_data_len == CONF_FCB_IDX_DELETED;
+}
+
+/*
+ * Checks if the entry referenced by an index slot stores the given setting,
+ * i.e. starts with "<name>=".
+ */
+static bool
+conf_fcb_idx_name_eq(const struct conf_fcb_idx_entry *ent, const char *name)
+{
+    uint8_t buf[32];
+    int name_len;
+    int cmp_len;
+    int off;
+    int len;
+
+    name_len = strlen(name);
+    if (name_len + 1 > ent->cie_data_len) {
+        return false;
+    }
+
+    for (off = 0; off <= name_len; off += len) {
+        len = min(name_len + 1 - off, sizeof(buf));
+        if (flash_area_read(ent->cie_area, ent->cie_data_off + off, buf,
+                            len)) {
+            return false;
+        }
+        cmp_len = len;
+        if (off + len > name_len) {
+            if (buf[--cmp_len] != '=') {
+                return false;
+            }
+        }
+        if (memcmp(buf, name + off, cmp_len)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Looks up the slot of a setting.  If the setting is not in the index and
+ * free_slot is given, it is set to the slot where it can be inserted (or
+ * NULL if the index is full).
+ */
+static struct conf_fcb_idx_entry *
+conf_fcb_idx_find(struct conf_fcb *cf, const char *name, uint32_t hash,
+                  struct conf_fcb_idx_entry **free_slot)
+{
+    struct conf_fcb_idx_entry *ent;
+    int i;
+
+    if (free_slot) {
+        *free_slot = NULL;
+    }
+    for (i = 0; i < ARRAY_SIZE(cf->cf_idx); i++) {
+        ent = &cf->cf_idx[(hash + i) % ARRAY_SIZE(cf->cf_idx)];
+        if (conf_fcb_idx_empty(ent) || conf_fcb_idx_deleted(ent)) {
+            if (free_slot && !*free_slot) {
+                *free_slot = ent;
+            }
+            if (conf_fcb_idx_empty(ent)) {
+                break;
+            }
+            continue;
+        }
+        if (ent->cie_hash == hash && conf_fcb_idx_name_eq(ent, name)) {
+            return ent;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Looks up the slot pointing to the given entry, i.e. the slot of the
+ * setting if this is its latest value.  No flash reads needed.
+ */
+static struct conf_fcb_idx_entry *
+conf_fcb_idx_find_loc(struct conf_fcb *cf, const char *name,
+                      const struct fcb_entry *loc)
+{
+    struct conf_fcb_idx_entry *ent;
+    uint32_t hash;
+    int i;
+
+    hash = conf_fcb_idx_hash(name);
+    for (i = 0; i < ARRAY_SIZE(cf->cf_idx); i++) {
+        ent = &cf->cf_idx[(hash + i) % ARRAY_SIZE(cf->cf_idx)];
+        if (conf_fcb_idx_empty(ent)) {
+            break;
+        }
+        if (ent->cie_area == loc->fe_area &&
+            ent->cie_data_off == loc->fe_data_off) {
+            return ent;
+        }
+    }
+    return NULL;
+}
+
+static void
+conf_fcb_idx_set(struct conf_fcb_idx_entry *ent, const struct fcb_entry *loc)
+{
+    ent->cie_area = loc->fe_area;
+    ent->cie_data_off = loc->fe_data_off;
+    ent->cie_data_len = loc->fe_data_len;
+}
+
+/*
+ * Records loc as the latest value of a setting.
+ */
+static void
+conf_fcb_idx_put(struct conf_fcb *cf, const char *name,
+                 const struct fcb_entry *loc)
+{
+    struct conf_fcb_idx_entry *free_slot;
+    struct conf_fcb_idx_entry *ent;
+    uint32_t hash;
+
+    if (!cf || cf->cf_idx_state != CONF_FCB_IDX_VALID) {
+        return;
+    }
+
+    hash = conf_fcb_idx_hash(name);
+    ent = conf_fcb_idx_find(cf, name, hash, &free_slot);
+    if (!ent) {
+        ent = free_slot;
+        if (!ent) {
+            cf->cf_idx_state = CONF_FCB_IDX_OVERFLOW;
+            return;
+        }
+        ent->cie_hash = hash;
+    }
+    conf_fcb_idx_set(ent, loc);
+}
+
+/*
+ * Drops all slots pointing to an erased sector.
+ */
+static void
+conf_fcb_idx_drop_area(struct conf_fcb *cf, struct flash_area *fa)
+{
+    int i;
+
+    for (i = 0; i < ARRAY_SIZE(cf->cf_idx); i++) {
+        if (cf->cf_idx[i].cie_area == fa) {
+            cf->cf_idx[i].cie_area = NULL;
+            cf->cf_idx[i].cie_data_len = CONF_FCB_IDX_DELETED;
+        }
+    }
+}
+#endif
+
 int
 conf_fcb_src(struct conf_fcb *cf)
 {
     int rc;
 
     cf->cf_fcb.f_version = CONF_FCB_VERS;
+#if MYNEWT_VAL(CONFIG_FCB_INDEX)
+    cf->cf_idx_state = CONF_FCB_IDX_NONE;
+#endif
     if (cf->cf_fcb.f_sector_cnt > 1) {
         cf->cf_fcb.f_scratch_cnt = 1;
     } else {
@@ -126,6 +325,12 @@ conf_fcb_load_cb(struct fcb_entry *loc, void *arg)
     if (rc) {
         return 0;
     }
+#if MYNEWT_VAL(CONFIG_FCB_INDEX)
+    conf_fcb_idx_put(argp->cf, name_str, loc);
+    if (!argp->cb) {
+        return 0;
+    }
+#endif
     argp->cb(name_str, val_str, argp->cb_arg);
     return 0;
 }
@@ -139,12 +344,73 @@ conf_fcb_load(struct conf_store *cs, conf_store_load_cb cb, void *cb_arg)
 
     arg.cb = cb;
     arg.cb_arg = cb_arg;
+#if MYNEWT_VAL(CONFIG_FCB_INDEX)
+    /*
+     * Build the index during the first walk.
+     */
+    arg.cf = NULL;
+    if (cf->cf_idx_state == CONF_FCB_IDX_NONE) {
+        memset(cf->cf_idx, 0, sizeof(cf->cf_idx));
+        cf->cf_idx_state = CONF_FCB_IDX_VALID;
+        arg.cf = cf;
+    }
+#endif
     rc = fcb_walk(&cf->cf_fcb, 0, conf_fcb_load_cb, &arg);
+    if (rc) {
+#if MYNEWT_VAL(CONFIG_FCB_INDEX)
+        if (arg.cf) {
+            cf->cf_idx_state = CONF_FCB_IDX_NONE;
+        }
+#endif
+        return OS_EINVAL;
+    }
+    return OS_OK;
+}
+
+#if MYNEWT_VAL(CONFIG_FCB_INDEX)
+static int
+conf_fcb_load_one(struct conf_store *cs, const char *name,
+                  conf_store_load_cb cb, void *cb_arg)
+{
+    struct conf_fcb *cf = (struct conf_fcb *)cs;
+    struct conf_fcb_idx_entry *ent;
+    char buf[CONF_MAX_NAME_LEN + CONF_MAX_VAL_LEN + 32];
+    char *name_str;
+    char *val_str;
+    int rc;
+    int len;
+
+    if (cf->cf_idx_state == CONF_FCB_IDX_NONE) {
+        conf_fcb_load(cs, NULL, NULL);
+    }
+    if (cf->cf_idx_state != CONF_FCB_IDX_VALID) {
+        return conf_fcb_load(cs, cb, cb_arg);
+    }
+
+    ent = conf_fcb_idx_find(cf, name, conf_fcb_idx_hash(name), NULL);
+    if (!ent) {
+        return OS_OK;
+    }
+
+    len = ent->cie_data_len;
+    if (len >= sizeof(buf)) {
+        len = sizeof(buf) - 1;
+    }
+
+    rc = flash_area_read(ent->cie_area, ent->cie_data_off, buf, len);
     if (rc) {
         return OS_EINVAL;
     }
+    buf[len] = '\0';
+
+    rc = conf_line_parse(buf, &name_str, &val_str);
+    if (rc) {
+        return OS_OK;
+    }
+    cb(name_str, val_str, cb_arg);
     return OS_OK;
 }
+#endif
 
 static int
 conf_fcb_var_read(struct fcb_entry *loc, char *buf, char **name, char **val)
@@ -161,11 +427,15 @@ conf_fcb_var_read(struct fcb_entry *loc, char *buf, char **name, char **val)
 }
 
 static void
-conf_fcb_compress_internal(struct fcb *fcb,
+conf_fcb_compress_internal(struct fcb *fcb, struct conf_fcb *cf,
                            int (*copy_or_not)(const char *name, const char *val,
                                               void *cn_arg),
                            void *cn_arg)
 {
+#if MYNEWT_VAL(CONFIG_FCB_INDEX)
+    struct conf_fcb_idx_entry *ent = NULL;
+    struct flash_area *oldest;
+#endif
     int rc;
     char buf1[CONF_MAX_NAME_LEN + CONF_MAX_VAL_LEN + 32];
     char buf2[CONF_MAX_NAME_LEN + CONF_MAX_VAL_LEN + 32];
@@ -194,17 +464,28 @@ conf_fcb_compress_internal(struct fcb *fcb,
         if (!val1) {
             continue;
         }
-        loc2 = loc1;
-        copy = 1;
-        while (fcb_getnext(fcb, &loc2) == 0) {
-            hal_watchdog_tickle();
-            rc = conf_fcb_var_read(&loc2, buf2, &name2, &val2);
-            if (rc) {
-                continue;
-            }
-            if (!strcmp(name1, name2)) {
-                copy = 0;
-                break;
+#if MYNEWT_VAL(CONFIG_FCB_INDEX)
+        if (cf && cf->cf_idx_state == CONF_FCB_IDX_VALID) {
+            /*
+             * Only the latest value of a setting is in the index.
+             */
+            ent = conf_fcb_idx_find_loc(cf, name1, &loc1);
+            copy = ent != NULL;
+        } else
+#endif
+        {
+            loc2 = loc1;
+            copy = 1;
+            while (fcb_getnext(fcb, &loc2) == 0) {
+                hal_watchdog_tickle();
+                rc = conf_fcb_var_read(&loc2, buf2, &name2, &val2);
+                if (rc) {
+                    continue;
+                }
+                if (!strcmp(name1, name2)) {
+                    copy = 0;
+                    break;
+                }
             }
         }
         if (!copy) {
@@ -235,16 +516,31 @@ conf_fcb_compress_internal(struct fcb *fcb,
             continue;
         }
         fcb_append_finish(fcb, &loc2);
+#if MYNEWT_VAL(CONFIG_FCB_INDEX)
+        if (ent) {
+            conf_fcb_idx_set(ent, &loc2);
+        }
+#endif
     }
+#if MYNEWT_VAL(CONFIG_FCB_INDEX)
+    oldest = fcb->f_oldest;
+#endif
     rc = fcb_rotate(fcb);
     if (rc) {
         /* XXXX */
         ;
     }
+#if MYNEWT_VAL(CONFIG_FCB_INDEX)
+    if (!rc && cf) {
+        /* Settings not copied are gone. */
+        conf_fcb_idx_drop_area(cf, oldest);
+    }
+#endif
 }
 
 static int
-conf_fcb_append(struct fcb *fcb, char *buf, int len)
+conf_fcb_append(struct fcb *fcb, struct conf_fcb *cf, char *buf, int len,
+                struct fcb_entry *out_loc)
 {
     int rc;
     int i;
@@ -258,7 +554,7 @@ conf_fcb_append(struct fcb *fcb, char *buf, int len)
         if (fcb->f_scratch_cnt == 0) {
             return OS_ENOMEM;
         }
-        conf_fcb_compress_internal(fcb, NULL, NULL);
+        conf_fcb_compress_internal(fcb, cf, NULL, NULL);
     }
     if (rc) {
         return OS_EINVAL;
@@ -268,15 +564,44 @@ conf_fcb_append(struct fcb *fcb, char *buf, int len)
         return OS_EINVAL;
     }
     fcb_append_finish(fcb, &loc);
+    if (out_loc) {
+        *out_loc = loc;
+    }
     return OS_OK;
 }
 
+static int
+conf_fcb_kv_save_internal(struct fcb *fcb, struct conf_fcb *cf,
+                          const char *name, const char *value)
+{
+    char buf[CONF_MAX_NAME_LEN + CONF_MAX_VAL_LEN + 32];
+    struct fcb_entry loc;
+    int len;
+    int rc;
+
+    if (!name) {
+        return OS_INVALID_PARM;
+    }
+
+    len = conf_line_make(buf, sizeof(buf), name, value);
+    if (len < 0 || len + 2 > sizeof(buf)) {
+        return OS_INVALID_PARM;
+    }
+    rc = conf_fcb_append(fcb, cf, buf, len, &loc);
+#if MYNEWT_VAL(CONFIG_FCB_INDEX)
+    if (rc == 0) {
+        conf_fcb_idx_put(cf, name, &loc);
+    }
+#endif
+    return rc;
+}
+
 static int
 conf_fcb_save(struct conf_store *cs, const char *name, const char *value)
 {
     struct conf_fcb *cf = (struct conf_fcb *)cs;
 
-    return conf_fcb_kv_save(&cf->cf_fcb, name, value);
+    return conf_fcb_kv_save_internal(&cf->cf_fcb, cf, name, value);
 }
 
 void
@@ -285,7 +610,7 @@ conf_fcb_compress(struct conf_fcb *cf,
                                      void *cn_arg),
                   void *cn_arg)
 {
-    conf_fcb_compress_internal(&cf->cf_fcb, copy_or_not, cn_arg);
+    conf_fcb_compress_internal(&cf->cf_fcb, cf, copy_or_not, cn_arg);
 }
 
 static int
@@ -345,18 +670,7 @@ conf_fcb_kv_load(struct fcb *fcb, const char *name, char *value, size_t len)
 int
 conf_fcb_kv_save(struct fcb *fcb, const char *name, const char *value)
 {
-    char buf[CONF_MAX_NAME_LEN + CONF_MAX_VAL_LEN + 32];
-    int len;
-
-    if (!name) {
-        return OS_INVALID_PARM;
-    }
-
-    len = conf_line_make(buf, sizeof(buf), name, value);
-    if (len < 0 || len + 2 > sizeof(buf)) {
-        return OS_INVALID_PARM;
-    }
-    return conf_fcb_append(fcb, buf, len);
+    return conf_fcb_kv_save_internal(fcb, NULL, name, value);
 }
 
 #endif
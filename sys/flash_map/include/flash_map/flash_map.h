@@ -89,6 +89,24 @@ int flash_area_write(const struct flash_area *, uint32_t off, const void *src,
   uint32_t len);
 int flash_area_erase(const struct flash_area *, uint32_t off, uint32_t len);
 
+/*
+ * Write a gather list back to back starting at off, without first copying it
+ * into a flat buffer.  See hal_flash_writev() for alignment rules.
+ */
+struct os_iovec;
+int flash_area_writev(const struct flash_area *, uint32_t off,
+  const struct os_iovec *iov, int iov_cnt);
+
+#if MYNEWT_VAL(HAL_FLASH_ASYNC)
+/*
+ * Queue an erase to the flash worker task; see hal_flash_erase_async().
+ * Completion is reported through op.
+ */
+struct hal_flash_op;
+int flash_area_erase_async(const struct flash_area *, uint32_t off,
+  uint32_t len, struct hal_flash_op *op);
+#endif
+
 /*
  * Whether the whole area is empty.
  */
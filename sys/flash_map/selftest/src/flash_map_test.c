@@ -38,6 +38,8 @@ TEST_CASE_DECL(flash_map_test_case_1)
 TEST_CASE_DECL(flash_map_test_case_2)
 TEST_CASE_DECL(flash_map_test_case_3)
 TEST_CASE_DECL(flash_map_test_case_new_areas)
+TEST_CASE_DECL(flash_map_test_case_writev)
+TEST_CASE_DECL(flash_map_test_case_async)
 
 TEST_SUITE(flash_map_test_suite)
 {
@@ -45,6 +47,8 @@ TEST_SUITE(flash_map_test_suite)
     flash_map_test_case_2();
     flash_map_test_case_3();
     flash_map_test_case_new_areas();
+    flash_map_test_case_writev();
+    flash_map_test_case_async();
 }
 
 int
@@ -0,0 +1,106 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "flash_map_test.h"
+#include "hal/hal_flash_async.h"
+
+static int flash_map_test_async_done_cnt;
+
+static void
+flash_map_test_async_done(struct os_event *ev)
+{
+    flash_map_test_async_done_cnt++;
+}
+
+/*
+ * Test erases and writes handed to the flash worker task.
+ */
+TEST_CASE_TASK(flash_map_test_case_async)
+{
+    const struct flash_area *fa;
+    struct hal_flash_op op1;
+    struct hal_flash_op op2;
+    struct os_eventq evq;
+    uint8_t wd[64];
+    uint8_t rd[64];
+    bool empty;
+    int rc;
+    int i;
+
+    rc = flash_area_open(FLASH_AREA_IMAGE_0, &fa);
+    TEST_ASSERT_FATAL(rc == 0, "flash_area_open() fail");
+
+    for (i = 0; i < sizeof(wd); i++) {
+        wd[i] = i;
+    }
+
+    rc = flash_area_write(fa, 0, wd, sizeof(wd));
+    TEST_ASSERT_FATAL(rc == 0, "flash_area_write() fail");
+
+    /* Erase completes with an event on the given queue. */
+    os_eventq_init(&evq);
+    hal_flash_op_init(&op1, &evq, flash_map_test_async_done, &op1);
+    rc = flash_area_erase_async(fa, 0, fa->fa_size, &op1);
+    TEST_ASSERT_FATAL(rc == 0, "flash_area_erase_async() fail");
+    TEST_ASSERT(hal_flash_op_busy(&op1));
+
+    /* A pending operation cannot be submitted again. */
+    rc = flash_area_erase_async(fa, 0, fa->fa_size, &op1);
+    TEST_ASSERT(rc == SYS_EBUSY);
+
+    os_eventq_run(&evq);
+    TEST_ASSERT(flash_map_test_async_done_cnt == 1);
+    TEST_ASSERT(op1.hfo_state == HAL_FLASH_OP_DONE);
+    TEST_ASSERT(op1.hfo_rc == 0);
+
+    rc = flash_area_is_empty(fa, &empty);
+    TEST_ASSERT(rc == 0 && empty, "area not erased");
+
+    /* Writes run in order; a queued one can be cancelled. */
+    hal_flash_op_init(&op1, NULL, NULL, NULL);
+    hal_flash_op_init(&op2, NULL, NULL, NULL);
+    rc = hal_flash_write_async(fa->fa_device_id, fa->fa_off, wd, sizeof(wd),
+                               &op1);
+    TEST_ASSERT_FATAL(rc == 0, "hal_flash_write_async() fail");
+    rc = hal_flash_write_async(fa->fa_device_id, fa->fa_off + sizeof(wd), wd,
+                               sizeof(wd), &op2);
+    TEST_ASSERT_FATAL(rc == 0, "hal_flash_write_async() fail");
+
+    /* The worker has a lower priority, so op2 has not started yet. */
+    rc = hal_flash_op_cancel(&op2);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(op2.hfo_state == HAL_FLASH_OP_IDLE);
+    TEST_ASSERT(hal_flash_op_wait(&op2, OS_TIMEOUT_NEVER) == SYS_EINVAL);
+
+    rc = hal_flash_op_wait(&op1, OS_TIMEOUT_NEVER);
+    TEST_ASSERT(rc == 0);
+
+    rc = flash_area_read(fa, 0, rd, sizeof(rd));
+    TEST_ASSERT_FATAL(rc == 0, "flash_area_read() fail");
+    TEST_ASSERT(memcmp(wd, rd, sizeof(wd)) == 0, "read data != write data");
+
+    rc = flash_area_read_is_empty(fa, sizeof(wd), rd, sizeof(rd));
+    TEST_ASSERT(rc == 1, "cancelled write was run");
+
+    /* Errors are reported through the operation. */
+    hal_flash_op_init(&op1, NULL, NULL, NULL);
+    rc = hal_flash_erase_sector_async(fa->fa_device_id, fa->fa_off + 1, &op1);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = hal_flash_op_wait(&op1, OS_TIMEOUT_NEVER);
+    TEST_ASSERT(rc == SYS_EIO);
+}
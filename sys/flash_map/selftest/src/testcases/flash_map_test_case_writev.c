@@ -0,0 +1,85 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "flash_map_test.h"
+
+/*
+ * Test flash_area_writev() with segments that straddle alignment units.
+ */
+TEST_CASE_SELF(flash_map_test_case_writev)
+{
+    const struct flash_area *fa;
+    struct os_iovec iov[5];
+    uint32_t align;
+    uint32_t off;
+    uint8_t wd[256];
+    uint8_t rd[256 + 32];
+    int len;
+    int rc;
+    int i;
+
+    rc = flash_area_open(FLASH_AREA_IMAGE_0, &fa);
+    TEST_ASSERT_FATAL(rc == 0, "flash_area_open() fail");
+
+    rc = flash_area_erase(fa, 0, fa->fa_size);
+    TEST_ASSERT_FATAL(rc == 0, "flash_area_erase() fail");
+
+    align = flash_area_align(fa);
+
+    for (i = 0; i < sizeof(wd); i++) {
+        wd[i] = i;
+    }
+
+    /* Odd-sized segments, including an empty one. */
+    iov[0] = (struct os_iovec) { .iov_base = wd, .iov_len = 3 };
+    iov[1] = (struct os_iovec) { .iov_base = wd + 3, .iov_len = 0 };
+    iov[2] = (struct os_iovec) { .iov_base = wd + 3, .iov_len = 1 };
+    iov[3] = (struct os_iovec) { .iov_base = wd + 4, .iov_len = 150 };
+    iov[4] = (struct os_iovec) { .iov_base = wd + 154, .iov_len = 101 };
+    len = 255;
+
+    off = 0;
+    rc = flash_area_writev(fa, off, iov, 5);
+    TEST_ASSERT_FATAL(rc == 0, "flash_area_writev() fail");
+
+    rc = flash_area_read(fa, off, rd, len);
+    TEST_ASSERT_FATAL(rc == 0, "flash_area_read() fail");
+    TEST_ASSERT(memcmp(wd, rd, len) == 0, "read data != write data");
+
+    /* The tail of the last alignment unit is left erased. */
+    off += len;
+    while (off % align != 0) {
+        rc = flash_area_read(fa, off, rd, 1);
+        TEST_ASSERT_FATAL(rc == 0, "flash_area_read() fail");
+        TEST_ASSERT(rd[0] == 0xff, "padding not erased");
+        off++;
+    }
+
+    /* A second list lands right after the first. */
+    iov[0] = (struct os_iovec) { .iov_base = wd, .iov_len = sizeof(wd) };
+    rc = flash_area_writev(fa, off, iov, 1);
+    TEST_ASSERT_FATAL(rc == 0, "flash_area_writev() fail");
+
+    rc = flash_area_read(fa, off, rd, sizeof(wd));
+    TEST_ASSERT_FATAL(rc == 0, "flash_area_read() fail");
+    TEST_ASSERT(memcmp(wd, rd, sizeof(wd)) == 0, "read data != write data");
+
+    /* Out of bounds. */
+    rc = flash_area_writev(fa, fa->fa_size - 1, iov, 1);
+    TEST_ASSERT(rc != 0, "flash_area_writev() past end succeeded");
+}
@@ -24,6 +24,7 @@
 #include "os/mynewt.h"
 #include "hal/hal_bsp.h"
 #include "hal/hal_flash.h"
+#include "hal/hal_flash_async.h"
 #include "hal/hal_flash_int.h"
 #if MYNEWT_VAL(FLASH_MAP_SUPPORT_MFG)
 #include "mfg/mfg.h"
@@ -266,6 +267,23 @@ flash_area_write(const struct flash_area *fa, uint32_t off, const void *src,
                            (void *)src, len);
 }
 
+int
+flash_area_writev(const struct flash_area *fa, uint32_t off,
+    const struct os_iovec *iov, int iov_cnt)
+{
+    uint32_t len;
+    int i;
+
+    len = 0;
+    for (i = 0; i < iov_cnt; i++) {
+        len += iov[i].iov_len;
+    }
+    if (off > fa->fa_size || off + len > fa->fa_size) {
+        return -1;
+    }
+    return hal_flash_writev(fa->fa_device_id, fa->fa_off + off, iov, iov_cnt);
+}
+
 int
 flash_area_erase(const struct flash_area *fa, uint32_t off, uint32_t len)
 {
@@ -275,6 +293,18 @@ flash_area_erase(const struct flash_area *fa, uint32_t off, uint32_t len)
     return hal_flash_erase(fa->fa_device_id, fa->fa_off + off, len);
 }
 
+#if MYNEWT_VAL(HAL_FLASH_ASYNC)
+int
+flash_area_erase_async(const struct flash_area *fa, uint32_t off,
+                       uint32_t len, struct hal_flash_op *op)
+{
+    if (off > fa->fa_size || off + len > fa->fa_size) {
+        return -1;
+    }
+    return hal_flash_erase_async(fa->fa_device_id, fa->fa_off + off, len, op);
+}
+#endif
+
 uint32_t
 flash_area_align(const struct flash_area *fa)
 {
@@ -28,6 +28,9 @@
 #if MYNEWT_VAL(LOG_FCB) || MYNEWT_VAL(LOG_FCB2)
 #include "log/log_fcb.h"
 #endif
+#if MYNEWT_VAL(LOG_DICT)
+#include "log/log_dict.h"
+#endif
 
 #if MYNEWT_VAL(LOG_FLAGS_IMAGE_HASH)
 #define LOG_HDR_SIZE 19
@@ -195,36 +198,44 @@ struct log_entry_hdr {
 
 #define LOG_MODULE_STR(module)      log_module_get_name(module)
 
+#if MYNEWT_VAL(LOG_DICT)
+#define LOG_PRINTF_(__l, __mod, __lvl, __msg, ...) log_printf_dict(__l, \
+        __mod, __lvl, LOG_DICT_FMT(__msg), ##__VA_ARGS__)
+#else
+#define LOG_PRINTF_(__l, __mod, __lvl, __msg, ...) log_printf(__l, __mod, \
+        __lvl, __msg, ##__VA_ARGS__)
+#endif
+
 #if MYNEWT_VAL(LOG_LEVEL) <= LOG_LEVEL_DEBUG
-#define LOG_DEBUG(__l, __mod, __msg, ...) log_printf(__l, __mod, \
+#define LOG_DEBUG(__l, __mod, __msg, ...) LOG_PRINTF_(__l, __mod, \
         LOG_LEVEL_DEBUG, __msg, ##__VA_ARGS__)
 #else
 #define LOG_DEBUG(__l, __mod, ...) IGNORE(__VA_ARGS__)
 #endif
 
 #if MYNEWT_VAL(LOG_LEVEL) <= LOG_LEVEL_INFO
-#define LOG_INFO(__l, __mod, __msg, ...) log_printf(__l, __mod, \
+#define LOG_INFO(__l, __mod, __msg, ...) LOG_PRINTF_(__l, __mod, \
         LOG_LEVEL_INFO, __msg, ##__VA_ARGS__)
 #else
 #define LOG_INFO(__l, __mod, ...) IGNORE(__VA_ARGS__)
 #endif
 
 #if MYNEWT_VAL(LOG_LEVEL) <= LOG_LEVEL_WARN
-#define LOG_WARN(__l, __mod, __msg, ...) log_printf(__l, __mod, \
+#define LOG_WARN(__l, __mod, __msg, ...) LOG_PRINTF_(__l, __mod, \
         LOG_LEVEL_WARN, __msg, ##__VA_ARGS__)
 #else
 #define LOG_WARN(__l, __mod, ...) IGNORE(__VA_ARGS__)
 #endif
 
 #if MYNEWT_VAL(LOG_LEVEL) <= LOG_LEVEL_ERROR
-#define LOG_ERROR(__l, __mod, __msg, ...) log_printf(__l, __mod, \
+#define LOG_ERROR(__l, __mod, __msg, ...) LOG_PRINTF_(__l, __mod, \
         LOG_LEVEL_ERROR, __msg, ##__VA_ARGS__)
 #else
 #define LOG_ERROR(__l, __mod, ...) IGNORE(__VA_ARGS__)
 #endif
 
 #if MYNEWT_VAL(LOG_LEVEL) <= LOG_LEVEL_CRITICAL
-#define LOG_CRITICAL(__l, __mod, __msg, ...) log_printf(__l, __mod, \
+#define LOG_CRITICAL(__l, __mod, __msg, ...) LOG_PRINTF_(__l, __mod, \
         LOG_LEVEL_CRITICAL, __msg, ##__VA_ARGS__)
 #else
 #define LOG_CRITICAL(__l, __mod, ...) IGNORE(__VA_ARGS__)
@@ -276,6 +287,10 @@ struct log {
 #if MYNEWT_VAL(LOG_STATS)
     STATS_SECT_DECL(logs) l_stats;
 #endif
+#if MYNEWT_VAL(LOG_ASYNC)
+    /* Entries are staged and written by the log writer task */
+    uint8_t l_async;
+#endif
 #if MYNEWT_VAL(LOG_INIT_CB)
     /* Custom log init callback to be called by the last hdr
      * read function to read custom data from log entries
@@ -889,6 +904,38 @@ void log_set_max_entry_len(struct log *log, uint16_t max_entry_len);
  */
 uint32_t log_get_last_index(struct log *log);
 
+#if MYNEWT_VAL(LOG_ASYNC)
+/**
+ * @brief Enables or disables deferred writes for a log.
+ *
+ * Entries appended to an asynchronous log are timestamped and indexed by the
+ * caller and copied into a RAM staging ring.  The log writer task writes them
+ * to the backing store later; until then they are not visible to log walks
+ * and reads.  The log append callback is called by the writer task once the
+ * entry has been written.
+ *
+ * @param log                   The log to configure.
+ * @param async                 1 to defer writes, 0 to write synchronously.
+ *
+ * @return                      0 on success; SYS_ENOTSUP if the log handler
+ *                                  does not support body appends.
+ */
+int log_set_async(struct log *log, int async);
+
+/**
+ * @brief Waits until all staged log entries have been written.
+ *
+ * @param timeout               Maximum time to wait, in OS ticks.
+ *
+ * @return                      0 on success;
+ *                              SYS_ETIMEOUT if entries are still staged after
+ *                                  the timeout expired;
+ *                              SYS_EINVAL if the caller cannot block (ISR,
+ *                                  OS not started, or the writer task).
+ */
+int log_async_sync(os_time_t timeout);
+#endif
+
 #if MYNEWT_VAL(LOG_STORAGE_INFO)
 /**
  * Return information about log storage
@@ -0,0 +1,117 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef __SYS_LOG_DICT_H_
+#define __SYS_LOG_DICT_H_
+
+/**
+ * @file
+ * @brief Dictionary (binary) printf-style logging.
+ *
+ * With `LOG_DICT` enabled, the printf-style logging macros no longer format
+ * their message on the device.  Each format string is placed in the
+ * `log_dict_fmts` link table and the log entry only contains the index of
+ * the format string in that table followed by the raw arguments.  The
+ * table is only needed to turn entries back into text, which is done on the
+ * host from the ELF image (see `sys/log/full/scripts/log_dict_decode.py`).
+ *
+ * Entries are written with the `LOG_ETYPE_CBOR` type so that they pass
+ * unchanged through log walks and the log management read path.  The body
+ * is a CBOR array tagged with `LOG_DICT_CBOR_TAG`:
+ *
+ *     LOG_DICT_CBOR_TAG([format-id, arg0, arg1, ...])
+ *
+ * Integer, character and pointer arguments are encoded as CBOR integers,
+ * floating point arguments as double precision floats and strings as text
+ * strings.  Arguments that do not fit in the entry are omitted.
+ */
+
+#include <stdarg.h>
+#include "os/mynewt.h"
+#include "os/link_tables.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct log;
+
+/** CBOR tag identifying a dictionary log entry. */
+#define LOG_DICT_CBOR_TAG       0x6c64
+
+/** Table of all format strings used with dictionary logging. */
+LINK_TABLE(const char *, log_dict_fmts)
+
+/**
+ * @brief Places a format string in the dictionary.
+ *
+ * Evaluates to the address of the table element holding the format string.
+ * The format string must be a string literal.
+ */
+#define LOG_DICT_FMT(fmt_) ({                                               \
+    static const char *const log_dict_fmt_                                 \
+        LINK_TABLE_SECTION(log_dict_fmts) = (fmt_);                         \
+    &log_dict_fmt_;                                                         \
+})
+
+/**
+ * @brief Returns the dictionary ID of a format string table element.
+ *
+ * @param fmt                   A table element created with LOG_DICT_FMT().
+ *
+ * @return                      The format string ID.
+ */
+static inline uint32_t
+log_dict_fmt_id(const char *const *fmt)
+{
+    return fmt - LINK_TABLE_START(log_dict_fmts);
+}
+
+/**
+ * @brief Encodes a dictionary log entry body.
+ *
+ * @param buf                   The buffer to encode into.
+ * @param buf_len               The size of the buffer, in bytes.
+ * @param fmt                   A table element created with LOG_DICT_FMT().
+ * @param ap                    The arguments matching the format string.
+ *
+ * @return                      The number of bytes encoded; 0 if the buffer
+ *                                  is too small to hold even the header.
+ */
+int log_dict_vencode(void *buf, int buf_len, const char *const *fmt,
+                     va_list ap);
+
+/**
+ * @brief Writes a dictionary entry to the specified log.
+ *
+ * This is the dictionary counterpart of log_printf().  It is normally
+ * invoked through the LOG_[...] macros rather than called directly.
+ *
+ * @param log                   The log to write to.
+ * @param module                The log module of the entry to write.
+ * @param level                 The severity of the log entry to write.
+ * @param fmt                   A table element created with LOG_DICT_FMT().
+ */
+void log_printf_dict(struct log *log, uint8_t module, uint8_t level,
+                     const char *const *fmt, ...);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SYS_LOG_DICT_H_ */
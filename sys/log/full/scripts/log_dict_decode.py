@@ -0,0 +1,272 @@
+#!/usr/bin/env python3
+#
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#  http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+#
+
+"""Decodes dictionary log entries (LOG_DICT) into text.
+
+The format strings are read from the `log_dict_fmts` link table of the ELF
+image the entries were produced by.  Entry bodies are given as hex or
+base64 strings, either on the command line or one per line on stdin:
+
+    log_dict_decode.py bin/targets/my_app/app/apps/my_app/my_app.elf d96c6483...
+"""
+
+import argparse
+import base64
+import binascii
+import re
+import struct
+import sys
+
+LOG_DICT_CBOR_TAG = 0x6c64
+
+SHT_SYMTAB = 2
+SHT_NOBITS = 8
+
+
+class Elf:
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            self.data = f.read()
+
+        if self.data[:4] != b'\x7fELF':
+            raise ValueError('%s is not an ELF file' % path)
+
+        self.is64 = self.data[4] == 2
+        self.endian = '<' if self.data[5] == 1 else '>'
+        self.ptr_size = 8 if self.is64 else 4
+
+        if self.is64:
+            shoff, = self._unpack('Q', 0x28)
+            shentsize, shnum = self._unpack('HH', 0x3a)
+        else:
+            shoff, = self._unpack('I', 0x20)
+            shentsize, shnum = self._unpack('HH', 0x2e)
+
+        self.sections = []
+        for i in range(shnum):
+            off = shoff + i * shentsize
+            if self.is64:
+                (name, stype, flags, addr, offset, size,
+                 link, info, align, entsize) = self._unpack('IIQQQQIIQQ', off)
+            else:
+                (name, stype, flags, addr, offset, size,
+                 link, info, align, entsize) = self._unpack('IIIIIIIIII', off)
+            self.sections.append({'type': stype, 'addr': addr,
+                                  'offset': offset, 'size': size,
+                                  'link': link, 'entsize': entsize})
+
+    def _unpack(self, fmt, off):
+        fmt = self.endian + fmt
+        return struct.unpack_from(fmt, self.data, off)
+
+    def symbol(self, wanted):
+        for sec in self.sections:
+            if sec['type'] != SHT_SYMTAB:
+                continue
+
+            strtab = self.sections[sec['link']]
+            for off in range(sec['offset'], sec['offset'] + sec['size'],
+                             sec['entsize']):
+                if self.is64:
+                    name, info, other, shndx, value, size = \
+                        self._unpack('IBBHQQ', off)
+                else:
+                    name, value, size, info, other, shndx = \
+                        self._unpack('IIIBBH', off)
+                if self._cstr(strtab['offset'] + name) == wanted:
+                    return value
+
+        raise KeyError('symbol %s not found' % wanted)
+
+    def _cstr(self, off):
+        end = self.data.index(b'\0', off)
+        return self.data[off:end].decode('utf-8', 'replace')
+
+    def _file_offset(self, addr):
+        for sec in self.sections:
+            if sec['type'] == SHT_NOBITS or sec['addr'] == 0:
+                continue
+            if sec['addr'] <= addr < sec['addr'] + sec['size']:
+                return sec['offset'] + addr - sec['addr']
+
+        raise ValueError('address 0x%x is not in the image' % addr)
+
+    def read_ptr(self, addr):
+        fmt = 'Q' if self.is64 else 'I'
+        return self._unpack(fmt, self._file_offset(addr))[0]
+
+    def read_str(self, addr):
+        return self._cstr(self._file_offset(addr))
+
+    def dict_fmts(self):
+        start = self.symbol('__log_dict_fmts_start__')
+        end = self.symbol('__log_dict_fmts_end__')
+
+        return [self.read_str(self.read_ptr(addr))
+                for addr in range(start, end, self.ptr_size)]
+
+
+class CborDecoder:
+    def __init__(self, data):
+        self.data = data
+        self.off = 0
+
+    def _take(self, n):
+        if self.off + n > len(self.data):
+            raise ValueError('truncated CBOR item')
+        b = self.data[self.off:self.off + n]
+        self.off += n
+        return b
+
+    def _arg(self, info):
+        if info < 24:
+            return info
+        if info == 24:
+            return self._take(1)[0]
+        if info == 25:
+            return struct.unpack('>H', self._take(2))[0]
+        if info == 26:
+            return struct.unpack('>I', self._take(4))[0]
+        if info == 27:
+            return struct.unpack('>Q', self._take(8))[0]
+        raise ValueError('unsupported CBOR length encoding %d' % info)
+
+    def decode(self):
+        ib = self._take(1)[0]
+        major = ib >> 5
+        info = ib & 0x1f
+
+        if major == 7:
+            if info == 25:
+                return struct.unpack('>e', self._take(2))[0]
+            if info == 26:
+                return struct.unpack('>f', self._take(4))[0]
+            if info == 27:
+                return struct.unpack('>d', self._take(8))[0]
+            return {20: False, 21: True, 22: None}.get(info)
+
+        val = self._arg(info)
+        if major == 0:
+            return val
+        if major == 1:
+            return -1 - val
+        if major == 2:
+            return self._take(val)
+        if major == 3:
+            return self._take(val).decode('utf-8', 'replace')
+        if major == 4:
+            return [self.decode() for _ in range(val)]
+        if major == 5:
+            return {self.decode(): self.decode() for _ in range(val)}
+        return (val, self.decode())
+
+
+CONV_RE = re.compile(r'%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d*))?'
+                     r'(hh|h|ll|l|j|z|t|L)?([diouxXcspfFeEgGaAn%])')
+
+
+def format_entry(fmt, args):
+    args = list(args)
+
+    def conv(m):
+        flags, width, prec, _, spec = m.groups()
+        if spec == '%':
+            return '%'
+        if spec == 'n':
+            return ''
+
+        if width == '*':
+            width = str(args.pop(0)) if args else ''
+        if prec == '*':
+            prec = str(args.pop(0)) if args else ''
+        if not args:
+            return '<?>'
+        val = args.pop(0)
+
+        pyspec = '%' + flags + (width or '')
+        if prec is not None:
+            pyspec += '.' + prec
+
+        if spec in 'diu':
+            return (pyspec + 'd') % val
+        if spec == 'c':
+            return (pyspec + 's') % chr(val)
+        if spec == 'p':
+            return (pyspec + 's') % ('0x%x' % val)
+        if spec in 'aA':
+            text = float(val).hex()
+            return (pyspec + 's') % (text.upper() if spec == 'A' else text)
+        return (pyspec + spec) % val
+
+    return CONV_RE.sub(conv, fmt)
+
+
+def decode_entry(fmts, body):
+    item = CborDecoder(body).decode()
+    if (not isinstance(item, tuple) or item[0] != LOG_DICT_CBOR_TAG or
+            not isinstance(item[1], list) or not item[1]):
+        raise ValueError('not a dictionary log entry')
+
+    fmt_id = item[1][0]
+    if fmt_id >= len(fmts):
+        raise ValueError('unknown format ID %d' % fmt_id)
+
+    return format_entry(fmts[fmt_id], item[1][1:])
+
+
+def parse_body(text):
+    text = text.strip()
+    try:
+        return binascii.unhexlify(re.sub(r'\s+', '', text))
+    except (binascii.Error, ValueError):
+        return base64.b64decode(text)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Decode dictionary log entries (LOG_DICT).')
+    parser.add_argument('elf', help='ELF image the entries were produced by')
+    parser.add_argument('entries', nargs='*',
+                        help='entry bodies as hex or base64; '
+                             'read from stdin if none are given')
+    parser.add_argument('--list', action='store_true',
+                        help='print the format string dictionary and exit')
+    args = parser.parse_args()
+
+    fmts = Elf(args.elf).dict_fmts()
+    if args.list:
+        for i, fmt in enumerate(fmts):
+            print('%d: %r' % (i, fmt))
+        return 0
+
+    entries = args.entries or [l for l in sys.stdin if l.strip()]
+    rc = 0
+    for entry in entries:
+        try:
+            print(decode_entry(fmts, parse_body(entry)))
+        except ValueError as e:
+            print('error: %s' % e, file=sys.stderr)
+            rc = 1
+
+    return rc
+
+
+if __name__ == '__main__':
+    sys.exit(main())
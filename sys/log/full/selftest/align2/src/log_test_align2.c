@@ -24,11 +24,7 @@ int
 main(int argc, char **argv)
 {
     log_test_suite_fcb_flat();
-
-    /* XXX: The current fcb mbuf implementation requires flash-alignment=1. */
-#if 0
     log_test_suite_fcb_mbuf();
-#endif
 
     return tu_any_failed;
 }
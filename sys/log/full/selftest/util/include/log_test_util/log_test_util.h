@@ -74,6 +74,17 @@ TEST_CASE_DECL(log_test_case_append_cb);
 
 TEST_CASE_DECL(log_test_case_2logs);
 
+#if MYNEWT_VAL(LOG_ASYNC)
+TEST_SUITE_DECL(log_test_suite_async);
+TEST_CASE_DECL(log_test_case_async_append);
+TEST_CASE_DECL(log_test_case_async_overflow);
+#endif
+
+#if MYNEWT_VAL(LOG_DICT)
+TEST_SUITE_DECL(log_test_suite_dict);
+TEST_CASE_DECL(log_test_case_dict_printf);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
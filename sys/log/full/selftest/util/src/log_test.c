@@ -54,3 +54,18 @@ TEST_SUITE(log_test_suite_misc)
     log_test_case_2logs();
 #endif
 }
+
+#if MYNEWT_VAL(LOG_ASYNC)
+TEST_SUITE(log_test_suite_async)
+{
+    log_test_case_async_append();
+    log_test_case_async_overflow();
+}
+#endif
+
+#if MYNEWT_VAL(LOG_DICT)
+TEST_SUITE(log_test_suite_dict)
+{
+    log_test_case_dict_printf();
+}
+#endif
@@ -0,0 +1,94 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "log_test_util/log_test_util.h"
+
+#if MYNEWT_VAL(LOG_ASYNC)
+
+static int ltcaa_num_cbs;
+static uint32_t ltcaa_last_idx;
+
+static void
+ltcaa_append_cb(struct log *log, uint32_t idx)
+{
+    ltcaa_num_cbs++;
+    ltcaa_last_idx = idx;
+}
+
+static int
+ltcaa_walk_count(struct log *log, struct log_offset *log_offset,
+                 const void *dptr, uint16_t len)
+{
+    (*(int *)log_offset->lo_arg)++;
+    return 0;
+}
+
+TEST_CASE_TASK(log_test_case_async_append)
+{
+    struct log_offset log_offset = { 0 };
+    struct os_mbuf *om;
+    struct cbmem cbmem;
+    struct log log = {0};
+    uint32_t first_idx;
+    char *str;
+    int count;
+    int rc;
+    int i;
+
+    ltu_setup_cbmem(&cbmem, &log);
+    log_set_append_cb(&log, ltcaa_append_cb);
+
+    rc = log_set_async(&log, 1);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    first_idx = log_get_last_index(&log);
+    for (i = 0; ; i++) {
+        str = ltu_str_logs[i];
+        if (!str) {
+            break;
+        }
+
+        if (i % 2 == 0) {
+            rc = log_append_body(&log, 0, 0, LOG_ETYPE_STRING, str,
+                                 strlen(str));
+        } else {
+            om = ltu_flat_to_fragged_mbuf(str, strlen(str), 7);
+            rc = log_append_mbuf_body(&log, 0, 0, LOG_ETYPE_STRING, om);
+        }
+        TEST_ASSERT(rc == 0);
+    }
+
+    /* The writer task has a lower priority; nothing is written yet. */
+    count = 0;
+    log_offset.lo_arg = &count;
+    rc = log_walk(&log, ltcaa_walk_count, &log_offset);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(count == 0);
+    TEST_ASSERT(ltcaa_num_cbs == 0);
+
+    rc = log_async_sync(OS_TIMEOUT_NEVER);
+    TEST_ASSERT(rc == 0);
+
+    TEST_ASSERT(ltcaa_num_cbs == i);
+    TEST_ASSERT(ltcaa_last_idx == first_idx + i - 1);
+
+    ltu_verify_contents(&log);
+}
+
+#endif
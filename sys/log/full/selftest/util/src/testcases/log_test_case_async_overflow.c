@@ -0,0 +1,96 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "log_test_util/log_test_util.h"
+
+#if MYNEWT_VAL(LOG_ASYNC)
+
+#define LTCAO_BODY_LEN      200
+#define LTCAO_MAX_ENTRIES   64
+
+static int
+ltcao_walk_count(struct log *log, struct log_offset *log_offset,
+                 const void *dptr, uint16_t len)
+{
+    (*(int *)log_offset->lo_arg)++;
+    return 0;
+}
+
+static int
+ltcao_num_entries(struct log *log)
+{
+    struct log_offset log_offset = { 0 };
+    int count;
+    int rc;
+
+    count = 0;
+    log_offset.lo_arg = &count;
+    rc = log_walk(log, ltcao_walk_count, &log_offset);
+    TEST_ASSERT(rc == 0);
+
+    return count;
+}
+
+TEST_CASE_TASK(log_test_case_async_overflow)
+{
+    uint8_t body[LTCAO_BODY_LEN];
+    struct cbmem cbmem;
+    struct log log = {0};
+    int staged;
+    int rc;
+
+    ltu_setup_cbmem(&cbmem, &log);
+
+    rc = log_set_async(&log, 1);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    memset(body, 0xa5, sizeof(body));
+
+    /*** Fill the staging ring; excess entries are dropped. */
+
+    for (staged = 0; staged < LTCAO_MAX_ENTRIES; staged++) {
+        rc = log_append_body(&log, 0, 0, LOG_ETYPE_BINARY, body,
+                             sizeof(body));
+        if (rc != 0) {
+            break;
+        }
+    }
+    TEST_ASSERT(rc == SYS_ENOMEM);
+    TEST_ASSERT(staged > 0 && staged < LTCAO_MAX_ENTRIES);
+
+    rc = log_async_sync(OS_TIMEOUT_NEVER);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(ltcao_num_entries(&log) == staged);
+
+    /*** The ring is usable again once drained. */
+
+    rc = log_append_body(&log, 0, 0, LOG_ETYPE_BINARY, body, sizeof(body));
+    TEST_ASSERT(rc == 0);
+
+    /*** Flushing the log discards staged entries. */
+
+    rc = log_flush(&log);
+    TEST_ASSERT(rc == 0);
+
+    rc = log_async_sync(OS_TIMEOUT_NEVER);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(ltcao_num_entries(&log) == 0);
+}
+
+#endif
@@ -0,0 +1,138 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "log_test_util/log_test_util.h"
+
+#if MYNEWT_VAL(LOG_DICT)
+
+struct ltcdp_entry {
+    uint8_t etype;
+    uint8_t body[LOG_PRINTF_MAX_ENTRY_LEN];
+    uint16_t len;
+};
+
+static int
+ltcdp_walk_cb(struct log *log, struct log_offset *log_offset,
+              const struct log_entry_hdr *hdr, const void *dptr, uint16_t len)
+{
+    struct ltcdp_entry *entry;
+    int rc;
+
+    entry = log_offset->lo_arg;
+    entry->etype = hdr->ue_etype;
+    entry->len = len;
+
+    rc = log_read_body(log, dptr, entry->body, 0, len);
+    TEST_ASSERT_FATAL(rc == len);
+
+    return 0;
+}
+
+#define LTCDP_D20 \
+    "%d%d%d%d%d%d%d%d%d%d%d%d%d%d%d%d%d%d%d%d"
+#define LTCDP_ARGS20 \
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19
+
+static int
+ltcdp_encode(void *buf, int buf_len, const char *const *fmt, ...)
+{
+    va_list args;
+    int len;
+
+    va_start(args, fmt);
+    len = log_dict_vencode(buf, buf_len, fmt, args);
+    va_end(args);
+
+    return len;
+}
+
+TEST_CASE_SELF(log_test_case_dict_printf)
+{
+    static const uint8_t expected[] = {
+        0xd9, 0x6c, 0x64,           /* Tag LOG_DICT_CBOR_TAG. */
+        0x86,                       /* Array of 6 items. */
+        0x00,                       /* Format ID; patched below. */
+        0x24,                       /* -5 */
+        0x19, 0x12, 0x34,           /* 0x1234 */
+        0x63, 'a', 'b', 'c',        /* "abc" */
+        0x03,                       /* Width of %*.2f. */
+        0xfb, 0x3f, 0xf8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  /* 1.5 */
+    };
+    struct log_offset log_offset = { 0 };
+    struct ltcdp_entry entry = { 0 };
+    const char *const *fmt;
+    uint8_t exp[sizeof(expected)];
+    struct cbmem cbmem;
+    struct log log = {0};
+    uint32_t id;
+    int rc;
+
+    ltu_setup_cbmem(&cbmem, &log);
+
+    LOG_ERROR(&log, 0, "d=%d x=%04lx s=%s f=%*.2f%%\n", -5, 0x1234UL, "abc", 3,
+              1.5);
+
+    log_offset.lo_arg = &entry;
+    rc = log_walk_body(&log, ltcdp_walk_cb, &log_offset);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    TEST_ASSERT(entry.etype == LOG_ETYPE_CBOR);
+    TEST_ASSERT_FATAL(entry.len == sizeof(expected));
+
+    /* The format string ID indexes the dictionary. */
+    id = entry.body[4];
+    TEST_ASSERT_FATAL(id < log_dict_fmts_size());
+    TEST_ASSERT(strcmp(LINK_TABLE_START(log_dict_fmts)[id],
+                       "d=%d x=%04lx s=%s f=%*.2f%%\n") == 0);
+
+    memcpy(exp, expected, sizeof(exp));
+    exp[4] = id;
+    TEST_ASSERT(memcmp(entry.body, exp, sizeof(exp)) == 0);
+
+    /* Direct encoding; arguments that don't fit are omitted. */
+    fmt = LOG_DICT_FMT("%s %d");
+    memset(&entry, 0, sizeof(entry));
+    entry.len = ltcdp_encode(entry.body, 8, fmt, "abcdefgh", 7);
+    TEST_ASSERT(entry.len == 8);
+    TEST_ASSERT(entry.body[3] == 0x82);
+    TEST_ASSERT(entry.body[4] == log_dict_fmt_id(fmt));
+    TEST_ASSERT(entry.body[5] == 0x62);
+    TEST_ASSERT(memcmp(&entry.body[6], "ab", 2) == 0);
+
+    /* At most 22 arguments are encoded, starred width and precision
+     * included; the item count must not exceed the one byte array header.
+     */
+    fmt = LOG_DICT_FMT(LTCDP_D20 "%d%*.*d");
+    memset(&entry, 0, sizeof(entry));
+    entry.len = ltcdp_encode(entry.body, sizeof(entry.body), fmt,
+                             LTCDP_ARGS20, 20, 21, 22, 23);
+    TEST_ASSERT_FATAL(entry.len > 5);
+    TEST_ASSERT(entry.body[3] == 0x97);
+    TEST_ASSERT(entry.body[entry.len - 1] == 21);
+
+    fmt = LOG_DICT_FMT(LTCDP_D20 "%*.*d");
+    memset(&entry, 0, sizeof(entry));
+    entry.len = ltcdp_encode(entry.body, sizeof(entry.body), fmt,
+                             LTCDP_ARGS20, 20, 21, 22);
+    TEST_ASSERT_FATAL(entry.len > 5);
+    TEST_ASSERT(entry.body[3] == 0x97);
+    TEST_ASSERT(entry.body[entry.len - 1] == 21);
+}
+
+#endif
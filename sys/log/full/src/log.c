@@ -25,6 +25,7 @@
 #include "os/mynewt.h"
 #include "cbmem/cbmem.h"
 #include "log/log.h"
+#include "log_priv.h"
 #if MYNEWT_VAL(LOG_STORAGE_WATERMARK)
 #include "config/config.h"
 #endif
@@ -130,6 +131,10 @@ log_init(void)
     log_console_init();
 #endif
 
+#if MYNEWT_VAL(LOG_ASYNC)
+    log_async_init();
+#endif
+
 #if MYNEWT_VAL(LOG_STORAGE_WATERMARK)
 #if MYNEWT_VAL(LOG_PERSIST_WATERMARK)
     rc = conf_register(&log_conf);
@@ -428,6 +433,9 @@ log_register(const char *name, struct log *log, const struct log_handler *lh,
     log->l_level = level;
     log->l_append_cb = NULL;
     log->l_max_entry_len = 0;
+#if MYNEWT_VAL(LOG_ASYNC)
+    log->l_async = 0;
+#endif
 #if !MYNEWT_VAL(LOG_GLOBAL_IDX)
     log->l_idx = 0;
 #endif
@@ -644,7 +652,7 @@ err:
 /**
  * Calls the given log's append callback, if it has one.
  */
-static void
+void
 log_call_append_cb(struct log *log, uint32_t idx)
 {
     /* Qualify this as `volatile` to prevent a race condition.  This prevents
@@ -683,6 +691,17 @@ log_append_typed(struct log *log, uint8_t module, uint8_t level, uint8_t etype,
         goto err;
     }
 
+#if MYNEWT_VAL(LOG_ASYNC)
+    if (log->l_async) {
+        rc = log_async_append_body(log, hdr,
+                                   (uint8_t *)data + log_hdr_len(hdr), len);
+        if (rc != 0) {
+            goto err;
+        }
+        return 0;
+    }
+#endif
+
     rc = log->l_log->log_append(log, data, len + log_hdr_len(hdr));
     if (rc != 0) {
         LOG_STATS_INC(log, errs);
@@ -723,6 +742,16 @@ log_append_body(struct log *log, uint8_t module, uint8_t level, uint8_t etype,
         goto err;
     }
 
+#if MYNEWT_VAL(LOG_ASYNC)
+    if (log->l_async) {
+        rc = log_async_append_body(log, &hdr, body, body_len);
+        if (rc != 0) {
+            goto err;
+        }
+        return 0;
+    }
+#endif
+
     rc = log->l_log->log_append_body(log, &hdr, body, body_len);
     if (rc != 0) {
         LOG_STATS_INC(log, errs);
@@ -803,6 +832,22 @@ log_append_mbuf_typed_no_free(struct log *log, uint8_t module, uint8_t level,
         goto drop;
     }
 
+#if MYNEWT_VAL(LOG_ASYNC)
+    if (log->l_async) {
+        hdr_len = log_hdr_len(hdr);
+        if (len < hdr_len) {
+            rc = SYS_EINVAL;
+            goto drop;
+        }
+        rc = log_async_append_mbuf_body(log, hdr, om, hdr_len, len - hdr_len);
+        if (rc != 0) {
+            goto drop;
+        }
+        *om_ptr = om;
+        return 0;
+    }
+#endif
+
     rc = log->l_log->log_append_mbuf(log, om);
     if (rc != 0) {
         goto err;
@@ -872,6 +917,16 @@ log_append_mbuf_body_no_free(struct log *log, uint8_t module, uint8_t level,
         goto drop;
     }
 
+#if MYNEWT_VAL(LOG_ASYNC)
+    if (log->l_async) {
+        rc = log_async_append_mbuf_body(log, &hdr, om, 0, len);
+        if (rc != 0) {
+            goto drop;
+        }
+        return 0;
+    }
+#endif
+
     rc = log->l_log->log_append_mbuf_body(log, &hdr, om);
     if (rc != 0) {
         goto err;
@@ -1141,6 +1196,11 @@ log_flush(struct log *log)
     log_trailer_reset_data(log, log->l_tr_arg);
 #endif
 
+#if MYNEWT_VAL(LOG_ASYNC)
+    /* Staged entries predate the flush; don't let them reappear. */
+    log_async_discard(log);
+#endif
+
     rc = log->l_log->log_flush(log);
     if (rc != 0) {
         goto err;
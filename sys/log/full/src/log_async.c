@@ -0,0 +1,600 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <assert.h>
+#include <string.h>
+
+#include "os/mynewt.h"
+#include "log/log.h"
+#include "log_priv.h"
+
+#if MYNEWT_VAL(LOG_ASYNC)
+
+/*
+ * Asynchronous (deferred) log writes.
+ *
+ * Appends to an asynchronous log are prepared (timestamp, index, level
+ * filtering) in the caller's context, then copied into a staging ring shared
+ * by all asynchronous logs.  The interrupts-disabled section only covers the
+ * space reservation; the entry is copied afterwards and published by marking
+ * its record ready.  A dedicated low priority task drains ready records in
+ * order and writes them with the log handler's append_body function.
+ *
+ * Each record is a struct log_async_rec followed by the entry body, padded
+ * to OS_ALIGNMENT.  Records never wrap; when a record does not fit at the
+ * end of the ring, the remaining space is turned into padding and the record
+ * is placed at the beginning.
+ */
+
+#define LOG_ASYNC_BUF_SIZE  \
+    OS_ALIGN(MYNEWT_VAL(LOG_ASYNC_BUF_SIZE), OS_ALIGNMENT)
+
+#define LOG_ASYNC_REC_RESERVED  1   /* Being filled in by the producer */
+#define LOG_ASYNC_REC_READY     2   /* Waiting for the writer task */
+#define LOG_ASYNC_REC_BUSY      3   /* Being written by the writer task */
+#define LOG_ASYNC_REC_PAD       4   /* Padding up to the end of the ring */
+
+struct log_async_rec {
+    /* Destination log; NULL if the entry was discarded */
+    struct log *lar_log;
+    struct log_entry_hdr lar_hdr;
+    volatile uint8_t lar_state;
+    uint16_t lar_len;
+};
+
+struct log_async {
+    uint32_t la_head;
+    uint32_t la_tail;
+    uint32_t la_used;
+    /* Number of tasks waiting on la_sem */
+    uint16_t la_waiters;
+    struct os_sem la_sem;
+    struct os_eventq la_evq;
+    struct os_event la_ev;
+    struct os_task la_task;
+};
+
+static struct log_async log_async;
+static os_membuf_t log_async_buf[LOG_ASYNC_BUF_SIZE / sizeof(os_membuf_t)];
+OS_TASK_STACK_DEFINE(log_async_stack, MYNEWT_VAL(LOG_ASYNC_STACK_SIZE));
+
+#if MYNEWT_VAL(LOG_STATS)
+STATS_SECT_START(log_async_stats)
+    STATS_SECT_ENTRY(staged)
+    STATS_SECT_ENTRY(written)
+    STATS_SECT_ENTRY(errs)
+    STATS_SECT_ENTRY(drop_newest)
+    STATS_SECT_ENTRY(drop_oldest)
+    STATS_SECT_ENTRY(discarded)
+    STATS_SECT_ENTRY(blocked)
+    STATS_SECT_ENTRY(depth)
+    STATS_SECT_ENTRY(max_depth)
+STATS_SECT_END
+
+STATS_NAME_START(log_async_stats)
+    STATS_NAME(log_async_stats, staged)
+    STATS_NAME(log_async_stats, written)
+    STATS_NAME(log_async_stats, errs)
+    STATS_NAME(log_async_stats, drop_newest)
+    STATS_NAME(log_async_stats, drop_oldest)
+    STATS_NAME(log_async_stats, discarded)
+    STATS_NAME(log_async_stats, blocked)
+    STATS_NAME(log_async_stats, depth)
+    STATS_NAME(log_async_stats, max_depth)
+STATS_NAME_END(log_async_stats)
+
+static STATS_SECT_DECL(log_async_stats) log_async_stats;
+
+#define LOG_ASYNC_STATS_INC(name)   STATS_INC(log_async_stats, name)
+#else
+#define LOG_ASYNC_STATS_INC(name)
+#endif
+
+static inline struct log_async_rec *
+log_async_rec_at(uint32_t off)
+{
+    return (struct log_async_rec *)((uint8_t *)log_async_buf + off);
+}
+
+static inline uint32_t
+log_async_rec_size(uint16_t body_len)
+{
+    return OS_ALIGN(sizeof(struct log_async_rec) + body_len, OS_ALIGNMENT);
+}
+
+/**
+ * Updates the queue depth statistics.  Must be called with interrupts
+ * disabled.
+ */
+static void
+log_async_update_depth(void)
+{
+#if MYNEWT_VAL(LOG_STATS)
+    STATS_SET(log_async_stats, depth, log_async.la_used);
+    if (log_async.la_used > STATS_GET(log_async_stats, max_depth)) {
+        STATS_SET(log_async_stats, max_depth, log_async.la_used);
+    }
+#endif
+}
+
+/**
+ * Releases a record (or padding) of the specified size at the tail of the
+ * ring and skips over any wrap padding that follows.  Must be called with
+ * interrupts disabled.
+ */
+static void
+log_async_release(uint32_t size)
+{
+    uint32_t rem;
+
+    log_async.la_tail += size;
+    log_async.la_used -= size;
+    if (log_async.la_tail == LOG_ASYNC_BUF_SIZE) {
+        log_async.la_tail = 0;
+    }
+
+    if (log_async.la_used == 0) {
+        return;
+    }
+
+    /* The end of the ring is padding if it is too small to hold a record or
+     * if the producer marked it as such when wrapping.
+     */
+    rem = LOG_ASYNC_BUF_SIZE - log_async.la_tail;
+    if (rem < sizeof(struct log_async_rec) ||
+        log_async_rec_at(log_async.la_tail)->lar_state == LOG_ASYNC_REC_PAD) {
+
+        log_async.la_tail = 0;
+        log_async.la_used -= rem;
+    }
+}
+
+/**
+ * Reserves space for a record.  The record's log and length are filled in
+ * before the space is published so that the ring can be walked while the
+ * body is still being copied.  Must be called with interrupts disabled.
+ *
+ * @return                      The offset of the reserved space; -1 if the
+ *                                  ring does not have enough room.
+ */
+static int
+log_async_reserve_locked(struct log *log, uint16_t body_len)
+{
+    struct log_async_rec *rec;
+    uint32_t size;
+    uint32_t off;
+    uint32_t rem;
+
+    size = log_async_rec_size(body_len);
+
+    if (log_async.la_used == 0) {
+        log_async.la_head = 0;
+        log_async.la_tail = 0;
+    }
+
+    if (log_async.la_used == 0 || log_async.la_head > log_async.la_tail) {
+        rem = LOG_ASYNC_BUF_SIZE - log_async.la_head;
+        if (rem >= size) {
+            off = log_async.la_head;
+        } else if (log_async.la_tail >= size) {
+            /* Pad out the end of the ring and wrap around. */
+            if (rem >= sizeof(struct log_async_rec)) {
+                log_async_rec_at(log_async.la_head)->lar_state =
+                    LOG_ASYNC_REC_PAD;
+            }
+            log_async.la_used += rem;
+            off = 0;
+        } else {
+            return -1;
+        }
+    } else if (log_async.la_tail - log_async.la_head >= size) {
+        off = log_async.la_head;
+    } else {
+        return -1;
+    }
+
+    log_async.la_head = off + size;
+    if (log_async.la_head == LOG_ASYNC_BUF_SIZE) {
+        log_async.la_head = 0;
+    }
+    log_async.la_used += size;
+
+    rec = log_async_rec_at(off);
+    rec->lar_state = LOG_ASYNC_REC_RESERVED;
+    rec->lar_log = log;
+    rec->lar_len = body_len;
+    log_async_update_depth();
+
+    return off;
+}
+
+#if MYNEWT_VAL_CHOICE(LOG_ASYNC_OVERFLOW, drop_oldest)
+/**
+ * Drops the oldest staged record to make room for a new one.  Records that
+ * are still being filled in or written cannot be dropped.  Must be called
+ * with interrupts disabled.
+ *
+ * @return                      1 if a record was dropped; 0 otherwise.
+ */
+static int
+log_async_drop_oldest_locked(void)
+{
+    struct log_async_rec *rec;
+
+    if (log_async.la_used == 0) {
+        return 0;
+    }
+
+    rec = log_async_rec_at(log_async.la_tail);
+    if (rec->lar_state != LOG_ASYNC_REC_READY) {
+        return 0;
+    }
+
+    if (rec->lar_log != NULL) {
+        LOG_STATS_INC(rec->lar_log, drops);
+    }
+    LOG_ASYNC_STATS_INC(drop_oldest);
+
+    log_async_release(log_async_rec_size(rec->lar_len));
+
+    return 1;
+}
+#endif
+
+/**
+ * Withdraws the calling task from the waiter count after its wait on la_sem
+ * timed out.  If the writer task claimed the waiter first, the token it
+ * releases only causes a spurious wakeup, which all waiters tolerate.
+ */
+static void
+log_async_cancel_wait(void)
+{
+    int sr;
+
+    OS_ENTER_CRITICAL(sr);
+    if (log_async.la_waiters > 0) {
+        log_async.la_waiters--;
+    }
+    OS_EXIT_CRITICAL(sr);
+}
+
+#if MYNEWT_VAL_CHOICE(LOG_ASYNC_OVERFLOW, block)
+/**
+ * Indicates whether the caller may wait for the writer task.
+ */
+static int
+log_async_can_block(void)
+{
+    return os_started() && !os_arch_in_isr() &&
+           os_sched_get_current_task() != &log_async.la_task;
+}
+#endif
+
+/**
+ * Reserves a record for an entry with the specified body length, applying
+ * the configured overflow policy if the ring is full.
+ */
+static struct log_async_rec *
+log_async_reserve(struct log *log, uint16_t body_len)
+{
+    uint32_t size;
+    int off;
+    int sr;
+#if MYNEWT_VAL_CHOICE(LOG_ASYNC_OVERFLOW, block)
+    int rc;
+#endif
+
+    size = log_async_rec_size(body_len);
+    if (size > LOG_ASYNC_BUF_SIZE) {
+        goto drop;
+    }
+
+    while (1) {
+        OS_ENTER_CRITICAL(sr);
+
+        off = log_async_reserve_locked(log, body_len);
+#if MYNEWT_VAL_CHOICE(LOG_ASYNC_OVERFLOW, drop_oldest)
+        while (off < 0 && log_async_drop_oldest_locked()) {
+            off = log_async_reserve_locked(log, body_len);
+        }
+#endif
+        if (off >= 0) {
+            OS_EXIT_CRITICAL(sr);
+            return log_async_rec_at(off);
+        }
+
+#if MYNEWT_VAL_CHOICE(LOG_ASYNC_OVERFLOW, block)
+        if (log_async_can_block()) {
+            log_async.la_waiters++;
+            OS_EXIT_CRITICAL(sr);
+
+            LOG_ASYNC_STATS_INC(blocked);
+            rc = os_sem_pend(&log_async.la_sem, os_time_ms_to_ticks32(
+                                 MYNEWT_VAL(LOG_ASYNC_BLOCK_TIMEOUT)));
+            if (rc == OS_TIMEOUT) {
+                log_async_cancel_wait();
+                goto drop;
+            }
+            continue;
+        }
+#endif
+
+        OS_EXIT_CRITICAL(sr);
+        break;
+    }
+
+drop:
+    LOG_STATS_INC(log, drops);
+    LOG_ASYNC_STATS_INC(drop_newest);
+    return NULL;
+}
+
+/**
+ * Publishes a filled-in record and wakes up the writer task.
+ */
+static void
+log_async_commit(struct log_async_rec *rec)
+{
+    rec->lar_state = LOG_ASYNC_REC_READY;
+    LOG_ASYNC_STATS_INC(staged);
+
+    os_eventq_put(&log_async.la_evq, &log_async.la_ev);
+}
+
+int
+log_async_append_body(struct log *log, const struct log_entry_hdr *hdr,
+                      const void *body, uint16_t body_len)
+{
+    struct log_async_rec *rec;
+
+    rec = log_async_reserve(log, body_len);
+    if (rec == NULL) {
+        return SYS_ENOMEM;
+    }
+
+    rec->lar_hdr = *hdr;
+    memcpy(rec + 1, body, body_len);
+
+    log_async_commit(rec);
+
+    return 0;
+}
+
+int
+log_async_append_mbuf_body(struct log *log, const struct log_entry_hdr *hdr,
+                           const struct os_mbuf *om, uint16_t off,
+                           uint16_t body_len)
+{
+    struct log_async_rec *rec;
+    int rc;
+
+    rec = log_async_reserve(log, body_len);
+    if (rec == NULL) {
+        return SYS_ENOMEM;
+    }
+
+    rc = os_mbuf_copydata(om, off, body_len, rec + 1);
+
+    /* The record is still committed on failure so that the ring stays
+     * consistent; the writer task skips it.
+     */
+    if (rc != 0) {
+        rec->lar_log = NULL;
+    }
+    rec->lar_hdr = *hdr;
+
+    log_async_commit(rec);
+
+    return rc == 0 ? 0 : SYS_EINVAL;
+}
+
+void
+log_async_discard(struct log *log)
+{
+    struct log_async_rec *rec;
+    uint32_t remaining;
+    uint32_t size;
+    uint32_t off;
+    int sr;
+
+    OS_ENTER_CRITICAL(sr);
+
+    off = log_async.la_tail;
+    remaining = log_async.la_used;
+    while (remaining > 0) {
+        size = LOG_ASYNC_BUF_SIZE - off;
+        rec = log_async_rec_at(off);
+        if (size < sizeof(struct log_async_rec) ||
+            rec->lar_state == LOG_ASYNC_REC_PAD) {
+
+            off = 0;
+        } else {
+            size = log_async_rec_size(rec->lar_len);
+            if (rec->lar_state != LOG_ASYNC_REC_BUSY && rec->lar_log == log) {
+                rec->lar_log = NULL;
+                LOG_ASYNC_STATS_INC(discarded);
+            }
+            off += size;
+            if (off == LOG_ASYNC_BUF_SIZE) {
+                off = 0;
+            }
+        }
+        remaining -= size;
+    }
+
+    OS_EXIT_CRITICAL(sr);
+}
+
+/**
+ * Wakes up all tasks waiting for the ring to drain.
+ */
+static void
+log_async_wake_waiters(void)
+{
+    uint16_t waiters;
+    int sr;
+
+    OS_ENTER_CRITICAL(sr);
+    waiters = log_async.la_waiters;
+    log_async.la_waiters = 0;
+    OS_EXIT_CRITICAL(sr);
+
+    while (waiters-- > 0) {
+        os_sem_release(&log_async.la_sem);
+    }
+}
+
+/**
+ * Writer task event handler; writes out all ready records in order.
+ */
+static void
+log_async_drain(struct os_event *ev)
+{
+    struct log_async_rec *rec;
+    struct log *log;
+    int rc;
+    int sr;
+
+    while (1) {
+        OS_ENTER_CRITICAL(sr);
+        rec = log_async_rec_at(log_async.la_tail);
+        if (log_async.la_used == 0 ||
+            rec->lar_state != LOG_ASYNC_REC_READY) {
+
+            /* Records still being filled in are published with a new
+             * event once complete.
+             */
+            OS_EXIT_CRITICAL(sr);
+            break;
+        }
+        rec->lar_state = LOG_ASYNC_REC_BUSY;
+        log = rec->lar_log;
+        OS_EXIT_CRITICAL(sr);
+
+        if (log != NULL) {
+            rc = log->l_log->log_append_body(log, &rec->lar_hdr, rec + 1,
+                                             rec->lar_len);
+            if (rc == 0) {
+                LOG_ASYNC_STATS_INC(written);
+                log_call_append_cb(log, rec->lar_hdr.ue_index);
+            } else {
+                LOG_STATS_INC(log, errs);
+                LOG_ASYNC_STATS_INC(errs);
+            }
+        }
+
+        OS_ENTER_CRITICAL(sr);
+        log_async_release(log_async_rec_size(rec->lar_len));
+        log_async_update_depth();
+        OS_EXIT_CRITICAL(sr);
+
+        log_async_wake_waiters();
+    }
+}
+
+static void
+log_async_task_handler(void *arg)
+{
+    while (1) {
+        os_eventq_run(&log_async.la_evq);
+    }
+}
+
+int
+log_set_async(struct log *log, int async)
+{
+    if (async && log->l_log->log_append_body == NULL) {
+        return SYS_ENOTSUP;
+    }
+
+    log->l_async = !!async;
+
+    return 0;
+}
+
+int
+log_async_sync(os_time_t timeout)
+{
+    os_time_t deadline;
+    os_time_t now;
+    int sr;
+    int rc;
+
+    if (!os_started() || os_arch_in_isr() ||
+        os_sched_get_current_task() == &log_async.la_task) {
+        return SYS_EINVAL;
+    }
+
+    deadline = os_time_get() + timeout;
+    while (1) {
+        OS_ENTER_CRITICAL(sr);
+        if (log_async.la_used == 0) {
+            OS_EXIT_CRITICAL(sr);
+            return 0;
+        }
+
+        now = os_time_get();
+        if (timeout != OS_TIMEOUT_NEVER && !OS_TIME_TICK_LT(now, deadline)) {
+            OS_EXIT_CRITICAL(sr);
+            return SYS_ETIMEOUT;
+        }
+
+        /* Only count the waiter while it is pending on the semaphore. */
+        log_async.la_waiters++;
+        OS_EXIT_CRITICAL(sr);
+
+        rc = os_sem_pend(&log_async.la_sem, timeout == OS_TIMEOUT_NEVER ?
+                                            OS_TIMEOUT_NEVER : deadline - now);
+        if (rc == OS_TIMEOUT) {
+            log_async_cancel_wait();
+        }
+    }
+}
+
+void
+log_async_init(void)
+{
+    int rc;
+
+    memset(&log_async, 0, sizeof(log_async));
+
+    rc = os_sem_init(&log_async.la_sem, 0);
+    SYSINIT_PANIC_ASSERT(rc == 0);
+
+    os_eventq_init(&log_async.la_evq);
+    log_async.la_ev.ev_cb = log_async_drain;
+
+#if MYNEWT_VAL(LOG_STATS)
+    rc = stats_init(STATS_HDR(log_async_stats),
+                    STATS_SIZE_INIT_PARMS(log_async_stats, STATS_SIZE_32),
+                    STATS_NAME_INIT_PARMS(log_async_stats));
+    SYSINIT_PANIC_ASSERT(rc == 0);
+
+    /* Fails harmlessly if log_init() runs more than once (unit tests). */
+    stats_register("log_async", STATS_HDR(log_async_stats));
+#endif
+
+    rc = os_task_init(&log_async.la_task, "log_async",
+                      log_async_task_handler, NULL,
+                      MYNEWT_VAL(LOG_ASYNC_TASK_PRIO), OS_WAIT_FOREVER,
+                      log_async_stack, MYNEWT_VAL(LOG_ASYNC_STACK_SIZE));
+    SYSINIT_PANIC_ASSERT(rc == 0);
+}
+
+#endif /* MYNEWT_VAL(LOG_ASYNC) */
@@ -0,0 +1,385 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdarg.h>
+
+#include "os/mynewt.h"
+#include "log/log.h"
+
+#if MYNEWT_VAL(LOG_DICT)
+
+#define LOG_DICT_CBOR_UINT      0
+#define LOG_DICT_CBOR_NINT      1
+#define LOG_DICT_CBOR_TEXT      3
+#define LOG_DICT_CBOR_ARRAY     4
+#define LOG_DICT_CBOR_TAG_TYPE  6
+#define LOG_DICT_CBOR_FLOAT64   0xfb
+
+/* The array header is a single byte; one item is the format ID. */
+#define LOG_DICT_MAX_ARGS       22
+
+struct log_dict_enc {
+    uint8_t *buf;
+    int len;
+    int off;
+};
+
+static int
+log_dict_hdr_len(uint64_t val)
+{
+    if (val < 24) {
+        return 1;
+    } else if (val <= UINT8_MAX) {
+        return 2;
+    } else if (val <= UINT16_MAX) {
+        return 3;
+    } else if (val <= UINT32_MAX) {
+        return 5;
+    } else {
+        return 9;
+    }
+}
+
+static void
+log_dict_put_be(uint8_t *dst, uint64_t val, int len)
+{
+    while (len-- > 0) {
+        dst[len] = val;
+        val >>= 8;
+    }
+}
+
+static int
+log_dict_put_hdr(struct log_dict_enc *enc, uint8_t major, uint64_t val)
+{
+    uint8_t *dst;
+    int len;
+
+    len = log_dict_hdr_len(val);
+    if (enc->off + len > enc->len) {
+        return -1;
+    }
+
+    dst = enc->buf + enc->off;
+    switch (len) {
+    case 1:
+        dst[0] = (major << 5) | val;
+        break;
+    case 2:
+        dst[0] = (major << 5) | 24;
+        break;
+    case 3:
+        dst[0] = (major << 5) | 25;
+        break;
+    case 5:
+        dst[0] = (major << 5) | 26;
+        break;
+    default:
+        dst[0] = (major << 5) | 27;
+        break;
+    }
+    if (len > 1) {
+        log_dict_put_be(dst + 1, val, len - 1);
+    }
+    enc->off += len;
+
+    return 0;
+}
+
+static int
+log_dict_put_int(struct log_dict_enc *enc, int64_t val)
+{
+    if (val >= 0) {
+        return log_dict_put_hdr(enc, LOG_DICT_CBOR_UINT, val);
+    } else {
+        return log_dict_put_hdr(enc, LOG_DICT_CBOR_NINT, ~(uint64_t)val);
+    }
+}
+
+static int
+log_dict_put_str(struct log_dict_enc *enc, const char *str)
+{
+    int avail;
+    int len;
+
+    if (str == NULL) {
+        str = "(null)";
+    }
+
+    /* Long strings are truncated to the space left in the entry. */
+    avail = enc->len - enc->off;
+    len = strlen(str);
+    if (log_dict_hdr_len(len) + len > avail) {
+        len = avail - log_dict_hdr_len(avail);
+        if (len < 0) {
+            return -1;
+        }
+    }
+
+    log_dict_put_hdr(enc, LOG_DICT_CBOR_TEXT, len);
+    memcpy(enc->buf + enc->off, str, len);
+    enc->off += len;
+
+    return 0;
+}
+
+static int
+log_dict_put_double(struct log_dict_enc *enc, double val)
+{
+    uint64_t bits;
+
+    if (enc->off + 9 > enc->len) {
+        return -1;
+    }
+
+    memcpy(&bits, &val, sizeof(bits));
+    enc->buf[enc->off] = LOG_DICT_CBOR_FLOAT64;
+    log_dict_put_be(enc->buf + enc->off + 1, bits, 8);
+    enc->off += 9;
+
+    return 0;
+}
+
+/**
+ * Fetches the argument for a single signed conversion.
+ */
+static int64_t
+log_dict_arg_signed(char lenmod, va_list *ap)
+{
+    switch (lenmod) {
+    case 'l':
+        return va_arg(*ap, long);
+    case 'q':
+        return va_arg(*ap, long long);
+    case 'j':
+        return va_arg(*ap, intmax_t);
+    case 'z':
+    case 't':
+        return va_arg(*ap, ptrdiff_t);
+    default:
+        return va_arg(*ap, int);
+    }
+}
+
+/**
+ * Fetches the argument for a single unsigned conversion.
+ */
+static uint64_t
+log_dict_arg_unsigned(char lenmod, va_list *ap)
+{
+    switch (lenmod) {
+    case 'l':
+        return va_arg(*ap, unsigned long);
+    case 'q':
+        return va_arg(*ap, unsigned long long);
+    case 'j':
+        return va_arg(*ap, uintmax_t);
+    case 'z':
+    case 't':
+        return va_arg(*ap, size_t);
+    default:
+        return va_arg(*ap, unsigned int);
+    }
+}
+
+int
+log_dict_vencode(void *buf, int buf_len, const char *const *fmt, va_list ap)
+{
+    struct log_dict_enc enc = {
+        .buf = buf,
+        .len = buf_len,
+    };
+    va_list args;
+    const char *p;
+    char lenmod;
+    int arr_off;
+    int nargs;
+    int rc;
+
+    rc = log_dict_put_hdr(&enc, LOG_DICT_CBOR_TAG_TYPE, LOG_DICT_CBOR_TAG);
+    if (rc != 0 || enc.off >= enc.len) {
+        return 0;
+    }
+
+    /* The item count is filled in once all arguments are encoded. */
+    arr_off = enc.off++;
+
+    rc = log_dict_put_hdr(&enc, LOG_DICT_CBOR_UINT, log_dict_fmt_id(fmt));
+    if (rc != 0) {
+        return 0;
+    }
+
+    /* Walk the format string only to find out the type of each argument;
+     * nothing is formatted here.
+     */
+    va_copy(args, ap);
+    nargs = 0;
+    for (p = *fmt; *p != '\0' && rc == 0; p++) {
+        if (*p != '%') {
+            continue;
+        }
+        p++;
+        if (*p == '%') {
+            continue;
+        }
+
+        while (*p != '\0' && strchr("-+ #0", *p) != NULL) {
+            p++;
+        }
+
+        /* Starred width and precision consume an argument too. */
+        if (*p == '*') {
+            if (nargs >= LOG_DICT_MAX_ARGS) {
+                break;
+            }
+            rc = log_dict_put_int(&enc, va_arg(args, int));
+            if (rc != 0) {
+                break;
+            }
+            nargs++;
+            p++;
+        }
+        while (*p >= '0' && *p <= '9') {
+            p++;
+        }
+        if (*p == '.') {
+            p++;
+            if (*p == '*') {
+                if (nargs >= LOG_DICT_MAX_ARGS) {
+                    break;
+                }
+                rc = log_dict_put_int(&enc, va_arg(args, int));
+                if (rc != 0) {
+                    break;
+                }
+                nargs++;
+                p++;
+            }
+            while (*p >= '0' && *p <= '9') {
+                p++;
+            }
+        }
+
+        lenmod = '\0';
+        switch (*p) {
+        case 'h':
+            p++;
+            if (*p == 'h') {
+                p++;
+            }
+            break;
+        case 'l':
+            p++;
+            lenmod = 'l';
+            if (*p == 'l') {
+                p++;
+                lenmod = 'q';
+            }
+            break;
+        case 'j':
+        case 'z':
+        case 't':
+        case 'L':
+            lenmod = *p++;
+            break;
+        }
+
+        if (nargs >= LOG_DICT_MAX_ARGS) {
+            break;
+        }
+
+        switch (*p) {
+        case 'd':
+        case 'i':
+            rc = log_dict_put_int(&enc, log_dict_arg_signed(lenmod, &args));
+            break;
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+            rc = log_dict_put_hdr(&enc, LOG_DICT_CBOR_UINT,
+                                  log_dict_arg_unsigned(lenmod, &args));
+            break;
+        case 'c':
+            rc = log_dict_put_int(&enc, va_arg(args, int));
+            break;
+        case 'p':
+            rc = log_dict_put_hdr(&enc, LOG_DICT_CBOR_UINT,
+                                  (uintptr_t)va_arg(args, void *));
+            break;
+        case 's':
+            rc = log_dict_put_str(&enc, va_arg(args, const char *));
+            break;
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            if (lenmod == 'L') {
+                rc = log_dict_put_double(&enc, va_arg(args, long double));
+            } else {
+                rc = log_dict_put_double(&enc, va_arg(args, double));
+            }
+            break;
+        default:
+            /* Unknown conversion; the remaining argument types can't be
+             * determined.
+             */
+            rc = -1;
+            break;
+        }
+
+        if (rc == 0) {
+            nargs++;
+        }
+        if (*p == '\0') {
+            break;
+        }
+    }
+    va_end(args);
+
+    enc.buf[arr_off] = (LOG_DICT_CBOR_ARRAY << 5) | (nargs + 1);
+
+    return enc.off;
+}
+
+void
+log_printf_dict(struct log *log, uint8_t module, uint8_t level,
+                const char *const *fmt, ...)
+{
+    va_list args;
+    uint8_t buf[LOG_PRINTF_MAX_ENTRY_LEN];
+    int len;
+
+    va_start(args, fmt);
+    len = log_dict_vencode(buf, sizeof(buf), fmt, args);
+    va_end(args);
+
+    if (len > 0) {
+        log_append_body(log, module, level, LOG_ETYPE_CBOR, buf, len);
+    }
+}
+
+#endif /* MYNEWT_VAL(LOG_DICT) */
@@ -30,6 +30,9 @@
 /* Assume the flash alignment requirement is no stricter than 32. */
 #define LOG_FCB_MAX_ALIGN   32
 
+/* Number of segments handed to flash per vectored write. */
+#define LOG_FCB_MBUF_IOV_CNT    8
+
 #define LOG_FCB_EXT_HDR_SIZE LOG_BASE_ENTRY_HDR_SIZE + LOG_IMG_HASHLEN + \
     LOG_FCB_MAX_ALIGN
 
@@ -514,20 +517,92 @@ log_fcb_append(struct log *log, void *buf, int len)
                                len - hdr_len);
 }
 
+/*
+ * Writes the entry header followed by the mbuf chain, straight from the mbuf
+ * data buffers.  The chain is handed to flash in batches of
+ * LOG_FCB_MBUF_IOV_CNT segments; the unaligned tail of each batch (less than
+ * one alignment unit) is held back and leads the next batch, so only those
+ * few bytes are ever copied.
+ */
 static int
-log_fcb_write_mbuf(struct fcb_entry *loc, struct os_mbuf *om)
+log_fcb_write_mbuf(struct fcb *fcb, struct fcb_entry *loc,
+                   const struct log_entry_hdr *hdr, const struct os_mbuf *om)
 {
+    uint8_t carry[2][LOG_FCB_MAX_ALIGN];
+    struct os_iovec iov[LOG_FCB_MBUF_IOV_CNT];
+    struct os_mbuf_iov_iter it;
+    uint32_t excess;
+    uint32_t align;
+    uint32_t held;
+    uint32_t len;
+    uint32_t n;
+    int carry_idx;
+    int iov_cnt;
     int rc;
+    int i;
 
-    while (om) {
-        rc = flash_area_write(loc->fe_area, loc->fe_data_off, om->om_data,
-                              om->om_len);
-        if (rc != 0) {
-            return SYS_EIO;
+    iov_cnt = 0;
+    iov[iov_cnt++] = (struct os_iovec) {
+        .iov_base = (void *)hdr,
+        .iov_len = LOG_BASE_ENTRY_HDR_SIZE,
+    };
+    if (hdr->ue_flags & LOG_FLAGS_IMG_HASH) {
+        iov[iov_cnt++] = (struct os_iovec) {
+            .iov_base = (void *)hdr->ue_imghash,
+            .iov_len = LOG_IMG_HASHLEN,
+        };
+    }
+
+    rc = os_mbuf_iov_init(&it, om, 0, os_mbuf_len(om));
+    if (rc != 0) {
+        return rc;
+    }
+
+    align = fcb->f_align;
+    carry_idx = 0;
+    while (1) {
+        iov_cnt += os_mbuf_iov_fill(&it, iov + iov_cnt,
+                                    LOG_FCB_MBUF_IOV_CNT - iov_cnt);
+
+        len = 0;
+        for (i = 0; i < iov_cnt; i++) {
+            len += iov[i].iov_len;
+        }
+
+        /* Hold back the unaligned tail unless this is the last batch.  The
+         * held-back bytes go in the other carry buffer; this batch may still
+         * be writing from the current one.
+         */
+        excess = os_mbuf_iov_done(&it) ? 0 : len % align;
+        held = excess;
+        len -= excess;
+        carry_idx ^= 1;
+        for (i = iov_cnt - 1; excess > 0; i--) {
+            n = min(iov[i].iov_len, excess);
+            iov[i].iov_len -= n;
+            excess -= n;
+            memcpy(carry[carry_idx] + excess,
+                   (uint8_t *)iov[i].iov_base + iov[i].iov_len, n);
+        }
+
+        if (len > 0) {
+            rc = fcb_writev(fcb, loc, iov, iov_cnt);
+            if (rc != 0) {
+                return SYS_EIO;
+            }
         }
 
-        loc->fe_data_off += om->om_len;
-        om = SLIST_NEXT(om, om_next);
+        if (os_mbuf_iov_done(&it)) {
+            break;
+        }
+
+        iov_cnt = 0;
+        if (held > 0) {
+            iov[iov_cnt++] = (struct os_iovec) {
+                .iov_base = carry[carry_idx],
+                .iov_len = held,
+            };
+        }
     }
 
     return 0;
@@ -552,12 +627,17 @@ log_fcb_append_mbuf_body(struct log *log, const struct log_entry_hdr *hdr,
     fcb_log = (struct fcb_log *)log->l_arg;
     fcb = &fcb_log->fl_fcb;
 
-    /* This function expects to be able to write each mbuf without any
-     * buffering.
+    if (fcb->f_align > LOG_FCB_MAX_ALIGN) {
+        return SYS_ENOTSUP;
+    }
+#if MYNEWT_VAL(LOG_FLAGS_TRAILER)
+    /* The trailer is padded from the end of the chain, which only lines up
+     * with what readers expect when writes are unaligned.
      */
-    if (fcb->f_align != 1) {
+    if (fcb->f_align != 1 && (hdr->ue_flags & LOG_FLAGS_TRAILER)) {
         return SYS_ENOTSUP;
     }
+#endif
 
     buflen = os_mbuf_len(om);
     len = log_hdr_len(hdr) + buflen;
@@ -588,23 +668,6 @@ log_fcb_append_mbuf_body(struct log *log, const struct log_entry_hdr *hdr,
         return rc;
     }
 
-    rc = flash_area_write(loc.fe_area, loc.fe_data_off, hdr,
-                          LOG_BASE_ENTRY_HDR_SIZE);
-    if (rc != 0) {
-        return rc;
-    }
-    loc.fe_data_off += LOG_BASE_ENTRY_HDR_SIZE;
-
-    if (hdr->ue_flags & LOG_FLAGS_IMG_HASH) {
-        /* Write LOG_IMG_HASHLEN bytes of image hash */
-        rc = flash_area_write(loc.fe_area, loc.fe_data_off, hdr->ue_imghash,
-                              LOG_IMG_HASHLEN);
-        if (rc != 0) {
-            return rc;
-        }
-        loc.fe_data_off += LOG_IMG_HASHLEN;
-    }
-
 #if MYNEWT_VAL(LOG_FLAGS_TRAILER)
     if (hdr->ue_flags & LOG_FLAGS_TRAILER) {
         /* The trailer gets appended after the padding + trailer_alignment
@@ -643,7 +706,7 @@ log_fcb_append_mbuf_body(struct log *log, const struct log_entry_hdr *hdr,
     }
 #endif
 
-    rc = log_fcb_write_mbuf(&loc, om);
+    rc = log_fcb_write_mbuf(fcb, &loc, hdr, om);
     if (rc != 0) {
         return rc;
     }
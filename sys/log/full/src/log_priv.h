@@ -0,0 +1,46 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef __SYS_LOG_FULL_PRIV_H_
+#define __SYS_LOG_FULL_PRIV_H_
+
+#include "os/mynewt.h"
+#include "log/log.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void log_call_append_cb(struct log *log, uint32_t idx);
+
+#if MYNEWT_VAL(LOG_ASYNC)
+void log_async_init(void);
+int log_async_append_body(struct log *log, const struct log_entry_hdr *hdr,
+                          const void *body, uint16_t body_len);
+int log_async_append_mbuf_body(struct log *log,
+                               const struct log_entry_hdr *hdr,
+                               const struct os_mbuf *om, uint16_t off,
+                               uint16_t body_len);
+void log_async_discard(struct log *log);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SYS_LOG_FULL_PRIV_H_ */
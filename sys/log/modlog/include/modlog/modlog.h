@@ -197,6 +197,21 @@ void modlog_printf(uint8_t module, uint8_t level, const char *msg, ...)
 #endif
     ;
 
+#if MYNEWT_VAL(LOG_DICT)
+/**
+ * @brief Writes a dictionary entry to the specified log module.
+ *
+ * This is the dictionary counterpart of modlog_printf().  It is normally
+ * invoked through the MODLOG_[...] macros rather than called directly.
+ *
+ * @param module                The log module to write to.
+ * @param level                 The severity of the log entry to write.
+ * @param fmt                   A table element created with LOG_DICT_FMT().
+ */
+void modlog_printf_dict(uint8_t module, uint8_t level,
+                        const char *const *fmt, ...);
+#endif
+
 /**
  * @brief Writes a specified number of bytes as a text entry to the specified log module.
  *
@@ -268,6 +283,15 @@ modlog_hexdump(uint8_t module, uint8_t level,
 
 #endif
 
+#if MYNEWT_VAL(LOG_DICT)
+#define MODLOG_PRINTF_(ml_mod_, ml_lvl_, ml_msg_, ...) \
+    modlog_printf_dict((ml_mod_), (ml_lvl_), LOG_DICT_FMT(ml_msg_), \
+                       ##__VA_ARGS__)
+#else
+#define MODLOG_PRINTF_(ml_mod_, ml_lvl_, ml_msg_, ...) \
+    modlog_printf((ml_mod_), (ml_lvl_), (ml_msg_), ##__VA_ARGS__)
+#endif
+
 #if MYNEWT_VAL(LOG_LEVEL) <= LOG_LEVEL_DEBUG || defined __DOXYGEN__
 /**
  * @brief Writes a formatted debug text entry to the specified log module.
@@ -279,7 +303,7 @@ modlog_hexdump(uint8_t module, uint8_t level,
  * @param ml_msg_               The "printf" formatted string to write.
  */
 #define MODLOG_DEBUG(ml_mod_, ml_msg_, ...) \
-    modlog_printf((ml_mod_), LOG_LEVEL_DEBUG, (ml_msg_), ##__VA_ARGS__)
+    MODLOG_PRINTF_((ml_mod_), LOG_LEVEL_DEBUG, ml_msg_, ##__VA_ARGS__)
 
 /**
  * @brief Writes a specified number of bytes as a debug text entry
@@ -314,7 +338,7 @@ modlog_hexdump(uint8_t module, uint8_t level,
  * @param ml_msg_               The "printf" formatted string to write.
  */
 #define MODLOG_INFO(ml_mod_, ml_msg_, ...) \
-    modlog_printf((ml_mod_), LOG_LEVEL_INFO, (ml_msg_), ##__VA_ARGS__)
+    MODLOG_PRINTF_((ml_mod_), LOG_LEVEL_INFO, ml_msg_, ##__VA_ARGS__)
 
 /**
  * @brief Writes a specified number of bytes as an info text entry
@@ -349,7 +373,7 @@ modlog_hexdump(uint8_t module, uint8_t level,
  * @param ml_msg_               The "printf" formatted string to write.
  */
 #define MODLOG_WARN(ml_mod_, ml_msg_, ...) \
-    modlog_printf((ml_mod_), LOG_LEVEL_WARN, (ml_msg_), ##__VA_ARGS__)
+    MODLOG_PRINTF_((ml_mod_), LOG_LEVEL_WARN, ml_msg_, ##__VA_ARGS__)
 
 /**
  * @brief Writes a specified number of bytes as a warn text entry
@@ -384,7 +408,7 @@ modlog_hexdump(uint8_t module, uint8_t level,
  * @param ml_msg_               The "printf" formatted string to write.
  */
 #define MODLOG_ERROR(ml_mod_, ml_msg_, ...) \
-    modlog_printf((ml_mod_), LOG_LEVEL_ERROR, (ml_msg_), ##__VA_ARGS__)
+    MODLOG_PRINTF_((ml_mod_), LOG_LEVEL_ERROR, ml_msg_, ##__VA_ARGS__)
 
 /**
  * @brief Writes a specified number of bytes as an error text entry
@@ -419,7 +443,7 @@ modlog_hexdump(uint8_t module, uint8_t level,
  * @param ml_msg_               The "printf" formatted string to write.
  */
 #define MODLOG_CRITICAL(ml_mod_, ml_msg_, ...) \
-    modlog_printf((ml_mod_), LOG_LEVEL_CRITICAL, (ml_msg_), ##__VA_ARGS__)
+    MODLOG_PRINTF_((ml_mod_), LOG_LEVEL_CRITICAL, ml_msg_, ##__VA_ARGS__)
 
 /**
  * @brief Writes a specified number of bytes as a critical text entry
@@ -476,6 +476,24 @@ modlog_printf(uint8_t module, uint8_t level, const char *msg, ...)
     modlog_append(module, level, LOG_ETYPE_STRING, buf, len);
 }
 
+#if MYNEWT_VAL(LOG_DICT)
+void
+modlog_printf_dict(uint8_t module, uint8_t level, const char *const *fmt, ...)
+{
+    va_list args;
+    uint8_t buf[MYNEWT_VAL(MODLOG_MAX_PRINTF_LEN)];
+    int len;
+
+    va_start(args, fmt);
+    len = log_dict_vencode(buf, sizeof(buf), fmt, args);
+    va_end(args);
+
+    if (len > 0) {
+        modlog_append(module, level, LOG_ETYPE_CBOR, buf, len);
+    }
+}
+#endif
+
 void
 modlog_hexdump(uint8_t module, uint8_t level,
                const void *data_ptr, uint16_t len, uint16_t line_break)
@@ -229,6 +229,104 @@ shell_os_mpool_display_cmd(const struct shell_cmd *cmd, int argc, char **argv,
     return 0;
 }
 
+#if MYNEWT_VAL(OS_MALLOC_SLAB)
+int
+shell_os_slab_display_cmd(const struct shell_cmd *cmd, int argc, char **argv,
+                          struct streamer *streamer)
+{
+    struct os_malloc_slab_info omsi;
+    uint64_t used_bytes;
+    int util;
+    int i;
+
+    streamer_printf(streamer, "Malloc size classes: \n");
+    streamer_printf(streamer, "%5s %4s %4s %4s %4s %10s %8s %4s\n",
+                    "blksz", "cnt", "free", "min", "hwm", "allocs", "fallback",
+                    "util");
+    for (i = 0; os_malloc_slab_info_get(i, &omsi) == 0; i++) {
+        /* Share of the allocated bytes that was actually requested. */
+        used_bytes = (uint64_t)omsi.omsi_allocs * omsi.omsi_block_size;
+        if (used_bytes != 0) {
+            util = (int)(omsi.omsi_req_bytes * 100 / used_bytes);
+        } else {
+            util = 100;
+        }
+
+        streamer_printf(streamer, "%5lu %4d %4d %4d %4d %10lu %8lu %3d%%\n",
+                        (unsigned long)omsi.omsi_block_size,
+                        omsi.omsi_num_blocks, omsi.omsi_num_free,
+                        omsi.omsi_min_free,
+                        omsi.omsi_num_blocks - omsi.omsi_min_free,
+                        (unsigned long)omsi.omsi_allocs,
+                        (unsigned long)omsi.omsi_fallbacks, util);
+    }
+
+    return 0;
+}
+#endif
+
+#if MYNEWT_VAL(MSYS_STATS)
+int
+shell_os_msys_display_cmd(const struct shell_cmd *cmd, int argc, char **argv,
+                          struct streamer *streamer)
+{
+    struct os_msys_info omsi;
+    const struct os_msys_stats *stats;
+    uint64_t used_bytes;
+    int util;
+    int i;
+    int j;
+
+    if (argc > 1 && !strcmp(argv[1], "clear")) {
+        os_msys_stats_clear();
+        return 0;
+    }
+
+    streamer_printf(streamer, "Msys pools: \n");
+    streamer_printf(streamer, "%5s %4s %4s %4s %10s %10s %8s %8s %8s %4s\n",
+                    "blksz", "cnt", "free", "min", "reqs", "blocks", "chains",
+                    "fallback", "fail", "util");
+    for (i = 0; os_msys_info_get(i, &omsi) == 0; i++) {
+        stats = &omsi.omsi_stats;
+
+        /* Share of the handed out bytes that was actually requested. */
+        used_bytes = (uint64_t)stats->oms_blocks * omsi.omsi_databuf_len;
+        if (used_bytes != 0 && stats->oms_req_bytes != 0) {
+            util = (int)((uint64_t)stats->oms_req_bytes * 100 / used_bytes);
+        } else {
+            util = 100;
+        }
+
+        streamer_printf(streamer, "%5d %4d %4d %4d %10lu %10lu %8lu %8lu %8lu "
+                        "%3d%%\n",
+                        omsi.omsi_databuf_len, omsi.omsi_num_blocks,
+                        omsi.omsi_num_free, omsi.omsi_min_free,
+                        (unsigned long)stats->oms_reqs,
+                        (unsigned long)stats->oms_blocks,
+                        (unsigned long)stats->oms_chains,
+                        (unsigned long)stats->oms_fallbacks,
+                        (unsigned long)stats->oms_failures, util);
+    }
+
+    streamer_printf(streamer, "Requested sizes: \n");
+    streamer_printf(streamer, "%5s", "blksz");
+    for (j = 0; j < OS_MSYS_HIST_BUCKETS - 1; j++) {
+        streamer_printf(streamer, " %7s%-4d", "<", 32 << j);
+    }
+    streamer_printf(streamer, " %7s%-4d\n", ">=", 32 << (j - 1));
+    for (i = 0; os_msys_info_get(i, &omsi) == 0; i++) {
+        streamer_printf(streamer, "%5d", omsi.omsi_databuf_len);
+        for (j = 0; j < OS_MSYS_HIST_BUCKETS; j++) {
+            streamer_printf(streamer, " %11lu",
+                            (unsigned long)omsi.omsi_stats.oms_hist[j]);
+        }
+        streamer_printf(streamer, "\n");
+    }
+
+    return 0;
+}
+#endif
+
 int
 shell_os_date_cmd(const struct shell_cmd *cmd, int argc, char **argv,
                   struct streamer *streamer)
@@ -340,6 +438,27 @@ static const struct shell_cmd_help mpool_help = {
     .params = mpool_params,
 };
 
+#if MYNEWT_VAL(OS_MALLOC_SLAB)
+static const struct shell_cmd_help slab_help = {
+    .summary = "show os_malloc size classes",
+    .usage = NULL,
+    .params = NULL,
+};
+#endif
+
+#if MYNEWT_VAL(MSYS_STATS)
+static const struct shell_param msys_params[] = {
+    {"clear", "clear the allocation counters"},
+    {NULL, NULL}
+};
+
+static const struct shell_cmd_help msys_help = {
+    .summary = "show msys pool allocation statistics",
+    .usage = NULL,
+    .params = msys_params,
+};
+#endif
+
 #if (MYNEWT_VAL(SHELL_OS_DATETIME_CMD) & 2) == 2
 static const struct shell_param date_params[] = {
     {"", "datetime to set"},
@@ -380,6 +499,12 @@ static const struct shell_cmd_help ls_dev_help = {
 MAKE_SHELL_EXT_CMD(tasks, shell_os_tasks_display_cmd, &tasks_help)
 MAKE_SHELL_EXT_CMD(uptime, uptime_cmd, &uptime_help);
 MAKE_SHELL_EXT_CMD(mpool, shell_os_mpool_display_cmd, &mpool_help)
+#if MYNEWT_VAL(OS_MALLOC_SLAB)
+MAKE_SHELL_EXT_CMD(slab, shell_os_slab_display_cmd, &slab_help)
+#endif
+#if MYNEWT_VAL(MSYS_STATS)
+MAKE_SHELL_EXT_CMD(msys, shell_os_msys_display_cmd, &msys_help)
+#endif
 MAKE_SHELL_EXT_CMD(date, shell_os_date_cmd, &date_help)
 MAKE_SHELL_EXT_CMD(reset, shell_os_reset_cmd, &reset_help)
 MAKE_SHELL_EXT_CMD(reset_cause, shell_os_print_reset_cause, &print_reset_cause_help)
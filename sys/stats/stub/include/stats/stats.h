@@ -63,6 +63,7 @@ struct stats_hdr {
 
 #define STATS_INC(__sectvarname, __var)
 #define STATS_INCN(__sectvarname, __var, __n)
+#define STATS_SET(__sectvarname, __var, __val)
 #define STATS_CLEAR(__sectvarname, __var)
 
 #define STATS_NAME_START(__name)
@@ -28,11 +28,47 @@
 extern "C" {
 #endif
 
+struct os_mbuf;
+
 uint32_t crc32_init(void);
 uint32_t crc32_calc(uint32_t val, const void *buf, size_t cnt);
 
+/**
+ * Continues a CRC-32 calculation over a range of an mbuf chain.  The data is
+ * read in place from each mbuf of the chain.  Built with
+ * UTIL_CRC_CRC32_MBUF.
+ *
+ * @param val                   On input, the CRC to continue from; on
+ *                                  success, the updated CRC.
+ * @param om                    The mbuf chain to read from.
+ * @param off                   Offset of the range within the chain.
+ * @param len                   Number of bytes to include.
+ *
+ * @return                      0 on success;
+ *                              SYS_EINVAL if the chain is too short.
+ */
+int crc32_calc_mbuf(uint32_t *val, const struct os_mbuf *om, int off,
+                    int len);
+
+/**
+ * Continues a CRC-32 calculation over a flash range.  The flash is read in
+ * small chunks through a stack buffer, so the range does not need to fit in
+ * RAM.  Built with UTIL_CRC_CRC32_FLASH.
+ *
+ * @param val                   On input, the CRC to continue from; on
+ *                                  success, the updated CRC.
+ * @param flash_id              The flash device to read from.
+ * @param addr                  Start address of the range.
+ * @param len                   Number of bytes to include.
+ *
+ * @return                      0 on success;
+ *                              SYS_EIO on flash read failure.
+ */
+int crc32_calc_flash(uint32_t *val, uint8_t flash_id, uint32_t addr,
+                     uint32_t len);
+
 #ifdef __cplusplus
 }
 #endif
 
-#endif /* _CRC16_H_ */
+#endif /* _CRC32_H_ */
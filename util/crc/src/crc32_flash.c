@@ -0,0 +1,56 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#include <syscfg/syscfg.h>
+
+#if MYNEWT_VAL(UTIL_CRC_CRC32_FLASH)
+
+#include "os/mynewt.h"
+#include "hal/hal_flash.h"
+#include <crc/crc32.h>
+
+#define CRC32_FLASH_BUF_SZ  64
+
+int
+crc32_calc_flash(uint32_t *val, uint8_t flash_id, uint32_t addr,
+                 uint32_t len)
+{
+    uint8_t buf[CRC32_FLASH_BUF_SZ];
+    uint32_t chunk;
+    uint32_t crc;
+    int rc;
+
+    crc = *val;
+    while (len > 0) {
+        chunk = min(len, sizeof(buf));
+        rc = hal_flash_read(flash_id, addr, buf, chunk);
+        if (rc != 0) {
+            return SYS_EIO;
+        }
+        crc = crc32_calc(crc, buf, chunk);
+        addr += chunk;
+        len -= chunk;
+    }
+
+    *val = crc;
+    return 0;
+}
+
+#endif
@@ -0,0 +1,55 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#include <syscfg/syscfg.h>
+
+#if MYNEWT_VAL(UTIL_CRC_CRC32_MBUF)
+
+#include "os/mynewt.h"
+#include <crc/crc32.h>
+
+int
+crc32_calc_mbuf(uint32_t *val, const struct os_mbuf *om, int off, int len)
+{
+    uint16_t om_off;
+    uint32_t crc;
+    int chunk;
+
+    om = os_mbuf_off(om, off, &om_off);
+
+    crc = *val;
+    while (len > 0) {
+        if (om == NULL) {
+            return SYS_EINVAL;
+        }
+
+        chunk = min(om->om_len - om_off, len);
+        crc = crc32_calc(crc, om->om_data + om_off, chunk);
+        len -= chunk;
+
+        om = SLIST_NEXT(om, om_next);
+        om_off = 0;
+    }
+
+    *val = crc;
+    return 0;
+}
+
+#endif